@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <boost/program_options.hpp>
+#include <filesystem>
+#include <set>
+
+#include "AppBase.hpp"
+#include "libreporter/ArchiveReader.h"
+#include "visibility.h"
+
+namespace trade
+{
+
+/// Exports tick archives written by ArchiveReporter to CSV files in the same
+/// format as CSVReporter.
+class TD_PUBLIC_API ArchiveExporter final: private AppBase<>
+{
+public:
+    ArchiveExporter(int argc, char* argv[]);
+    ~ArchiveExporter() override = default;
+
+public:
+    int run();
+    int stop(int signal);
+    static void signal(int signal);
+
+private:
+    bool argv_parse(int argc, char* argv[]);
+
+private:
+    void export_archive(const std::filesystem::path& input, const std::filesystem::path& output);
+    static void write_csv(const reporter::archive::Table& table, const std::string& symbol, std::ostream& out);
+
+private:
+    boost::program_options::variables_map m_arguments;
+
+private:
+    std::atomic<bool> m_is_running = false;
+    std::atomic<int> m_exit_code   = 0;
+
+private:
+    static std::set<ArchiveExporter*> m_instances;
+};
+
+} // namespace trade
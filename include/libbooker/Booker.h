@@ -43,6 +43,16 @@ public:
     bool trade(const TradeTickPtr& trade_tick);
     void switch_to_continuous_stage();
 
+public:
+    /// Generated ticks are held until end_batch() and then reported in batch,
+    /// e.g. once per input packet, instead of one by one.
+    void begin_batch();
+    void end_batch();
+
+private:
+    void report(const GeneratedL2TickPtr& generated_l2_tick);
+    void report(const RangedTickPtr& ranged_tick);
+
 private:
     void auction(const OrderWrapperPtr& order_wrapper);
 
@@ -136,6 +146,9 @@ private:
 
 private:
     std::shared_ptr<reporter::IReporter> m_reporter;
+    bool m_is_batching = false;
+    std::vector<GeneratedL2TickPtr> m_pending_l2_ticks;
+    std::vector<RangedTickPtr> m_pending_ranged_ticks;
 };
 
 template<typename TickTypePtr>
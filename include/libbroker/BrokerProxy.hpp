@@ -2,6 +2,7 @@
 
 #include "AppBase.hpp"
 #include "IBroker.h"
+#include "RiskEngine.hpp"
 #include "libholder/IHolder.h"
 #include "libreporter/IReporter.hpp"
 #include "utilities/TimeHelper.hpp"
@@ -11,7 +12,8 @@ namespace trade::broker
 {
 
 /// BrokerProxy provides a basic processing logic required by a broker, e.g. ID
-/// generation, database operations, etc.
+/// generation, database operations, etc. Orders and cancels passing it are
+/// handed one by one to send_order and send_cancel of the broker.
 template<typename TickerTaperT = int64_t, utilities::ConfigFileType ConfigFileType = utilities::ConfigFileType::INI>
 class BrokerProxy
     : public IBroker,
@@ -27,12 +29,15 @@ public:
         m_holder(holder),
         m_reporter(reporter)
     {
+        if (AppBase<TickerTaperT, ConfigFileType>::config->template get<bool>("Risk.EnableRisk", false)) {
+            m_risk_engine = std::make_shared<RiskEngine>(risk_limits(), AppBase<TickerTaperT, ConfigFileType>::config->template get<double>("Risk.AvailableFund", -1), m_reporter);
+        }
     }
 
     ~BrokerProxy() override = default;
 
 public:
-    std::shared_ptr<types::NewOrderRsp> new_order(std::shared_ptr<types::NewOrderReq> new_order_req) override
+    std::shared_ptr<types::NewOrderRsp> new_order(std::shared_ptr<types::NewOrderReq> new_order_req) final
     {
         auto new_order_rsp = std::make_shared<types::NewOrderRsp>();
 
@@ -45,10 +50,24 @@ public:
             new_order_req->set_unique_id(AppBase<TickerTaperT, ConfigFileType>::snow_flaker());
         }
 
+        /// Checked before anything is written, rejected orders never reach
+        /// holder or broker.
+        if (const auto rejection_code = check_risk(*new_order_req); rejection_code != types::RejectionCode::invalid_rejection_code) [[unlikely]] {
+            new_order_rsp->set_request_id(new_order_req->request_id());
+            new_order_rsp->set_unique_id(INVALID_ID);
+            new_order_rsp->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
+            new_order_rsp->set_rejection_code(rejection_code);
+            new_order_rsp->set_rejection_reason(fmt::format("Rejected by risk check: {}", types::RejectionCode_Name(rejection_code)));
+
+            return new_order_rsp;
+        }
+
         /// Pre-create order in holder.
         if (!pre_insert_order(new_order_req)) {
             AppBase<TickerTaperT, ConfigFileType>::logger->error("Failed to pre-create order due to holder error: {}", utilities::ToJSON()(*new_order_req));
 
+            release_risk(new_order_req->unique_id());
+
             new_order_rsp->set_request_id(new_order_req->request_id());
             new_order_rsp->set_unique_id(INVALID_ID);
             new_order_rsp->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
@@ -64,10 +83,12 @@ public:
         new_order_rsp->set_unique_id(new_order_req->unique_id());
         new_order_rsp->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
 
+        send(new_order_req, new_order_rsp);
+
         return new_order_rsp;
     }
 
-    std::shared_ptr<types::NewCancelRsp> cancel_order(std::shared_ptr<types::NewCancelReq> new_cancel_req) override
+    std::shared_ptr<types::NewCancelRsp> cancel_order(std::shared_ptr<types::NewCancelReq> new_cancel_req) final
     {
         auto new_cancel_rsp = std::make_shared<types::NewCancelRsp>();
 
@@ -82,6 +103,8 @@ public:
         new_cancel_rsp->set_original_unique_id(new_cancel_req->original_unique_id());
         new_cancel_rsp->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
 
+        send_cancel(new_cancel_req, new_cancel_rsp);
+
         return new_cancel_rsp;
     }
 
@@ -100,33 +123,221 @@ public:
         return new_cancel_all_rsp;
     }
 
+    std::shared_ptr<types::NewOrdersRsp> new_orders(std::shared_ptr<types::NewOrdersReq> new_orders_req) final
+    {
+        auto new_orders_rsp = std::make_shared<types::NewOrdersRsp>();
+
+        /// Orders without request_id share the one of batch.
+        if (!new_orders_req->has_request_id()) {
+            new_orders_req->set_request_id(AppBase<TickerTaperT, ConfigFileType>::snow_flaker());
+        }
+
+        for (auto& new_order_req : *new_orders_req->mutable_orders()) {
+            if (!new_order_req.has_request_id()) {
+                new_order_req.set_request_id(new_orders_req->request_id());
+            }
+
+            if (!new_order_req.has_unique_id()) {
+                new_order_req.set_unique_id(AppBase<TickerTaperT, ConfigFileType>::snow_flaker());
+            }
+        }
+
+        /// Pre-create all orders passed risk check in one holder transaction.
+        std::vector<types::RejectionCode> rejection_codes;
+        rejection_codes.reserve(new_orders_req->orders_size());
+
+        const auto orders = std::make_shared<types::Orders>();
+
+        for (const auto& new_order_req : new_orders_req->orders()) {
+            rejection_codes.push_back(check_risk(new_order_req));
+            rejection_codes.back() == types::RejectionCode::invalid_rejection_code ? to_order(new_order_req, *orders->add_orders()) : void();
+        }
+
+        const bool is_pre_inserted = orders->orders_size() == 0 || m_holder->update_orders(orders) == orders->orders_size();
+
+        if (!is_pre_inserted) {
+            for (const auto& order : orders->orders())
+                release_risk(order.unique_id());
+        }
+
+        if (is_pre_inserted) {
+            AppBase<TickerTaperT, ConfigFileType>::logger->info("{} new orders pre-created in batch {}", new_orders_req->orders_size(), new_orders_req->request_id());
+
+            if (AppBase<TickerTaperT, ConfigFileType>::logger->should_log(spdlog::level::debug)) {
+                for (const auto& new_order_req : new_orders_req->orders())
+                    AppBase<TickerTaperT, ConfigFileType>::logger->debug("New order pre-created: {}", utilities::ToJSON()(new_order_req));
+            }
+        }
+        else {
+            AppBase<TickerTaperT, ConfigFileType>::logger->error("Failed to pre-create {} orders in batch {} due to holder error: {}", new_orders_req->orders_size(), new_orders_req->request_id(), utilities::ToJSON()(*new_orders_req));
+        }
+
+        const std::unique_ptr<google::protobuf::Timestamp> creation_time {utilities::Now<google::protobuf::Timestamp*>()()};
+
+        new_orders_rsp->set_request_id(new_orders_req->request_id());
+
+        for (int i = 0; i < new_orders_req->orders_size(); i++) {
+            const auto& new_order_req = new_orders_req->orders(i);
+            const auto new_order_rsp  = new_orders_rsp->add_orders();
+
+            new_order_rsp->set_request_id(new_order_req.request_id());
+            new_order_rsp->mutable_creation_time()->CopyFrom(*creation_time);
+
+            if (rejection_codes[i] != types::RejectionCode::invalid_rejection_code) [[unlikely]] {
+                new_order_rsp->set_unique_id(INVALID_ID);
+                new_order_rsp->set_rejection_code(rejection_codes[i]);
+                new_order_rsp->set_rejection_reason(fmt::format("Rejected by risk check: {}", types::RejectionCode_Name(rejection_codes[i])));
+            }
+            else if (is_pre_inserted) {
+                new_order_rsp->set_unique_id(new_order_req.unique_id());
+            }
+            else {
+                new_order_rsp->set_unique_id(INVALID_ID);
+                new_order_rsp->set_rejection_code(types::RejectionCode::unknown);
+                new_order_rsp->set_rejection_reason("Internal error. Check server side logs for details."); /// Do not send sensitive info to client side.
+            }
+        }
+
+        /// Orders share the lifetime of batch.
+        for (int i = 0; i < new_orders_rsp->orders_size(); i++) {
+            if (new_orders_rsp->orders(i).has_rejection_code())
+                continue;
+
+            send(
+                std::shared_ptr<types::NewOrderReq>(new_orders_req, new_orders_req->mutable_orders(i)),
+                std::shared_ptr<types::NewOrderRsp>(new_orders_rsp, new_orders_rsp->mutable_orders(i))
+            );
+        }
+
+        return new_orders_rsp;
+    }
+
+    std::shared_ptr<types::NewCancelsRsp> cancel_orders(std::shared_ptr<types::NewCancelsReq> new_cancels_req) final
+    {
+        auto new_cancels_rsp = std::make_shared<types::NewCancelsRsp>();
+
+        /// Cancels without request_id share the one of batch.
+        if (!new_cancels_req->has_request_id()) {
+            new_cancels_req->set_request_id(AppBase<TickerTaperT, ConfigFileType>::snow_flaker());
+        }
+
+        AppBase<TickerTaperT, ConfigFileType>::logger->info("{} new cancels pre-created in batch {}", new_cancels_req->cancels_size(), new_cancels_req->request_id());
+
+        const std::unique_ptr<google::protobuf::Timestamp> creation_time {utilities::Now<google::protobuf::Timestamp*>()()};
+
+        new_cancels_rsp->set_request_id(new_cancels_req->request_id());
+
+        for (auto& new_cancel_req : *new_cancels_req->mutable_cancels()) {
+            if (!new_cancel_req.has_request_id()) {
+                new_cancel_req.set_request_id(new_cancels_req->request_id());
+            }
+
+            const auto new_cancel_rsp = new_cancels_rsp->add_cancels();
+
+            new_cancel_rsp->set_request_id(new_cancel_req.request_id());
+            new_cancel_rsp->set_original_unique_id(new_cancel_req.original_unique_id());
+            new_cancel_rsp->mutable_creation_time()->CopyFrom(*creation_time);
+        }
+
+        for (int i = 0; i < new_cancels_rsp->cancels_size(); i++) {
+            send_cancel(
+                std::shared_ptr<types::NewCancelReq>(new_cancels_req, new_cancels_req->mutable_cancels(i)),
+                std::shared_ptr<types::NewCancelRsp>(new_cancels_rsp, new_cancels_rsp->mutable_cancels(i))
+            );
+        }
+
+        return new_cancels_rsp;
+    }
+
+protected:
+    /// Sends an order passing risk check and pre-created in holder, sets
+    /// rejection of response if it is not sent.
+    virtual void send_order(std::shared_ptr<types::NewOrderReq> new_order_req, std::shared_ptr<types::NewOrderRsp> new_order_rsp) = 0;
+    /// Sends a cancel, sets rejection of response if it is not sent.
+    virtual void send_cancel(std::shared_ptr<types::NewCancelReq> new_cancel_req, std::shared_ptr<types::NewCancelRsp> new_cancel_rsp) = 0;
+
+    /// Reporter for order and trade callbacks of broker, so that counters of
+    /// risk engine follow them.
+    [[nodiscard]] std::shared_ptr<reporter::IReporter> trade_reporter() const
+    {
+        return m_risk_engine != nullptr ? m_risk_engine : m_reporter;
+    }
+
+    /// Release counters of an order failed to be sent to broker.
+    void release_risk(const int64_t unique_id) const
+    {
+        m_risk_engine != nullptr ? m_risk_engine->release(unique_id) : void();
+    }
+
 private:
+    void send(const std::shared_ptr<types::NewOrderReq>& new_order_req, const std::shared_ptr<types::NewOrderRsp>& new_order_rsp)
+    {
+        send_order(new_order_req, new_order_rsp);
+
+        /// Not sent, never to be reported by broker.
+        new_order_rsp->has_rejection_code() ? release_risk(new_order_req->unique_id()) : void();
+    }
+
+    [[nodiscard]] types::RejectionCode check_risk(const types::NewOrderReq& new_order_req) const
+    {
+        if (m_risk_engine == nullptr)
+            return types::RejectionCode::invalid_rejection_code;
+
+        const auto rejection_code = m_risk_engine->check(new_order_req);
+
+        if (rejection_code != types::RejectionCode::invalid_rejection_code) [[unlikely]] {
+            AppBase<TickerTaperT, ConfigFileType>::logger->warn("New order rejected by risk check with {}: {}", types::RejectionCode_Name(rejection_code), utilities::ToJSON()(new_order_req));
+        }
+
+        return rejection_code;
+    }
+
+    [[nodiscard]] RiskLimits risk_limits() const
+    {
+        const auto& config = AppBase<TickerTaperT, ConfigFileType>::config;
+
+        return {
+            .max_order_quantity    = config->template get<int64_t>("Risk.MaxOrderQuantity", 0),
+            .max_order_value       = config->template get<double>("Risk.MaxOrderValue", 0),
+            .max_symbol_position   = config->template get<int64_t>("Risk.MaxSymbolPosition", 0),
+            .max_working_value     = config->template get<double>("Risk.MaxWorkingValue", 0),
+            .max_order_rate        = config->template get<int64_t>("Risk.MaxOrderRate", 0),
+            .max_order_burst       = config->template get<int64_t>("Risk.MaxOrderBurst", 1),
+            .is_self_trade_guarded = config->template get<bool>("Risk.EnableSelfTradeGuard", true),
+            .symbol_capacity       = config->template get<size_t>("Risk.SymbolCapacity", 1 << 14),
+            .order_capacity        = config->template get<size_t>("Risk.OrderCapacity", 1 << 18),
+        };
+    }
+
     [[nodiscard]] bool pre_insert_order(const std::shared_ptr<types::NewOrderReq>& new_order_req) const
     {
         const auto orders = std::make_shared<types::Orders>();
 
-        types::Order order;
+        to_order(*new_order_req, *orders->add_orders());
+
+        /// Return true if the order is inserted successfully.
+        return m_holder->update_orders(orders) == 1;
+    }
 
-        order.set_unique_id(new_order_req->unique_id());
+    static void to_order(const types::NewOrderReq& new_order_req, types::Order& order)
+    {
+        order.set_unique_id(new_order_req.unique_id());
         order.clear_broker_id();   /// No broker_id yet.
         order.clear_exchange_id(); /// No exchange_id yet.
-        order.set_symbol(new_order_req->symbol());
-        order.set_side(new_order_req->side());
-        order.set_position_side(new_order_req->position_side());
-        order.set_price(new_order_req->price());
-        order.set_quantity(new_order_req->quantity());
+        order.set_symbol(new_order_req.symbol());
+        order.set_side(new_order_req.side());
+        order.set_position_side(new_order_req.position_side());
+        order.set_price(new_order_req.price());
+        order.set_quantity(new_order_req.quantity());
         order.set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
         order.set_allocated_update_time(utilities::Now<google::protobuf::Timestamp*>()());
-
-        orders->add_orders()->CopyFrom(order);
-
-        /// Return true if the order is inserted successfully.
-        return m_holder->update_orders(orders) == 1;
     }
 
 protected:
     std::shared_ptr<holder::IHolder> m_holder;
     std::shared_ptr<reporter::IReporter> m_reporter;
+    /// Null if risk check is not enabled.
+    std::shared_ptr<RiskEngine> m_risk_engine;
 };
 
 } // namespace trade::broker
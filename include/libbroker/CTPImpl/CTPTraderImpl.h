@@ -1,7 +1,10 @@
 #pragma once
 
+#include <mutex>
+
 #include "AppBase.hpp"
 #include "CTPCommonData.h"
+#include "libbroker/OrderStateCache.hpp"
 #include "libholder/IHolder.h"
 #include "libreporter/IReporter.hpp"
 #include "third/ctp/ThostFtdcTraderApi.h"
@@ -96,6 +99,7 @@ private:
         CThostFtdcRspInfoField* pRspInfo
     ) override;
     void OnRtnOrder(CThostFtdcOrderField* pOrder) override;
+    void OnRtnTrade(CThostFtdcTradeField* pTrade) override;
 
 private:
     CThostFtdcTraderApi* m_trader_api;
@@ -106,8 +110,10 @@ private:
     std::unordered_map<std::string, CThostFtdcProductField> m_products;
     /// InstrumentID -> CThostFtdcTradingAccountField.
     std::unordered_map<std::string, CThostFtdcTradingAccountField> m_trading_account;
-    /// OrderRef -> CThostFtdcOrderField.
-    std::unordered_map<std::string, CThostFtdcOrderField> m_orders;
+    /// Orders by OrderRef and exchange id, so that @OnRtnOrder never
+    /// queries holder for orders seen before.
+    OrderStateCache m_order_states;
+    std::mutex m_insert_mutex;
 
 private:
     /// nRequestID -> UniqueID/RequestID.
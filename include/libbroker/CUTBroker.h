@@ -23,14 +23,14 @@ public:
     void start_login() noexcept override;
     void start_logout() noexcept override;
 
-public:
-    std::shared_ptr<types::NewOrderRsp> new_order(std::shared_ptr<types::NewOrderReq> new_order_req) override;
-    std::shared_ptr<types::NewCancelRsp> cancel_order(std::shared_ptr<types::NewCancelReq> new_cancel_req) override;
-
 public:
     void subscribe(const std::unordered_set<std::string>& symbols) override;
     void unsubscribe(const std::unordered_set<std::string>& symbols) override;
 
+protected:
+    void send_order(std::shared_ptr<types::NewOrderReq> new_order_req, std::shared_ptr<types::NewOrderRsp> new_order_rsp) override;
+    void send_cancel(std::shared_ptr<types::NewCancelReq> new_cancel_req, std::shared_ptr<types::NewCancelRsp> new_cancel_rsp) override;
+
 private:
     std::unique_ptr<CUTMdImpl> m_md_impl;
     std::unique_ptr<CUTTraderImpl> m_trader_impl;
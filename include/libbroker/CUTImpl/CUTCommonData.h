@@ -1,9 +1,13 @@
 #pragma once
 
+#include <span>
+
 #include "RawStructure.h"
 #include "libbooker/BookerCommonData.h"
 #include "networks.pb.h"
 #include "third/cut/UTApiStruct.h"
+#include "utilities/DigitParser.hpp"
+#include "utilities/MessagePool.hpp"
 
 namespace trade::broker
 {
@@ -59,7 +63,11 @@ public:
     /// @return std::tuple<exchange, order_sys_id>. Empty string if exchange_id
     /// is not in format.
     [[nodiscard]] static std::tuple<std::string, std::string> from_exchange_id(const std::string& exchange_id);
-    [[nodiscard]] static int64_t get_symbol_from_message(const std::vector<u_char>& message);
+    [[nodiscard]] static int64_t get_symbol_from_message(std::span<const u_char> message);
+    /// Extract exchange, channel and per-channel sequence from message.
+    /// @return std::tuple<exchange, channel, seq>. Exchange is
+    /// invalid_exchange if message carries no per-channel sequence.
+    [[nodiscard]] static std::tuple<types::ExchangeType, int64_t, int64_t> get_channel_seq_from_message(std::span<const u_char> message);
     template<IsOrderTick MessageType>
     [[nodiscard]] static booker::OrderTickPtr to_order_tick(const std::vector<u_char>& message);
     template<IsTradeTick Mess7ageType>
@@ -94,7 +102,7 @@ public:
 template<>
 inline booker::OrderTickPtr CUTCommonData::to_order_tick<SSEHpfTick>(const std::vector<u_char>& message)
 {
-    auto order_tick = std::make_shared<types::OrderTick>();
+    auto order_tick = utilities::MessagePool<types::OrderTick>::local()->acquire();
 
     assert(message.size() == sizeof(SSEHpfTick));
     const auto raw_order = reinterpret_cast<const SSEHpfTick*>(message.data());
@@ -119,7 +127,7 @@ inline booker::OrderTickPtr CUTCommonData::to_order_tick<SSEHpfTick>(const std::
 template<>
 inline booker::OrderTickPtr CUTCommonData::to_order_tick<SZSEHpfOrderTick>(const std::vector<u_char>& message)
 {
-    auto order_tick = std::make_shared<types::OrderTick>();
+    auto order_tick = utilities::MessagePool<types::OrderTick>::local()->acquire();
 
     assert(message.size() == sizeof(SZSEHpfOrderTick));
     const auto raw_order = reinterpret_cast<const SZSEHpfOrderTick*>(message.data());
@@ -144,7 +152,7 @@ inline booker::OrderTickPtr CUTCommonData::to_order_tick<SZSEHpfOrderTick>(const
 template<>
 inline booker::TradeTickPtr CUTCommonData::to_trade_tick<SZSEHpfTradeTick>(const std::vector<u_char>& message)
 {
-    auto trade_tick = std::make_shared<types::TradeTick>();
+    auto trade_tick = utilities::MessagePool<types::TradeTick>::local()->acquire();
 
     assert(message.size() == sizeof(SZSEHpfTradeTick));
     const auto raw_trade = reinterpret_cast<const SZSEHpfTradeTick*>(message.data());
@@ -169,7 +177,7 @@ inline booker::TradeTickPtr CUTCommonData::to_trade_tick<SZSEHpfTradeTick>(const
 template<>
 inline booker::ExchangeL2SnapPtr CUTCommonData::to_l2_tick<SSEHpfL2Snap>(const std::vector<u_char>& message)
 {
-    auto exchange_l2_snap = std::make_shared<types::ExchangeL2Snap>();
+    auto exchange_l2_snap = utilities::MessagePool<types::ExchangeL2Snap>::local()->acquire();
 
     assert(message.size() == sizeof(SSEHpfL2Snap));
     const auto raw_l2_tick = reinterpret_cast<const SSEHpfL2Snap*>(message.data());
@@ -215,7 +223,7 @@ inline booker::ExchangeL2SnapPtr CUTCommonData::to_l2_tick<SSEHpfL2Snap>(const s
 template<>
 inline booker::ExchangeL2SnapPtr CUTCommonData::to_l2_tick<SZSEHpfL2Snap>(const std::vector<u_char>& message)
 {
-    auto exchange_l2_snap = std::make_shared<types::ExchangeL2Snap>();
+    auto exchange_l2_snap = utilities::MessagePool<types::ExchangeL2Snap>::local()->acquire();
 
     assert(message.size() == sizeof(SZSEHpfL2Snap));
     const auto raw_l2_tick = reinterpret_cast<const SZSEHpfL2Snap*>(message.data());
@@ -263,6 +271,12 @@ int64_t CUTCommonData::to_unique_id(T exchange_raw_id, const std::string_view sy
 {
     int64_t unique_id = static_cast<int64_t>(exchange_raw_id) * 1000000;
 
+    /// Six-digit symbols are parsed without std::stoll.
+    if (symbol.size() == 6) [[likely]] {
+        if (const auto code = utilities::DigitParser<6>()(symbol.data()); code >= 0) [[likely]]
+            return unique_id + code;
+    }
+
     try {
         unique_id += std::stoll(symbol.data());
     }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <boost/lockfree/spsc_queue.hpp>
+#include <chrono>
+#include <map>
 #include <pcap/pcap.h>
 
 #include "AppBase.hpp"
@@ -8,7 +10,10 @@
 #include "libholder/IHolder.h"
 #include "libreporter/IReporter.hpp"
 #include "third/ctp/ThostFtdcMdApi.h"
+#include "utilities/FeedArbitrator.hpp"
 #include "utilities/LoginSyncer.hpp"
+#include "utilities/SeqGapDetector.hpp"
+#include "utilities/SymbolBitmap.hpp"
 
 namespace trade::broker
 {
@@ -29,7 +34,18 @@ public:
     void unsubscribe(const std::unordered_set<std::string>& symbols);
 
 private:
-    using MessageBufferType = boost::lockfree::spsc_queue<std::vector<u_char>*, boost::lockfree::capacity<100000000>>;
+    /// @return Index of symbol in bitmap, -1 if it is not a six-digit symbol.
+    [[nodiscard]] static int64_t to_symbol_index(const std::string& symbol);
+
+private:
+    using MessageType       = std::vector<u_char>*;
+    using MessageBufferType = boost::lockfree::spsc_queue<MessageType, boost::lockfree::capacity<100000000>>;
+
+    /// Messages pending for one booker shard, published as a whole.
+    struct MessageBatch {
+        std::vector<MessageType> messages;
+        std::chrono::steady_clock::time_point first_arrival;
+    };
 
     pcap_t* init_pcap_handle(
         const std::string& interface,
@@ -39,16 +55,56 @@ private:
         pcap_t* handle,
         std::string dump_file
     ) const;
+    /// Packet fetched ahead from a line.
+    struct LinePacket {
+        pcap_pkthdr* header  = nullptr;
+        const u_char* packet = nullptr;
+        bool exhausted       = false;
+    };
+
+    /// @return Line of the earliest packet available, -1 if there is none.
+    int64_t next_packet(const std::vector<pcap_t*>& handles, std::vector<LinePacket>& lines) const;
+    bool arbitrate(size_t line, const pcap_pkthdr& header, std::span<const u_char> payload);
     void tick_receiver();
+    void flush(MessageBatch& batch, MessageBufferType& message_buffer) const;
+    void check_seq(std::span<const u_char> message);
+    void dump_feed_stats() const;
+    /// Exchange ticks of one popped batch, reported together.
+    struct TickBatch {
+        std::vector<booker::OrderTickPtr> order_ticks;
+        std::vector<booker::TradeTickPtr> trade_ticks;
+        std::vector<booker::ExchangeL2SnapPtr> l2_snaps;
+    };
+
     void booker(MessageBufferType& message_buffer);
+    void book(booker::Booker& booker, const std::vector<u_char>& message, TickBatch& ticks) const;
 
 private:
     std::atomic<bool> m_is_running;
+    /// Bookers exit only after tick receiver published its last batch.
+    std::atomic<bool> m_is_receiving = false;
     std::thread m_tick_receiver_thread;
     size_t m_booker_thread_size;
     std::vector<std::thread> m_booker_threads;
     std::vector<std::unique_ptr<MessageBufferType>> m_message_buffers;
 
+private:
+    /// Messages handed to/taken from a booker shard at once.
+    size_t m_batch_size;
+    /// Max time a message may wait in a pending batch before published.
+    std::chrono::microseconds m_max_batch_latency;
+
+private:
+    /// Sequence tracking per exchange channel, only accessed by tick
+    /// receiver thread.
+    std::map<std::tuple<types::ExchangeType, int64_t>, utilities::SeqGapDetector<>> m_seq_gap_detectors;
+    /// Arbitrates A/B lines if backup interface is configured.
+    std::unique_ptr<utilities::FeedArbitrator<std::tuple<types::ExchangeType, int64_t>>> m_feed_arbitrator;
+
+private:
+    /// Symbols to book, checked on raw packets before queueing.
+    utilities::SymbolBitmap m_subscribed_symbols;
+
 private:
     std::shared_ptr<holder::IHolder> m_holder;
     std::shared_ptr<reporter::IReporter> m_reporter;
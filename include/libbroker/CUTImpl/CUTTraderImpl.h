@@ -1,7 +1,10 @@
 #pragma once
 
+#include <mutex>
+
 #include "AppBase.hpp"
 #include "CUTCommonData.h"
+#include "libbroker/OrderStateCache.hpp"
 #include "libholder/IHolder.h"
 #include "libreporter/IReporter.hpp"
 #include "third/cut/UTApi.h"
@@ -75,10 +78,15 @@ private:
     ) override;
     void OnErrRtnOrderAction(CUTOrderActionField* pOrderAction) override;
     void OnRtnOrder(CUTOrderField* pOrder) override;
+    void OnRtnTrade(CUTTradeField* pTrade) override;
 
 private:
     CUTApi* m_trader_api;
     CUTCommonData m_common_data;
+    /// Orders by OrderRef and exchange id, so that @OnRtnOrder never
+    /// queries holder for orders seen before.
+    OrderStateCache m_order_states;
+    std::mutex m_insert_mutex;
 
 private:
     /// nRequestID -> UniqueID/RequestID.
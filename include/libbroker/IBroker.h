@@ -22,6 +22,10 @@ public:
     virtual std::shared_ptr<types::NewCancelRsp> cancel_order(std::shared_ptr<types::NewCancelReq> new_cancel_req)         = 0;
     virtual std::shared_ptr<types::NewCancelAllRsp> cancel_all(std::shared_ptr<types::NewCancelAllReq> new_cancel_all_req) = 0;
 
+    /// Batches are handled as one unit, responses are in order of requests.
+    virtual std::shared_ptr<types::NewOrdersRsp> new_orders(std::shared_ptr<types::NewOrdersReq> new_orders_req)           = 0;
+    virtual std::shared_ptr<types::NewCancelsRsp> cancel_orders(std::shared_ptr<types::NewCancelsReq> new_cancels_req)     = 0;
+
 public:
     virtual void subscribe(const std::unordered_set<std::string>& symbols)   = 0;
     virtual void unsubscribe(const std::unordered_set<std::string>& symbols) = 0;
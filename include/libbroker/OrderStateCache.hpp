@@ -0,0 +1,257 @@
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "libreporter/IReporter.hpp"
+#include "orms.pb.h"
+#include "utilities/TimeHelper.hpp"
+
+namespace trade::broker
+{
+
+/// Order as last reported by broker.
+struct OrderState {
+    types::Order order;
+    /// Cumulative traded quantity of order callbacks.
+    int64_t traded_quantity = 0;
+    /// Cumulative quantity of trade callbacks, and their trade ids, as
+    /// trades are replayed after reconnecting.
+    int64_t filled_quantity = 0;
+    std::unordered_set<std::string> trade_ids;
+    /// Raw order status and submit status of SDK, 0 before first report.
+    char status        = 0;
+    char submit_status = 0;
+
+    /// @return Trade of a trade callback, nullptr if already reported.
+    [[nodiscard]] std::shared_ptr<types::Trade> fill(const std::string& trade_id, const double price, const int64_t quantity)
+    {
+        if (!trade_ids.insert(trade_id).second)
+            return nullptr;
+
+        filled_quantity += quantity;
+
+        const auto trade = std::make_shared<types::Trade>();
+
+        trade->set_unique_id(order.unique_id());
+        order.has_broker_id() ? trade->set_broker_id(order.broker_id()) : void();
+        order.has_exchange_id() ? trade->set_exchange_id(order.exchange_id()) : void();
+        trade->set_trade_id(trade_id);
+        trade->set_symbol(order.symbol());
+        trade->set_side(order.side());
+        trade->set_price(price);
+        trade->set_quantity(quantity);
+        trade->set_cumulative_quantity(filled_quantity);
+        trade->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+        return trade;
+    }
+};
+
+/// Changes of an order found in a callback, reported after cache unlocked.
+struct OrderEvents {
+    bool is_broker_accepted   = false;
+    bool is_exchange_accepted = false;
+    bool is_rejected          = false;
+    bool is_canceled          = false;
+    bool is_cancel_rejected   = false;
+    /// Order after changes, not copied if nothing changed.
+    types::Order order;
+    int64_t canceled_quantity = 0;
+    /// Reason of rejection.
+    std::string reason;
+
+    [[nodiscard]] bool is_empty() const { return !is_broker_accepted && !is_exchange_accepted && !is_rejected && !is_canceled && !is_cancel_rejected; }
+
+    /// Only broker_id/exchange_id of order are kept by holder.
+    [[nodiscard]] bool is_persisted() const { return is_broker_accepted || is_exchange_accepted; }
+
+    void report(reporter::IReporter& reporter) const
+    {
+        if (is_broker_accepted) {
+            const auto broker_acceptance = std::make_shared<types::BrokerAcceptance>();
+
+            broker_acceptance->set_unique_id(order.unique_id());
+            broker_acceptance->set_broker_id(order.broker_id());
+            broker_acceptance->set_allocated_broker_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+            reporter.broker_accepted(broker_acceptance);
+        }
+
+        if (is_exchange_accepted) {
+            const auto exchange_acceptance = std::make_shared<types::ExchangeAcceptance>();
+
+            exchange_acceptance->set_unique_id(order.unique_id());
+            exchange_acceptance->set_exchange_id(order.exchange_id());
+            exchange_acceptance->set_allocated_exchange_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+            reporter.exchange_accepted(exchange_acceptance);
+        }
+
+        if (is_rejected) {
+            const auto order_rejection = std::make_shared<types::OrderRejection>();
+
+            order_rejection->set_original_unique_id(order.unique_id());
+            order.has_broker_id() ? order_rejection->set_original_broker_id(order.broker_id()) : void();
+            order.has_exchange_id() ? order_rejection->set_original_exchange_id(order.exchange_id()) : void();
+            order_rejection->set_rejection_code(types::RejectionCode::unknown);
+            order_rejection->set_rejection_reason(reason);
+            order_rejection->set_allocated_rejection_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+            reporter.order_rejected(order_rejection);
+        }
+
+        if (is_canceled) {
+            const auto cancel_success = std::make_shared<types::CancelSuccess>();
+
+            cancel_success->set_original_unique_id(order.unique_id());
+            order.has_broker_id() ? cancel_success->set_original_broker_id(order.broker_id()) : void();
+            order.has_exchange_id() ? cancel_success->set_original_exchange_id(order.exchange_id()) : void();
+            cancel_success->set_canceled_quantity(canceled_quantity);
+            cancel_success->set_allocated_canceled_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+            reporter.cancel_success(cancel_success);
+        }
+
+        if (is_cancel_rejected) {
+            const auto cancel_order_rejection = std::make_shared<types::CancelOrderRejection>();
+
+            cancel_order_rejection->set_original_unique_id(order.unique_id());
+            order.has_broker_id() ? cancel_order_rejection->set_original_broker_id(order.broker_id()) : void();
+            order.has_exchange_id() ? cancel_order_rejection->set_original_exchange_id(order.exchange_id()) : void();
+            cancel_order_rejection->set_rejection_code(types::RejectionCode::unknown);
+            cancel_order_rejection->set_rejection_reason(reason);
+            cancel_order_rejection->set_allocated_rejection_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+            reporter.cancel_order_rejected(cancel_order_rejection);
+        }
+    }
+};
+
+/// Order states of a trader, so that order callbacks are handled without
+/// querying holder. Orders submitted by this session are found by their
+/// integer OrderRef, orders from outside only by exchange_id.
+///
+/// States are modified under one lock, modifications of an order are
+/// expected from the callback thread of SDK only.
+class OrderStateCache final
+{
+public:
+    using OrderRefType = int;
+
+public:
+    /// Order submitted by this session.
+    void insert(const OrderRefType order_ref, OrderState state)
+    {
+        std::lock_guard lock(m_mutex);
+
+        const int64_t unique_id = state.order.unique_id();
+
+        m_order_refs.insert_or_assign(order_ref, unique_id);
+        insert_locked(std::move(state));
+    }
+
+    /// Order submitted from outside, only found by its exchange_id.
+    void insert(OrderState state)
+    {
+        std::lock_guard lock(m_mutex);
+
+        insert_locked(std::move(state));
+    }
+
+    /// Order of this session never submitted, e.g. its request failed.
+    void erase(const OrderRefType order_ref)
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto it = m_order_refs.find(order_ref);
+
+        if (it == m_order_refs.end()) [[unlikely]]
+            return;
+
+        if (const auto state = m_states.find(it->second); state != m_states.end()) {
+            state->second.order.has_exchange_id() ? void(m_exchange_ids.erase(state->second.order.exchange_id())) : void();
+            m_states.erase(state);
+        }
+
+        m_order_refs.erase(it);
+    }
+
+    /// Modify is called with OrderState& under lock, exchange_id of order may
+    /// be assigned there once but never changed.
+    /// @return false if not found.
+    template<typename Modify>
+    bool modify_by_order_ref(const OrderRefType order_ref, Modify&& modify)
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto it = m_order_refs.find(order_ref);
+        return it != m_order_refs.end() && modify_locked(it->second, std::forward<Modify>(modify));
+    }
+
+    template<typename Modify>
+    bool modify_by_exchange_id(const std::string& exchange_id, Modify&& modify)
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto it = m_exchange_ids.find(exchange_id);
+        return it != m_exchange_ids.end() && modify_locked(it->second, std::forward<Modify>(modify));
+    }
+
+    /// @return Copy of order, nullopt if not found.
+    [[nodiscard]] std::optional<types::Order> find(const int64_t unique_id) const
+    {
+        std::lock_guard lock(m_mutex);
+
+        const auto it = m_states.find(unique_id);
+        return it == m_states.end() ? std::nullopt : std::make_optional(it->second.order);
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        std::lock_guard lock(m_mutex);
+
+        return m_states.size();
+    }
+
+private:
+    void insert_locked(OrderState state)
+    {
+        const int64_t unique_id = state.order.unique_id();
+
+        state.order.has_exchange_id() ? void(m_exchange_ids.insert_or_assign(state.order.exchange_id(), unique_id)) : void();
+        m_states.insert_or_assign(unique_id, std::move(state));
+    }
+
+    template<typename Modify>
+    bool modify_locked(const int64_t unique_id, Modify&& modify)
+    {
+        const auto it = m_states.find(unique_id);
+
+        if (it == m_states.end()) [[unlikely]]
+            return false;
+
+        auto& state                = it->second;
+        const bool had_exchange_id = state.order.has_exchange_id();
+
+        modify(state);
+
+        !had_exchange_id && state.order.has_exchange_id() ? void(m_exchange_ids.insert_or_assign(state.order.exchange_id(), unique_id)) : void();
+
+        return true;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    /// UniqueID -> OrderState.
+    std::unordered_map<int64_t, OrderState> m_states;
+    /// OrderRef -> UniqueID, orders of this session only.
+    std::unordered_map<OrderRefType, int64_t> m_order_refs;
+    /// ExchangeID -> UniqueID.
+    std::unordered_map<std::string, int64_t> m_exchange_ids;
+};
+
+} // namespace trade::broker
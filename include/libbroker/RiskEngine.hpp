@@ -0,0 +1,527 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "libreporter/NopReporter.hpp"
+
+namespace trade::broker
+{
+
+/// Open addressing table of keys other than 0, ~0 and ~1. Entries are never
+/// moved, so that they are found and updated without locks. Slots of erased
+/// entries are reused by later insertions, so an entry must not be used after
+/// erased and the same key is not expected to be inserted and erased at once.
+template<typename Value>
+class AtomicTable final
+{
+private:
+    static constexpr uint64_t ERASED_KEY = ~0ULL;
+    /// Erased slot being turned back to empty, see clear().
+    static constexpr uint64_t CLEARING_KEY = ~1ULL;
+
+    struct AnyValue {
+        bool operator()(const Value&) const { return true; }
+    };
+
+public:
+    explicit AtomicTable(const size_t capacity)
+        : m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          m_slots(std::make_unique<Slot[]>(m_mask + 1))
+    {
+    }
+
+public:
+    /// Match is called with const Value& of entries of the same key, when the
+    /// key is a hash and entries of colliding ones are told apart by value.
+    /// @return nullptr if not found or not initialized yet.
+    template<typename Match = AnyValue>
+    [[nodiscard]] Value* find(const uint64_t key, Match&& match = {}) const
+    {
+        const auto index = find_index(key, std::forward<Match>(match));
+        return index > m_mask ? nullptr : &m_slots[index].value;
+    }
+
+    /// Init is called with Value& once by the inserting thread before the
+    /// entry can be found, it reinitializes every field of a reused slot.
+    /// @return Entry of key and whether it is inserted, nullptr if full.
+    template<typename Init, typename Match = AnyValue>
+    std::pair<Value*, bool> emplace(const uint64_t key, Init&& init, Match&& match = {})
+    {
+        while (true) {
+            size_t erased = NOT_FOUND;
+            size_t empty  = NOT_FOUND;
+
+            for (size_t i = 0, index = slot_index(key); i <= m_mask && empty == NOT_FOUND; i++, index = index + 1 & m_mask) {
+                auto& slot            = m_slots[index];
+                const uint64_t chosen = slot.key.load();
+
+                if (chosen == key) {
+                    /// Inserted by another thread just now.
+                    while (!slot.is_ready.load(std::memory_order_acquire))
+                        ;
+
+                    if (match(std::as_const(slot.value)))
+                        return {&slot.value, false};
+                }
+                else if (chosen == ERASED_KEY) {
+                    erased == NOT_FOUND ? void(erased = index) : void();
+                }
+                else if (chosen == 0) {
+                    empty = index;
+                }
+            }
+
+            /// Keys are looked up till the first empty slot, so the first
+            /// erased one before it is taken.
+            const size_t index = erased != NOT_FOUND ? erased : empty;
+
+            if (index == NOT_FOUND) [[unlikely]]
+                return {nullptr, false};
+
+            auto& slot = m_slots[index];
+
+            if (uint64_t expected = index == erased ? ERASED_KEY : 0; !slot.key.compare_exchange_strong(expected, key)) {
+                /// Taken by another insertion, probe again.
+                continue;
+            }
+
+            init(slot.value);
+            slot.is_ready.store(true, std::memory_order_release);
+
+            if (is_reachable(key, index)) [[likely]]
+                return {&slot.value, true};
+
+            /// A slot before is cleared meanwhile, the entry can not be found.
+            slot.is_ready.store(false, std::memory_order_relaxed);
+            slot.key.store(ERASED_KEY);
+        }
+    }
+
+    /// @return false if not found.
+    template<typename Match = AnyValue>
+    bool erase(const uint64_t key, Match&& match = {})
+    {
+        const auto index = find_index(key, std::forward<Match>(match));
+
+        if (index > m_mask)
+            return false;
+
+        m_slots[index].is_ready.store(false, std::memory_order_relaxed);
+        m_slots[index].key.store(ERASED_KEY);
+
+        clear(index);
+
+        return true;
+    }
+
+    [[nodiscard]] size_t capacity() const { return m_mask + 1; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key {0};
+        std::atomic<bool> is_ready {false};
+        Value value {};
+    };
+
+    static constexpr size_t NOT_FOUND = ~size_t {0};
+
+    /// Fibonacci hashing, so that sequential ids spread over slots.
+    [[nodiscard]] size_t slot_index(const uint64_t key) const
+    {
+        return static_cast<size_t>(key * 0x9E3779B97F4A7C15ULL >> 32) & m_mask;
+    }
+
+    template<typename Match>
+    [[nodiscard]] size_t find_index(const uint64_t key, Match&& match) const
+    {
+        for (size_t i = 0, index = slot_index(key); i <= m_mask; i++, index = index + 1 & m_mask) {
+            auto& slot            = m_slots[index];
+            const uint64_t chosen = slot.key.load();
+
+            if (chosen == key && slot.is_ready.load(std::memory_order_acquire) && match(std::as_const(slot.value))) [[likely]]
+                return index;
+
+            if (chosen == 0)
+                return NOT_FOUND;
+        }
+
+        return NOT_FOUND;
+    }
+
+    [[nodiscard]] bool is_reachable(const uint64_t key, const size_t target) const
+    {
+        for (size_t index = slot_index(key); index != target; index = index + 1 & m_mask) {
+            const uint64_t chosen = m_slots[index].key.load();
+
+            if (chosen == 0 || chosen == CLEARING_KEY)
+                return false;
+        }
+
+        return true;
+    }
+
+    /// Erased slots followed by an empty one are turned back to empty from
+    /// the end, so that absent keys are not probed through erased slots of a
+    /// whole trading day. A slot is marked before the next one is checked and
+    /// an insertion checks slots before it after claiming its own, both in
+    /// sequentially consistent order, so either the clearing or the insertion
+    /// sees the other one.
+    void clear(size_t index)
+    {
+        while (true) {
+            auto& slot = m_slots[index];
+            auto& next = m_slots[index + 1 & m_mask];
+
+            if (uint64_t expected = ERASED_KEY; next.key.load() != 0 || !slot.key.compare_exchange_strong(expected, CLEARING_KEY))
+                return;
+
+            if (next.key.load() != 0) {
+                slot.key.store(ERASED_KEY);
+                return;
+            }
+
+            slot.key.store(0);
+            index = index - 1 & m_mask;
+        }
+    }
+
+private:
+    const size_t m_mask;
+    const std::unique_ptr<Slot[]> m_slots;
+};
+
+/// Limits of RiskEngine, 0 disables a limit.
+struct RiskLimits {
+    /// Quantity and value of one order.
+    int64_t max_order_quantity = 0;
+    double max_order_value     = 0;
+    /// Net position plus working quantity on the same side, of one symbol.
+    int64_t max_symbol_position = 0;
+    /// Value of all working orders.
+    double max_working_value = 0;
+    /// Orders per second, and orders allowed at once above the rate.
+    int64_t max_order_rate  = 0;
+    int64_t max_order_burst = 1;
+    /// Reject orders which may trade against working orders of own.
+    bool is_self_trade_guarded = true;
+    /// Symbols of one trading day and orders working at once, tables are
+    /// twice of them so that probes stay short. Orders are dropped from the
+    /// table once filled, canceled or rejected.
+    size_t symbol_capacity = 1 << 14;
+    size_t order_capacity  = 1 << 18;
+};
+
+/// Pre-trade risk checks in memory, before an order goes to the broker.
+///
+/// Counters are atomics updated by fetch_add/CAS only, by check on the order
+/// path and by order and trade callbacks of the broker passing through this
+/// reporter to the outside. Checks of the same symbol are expected from one
+/// thread, otherwise the self-trade guard may miss a price.
+///
+/// Positions start from 0 at construction, only fills reported since then
+/// are counted. Buy orders reserve their value from available fund until
+/// filled, canceled or rejected, sell fills add to it.
+class RiskEngine final: public reporter::NopReporter
+{
+public:
+    /// @param available_fund Fund is not checked if negative.
+    explicit RiskEngine(
+        const RiskLimits& limits,
+        const double available_fund               = -1,
+        const std::shared_ptr<IReporter>& outside = nullptr
+    ) : NopReporter(outside),
+        m_limits(limits),
+        m_is_fund_checked(available_fund >= 0),
+        m_symbols(limits.symbol_capacity * 2),
+        m_orders(limits.order_capacity * 2)
+    {
+        m_available_fund.store(std::max(available_fund, 0.0), std::memory_order_relaxed);
+    }
+
+    ~RiskEngine() override = default;
+
+public:
+    /// Reserve counters for the order if passed.
+    /// @return invalid_rejection_code if passed.
+    [[nodiscard]] types::RejectionCode check(const types::NewOrderReq& new_order_req)
+    {
+        const int64_t quantity = new_order_req.quantity();
+        const double price     = new_order_req.price();
+        const double value     = price * static_cast<double>(quantity);
+        const bool is_buy      = new_order_req.side() == types::SideType::buy;
+
+        if (quantity <= 0 || (m_limits.max_order_quantity > 0 && quantity > m_limits.max_order_quantity)) [[unlikely]]
+            return types::RejectionCode::invalid_quantity;
+
+        if (m_limits.max_order_value > 0 && value > m_limits.max_order_value) [[unlikely]]
+            return types::RejectionCode::order_value_exceeded;
+
+        if (m_orders.find(new_order_req.unique_id()) != nullptr) [[unlikely]]
+            return types::RejectionCode::repeated_unique_id;
+
+        const auto symbol = emplace_symbol(new_order_req.symbol());
+
+        if (symbol == nullptr) [[unlikely]]
+            return types::RejectionCode::unknown;
+
+        if (m_limits.is_self_trade_guarded && is_self_trade(*symbol, is_buy, price)) [[unlikely]]
+            return types::RejectionCode::self_trade;
+
+        auto& working                = is_buy ? symbol->working_buy : symbol->working_sell;
+        const int64_t working_before = working.fetch_add(quantity, std::memory_order_relaxed);
+
+        if (m_limits.max_symbol_position > 0) {
+            const int64_t position = symbol->position.load(std::memory_order_relaxed);
+            const int64_t exposure = is_buy ? position + working_before + quantity : working_before + quantity - position;
+
+            if (exposure > m_limits.max_symbol_position) [[unlikely]] {
+                working.fetch_sub(quantity, std::memory_order_relaxed);
+                return types::RejectionCode::position_limit_exceeded;
+            }
+        }
+
+        const double working_value = m_working_value.fetch_add(value, std::memory_order_relaxed) + value;
+
+        if (m_limits.max_working_value > 0 && working_value > m_limits.max_working_value) [[unlikely]] {
+            unreserve(*symbol, is_buy, quantity, value, false);
+            return types::RejectionCode::exposure_exceeded;
+        }
+
+        const bool is_fund_reserved = is_buy && m_is_fund_checked;
+
+        if (is_fund_reserved && m_available_fund.fetch_sub(value, std::memory_order_relaxed) < value) [[unlikely]] {
+            unreserve(*symbol, is_buy, quantity, value, true);
+            return types::RejectionCode::fund_not_enough;
+        }
+
+        if (m_limits.max_order_rate > 0 && !acquire_rate()) [[unlikely]] {
+            unreserve(*symbol, is_buy, quantity, value, is_fund_reserved);
+            return types::RejectionCode::order_rate_exceeded;
+        }
+
+        const auto [order, is_inserted] = m_orders.emplace(new_order_req.unique_id(), [&](OrderRisk& order_risk) {
+            order_risk.symbol           = symbol;
+            order_risk.is_buy           = is_buy;
+            order_risk.is_fund_reserved = is_fund_reserved;
+            order_risk.price            = price;
+            order_risk.remaining.store(quantity, std::memory_order_relaxed);
+        });
+
+        if (!is_inserted) [[unlikely]] {
+            unreserve(*symbol, is_buy, quantity, value, is_fund_reserved);
+            return order == nullptr ? types::RejectionCode::unknown : types::RejectionCode::repeated_unique_id;
+        }
+
+        /// Extreme prices of working orders, stale ones only make the guard
+        /// stricter until no order is working on that side.
+        auto& extreme = is_buy ? symbol->highest_buy : symbol->lowest_sell;
+
+        if (working_before == 0) {
+            extreme.store(price, std::memory_order_relaxed);
+        }
+        else {
+            double current = extreme.load(std::memory_order_relaxed);
+            while ((is_buy ? price > current : price < current) && !extreme.compare_exchange_weak(current, price, std::memory_order_relaxed))
+                ;
+        }
+
+        return types::RejectionCode::invalid_rejection_code;
+    }
+
+    /// Release counters reserved for an order never sent to the broker.
+    void release(const int64_t unique_id)
+    {
+        const auto order = m_orders.find(unique_id);
+        order == nullptr ? void() : release(unique_id, *order);
+    }
+
+    [[nodiscard]] double available_fund() const { return m_available_fund.load(std::memory_order_relaxed); }
+    [[nodiscard]] double working_value() const { return m_working_value.load(std::memory_order_relaxed); }
+
+    /// @return 0 if the symbol is never seen.
+    [[nodiscard]] int64_t position(const std::string& symbol) const
+    {
+        const auto symbol_risk = find_symbol(symbol);
+        return symbol_risk == nullptr ? 0 : symbol_risk->position.load(std::memory_order_relaxed);
+    }
+
+    /// @return Working quantity of the side, 0 if the symbol is never seen.
+    [[nodiscard]] int64_t working(const std::string& symbol, const types::SideType side) const
+    {
+        const auto symbol_risk = find_symbol(symbol);
+
+        if (symbol_risk == nullptr)
+            return 0;
+
+        return (side == types::SideType::buy ? symbol_risk->working_buy : symbol_risk->working_sell).load(std::memory_order_relaxed);
+    }
+
+    /// Order.
+public:
+    void order_rejected(const std::shared_ptr<types::OrderRejection> order_rejection) override
+    {
+        release(order_rejection->original_unique_id());
+
+        NopReporter::order_rejected(order_rejection);
+    }
+
+    /// Cancel.
+public:
+    void cancel_success(const std::shared_ptr<types::CancelSuccess> cancel_success) override
+    {
+        release(cancel_success->original_unique_id());
+
+        NopReporter::cancel_success(cancel_success);
+    }
+
+    /// Trade.
+public:
+    /// Fills arriving after the order is dropped, e.g. outside orders, are
+    /// taken as fills of an unknown order.
+    void trade_accepted(const std::shared_ptr<types::Trade> trade) override
+    {
+        const auto order    = m_orders.find(trade->unique_id());
+        const bool is_buy   = order == nullptr ? trade->side() == types::SideType::buy : order->is_buy;
+        const auto quantity = trade->quantity();
+
+        /// Fills of orders not checked here, e.g. outside orders, only move
+        /// position and fund.
+        int64_t filled  = 0;
+        bool is_settled = false;
+
+        if (order != nullptr) {
+            int64_t remaining = order->remaining.load(std::memory_order_relaxed);
+
+            while (!order->remaining.compare_exchange_weak(remaining, remaining - std::min(remaining, quantity), std::memory_order_relaxed))
+                ;
+
+            filled     = std::min(remaining, quantity);
+            is_settled = filled > 0 && filled == remaining;
+
+            (is_buy ? order->symbol->working_buy : order->symbol->working_sell).fetch_sub(filled, std::memory_order_relaxed);
+            m_working_value.fetch_sub(order->price * static_cast<double>(filled), std::memory_order_relaxed);
+        }
+
+        const auto symbol = order == nullptr ? emplace_symbol(trade->symbol()) : order->symbol;
+        symbol == nullptr ? void() : void(symbol->position.fetch_add(is_buy ? quantity : -quantity, std::memory_order_relaxed));
+
+        if (m_is_fund_checked) {
+            const double reserved = order != nullptr && order->is_fund_reserved ? order->price * static_cast<double>(filled) : 0;
+            const double traded   = trade->price() * static_cast<double>(quantity);
+
+            m_available_fund.fetch_add((is_buy ? reserved - traded : traded) - trade->fee(), std::memory_order_relaxed);
+        }
+
+        /// The last fill drops the order, as release does.
+        is_settled ? void(m_orders.erase(trade->unique_id())) : void();
+
+        NopReporter::trade_accepted(trade);
+    }
+
+private:
+    struct alignas(64) SymbolRisk {
+        /// Told apart from colliding symbols by name.
+        std::string symbol;
+        /// Net filled quantity, negative if short.
+        std::atomic<int64_t> position {0};
+        std::atomic<int64_t> working_buy {0};
+        std::atomic<int64_t> working_sell {0};
+        std::atomic<double> highest_buy {0};
+        std::atomic<double> lowest_sell {0};
+    };
+
+    struct OrderRisk {
+        SymbolRisk* symbol    = nullptr;
+        bool is_buy           = false;
+        bool is_fund_reserved = false;
+        double price          = 0;
+        std::atomic<int64_t> remaining {0};
+    };
+
+    [[nodiscard]] static uint64_t symbol_key(const std::string_view symbol)
+    {
+        const uint64_t key = std::hash<std::string_view> {}(symbol);
+        return key == 0 || key >= ~1ULL ? 1 : key;
+    }
+
+    [[nodiscard]] SymbolRisk* find_symbol(const std::string_view symbol) const
+    {
+        return m_symbols.find(symbol_key(symbol), [symbol](const SymbolRisk& symbol_risk) { return symbol_risk.symbol == symbol; });
+    }
+
+    /// @return nullptr if full.
+    [[nodiscard]] SymbolRisk* emplace_symbol(const std::string_view symbol)
+    {
+        return m_symbols.emplace(
+            symbol_key(symbol),
+            [symbol](SymbolRisk& symbol_risk) { symbol_risk.symbol = symbol; },
+            [symbol](const SymbolRisk& symbol_risk) { return symbol_risk.symbol == symbol; }
+        ).first;
+    }
+
+    [[nodiscard]] static bool is_self_trade(const SymbolRisk& symbol, const bool is_buy, const double price)
+    {
+        if (is_buy)
+            return symbol.working_sell.load(std::memory_order_relaxed) > 0 && price >= symbol.lowest_sell.load(std::memory_order_relaxed);
+
+        return symbol.working_buy.load(std::memory_order_relaxed) > 0 && price <= symbol.highest_buy.load(std::memory_order_relaxed);
+    }
+
+    /// Generic cell rate algorithm, the theoretical arrival time of next order
+    /// is the only state.
+    [[nodiscard]] bool acquire_rate()
+    {
+        const int64_t interval  = std::chrono::nanoseconds(std::chrono::seconds(1)).count() / m_limits.max_order_rate;
+        const int64_t tolerance = interval * std::max<int64_t>(m_limits.max_order_burst - 1, 0);
+        const int64_t now       = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        int64_t arrival = m_arrival.load(std::memory_order_relaxed);
+
+        do {
+            if (arrival - now > tolerance)
+                return false;
+        } while (!m_arrival.compare_exchange_weak(arrival, std::max(arrival, now) + interval, std::memory_order_relaxed));
+
+        return true;
+    }
+
+    void unreserve(SymbolRisk& symbol, const bool is_buy, const int64_t quantity, const double value, const bool is_fund_reserved)
+    {
+        (is_buy ? symbol.working_buy : symbol.working_sell).fetch_sub(quantity, std::memory_order_relaxed);
+        m_working_value.fetch_sub(value, std::memory_order_relaxed);
+        is_fund_reserved ? void(m_available_fund.fetch_add(value, std::memory_order_relaxed)) : void();
+    }
+
+    /// Only the caller taking the remaining quantity to 0 drops the order.
+    void release(const int64_t unique_id, OrderRisk& order)
+    {
+        const int64_t remaining = order.remaining.exchange(0, std::memory_order_relaxed);
+
+        if (remaining > 0) {
+            unreserve(*order.symbol, order.is_buy, remaining, order.price * static_cast<double>(remaining), order.is_fund_reserved);
+            m_orders.erase(unique_id);
+        }
+    }
+
+private:
+    const RiskLimits m_limits;
+    const bool m_is_fund_checked;
+
+private:
+    alignas(64) std::atomic<double> m_available_fund {0};
+    alignas(64) std::atomic<double> m_working_value {0};
+    alignas(64) std::atomic<int64_t> m_arrival {0};
+
+private:
+    AtomicTable<SymbolRisk> m_symbols;
+    AtomicTable<OrderRisk> m_orders;
+};
+
+} // namespace trade::broker
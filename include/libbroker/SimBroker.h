@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+
+#include "BrokerProxy.hpp"
+#include "CUTImpl/CUTMdImpl.h"
+#include "SimImpl/SimMdImpl.h"
+#include "SimImpl/SimTraderImpl.h"
+
+namespace trade::broker
+{
+
+/// Local broker for benchmarking and testing the whole trading stack without
+/// a live counter. Orders go through BrokerProxy as usual and are matched
+/// against depth generated by booker from a replay of PCAP, as CUT does, or
+/// standard tick CSV.
+class TD_PUBLIC_API SimBroker final: public BrokerProxy<int>
+{
+public:
+    explicit SimBroker(
+        const std::string& config_path,
+        const std::shared_ptr<holder::IHolder>& holder,
+        const std::shared_ptr<reporter::IReporter>& reporter
+    );
+    ~SimBroker() override = default;
+
+public:
+    void start_login() noexcept override;
+    void start_logout() noexcept override;
+
+public:
+    void subscribe(const std::unordered_set<std::string>& symbols) override;
+    void unsubscribe(const std::unordered_set<std::string>& symbols) override;
+
+protected:
+    void send_order(std::shared_ptr<types::NewOrderReq> new_order_req, std::shared_ptr<types::NewOrderRsp> new_order_rsp) override;
+    void send_cancel(std::shared_ptr<types::NewCancelReq> new_cancel_req, std::shared_ptr<types::NewCancelRsp> new_cancel_rsp) override;
+
+private:
+    /// Only one of them replays, CSV if Server.TickFile is configured.
+    std::unique_ptr<CUTMdImpl> m_pcap_md_impl;
+    std::unique_ptr<SimMdImpl> m_csv_md_impl;
+    /// Shared with md impl, which reports market data through it.
+    std::shared_ptr<SimTraderImpl> m_trader_impl;
+};
+
+} // namespace trade::broker
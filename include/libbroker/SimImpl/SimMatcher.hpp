@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "orms.pb.h"
+
+namespace trade::broker
+{
+
+/// Matches simulated limit orders against the depth generated by booker.
+///
+/// Each generated l2 tick replaces the depth of its symbol. An order takes
+/// the opposite levels crossing its price at their prices, and the quantity
+/// taken is removed from the depth until the next tick replaces it, so that
+/// the same liquidity is never filled twice. The rest of the order waits
+/// until a later depth crosses it. Queue position at an uncrossed price is
+/// not simulated, nor are simulated orders matched with each other.
+///
+/// Not thread-safe.
+class SimMatcher final
+{
+public:
+    struct Fill {
+        int64_t unique_id;
+        std::string symbol;
+        bool is_buy;
+        int64_t price_1000x;
+        int64_t quantity;
+        /// Traded quantity of order including this fill.
+        int64_t cumulative_quantity;
+    };
+
+public:
+    /// Order arrives at exchange, fills are appended.
+    /// @return false if an order of unique_id is still working.
+    bool add(
+        const int64_t unique_id,
+        const std::string& symbol,
+        const bool is_buy,
+        const int64_t price_1000x,
+        const int64_t quantity,
+        std::vector<Fill>& fills
+    )
+    {
+        if (m_orders.contains(unique_id)) [[unlikely]]
+            return false;
+
+        auto& book = m_books[symbol];
+
+        Order order {
+            .symbol      = symbol,
+            .is_buy      = is_buy,
+            .price_1000x = price_1000x,
+            .quantity    = quantity,
+        };
+
+        if (match(book, unique_id, order, fills))
+            return true;
+
+        is_buy ? void(book.buys.emplace(price_1000x, unique_id)) : void(book.sells.emplace(price_1000x, unique_id));
+        m_orders.emplace(unique_id, std::move(order));
+
+        return true;
+    }
+
+    /// @return Canceled quantity, nullopt if order is not working, e.g. filled.
+    std::optional<int64_t> cancel(const int64_t unique_id)
+    {
+        const auto it = m_orders.find(unique_id);
+
+        if (it == m_orders.end())
+            return std::nullopt;
+
+        const auto& order = it->second;
+        auto& book        = m_books[order.symbol];
+
+        order.is_buy ? erase(book.buys, order.price_1000x, unique_id) : erase(book.sells, order.price_1000x, unique_id);
+
+        const int64_t canceled_quantity = order.quantity - order.traded_quantity;
+        m_orders.erase(it);
+
+        return canceled_quantity;
+    }
+
+    /// Depth of symbol is replaced, working orders crossed by it are filled.
+    void update(const types::GeneratedL2Tick& generated_l2_tick, std::vector<Fill>& fills)
+    {
+        auto& book = m_books[generated_l2_tick.symbol()];
+
+        to_levels(generated_l2_tick.ask_levels(), book.asks);
+        to_levels(generated_l2_tick.bid_levels(), book.bids);
+
+        match_working(book, book.buys, fills);
+        match_working(book, book.sells, fills);
+    }
+
+    [[nodiscard]] size_t size() const { return m_orders.size(); }
+
+private:
+    struct Level {
+        int64_t price_1000x;
+        int64_t quantity;
+    };
+
+    struct Order {
+        std::string symbol;
+        bool is_buy;
+        int64_t price_1000x;
+        int64_t quantity;
+        int64_t traded_quantity = 0;
+    };
+
+    struct Book {
+        /// Best first, empty levels have price 0.
+        std::vector<Level> asks;
+        std::vector<Level> bids;
+        /// Price -> UniqueID of working orders, best first and in order of
+        /// arrival at the same price.
+        std::multimap<int64_t, int64_t, std::greater<>> buys;
+        std::multimap<int64_t, int64_t> sells;
+    };
+
+    static void to_levels(const google::protobuf::RepeatedPtrField<types::PriceQuantityPair>& pairs, std::vector<Level>& levels)
+    {
+        levels.clear();
+
+        for (const auto& pair : pairs)
+            levels.push_back({pair.price_1000x(), pair.quantity()});
+    }
+
+    template<typename Orders>
+    static void erase(Orders& orders, const int64_t price_1000x, const int64_t unique_id)
+    {
+        const auto [begin, end] = orders.equal_range(price_1000x);
+        const auto it           = std::find_if(begin, end, [unique_id](const auto& pair) { return pair.second == unique_id; });
+
+        it != end ? void(orders.erase(it)) : void();
+    }
+
+    /// @return true if order is filled.
+    static bool match(Book& book, const int64_t unique_id, Order& order, std::vector<Fill>& fills)
+    {
+        for (auto& level : order.is_buy ? book.asks : book.bids) {
+            if (order.traded_quantity == order.quantity)
+                break;
+
+            /// Taken by earlier orders.
+            if (level.quantity <= 0)
+                continue;
+
+            if (level.price_1000x <= 0 || (order.is_buy ? level.price_1000x > order.price_1000x : level.price_1000x < order.price_1000x))
+                break;
+
+            const int64_t quantity = std::min(level.quantity, order.quantity - order.traded_quantity);
+
+            level.quantity        -= quantity;
+            order.traded_quantity += quantity;
+
+            fills.push_back({unique_id, order.symbol, order.is_buy, level.price_1000x, quantity, order.traded_quantity});
+        }
+
+        return order.traded_quantity == order.quantity;
+    }
+
+    template<typename Orders>
+    void match_working(Book& book, Orders& orders, std::vector<Fill>& fills)
+    {
+        auto it = orders.begin();
+
+        while (it != orders.end()) {
+            const auto order = m_orders.find(it->second);
+
+            /// Worse orders can not be crossed either.
+            if (!match(book, it->second, order->second, fills))
+                break;
+
+            m_orders.erase(order);
+            it = orders.erase(it);
+        }
+    }
+
+private:
+    /// Symbol -> Book.
+    std::unordered_map<std::string, Book> m_books;
+    /// UniqueID -> Working order.
+    std::unordered_map<int64_t, Order> m_orders;
+};
+
+} // namespace trade::broker
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+
+#include "AppBase.hpp"
+#include "libbooker/Booker.h"
+#include "libholder/IHolder.h"
+#include "libreporter/IReporter.hpp"
+
+namespace trade::broker
+{
+
+/// Replays standard tick CSV, as read by offline_booker, into a booker.
+/// Order/trade ticks and generated ticks are reported in batches as
+/// CUTMdImpl does.
+class SimMdImpl final: private AppBase<int>
+{
+public:
+    SimMdImpl(
+        std::shared_ptr<ConfigType> config,
+        std::shared_ptr<holder::IHolder> holder,
+        std::shared_ptr<reporter::IReporter> reporter
+    );
+    ~SimMdImpl() override;
+
+public:
+    /// Replay starts on first subscription, symbols are not changed after
+    /// that.
+    void subscribe(const std::unordered_set<std::string>& symbols);
+    void unsubscribe(const std::unordered_set<std::string>& symbols);
+
+private:
+    void replayer(std::unordered_set<std::string> symbols);
+
+private:
+    [[nodiscard]] static types::OrderType to_order_type(char order_type);
+    /// @param time HHMMSSmmm, e.g. 92500000.
+    /// @return Milliseconds of day.
+    [[nodiscard]] static int64_t to_milliseconds(int64_t time);
+
+private:
+    std::atomic<bool> m_is_running = false;
+    std::thread m_replayer_thread;
+
+private:
+    /// Rows booked between begin_batch() and end_batch().
+    size_t m_batch_size;
+    /// Replay speed relative to exchange time, 0 for as fast as possible.
+    double m_replay_speed;
+
+private:
+    std::shared_ptr<holder::IHolder> m_holder;
+    std::shared_ptr<reporter::IReporter> m_reporter;
+};
+
+} // namespace trade::broker
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+#include "AppBase.hpp"
+#include "SimMatcher.hpp"
+#include "libholder/IHolder.h"
+#include "libreporter/NopReporter.hpp"
+#include "utilities/LoginSyncer.hpp"
+
+namespace trade::broker
+{
+
+/// Simulated counter and exchange. Orders and cancels are acknowledged by
+/// broker and exchange after configured latencies and matched by
+/// SimMatcher.
+///
+/// It is also the reporter of market data, generated l2 ticks are taken as
+/// the depth of market before forwarded to md_reporter.
+class SimTraderImpl final: private AppBase<int>, public reporter::NopReporter
+{
+public:
+    explicit SimTraderImpl(
+        std::shared_ptr<ConfigType> config,
+        std::shared_ptr<holder::IHolder> holder,
+        std::shared_ptr<reporter::IReporter> reporter,
+        const std::shared_ptr<reporter::IReporter>& md_reporter,
+        utilities::LoginSyncer* parent
+    );
+    ~SimTraderImpl() override;
+
+public:
+    void new_order(
+        const std::shared_ptr<types::NewOrderReq>& new_order_req,
+        const std::shared_ptr<types::NewOrderRsp>& new_order_rsp
+    );
+    void cancel_order(
+        const std::shared_ptr<types::NewCancelReq>& new_cancel_req,
+        const std::shared_ptr<types::NewCancelRsp>& new_cancel_rsp
+    );
+
+    /// Market data.
+public:
+    void l2_tick_generated(std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick) override;
+
+    /// Batches are forwarded as batches.
+public:
+    void exchange_order_ticks_arrived(std::span<const std::shared_ptr<types::OrderTick>> order_ticks) override;
+    void exchange_trade_ticks_arrived(std::span<const std::shared_ptr<types::TradeTick>> trade_ticks) override;
+    void exchange_l2_snaps_arrived(std::span<const std::shared_ptr<types::ExchangeL2Snap>> exchange_l2_snaps) override;
+    void l2_ticks_generated(std::span<const std::shared_ptr<types::GeneratedL2Tick>> generated_l2_ticks) override;
+    void ranged_ticks_generated(std::span<const std::shared_ptr<types::RangedTick>> ranged_ticks) override;
+
+private:
+    /// Order/cancel arrives at broker, orders hold the only order to send.
+    void broker_order(const std::shared_ptr<types::Orders>& orders);
+    void broker_cancel(const std::shared_ptr<types::NewCancelReq>& new_cancel_req);
+    /// Order/cancel arrives at exchange.
+    void exchange_order(const std::shared_ptr<types::Orders>& orders);
+    void exchange_cancel(const std::shared_ptr<types::NewCancelReq>& new_cancel_req);
+
+    void report(const std::vector<SimMatcher::Fill>& fills) const;
+
+    [[nodiscard]] static std::string to_broker_id(int64_t unique_id);
+    [[nodiscard]] static std::string to_exchange_id(int64_t unique_id);
+
+private:
+    struct Event {
+        std::chrono::steady_clock::time_point due;
+        /// Events due at the same time run in order of scheduling.
+        uint64_t seq;
+        std::function<void()> task;
+
+        bool operator>(const Event& other) const { return std::tie(due, seq) > std::tie(other.due, other.seq); }
+    };
+
+    void schedule(std::chrono::steady_clock::time_point due, std::function<void()> task);
+    void scheduler();
+
+private:
+    std::chrono::microseconds m_broker_latency;
+    std::chrono::microseconds m_exchange_latency;
+
+private:
+    /// Min-heap of pending events.
+    std::vector<Event> m_events;
+    uint64_t m_event_seq = 0;
+    bool m_is_running    = true;
+    std::mutex m_events_mutex;
+    std::condition_variable m_events_cv;
+    std::thread m_scheduler_thread;
+
+private:
+    SimMatcher m_matcher;
+    std::mutex m_matcher_mutex;
+
+private:
+    std::shared_ptr<holder::IHolder> m_holder;
+    std::shared_ptr<reporter::IReporter> m_reporter;
+    std::shared_ptr<reporter::IReporter> m_md_reporter;
+
+private:
+    utilities::LoginSyncer* m_parent;
+};
+
+} // namespace trade::broker
@@ -15,6 +15,9 @@ public:
     virtual ~IHolder() = default;
 
 public:
+    /// update_* return the number of rows accepted. A holder writing in
+    /// background, e.g. WriteBehindHolder, accepts rows once they are queued,
+    /// which does not mean they are persisted yet.
     virtual int64_t update_symbols(std::shared_ptr<types::Symbols> symbols)                            = 0;
     virtual std::shared_ptr<types::Symbols> query_symbols_by_symbol(const std::string& symbol)         = 0;
     virtual std::shared_ptr<types::Symbols> query_symbols_by_exchange(types::ExchangeType exchange)    = 0;
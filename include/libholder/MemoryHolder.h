@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "AppBase.hpp"
+#include "IHolder.h"
+
+namespace trade::holder
+{
+
+/// Hash map split into shards each guarded by its own lock. Values are
+/// immutable and shared, so that readers only hold the shard lock to copy a
+/// pointer and writers only lock the shard of the key.
+template<typename Key, typename Value>
+class ShardedMap final
+{
+public:
+    static constexpr size_t shard_bits = 6;
+    static constexpr size_t shards     = size_t {1} << shard_bits;
+
+public:
+    /// @return nullptr if not found.
+    [[nodiscard]] std::shared_ptr<const Value> find(const Key& key) const
+    {
+        const auto& shard = shard_of(key);
+
+        std::shared_lock lock(shard.mutex);
+
+        const auto it = shard.map.find(key);
+        return it == shard.map.end() ? nullptr : it->second;
+    }
+
+    /// Replace value of key, replaced is called with the previous value,
+    /// nullptr if inserted, while the shard is still locked.
+    template<typename Replaced>
+    void put(const Key& key, std::shared_ptr<const Value> value, Replaced&& replaced)
+    {
+        auto& shard = shard_of(key);
+
+        std::lock_guard lock(shard.mutex);
+
+        auto& kept = shard.map[key];
+        kept.swap(value);
+
+        replaced(value);
+    }
+
+    void put(const Key& key, std::shared_ptr<const Value> value)
+    {
+        put(key, std::move(value), [](const std::shared_ptr<const Value>&) {});
+    }
+
+    /// Copy on write, value is erased if modify returns nullptr.
+    template<typename Modify>
+    void modify(const Key& key, Modify&& modify)
+    {
+        auto& shard = shard_of(key);
+
+        std::lock_guard lock(shard.mutex);
+
+        const auto it = shard.map.find(key);
+        auto value    = modify(it == shard.map.end() ? nullptr : it->second);
+
+        if (value == nullptr) {
+            it == shard.map.end() ? void() : void(shard.map.erase(it));
+        }
+        else {
+            shard.map.insert_or_assign(key, std::move(value));
+        }
+    }
+
+    /// Values are visited outside of shard locks.
+    void for_each(const std::function<void(const Value&)>& visit) const
+    {
+        std::vector<std::shared_ptr<const Value>> values;
+
+        for (const auto& shard : m_shards) {
+            values.clear();
+
+            {
+                std::shared_lock lock(shard.mutex);
+
+                values.reserve(shard.map.size());
+
+                for (const auto& [key, value] : shard.map)
+                    values.push_back(value);
+            }
+
+            for (const auto& value : values)
+                visit(*value);
+        }
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        size_t size = 0;
+
+        for (const auto& shard : m_shards) {
+            std::shared_lock lock(shard.mutex);
+            size += shard.map.size();
+        }
+
+        return size;
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, std::shared_ptr<const Value>> map;
+    };
+
+    /// Fibonacci hashing, so that sequential ids spread over shards.
+    [[nodiscard]] static size_t shard_index(const Key& key)
+    {
+        return static_cast<size_t>(std::hash<Key> {}(key) * 0x9E3779B97F4A7C15ULL) >> (64 - shard_bits);
+    }
+
+    Shard& shard_of(const Key& key) { return m_shards[shard_index(key)]; }
+    const Shard& shard_of(const Key& key) const { return m_shards[shard_index(key)]; }
+
+private:
+    std::array<Shard, shards> m_shards;
+};
+
+/// Holder keeping everything in memory, for intraday state never queried by
+/// ad hoc SQL.
+///
+/// Snapshots are written to snapshot_path every snapshot_interval and on
+/// destruction, and restored at construction if the file exists.
+class TD_PUBLIC_API MemoryHolder final: public IHolder, private AppBase<>
+{
+public:
+    /// @param snapshot_path No snapshot if empty.
+    /// @param snapshot_interval Only snapshot on destruction if 0.
+    /// @throw std::runtime_error if the snapshot to restore is not valid.
+    explicit MemoryHolder(
+        const std::string& snapshot_path       = "",
+        std::chrono::seconds snapshot_interval = std::chrono::seconds(0)
+    );
+    ~MemoryHolder() override;
+
+public:
+    int64_t update_symbols(std::shared_ptr<types::Symbols> symbols) override;
+    std::shared_ptr<types::Symbols> query_symbols_by_symbol(const std::string& symbol) override;
+    std::shared_ptr<types::Symbols> query_symbols_by_exchange(types::ExchangeType exchange) override;
+
+    int64_t update_funds(std::shared_ptr<types::Funds> funds) override;
+    std::shared_ptr<types::Funds> query_funds_by_account_id(const std::string& account_id) override;
+
+    int64_t update_positions(std::shared_ptr<types::Positions> positions) override;
+    std::shared_ptr<types::Positions> query_positions_by_symbol(const std::string& symbol) override;
+
+    int64_t update_orders(std::shared_ptr<types::Orders> orders) override;
+    std::shared_ptr<types::Orders> query_orders_by_unique_id(int64_t unique_id) override;
+    std::shared_ptr<types::Orders> query_orders_by_broker_id(const std::string& broker_id) override;
+    std::shared_ptr<types::Orders> query_orders_by_exchange_id(const std::string& exchange_id) override;
+
+public:
+    /// Write all tables to snapshot_path atomically.
+    /// @throw std::runtime_error if failed to write.
+    void snapshot() const;
+
+public:
+    static constexpr char snapshot_magic[8]    = {'T', 'D', 'M', 'H', 'S', 'N', 'A', 'P'};
+    static constexpr uint32_t snapshot_version = 1;
+
+private:
+    using UniqueIds = std::vector<int64_t>;
+
+    static void index(ShardedMap<std::string, UniqueIds>& index, const std::string& id, int64_t unique_id);
+    static void unindex(ShardedMap<std::string, UniqueIds>& index, const std::string& id, int64_t unique_id);
+    std::shared_ptr<types::Orders> query_orders_by(const ShardedMap<std::string, UniqueIds>& index, const std::string& id, const std::string& (types::Order::*id_of)() const) const;
+
+    void restore();
+    void snapshot_periodically();
+
+private:
+    ShardedMap<std::string, types::Symbol> m_symbols;
+    ShardedMap<std::string, types::Fund> m_funds;
+    ShardedMap<std::string, types::Position> m_positions;
+    ShardedMap<int64_t, types::Order> m_orders;
+    /// Unique ids by broker_id and exchange_id, always checked against orders.
+    ShardedMap<std::string, UniqueIds> m_broker_ids;
+    ShardedMap<std::string, UniqueIds> m_exchange_ids;
+
+private:
+    const std::string m_snapshot_path;
+    const std::chrono::seconds m_snapshot_interval;
+    /// Snapshots written by the periodic thread and destructor are serialized.
+    mutable std::mutex m_snapshot_mutex;
+    std::mutex m_running_mutex;
+    std::condition_variable m_running_cv;
+    bool m_is_running = true;
+    std::thread m_snapshot_thread;
+};
+
+} // namespace trade::holder
@@ -28,12 +28,24 @@ struct SQLite3StmtPtrDeleter {
 
 using SQLite3StmtPtr = std::unique_ptr<sqlite3_stmt, SQLite3StmtPtrDeleter>;
 
+class SQLiteBatch;
+
 class TD_PUBLIC_API SQLiteHolder final: public IHolder, private AppBase<>
 {
 public:
-    explicit SQLiteHolder(const std::string& db_path = ":memory:");
+    /// @param journal_mode Value of PRAGMA journal_mode, e.g. WAL, DELETE.
+    /// @param synchronous Value of PRAGMA synchronous, e.g. NORMAL, FULL.
+    explicit SQLiteHolder(
+        const std::string& db_path      = ":memory:",
+        const std::string& journal_mode = "WAL",
+        const std::string& synchronous  = "NORMAL"
+    );
     ~SQLiteHolder() override = default;
 
+public:
+    /// Unit of work, updates made until it is committed share one transaction.
+    [[nodiscard]] SQLiteBatch batch();
+
 public:
     int64_t update_symbols(std::shared_ptr<types::Symbols> symbols) override;
     std::shared_ptr<types::Symbols> query_symbols_by_symbol(const std::string& symbol) override;
@@ -51,8 +63,21 @@ public:
     std::shared_ptr<types::Orders> query_orders_by_exchange_id(const std::string& exchange_id) override;
 
 private:
+    friend class SQLiteBatch;
+
+    /// Do nothing inside a batch, which commits or rolls back at its end. A
+    /// failed code inside a batch makes it roll back.
     void start_transaction() const;
-    void commit_or_rollback(decltype(SQLITE_OK) code) const;
+    /// @return false if changes are rolled back, or will be with the batch.
+    bool commit_or_rollback(decltype(SQLITE_OK) code);
+
+    void begin_batch();
+    bool end_batch(bool is_commit);
+
+    void set_pragma(const std::string& pragma, const std::string& value, std::initializer_list<std::string_view> values) const;
+    /// Migrates tables of older versions in place.
+    /// @throws std::runtime_error If the version is unknown or migration fails.
+    void check_schema_version() const;
 
 private:
     void init_symbol_table();
@@ -78,10 +103,19 @@ private:
     [[nodiscard]] static types::SideType to_side(const std::string& side);
     [[nodiscard]] static std::string to_position_side(types::PositionSideType position_side);
     [[nodiscard]] static types::PositionSideType to_position_side(const std::string& position_side);
+    /// Timestamps are stored as nanoseconds since epoch.
+    [[nodiscard]] static int64_t to_nanoseconds(const google::protobuf::Timestamp& timestamp);
+    [[nodiscard]] static google::protobuf::Timestamp* to_timestamp(int64_t nanoseconds);
+
+public:
+    /// Bumped when layout of tables changes, kept in PRAGMA user_version.
+    static constexpr int schema_version = 1;
 
 private:
     SQLite3Ptr m_db;
     decltype(SQLITE_OK) m_exec_code;
+    bool m_is_in_batch     = false;
+    bool m_is_batch_failed = false;
     /// Symbols table.
     const std::string m_symbol_table_name;
     SQLite3StmtPtr m_insert_symbols;
@@ -100,4 +134,26 @@ private:
     std::unordered_map<std::string, SQLite3StmtPtr> m_query_orders_by;
 };
 
+/// Commits updates made through SQLiteHolder in one transaction, which saves
+/// a sync per update on file-backed databases. Rolled back if destroyed
+/// before commit().
+class TD_PUBLIC_API SQLiteBatch final
+{
+public:
+    explicit SQLiteBatch(SQLiteHolder& holder);
+    ~SQLiteBatch();
+
+    SQLiteBatch(const SQLiteBatch&)            = delete;
+    SQLiteBatch& operator=(const SQLiteBatch&) = delete;
+
+public:
+    /// @return false if any statement failed and the batch is rolled back.
+    bool commit();
+    void rollback();
+
+private:
+    SQLiteHolder& m_holder;
+    bool m_is_done = false;
+};
+
 } // namespace trade::holder
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <condition_variable>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "AppBase.hpp"
+#include "IHolder.h"
+
+namespace trade::holder
+{
+
+/// Keeps orders in memory and persists them to another holder in background.
+///
+/// Orders updated here are authoritative at once, queries by unique_id,
+/// broker_id and exchange_id are answered from memory while orders have
+/// changes not written yet, and fall back to the persistent holder once they
+/// are written and evicted. Changes are written by a background thread in
+/// batches, at most max_lag later, and all pending changes are written before
+/// destruction. Symbols, funds and positions are passed through to the
+/// persistent holder.
+///
+/// Orders of a failed write are kept and written again with the next batch,
+/// after a backoff doubling from max_lag up to max_backoff. They are dropped
+/// only if writes still fail when destroyed.
+class TD_PUBLIC_API WriteBehindHolder final: public IHolder, private AppBase<>
+{
+public:
+    explicit WriteBehindHolder(
+        const std::shared_ptr<IHolder>& holder,
+        std::chrono::milliseconds max_lag = std::chrono::milliseconds(100),
+        size_t batch_size                 = 1024
+    );
+    ~WriteBehindHolder() override;
+
+public:
+    int64_t update_symbols(std::shared_ptr<types::Symbols> symbols) override;
+    std::shared_ptr<types::Symbols> query_symbols_by_symbol(const std::string& symbol) override;
+    std::shared_ptr<types::Symbols> query_symbols_by_exchange(types::ExchangeType exchange) override;
+
+    int64_t update_funds(std::shared_ptr<types::Funds> funds) override;
+    std::shared_ptr<types::Funds> query_funds_by_account_id(const std::string& account_id) override;
+
+    int64_t update_positions(std::shared_ptr<types::Positions> positions) override;
+    std::shared_ptr<types::Positions> query_positions_by_symbol(const std::string& symbol) override;
+
+    int64_t update_orders(std::shared_ptr<types::Orders> orders) override;
+    std::shared_ptr<types::Orders> query_orders_by_unique_id(int64_t unique_id) override;
+    std::shared_ptr<types::Orders> query_orders_by_broker_id(const std::string& broker_id) override;
+    std::shared_ptr<types::Orders> query_orders_by_exchange_id(const std::string& exchange_id) override;
+
+public:
+    /// Block until all changes made before are written, which lasts as long
+    /// as writes fail.
+    void flush();
+    /// Changes not written yet.
+    [[nodiscard]] size_t pending() const;
+    /// Orders kept in memory.
+    [[nodiscard]] size_t kept() const;
+
+private:
+    using Index = std::unordered_multimap<std::string, int64_t>;
+
+    /// Must be called with m_orders_mutex held exclusively.
+    void put(const types::Order& order);
+    /// Must be called with m_orders_mutex held exclusively.
+    void evict(int64_t unique_id);
+    static void index(Index& index, const std::string& id, int64_t unique_id);
+    static void unindex(Index& index, const std::string& id, int64_t unique_id);
+
+    std::shared_ptr<types::Orders> query_orders_by(const Index& index, const std::string& id) const;
+
+    void write_behind();
+
+private:
+    static constexpr std::chrono::milliseconds max_backoff {5000};
+    static constexpr int max_failures_on_stop = 3;
+
+private:
+    const std::shared_ptr<IHolder> m_holder;
+    const std::chrono::milliseconds m_max_lag;
+    const size_t m_batch_size;
+
+private:
+    struct Kept {
+        types::Order order;
+        /// Bumped on every change, the order is evicted only if no change
+        /// came after the one written.
+        uint64_t version = 0;
+    };
+
+    /// Orders not written yet by unique_id and indexes of them.
+    mutable std::shared_mutex m_orders_mutex;
+    std::unordered_map<int64_t, Kept> m_orders;
+    Index m_broker_ids;
+    Index m_exchange_ids;
+
+private:
+    /// Unique ids of changed orders in order of change, latest one is written.
+    mutable std::mutex m_pending_mutex;
+    std::condition_variable m_pending_cv;
+    std::condition_variable m_written_cv;
+    std::vector<int64_t> m_pending;
+    uint64_t m_enqueued    = 0;
+    uint64_t m_written     = 0;
+    uint64_t m_flush_until = 0;
+    bool m_is_running      = true;
+
+private:
+    /// Persistent holder is not assumed to be thread-safe.
+    std::mutex m_holder_mutex;
+    std::thread m_writer;
+};
+
+} // namespace trade::holder
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Layout of tick archive files written by ArchiveReporter and read by
+/// ArchiveReader. All numbers are little-endian.
+///
+/// File   := FileHeader Block*
+/// FileHeader := magic(4) version(u16) kind(u8) symbol(str) column_count(u16) (type(u8) name(str))*
+/// Block  := magic(4) rows(u32) compression(u8) raw_size(u32) stored_size(u32) (min(i64) max(i64))* payload(stored_size)
+/// Payload (after decompression) := (size(varint) column)*
+/// str    := size(u16) bytes
+///
+/// Integer and timestamp columns are delta coded, floating point columns are
+/// XOR coded, see utilities::ColumnCodec. min/max of every column is kept in
+/// block header so that readers can skip blocks without decoding them.
+namespace trade::reporter::archive
+{
+
+static_assert(std::endian::native == std::endian::little, "Tick archive requires little-endian system");
+
+constexpr std::string_view file_magic  = "TDCA";
+constexpr std::string_view block_magic = "TDCB";
+constexpr uint16_t version             = 1;
+constexpr std::string_view extension   = ".tdca";
+
+enum class Kind : uint8_t {
+    l2_tick     = 0,
+    ranged_tick = 1,
+};
+
+enum class Compression : uint8_t {
+    none = 0,
+    zlib = 1,
+};
+
+enum class ColumnType : uint8_t {
+    integer   = 0,
+    /// Bit pattern of double.
+    floating  = 1,
+    /// Milliseconds since epoch.
+    timestamp = 2,
+};
+
+struct Column {
+    std::string name;
+    ColumnType type;
+
+    bool operator==(const Column&) const = default;
+};
+
+/// Decoded rows, column by column. Floating point values are stored as their
+/// bit patterns.
+struct Table {
+    std::vector<Column> columns;
+    std::vector<std::vector<int64_t>> values;
+
+    [[nodiscard]] size_t rows() const { return values.empty() ? 0 : values.front().size(); }
+
+    [[nodiscard]] double floating(const size_t column, const size_t row) const
+    {
+        return std::bit_cast<double>(values[column][row]);
+    }
+};
+
+inline std::string_view to_string(const Kind kind)
+{
+    return kind == Kind::l2_tick ? "l2-tick" : "ranged-tick";
+}
+
+/// Same columns as CSVReporter, without symbol which is in file header.
+inline const std::vector<Column>& schema(const Kind kind)
+{
+    static const std::vector<Column> l2_tick_columns {
+        {"price_1000x", ColumnType::integer},
+        {"quantity", ColumnType::integer},
+        {"ask_unique_id", ColumnType::integer},
+        {"bid_unique_id", ColumnType::integer},
+        {"sell_price_1000x_5", ColumnType::integer},
+        {"sell_quantity_5", ColumnType::integer},
+        {"sell_price_1000x_4", ColumnType::integer},
+        {"sell_quantity_4", ColumnType::integer},
+        {"sell_price_1000x_3", ColumnType::integer},
+        {"sell_quantity_3", ColumnType::integer},
+        {"sell_price_1000x_2", ColumnType::integer},
+        {"sell_quantity_2", ColumnType::integer},
+        {"sell_price_1000x_1", ColumnType::integer},
+        {"sell_quantity_1", ColumnType::integer},
+        {"buy_price_1000x_1", ColumnType::integer},
+        {"buy_quantity_1", ColumnType::integer},
+        {"buy_price_1000x_2", ColumnType::integer},
+        {"buy_quantity_2", ColumnType::integer},
+        {"buy_price_1000x_3", ColumnType::integer},
+        {"buy_quantity_3", ColumnType::integer},
+        {"buy_price_1000x_4", ColumnType::integer},
+        {"buy_quantity_4", ColumnType::integer},
+        {"buy_price_1000x_5", ColumnType::integer},
+        {"buy_quantity_5", ColumnType::integer},
+        /// Time.
+        {"exchange_time", ColumnType::integer},
+        {"local_system_time", ColumnType::timestamp},
+    };
+
+    static const std::vector<Column> ranged_tick_columns {
+        {"exchange_date", ColumnType::integer},
+        {"exchange_time", ColumnType::integer},
+        {"start_time", ColumnType::integer},
+        {"end_time", ColumnType::integer},
+        {"sell_price_1000x_5", ColumnType::integer},
+        {"sell_price_1000x_4", ColumnType::integer},
+        {"sell_price_1000x_3", ColumnType::integer},
+        {"sell_price_1000x_2", ColumnType::integer},
+        {"sell_price_1000x_1", ColumnType::integer},
+        {"buy_price_1000x_1", ColumnType::integer},
+        {"buy_price_1000x_2", ColumnType::integer},
+        {"buy_price_1000x_3", ColumnType::integer},
+        {"buy_price_1000x_4", ColumnType::integer},
+        {"buy_price_1000x_5", ColumnType::integer},
+        {"active_traded_sell_number", ColumnType::integer},
+        {"active_sell_number", ColumnType::integer},
+        {"active_sell_quantity", ColumnType::integer},
+        {"active_sell_amount_1000x", ColumnType::integer},
+        {"active_traded_buy_number", ColumnType::integer},
+        {"active_buy_number", ColumnType::integer},
+        {"active_buy_quantity", ColumnType::integer},
+        {"active_buy_amount_1000x", ColumnType::integer},
+        {"weighted_ask_price_5", ColumnType::floating},
+        {"weighted_ask_price_4", ColumnType::floating},
+        {"weighted_ask_price_3", ColumnType::floating},
+        {"weighted_ask_price_2", ColumnType::floating},
+        {"weighted_ask_price_1", ColumnType::floating},
+        {"weighted_bid_price_1", ColumnType::floating},
+        {"weighted_bid_price_2", ColumnType::floating},
+        {"weighted_bid_price_3", ColumnType::floating},
+        {"weighted_bid_price_4", ColumnType::floating},
+        {"weighted_bid_price_5", ColumnType::floating},
+        {"aggressive_sell_number", ColumnType::integer},
+        {"aggressive_buy_number", ColumnType::integer},
+        {"new_added_ask_1_quantity", ColumnType::integer},
+        {"new_added_bid_1_quantity", ColumnType::integer},
+        {"new_canceled_ask_1_quantity", ColumnType::integer},
+        {"new_canceled_bid_1_quantity", ColumnType::integer},
+        {"new_canceled_ask_all_quantity", ColumnType::integer},
+        {"new_canceled_bid_all_quantity", ColumnType::integer},
+        {"big_ask_amount_1000x", ColumnType::integer},
+        {"big_bid_amount_1000x", ColumnType::integer},
+        {"highest_price_1000x", ColumnType::integer},
+        {"lowest_price_1000x", ColumnType::integer},
+        {"ask_price_1_valid_duration_1000x", ColumnType::integer},
+        {"bid_price_1_valid_duration_1000x", ColumnType::integer},
+    };
+
+    return kind == Kind::l2_tick ? l2_tick_columns : ranged_tick_columns;
+}
+
+template<typename T>
+void put(std::string& out, const T value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void put_string(std::string& out, const std::string_view value)
+{
+    put<uint16_t>(out, static_cast<uint16_t>(value.size()));
+    out.append(value);
+}
+
+} // namespace trade::reporter::archive
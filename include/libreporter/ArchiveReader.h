@@ -0,0 +1,73 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "AppBase.hpp"
+#include "ArchiveFormat.hpp"
+#include "visibility.h"
+
+namespace trade::reporter
+{
+
+/// Reads tick archives written by ArchiveReporter. Only the file header and
+/// block headers are read on construction, blocks are decoded on demand.
+class TD_PUBLIC_API ArchiveReader final: private AppBase<>
+{
+public:
+    /// @throws std::runtime_error If the file cannot be opened or is not a
+    /// tick archive.
+    explicit ArchiveReader(const std::string& path) noexcept(false);
+    ~ArchiveReader() override = default;
+
+public:
+    struct Block {
+        uint32_t rows;
+        archive::Compression compression;
+        uint32_t raw_size;
+        uint32_t stored_size;
+        /// Offset of payload in file.
+        std::streamoff offset;
+        /// Min/max of every column. Bit patterns for floating point columns.
+        std::vector<std::pair<int64_t, int64_t>> ranges;
+    };
+
+    [[nodiscard]] archive::Kind kind() const { return m_kind; }
+    [[nodiscard]] const std::string& symbol() const { return m_symbol; }
+    [[nodiscard]] const std::vector<archive::Column>& columns() const { return m_columns; }
+    [[nodiscard]] const std::vector<Block>& blocks() const { return m_blocks; }
+    [[nodiscard]] size_t rows() const;
+
+    /// @return Index of the column, -1 if not found.
+    [[nodiscard]] int column_index(std::string_view name) const;
+
+public:
+    /// Decodes all rows.
+    /// @throws std::runtime_error If any block is corrupted.
+    [[nodiscard]] archive::Table read() noexcept(false);
+
+    /// Decodes rows of blocks whose range of the given column overlaps
+    /// [from, to], and keeps only the rows in it, e.g. exchange_time between
+    /// 93000000 and 100000000. Use bit patterns for floating point columns.
+    /// @throws std::runtime_error If column is not found or any block is
+    /// corrupted.
+    [[nodiscard]] archive::Table read(std::string_view column, int64_t from, int64_t to) noexcept(false);
+
+private:
+    void read_header() noexcept(false);
+    void read_blocks();
+    void decode(const Block& block, archive::Table& table) noexcept(false);
+
+private:
+    const std::string m_path;
+    std::ifstream m_file;
+
+private:
+    archive::Kind m_kind = archive::Kind::l2_tick;
+    std::string m_symbol;
+    std::vector<archive::Column> m_columns;
+    std::vector<Block> m_blocks;
+};
+
+} // namespace trade::reporter
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <filesystem>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "AppBase.hpp"
+#include "ArchiveFormat.hpp"
+#include "IReporter.hpp"
+#include "NopReporter.hpp"
+
+namespace trade::reporter
+{
+
+/// Archives generated ticks in columnar files, one per day, symbol and kind
+/// of tick, at <output_folder>/<exchange_date>/<symbol>-<kind>.tdca. See
+/// ArchiveFormat.hpp for the layout and ArchiveReader for reading them back.
+///
+/// Files of the same day left by previous runs are appended to.
+class TD_PUBLIC_API ArchiveReporter final: private AppBase<>, public NopReporter
+{
+public:
+    /// Rows are appended to the file as a block every block_rows rows of a
+    /// symbol, and on destruction. Empty output_folder disables archiving.
+    explicit ArchiveReporter(
+        std::string output_folder,
+        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>(),
+        size_t block_rows                         = 4096,
+        archive::Compression compression          = archive::Compression::zlib
+    );
+    ~ArchiveReporter() override;
+
+    /// Market data.
+public:
+    void l2_tick_generated(std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick) override;
+    void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick) override;
+
+private:
+    /// Rows of one file not yet written.
+    struct Columns {
+        archive::Kind kind;
+        std::string path;
+        std::vector<std::vector<int64_t>> values;
+    };
+
+    /// Symbol and exchange date.
+    using Key = std::pair<std::string, int64_t>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return std::hash<std::string>()(key.first) ^ std::hash<int64_t>()(key.second); }
+    };
+
+    /// Columns of one kind of tick, only touched by its reporting thread.
+    struct Tables {
+        archive::Kind kind;
+        std::unordered_map<Key, Columns, KeyHash> columns;
+        /// Symbol -> latest exchange date, whose columns are kept.
+        std::unordered_map<std::string, int64_t> dates;
+    };
+
+    Columns& new_columns(Tables& tables, const std::string& symbol, int64_t exchange_date);
+    /// Opens archive at path for appending, creating it if it does not exist.
+    /// @return Whether the file is ready.
+    bool open_file(const std::filesystem::path& path, archive::Kind kind, const std::string& symbol);
+    void append_row(Columns& columns, std::initializer_list<int64_t> row);
+    void write_block(Columns& columns);
+
+private:
+    const std::string m_output_folder;
+    const size_t m_block_rows;
+    const archive::Compression m_compression;
+
+private:
+    Tables m_l2_tick_tables {archive::Kind::l2_tick, {}};
+    Tables m_ranged_tick_tables {archive::Kind::ranged_tick, {}};
+
+private:
+    std::shared_ptr<IReporter> m_outside;
+};
+
+} // namespace trade::reporter
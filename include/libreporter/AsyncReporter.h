@@ -39,6 +39,7 @@ public:
     void exchange_l2_snap_arrived(std::shared_ptr<types::ExchangeL2Snap> exchange_l2_snap) override;
     void l2_tick_generated(std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick) override;
     void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick) override;
+    void md_seq_gap_detected(std::shared_ptr<types::SeqGap> seq_gap) override;
 
 private:
     /// Order.
@@ -65,6 +66,7 @@ public:
     void do_exchange_l2_tick_arrived();
     void do_l2_tick_generated();
     void do_ranged_tick_generated();
+    void do_md_seq_gap_detected();
 
 private:
     template<typename T>
@@ -116,6 +118,9 @@ private:
     BufferType<types::RangedTick> m_ranged_tick_buffer;
     std::mutex m_ranged_tick_mutex;
     std::thread m_ranged_tick_thread;
+    BufferType<types::SeqGap> m_seq_gap_buffer;
+    std::mutex m_seq_gap_mutex;
+    std::thread m_seq_gap_thread;
 
 private:
     std::atomic<bool> m_is_running;
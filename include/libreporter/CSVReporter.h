@@ -1,11 +1,22 @@
 #pragma once
 
 #include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "AppBase.hpp"
 #include "IReporter.hpp"
 #include "NopReporter.hpp"
+#include "utilities/TimeHelper.hpp"
 
 namespace trade::reporter
 {
@@ -13,16 +24,20 @@ namespace trade::reporter
 class TD_PUBLIC_API CSVReporter final: private AppBase<>, public NopReporter
 {
 public:
+    /// Rows are formatted into per-symbol buffers, which are handed to a
+    /// background writer thread once they exceed buffer_size bytes, or on
+    /// the next row after flush_interval_ms. The writer keeps at most
+    /// max_open_files files open and closes the least recently written ones.
+    /// Handing off blocks while max_pending_size bytes are not written yet,
+    /// so that a slow disk holds up reporting instead of growing memory.
     explicit CSVReporter(
         std::string output_folder,
-        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>()
-    )
-        : AppBase("CSVReporter"),
-          NopReporter(outside),
-          m_output_folder(std::move(output_folder)),
-          m_outside(outside)
-    {
-    }
+        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>(),
+        size_t max_open_files                     = 256,
+        size_t buffer_size                        = 64 * 1024,
+        int64_t flush_interval_ms                 = 1000,
+        size_t max_pending_size                   = 64 * 1024 * 1024
+    );
     ~CSVReporter() override;
 
     /// Market data.
@@ -31,17 +46,68 @@ public:
     void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick) override;
 
 private:
-    void new_l2_tick_writer(const std::string& symbol);
-    void new_ranged_tick_writer(const std::string& symbol);
+    /// Rows of one file.
+    struct Chunk {
+        std::string path;
+        std::string data;
+    };
+
+    /// Buffers of one kind of tick, only touched by its reporting thread.
+    struct Buffers {
+        /// Symbol -> rows not yet handed to writer thread.
+        std::unordered_map<std::string, Chunk> chunks;
+        std::chrono::steady_clock::time_point last_hand_off;
+        /// Not thread-safe, one per reporting thread.
+        utilities::CachedNow now;
+    };
+
+    Chunk& new_l2_tick_buffer(const std::string& symbol);
+    Chunk& new_ranged_tick_buffer(const std::string& symbol);
+    Chunk& new_buffer(Buffers& buffers, const std::string& symbol, const std::string& suffix, std::string_view header);
+
+    /// Hands chunk to writer thread if it is full, or all chunks of buffers
+    /// if flush interval has elapsed.
+    void try_hand_off(Buffers& buffers, Chunk& chunk);
+    void hand_off(Chunk& chunk);
+
+    void writer();
+    void write(const Chunk& chunk);
+    std::ofstream& open_file(const std::string& path);
+
+private:
+    const std::string m_output_folder;
+    const size_t m_max_open_files;
+    const size_t m_buffer_size;
+    const std::chrono::milliseconds m_flush_interval;
+    const size_t m_max_pending_size;
+
+private:
+    Buffers m_l2_tick_buffers;
+    Buffers m_ranged_tick_buffers;
+
+private:
+    /// Chunks pending for writer thread, and emptied strings for reuse.
+    std::vector<Chunk> m_chunks;
+    std::vector<std::string> m_spare_strings;
+    std::mutex m_chunk_mutex;
+    std::condition_variable m_chunk_cv;
+    std::condition_variable m_space_cv;
+    /// Bytes handed off and not written yet, including those being written.
+    size_t m_pending_size = 0;
+    /// Hand-offs blocked for pending bytes.
+    size_t m_stalls = 0;
+    std::atomic<bool> m_is_running;
+    std::thread m_writer_thread;
 
 private:
-    std::string m_output_folder;
-    /// Symbol -> ofstream.
-    std::unordered_map<std::string, std::ofstream> m_l2_tick_writers;
-    std::unordered_map<std::string, std::ofstream> m_ranged_tick_writers;
+    /// Only touched by writer thread. Most recently written file is at front.
+    std::list<std::string> m_lru;
+    std::unordered_map<std::string, std::pair<std::ofstream, std::list<std::string>::iterator>> m_files;
+    /// Files created in this run, reopened in append mode after eviction.
+    std::unordered_set<std::string> m_created_files;
 
 private:
     std::shared_ptr<IReporter> m_outside;
 };
 
-} // namespace trade::reporter
\ No newline at end of file
+} // namespace trade::reporter
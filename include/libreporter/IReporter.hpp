@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 
 #include "networks.pb.h"
 #include "orms.pb.h"
@@ -41,6 +42,42 @@ public:
     virtual void exchange_l2_snap_arrived(std::shared_ptr<types::ExchangeL2Snap> exchange_l2_snap) = 0;
     virtual void l2_tick_generated(std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick)      = 0;
     virtual void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick)            = 0;
+    virtual void md_seq_gap_detected(std::shared_ptr<types::SeqGap> seq_gap)                      = 0;
+
+    /// Market data in batch, e.g. all ticks of one input packet. Events are
+    /// passed by reference so that no refcount is touched unless a reporter
+    /// keeps them. Defaults call the per-event methods one by one, override
+    /// them to handle a batch at once.
+public:
+    virtual void exchange_order_ticks_arrived(const std::span<const std::shared_ptr<types::OrderTick>> order_ticks)
+    {
+        for (const auto& order_tick : order_ticks)
+            exchange_order_tick_arrived(order_tick);
+    }
+
+    virtual void exchange_trade_ticks_arrived(const std::span<const std::shared_ptr<types::TradeTick>> trade_ticks)
+    {
+        for (const auto& trade_tick : trade_ticks)
+            exchange_trade_tick_arrived(trade_tick);
+    }
+
+    virtual void exchange_l2_snaps_arrived(const std::span<const std::shared_ptr<types::ExchangeL2Snap>> exchange_l2_snaps)
+    {
+        for (const auto& exchange_l2_snap : exchange_l2_snaps)
+            exchange_l2_snap_arrived(exchange_l2_snap);
+    }
+
+    virtual void l2_ticks_generated(const std::span<const std::shared_ptr<types::GeneratedL2Tick>> generated_l2_ticks)
+    {
+        for (const auto& generated_l2_tick : generated_l2_ticks)
+            l2_tick_generated(generated_l2_tick);
+    }
+
+    virtual void ranged_ticks_generated(const std::span<const std::shared_ptr<types::RangedTick>> ranged_ticks)
+    {
+        for (const auto& ranged_tick : ranged_ticks)
+            ranged_tick_generated(ranged_tick);
+    }
 };
 
 } // namespace trade::reporter
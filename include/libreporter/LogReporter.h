@@ -44,6 +44,7 @@ public:
     void exchange_l2_snap_arrived(std::shared_ptr<types::ExchangeL2Snap> exchange_l2_snap) override;
     void l2_tick_generated(std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick) override;
     void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick) override;
+    void md_seq_gap_detected(std::shared_ptr<types::SeqGap> seq_gap) override;
 
 private:
     std::shared_ptr<spdlog::logger> trade_logger;
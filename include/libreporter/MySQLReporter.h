@@ -1,6 +1,12 @@
 #pragma once
 
-#include <mysqlx/xdevapi.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
 
 #include "AppBase.hpp"
 #include "IReporter.hpp"
@@ -12,13 +18,53 @@ namespace trade::reporter
 class TD_PUBLIC_API MySQLReporter final: private AppBase<>, public NopReporter
 {
 public:
+    /// Connection to the table rows are inserted into.
+    class Session
+    {
+    public:
+        virtual ~Session() = default;
+
+        /// All rows in one statement.
+        /// @throws std::exception If rows are not inserted, the session is
+        /// dropped and a new one is made for retrying.
+        virtual void insert(const std::vector<std::shared_ptr<types::RangedTick>>& ranged_ticks) = 0;
+    };
+
+    /// @throws std::exception If failed to connect.
+    using SessionFactory = std::function<std::unique_ptr<Session>()>;
+
+public:
+    /// Rows are buffered and inserted by a background thread in batches of
+    /// batch_size, or every flush_interval_ms if fewer rows arrived.
+    /// Batches still failing after max_retries are appended to spill_file
+    /// as JSON lines, or dropped if spill_file is empty. Once stopping,
+    /// failed batches are neither retried nor reconnected for.
+    /// Rows arriving while buffer_capacity rows are buffered are dropped
+    /// rather than blocking the caller.
     MySQLReporter(
         const std::string& url,
         const std::string& user,
         const std::string& password,
         const std::string& database,
         const std::string& table,
-        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>()
+        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>(),
+        size_t batch_size                         = 1000,
+        int64_t flush_interval_ms                 = 1000,
+        size_t buffer_capacity                    = 100000,
+        size_t max_retries                        = 3,
+        std::string spill_file                    = ""
+    );
+    /// Sessions made by make_session instead of X DevAPI, e.g. in tests.
+    /// @param target Name of the database in logs.
+    MySQLReporter(
+        std::string target,
+        SessionFactory make_session,
+        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>(),
+        size_t batch_size                         = 1000,
+        int64_t flush_interval_ms                 = 1000,
+        size_t buffer_capacity                    = 100000,
+        size_t max_retries                        = 3,
+        std::string spill_file                    = ""
     );
     ~MySQLReporter() override;
 
@@ -26,13 +72,55 @@ public:
 public:
     void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick) override;
 
+public:
+    struct Metrics {
+        std::atomic<size_t> queue_depth     = 0;
+        std::atomic<size_t> max_queue_depth = 0;
+        std::atomic<size_t> batches         = 0;
+        std::atomic<size_t> last_batch_size = 0;
+        std::atomic<size_t> inserted_rows   = 0;
+        std::atomic<size_t> spilled_rows    = 0;
+        /// For full buffer, or failed batches without spill file.
+        std::atomic<size_t> dropped_rows    = 0;
+        std::atomic<size_t> retries         = 0;
+        std::atomic<int64_t> last_flush_us  = 0;
+        std::atomic<int64_t> max_flush_us   = 0;
+        std::atomic<int64_t> total_flush_us = 0;
+    };
+
+    [[nodiscard]] const Metrics& metrics() const { return m_metrics; }
+
+private:
+    bool connect();
+    void flusher();
+    void flush(const std::vector<std::shared_ptr<types::RangedTick>>& ranged_ticks);
+    void spill(const std::vector<std::shared_ptr<types::RangedTick>>& ranged_ticks);
+    void log_metrics() const;
+
+private:
+    const std::string m_target;
+    const SessionFactory m_make_session;
+    /// Only touched by flusher thread, nullptr if disconnected.
+    std::unique_ptr<Session> m_session;
+
+private:
+    const size_t m_batch_size;
+    const std::chrono::milliseconds m_flush_interval;
+    const size_t m_buffer_capacity;
+    const size_t m_max_retries;
+    const std::string m_spill_file;
+    std::ofstream m_spill_stream;
+
 private:
-    std::shared_ptr<mysqlx::Session> m_sess;
-    std::shared_ptr<mysqlx::Schema> m_schema;
-    std::shared_ptr<mysqlx::Table> m_table;
+    std::deque<std::shared_ptr<types::RangedTick>> m_buffer;
+    std::mutex m_buffer_mutex;
+    std::condition_variable m_buffer_cv;
+    std::atomic<bool> m_is_running;
+    std::thread m_flusher_thread;
+    Metrics m_metrics;
 
 private:
     std::shared_ptr<IReporter> m_outside;
 };
 
-} // namespace trade::reporter
\ No newline at end of file
+} // namespace trade::reporter
@@ -77,6 +77,10 @@ public:
     {
         if (m_outside != nullptr) m_outside->ranged_tick_generated(ranged_tick);
     }
+    void md_seq_gap_detected(const std::shared_ptr<types::SeqGap> seq_gap) override
+    {
+        if (m_outside != nullptr) m_outside->md_seq_gap_detected(seq_gap);
+    }
 
 private:
     std::shared_ptr<IReporter> m_outside;
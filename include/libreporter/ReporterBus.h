@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "AppBase.hpp"
+#include "IReporter.hpp"
+#include "NopReporter.hpp"
+
+namespace trade::reporter
+{
+
+enum class OverflowPolicy
+{
+    /// Producer waits until the sink catches up.
+    block,
+    /// Oldest queued market data is dropped. Order, cancel and trade events
+    /// and seq gaps are never dropped, they block when the queue is full of
+    /// them.
+    drop_oldest,
+    /// Queued L2 snaps, generated L2 ticks and ranged ticks are replaced by
+    /// newer ones of the same symbol, other events block when full.
+    ///
+    /// The newer one takes the place of the queued one, so it is delivered
+    /// ahead of events queued after that place, of other symbols or of other
+    /// types of the same symbol. Only events of the same type and symbol keep
+    /// their order.
+    conflate,
+};
+
+struct SinkOptions {
+    std::string name;
+    /// Sink is called on the producer thread, for latency-critical sinks. It
+    /// must be thread-safe if there are several producers.
+    bool is_inline                 = false;
+    /// Sinks with higher priority receive events first, inline sinks always
+    /// before queued ones.
+    int priority                   = 0;
+    size_t capacity                = 64 * 1024;
+    OverflowPolicy overflow_policy = OverflowPolicy::block;
+};
+
+/// Delivers every event to all sinks, each of which runs on its own thread
+/// with its own bounded queue, or inline on the producer thread, so that a
+/// slow sink does not delay the others.
+class TD_PUBLIC_API ReporterBus final: private AppBase<>, public IReporter
+{
+public:
+    ReporterBus();
+    ~ReporterBus() override;
+
+public:
+    /// Sinks must be added before any event is reported.
+    void add_sink(std::shared_ptr<IReporter> sink, SinkOptions options);
+
+    struct SinkStats {
+        std::atomic<size_t> delivered = 0;
+        std::atomic<size_t> dropped   = 0;
+        std::atomic<size_t> conflated = 0;
+        std::atomic<size_t> max_depth = 0;
+    };
+
+    /// @return Stats of the sink, nullptr if not found.
+    [[nodiscard]] const SinkStats* stats(const std::string& name) const;
+
+    /// Order.
+public:
+    void broker_accepted(std::shared_ptr<types::BrokerAcceptance> broker_acceptance) override;
+    void exchange_accepted(std::shared_ptr<types::ExchangeAcceptance> exchange_acceptance) override;
+    void order_rejected(std::shared_ptr<types::OrderRejection> order_rejection) override;
+
+    /// Cancel.
+public:
+    void cancel_broker_accepted(std::shared_ptr<types::CancelBrokerAcceptance> cancel_broker_acceptance) override;
+    void cancel_exchange_accepted(std::shared_ptr<types::CancelExchangeAcceptance> cancel_exchange_acceptance) override;
+    void cancel_success(std::shared_ptr<types::CancelSuccess> cancel_success) override;
+    void cancel_order_rejected(std::shared_ptr<types::CancelOrderRejection> cancel_order_rejection) override;
+
+    /// Trade.
+public:
+    void trade_accepted(std::shared_ptr<types::Trade> trade) override;
+
+    /// Market data.
+public:
+    void exchange_order_tick_arrived(std::shared_ptr<types::OrderTick> order_tick) override;
+    void exchange_trade_tick_arrived(std::shared_ptr<types::TradeTick> trade_tick) override;
+    void exchange_l2_snap_arrived(std::shared_ptr<types::ExchangeL2Snap> exchange_l2_snap) override;
+    void l2_tick_generated(std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick) override;
+    void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick) override;
+    void md_seq_gap_detected(std::shared_ptr<types::SeqGap> seq_gap) override;
+
+    /// Market data in batch, queued with one lock per sink.
+public:
+    void exchange_order_ticks_arrived(std::span<const std::shared_ptr<types::OrderTick>> order_ticks) override;
+    void exchange_trade_ticks_arrived(std::span<const std::shared_ptr<types::TradeTick>> trade_ticks) override;
+    void exchange_l2_snaps_arrived(std::span<const std::shared_ptr<types::ExchangeL2Snap>> exchange_l2_snaps) override;
+    void l2_ticks_generated(std::span<const std::shared_ptr<types::GeneratedL2Tick>> generated_l2_ticks) override;
+    void ranged_ticks_generated(std::span<const std::shared_ptr<types::RangedTick>> ranged_ticks) override;
+
+private:
+    using Event = std::variant<
+        std::shared_ptr<types::BrokerAcceptance>,
+        std::shared_ptr<types::ExchangeAcceptance>,
+        std::shared_ptr<types::OrderRejection>,
+        std::shared_ptr<types::CancelBrokerAcceptance>,
+        std::shared_ptr<types::CancelExchangeAcceptance>,
+        std::shared_ptr<types::CancelSuccess>,
+        std::shared_ptr<types::CancelOrderRejection>,
+        std::shared_ptr<types::Trade>,
+        std::shared_ptr<types::OrderTick>,
+        std::shared_ptr<types::TradeTick>,
+        std::shared_ptr<types::ExchangeL2Snap>,
+        std::shared_ptr<types::GeneratedL2Tick>,
+        std::shared_ptr<types::RangedTick>,
+        std::shared_ptr<types::SeqGap>>;
+
+    struct Sink {
+        std::shared_ptr<IReporter> reporter;
+        SinkOptions options;
+        SinkStats stats;
+
+        /// Queue of threaded sinks, head_seq is the sequence of its front.
+        std::deque<Event> queue;
+        uint64_t head_seq = 0;
+        /// Event type and symbol -> sequence of latest queued event.
+        std::unordered_map<std::string, uint64_t> latest;
+        std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        bool is_running = true;
+        std::thread thread;
+    };
+
+    /// Events with empty symbol are never conflated.
+    void publish(const Event& event, std::string_view symbol = {});
+    void push(Sink& sink, const Event& event, std::string_view symbol);
+    /// Inline sinks get the whole batch by the batch method of reporter.
+    template<typename T>
+    void publish(
+        std::span<const std::shared_ptr<T>> events,
+        void (IReporter::*method)(std::span<const std::shared_ptr<T>>),
+        bool is_conflatable
+    );
+    /// Caller holds the lock of sink.
+    void enqueue(Sink& sink, std::unique_lock<std::mutex>& lock, const Event& event, std::string_view symbol);
+    /// Drop the oldest queued market data, or the event if it is market data.
+    /// @return false if nothing can be dropped.
+    static bool drop(Sink& sink, const Event& event);
+    void consume(Sink& sink);
+    static void deliver(IReporter& reporter, const Event& event);
+
+private:
+    /// Sorted by inline first, then priority.
+    std::vector<std::unique_ptr<Sink>> m_sinks;
+};
+
+} // namespace trade::reporter
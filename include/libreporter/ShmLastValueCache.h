@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <cstring>
+#include <string_view>
+
+#include "AppBase.hpp"
+#include "ShmReporter.h"
+
+namespace trade::reporter
+{
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Atomics in shared memory must be lock-free");
+
+/// Latest value of a symbol guarded by a seqlock, whose sequence is odd while
+/// the writer is updating the value.
+template<typename T>
+struct alignas(64) SMSeqLocked {
+    std::atomic<uint64_t> seq = 0;
+    T value;
+};
+
+struct TD_PUBLIC_API SMLastValueSlot {
+    SMSeqLocked<GeneratedL2Tick> generated_l2_tick;
+    SMSeqLocked<ExchangeL2Snap> exchange_l2_snap;
+    SMSeqLocked<RangedTick> ranged_tick;
+};
+
+/// Open addressing entry of directory, slot is published after symbol.
+struct TD_PUBLIC_API SMDirectoryEntry {
+    SymbolType symbol         = {};
+    std::atomic<int32_t> slot = -1;
+};
+
+struct TD_PUBLIC_API SMLastValueCacheHeader {
+    char magic[8]                    = {'T', 'D', 'L', 'V', 'C', '\0', '\0', '\0'};
+    uint32_t version                 = 1;
+    uint32_t slot_capacity           = 0;
+    uint32_t directory_size          = 0;
+    std::atomic<uint32_t> slot_count = 0;
+    /// Time the writer started, readers look up slots again if it changes.
+    std::atomic<int64_t> epoch       = 0;
+};
+
+/// Fixed-size table of the latest generated l2 tick, exchange l2 snap and
+/// ranged tick per symbol, for readers that only need the latest state of a
+/// symbol instead of scanning regions of ShmReporter.
+///
+/// Layout: header, directory, slots. Symbols get dense slots in order of
+/// arrival, which are never reused until the writer restarts.
+class TD_PUBLIC_API ShmLastValueCache final: private AppBase<>
+{
+public:
+    ShmLastValueCache(const std::string& shm_name, uint32_t slot_capacity);
+    ~ShmLastValueCache() override = default;
+
+public:
+    /// Update the value of the symbol in record. Not thread-safe, updates are
+    /// serialized by the lock of ShmReporter.
+    /// @return false if there is no free slot for a new symbol.
+    bool update(const GeneratedL2Tick& generated_l2_tick);
+    bool update(const ExchangeL2Snap& exchange_l2_snap);
+    bool update(const RangedTick& ranged_tick);
+
+public:
+    [[nodiscard]] static size_t segment_size(uint32_t slot_capacity);
+    [[nodiscard]] static size_t slots_offset(uint32_t slot_capacity);
+    [[nodiscard]] static uint32_t directory_size(uint32_t slot_capacity);
+    [[nodiscard]] static uint64_t hash(std::string_view symbol);
+
+private:
+    /// @return Slot of symbol, a new one if not found, -1 if full.
+    int32_t acquire_slot(const SymbolType& symbol);
+
+    template<typename T>
+    static void write(SMSeqLocked<T>& locked, const T& value)
+    {
+        const auto seq = locked.seq.load(std::memory_order_relaxed);
+
+        locked.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&locked.value, &value, sizeof(T));
+
+        locked.seq.store(seq + 2, std::memory_order_release);
+    }
+
+private:
+    boost::interprocess::shared_memory_object m_shm;
+    std::unique_ptr<boost::interprocess::mapped_region> m_region;
+    SMLastValueCacheHeader* m_header;
+    SMDirectoryEntry* m_directory;
+    SMLastValueSlot* m_slots;
+    bool m_is_full_warned = false;
+};
+
+/// Reads ShmLastValueCache from other processes.
+class TD_PUBLIC_API ShmLastValueCacheReader final
+{
+public:
+    /// @throw std::runtime_error if the table is not valid.
+    explicit ShmLastValueCacheReader(const std::string& shm_name);
+    ~ShmLastValueCacheReader() = default;
+
+public:
+    /// @return Slot of symbol, -1 if not found. Slots stay valid as long as
+    /// epoch() does not change.
+    [[nodiscard]] int32_t slot(std::string_view symbol) const;
+    [[nodiscard]] int64_t epoch() const { return m_header->epoch.load(std::memory_order_acquire); }
+    [[nodiscard]] uint32_t slot_count() const { return m_header->slot_count.load(std::memory_order_acquire); }
+
+    /// @return false if nothing has been written to the slot.
+    bool read(int32_t slot, GeneratedL2Tick& generated_l2_tick) const { return read_locked(m_slots[slot].generated_l2_tick, generated_l2_tick); }
+    bool read(int32_t slot, ExchangeL2Snap& exchange_l2_snap) const { return read_locked(m_slots[slot].exchange_l2_snap, exchange_l2_snap); }
+    bool read(int32_t slot, RangedTick& ranged_tick) const { return read_locked(m_slots[slot].ranged_tick, ranged_tick); }
+
+private:
+    template<typename T>
+    static bool read_locked(const SMSeqLocked<T>& locked, T& value)
+    {
+        while (true) {
+            const auto before = locked.seq.load(std::memory_order_acquire);
+
+            if (before == 0)
+                return false;
+
+            if (before & 1) [[unlikely]]
+                continue;
+
+            std::memcpy(&value, &locked.value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (locked.seq.load(std::memory_order_relaxed) == before) [[likely]]
+                return true;
+        }
+    }
+
+private:
+    boost::interprocess::shared_memory_object m_shm;
+    boost::interprocess::mapped_region m_region;
+    const SMLastValueCacheHeader* m_header;
+    const SMDirectoryEntry* m_directory;
+    const SMLastValueSlot* m_slots;
+};
+
+} // namespace trade::reporter
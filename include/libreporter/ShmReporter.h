@@ -1,9 +1,13 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
 #include <boost/interprocess/shared_memory_object.hpp>
 #include <boost/interprocess/sync/named_upgradable_mutex.hpp>
 #include <limits>
+#include <thread>
 
 #include "AppBase.hpp"
 #include "IReporter.hpp"
@@ -47,7 +51,8 @@ static_assert(sizeof(OrderType) == 4, "OrderType should be 4 bytes");
 struct TD_PUBLIC_API SMTickMateInfo {
     size_t tick_count        = 0;
     int64_t last_update_time = 0; /// Time in ISO 8601 format.
-    RESERVED(240)
+    size_t region_size       = 0; /// Size of region in bytes, including this info.
+    RESERVED(232)
 };
 
 static_assert(sizeof(SMTickMateInfo) == 256, "MateInfo for tick should be 256 bytes");
@@ -55,7 +60,8 @@ static_assert(sizeof(SMTickMateInfo) == 256, "MateInfo for tick should be 256 by
 struct TD_PUBLIC_API SMExchangeL2SnapMateInfo {
     size_t exchange_l2_snap_count = 0;
     int64_t last_update_time      = 0; /// Time in ISO 8601 format.
-    RESERVED(240)
+    size_t region_size            = 0; /// Size of region in bytes, including this info.
+    RESERVED(232)
 };
 
 static_assert(sizeof(SMExchangeL2SnapMateInfo) == 256, "MateInfo for exchange l2 sanp should be 256 bytes");
@@ -63,7 +69,8 @@ static_assert(sizeof(SMExchangeL2SnapMateInfo) == 256, "MateInfo for exchange l2
 struct TD_PUBLIC_API SMGeneratedL2TickMateInfo {
     size_t generated_l2_tick_count = 0;
     int64_t last_update_time       = 0; /// Time in ISO 8601 format.
-    RESERVED(240)
+    size_t region_size             = 0; /// Size of region in bytes, including this info.
+    RESERVED(232)
 };
 
 static_assert(sizeof(SMGeneratedL2TickMateInfo) == 256, "MateInfo for generated l2 tick should be 256 bytes");
@@ -83,6 +90,7 @@ enum class ShmUnionType
     trade_tick_from_exchange = 2, /// 交易所逐笔成交
     l2_snap_from_exchange    = 3, /// 交易所行情切片
     generated_l2_tick        = 4, /// 逐笔撮合行情
+    ranged_tick              = 5, /// 区间行情
 };
 
 static_assert(sizeof(ShmUnionType) == 4, "ShmUnionType should be 4 bytes");
@@ -187,6 +195,50 @@ struct TD_PUBLIC_API GeneratedL2Tick {
 
 static_assert(sizeof(GeneratedL2Tick) == 256, "L2Tick should be 256 bytes");
 
+/// @types::RangedTick without levels and weighted prices.
+struct TD_PUBLIC_API RangedTick {
+    ShmUnionType shm_union_type;
+
+    SymbolType symbol                        = {};
+    int64_t start_time                       = 0;
+    int64_t end_time                         = 0;
+
+    int64_t active_traded_sell_number        = 0;
+    int64_t active_sell_number               = 0;
+    int64_t active_sell_quantity             = 0;
+    int64_t active_sell_amount_1000x         = 0;
+    int64_t active_traded_buy_number         = 0;
+    int64_t active_buy_number                = 0;
+    int64_t active_buy_quantity              = 0;
+    int64_t active_buy_amount_1000x          = 0;
+
+    int64_t aggressive_sell_number           = 0;
+    int64_t aggressive_buy_number            = 0;
+
+    int64_t new_added_ask_1_quantity         = 0;
+    int64_t new_added_bid_1_quantity         = 0;
+    int64_t new_canceled_ask_1_quantity      = 0;
+    int64_t new_canceled_bid_1_quantity      = 0;
+    int64_t new_canceled_ask_all_quantity    = 0;
+    int64_t new_canceled_bid_all_quantity    = 0;
+
+    int64_t big_ask_amount_1000x             = 0;
+    int64_t big_bid_amount_1000x             = 0;
+
+    int64_t highest_price_1000x              = 0;
+    int64_t lowest_price_1000x               = 0;
+
+    int64_t ask_price_1_valid_duration_1000x = 0;
+    int64_t bid_price_1_valid_duration_1000x = 0;
+
+    int64_t exchange_time                    = 0;
+    int64_t local_system_time                = 0;
+
+    RESERVED(28)
+};
+
+static_assert(sizeof(RangedTick) == 256, "RangedTick should be 256 bytes");
+
 union TD_PUBLIC_API ShmUnion
 {
     OrderTick order_tick;
@@ -196,19 +248,200 @@ union TD_PUBLIC_API ShmUnion
 
 static_assert(sizeof(ShmUnion) == 256, "ShmUnion should be 256 bytes");
 
+/// Compact layout.
+/// Order/trade records fit in a cache line, times are HHMMSSmmm.
+
+/// @types::OrderTick.
+struct TD_PUBLIC_API CompactOrderTick {
+    ShmUnionType shm_union_type;
+    OrderType order_type      = OrderType::invalid_side;
+
+    int64_t unique_id         = 0;
+    SymbolType symbol         = {};
+    /// Side info stored in @order_type.
+    int64_t price_1000x       = 0;
+    int64_t quantity          = 0;
+
+    int32_t exchange_time     = 0;
+    int32_t local_system_time = 0;
+
+    RESERVED(8)
+};
+
+static_assert(sizeof(CompactOrderTick) == 64, "Compact tick should be 64 bytes");
+
+/// @types::TradeTick.
+struct TD_PUBLIC_API CompactTradeTick {
+    ShmUnionType shm_union_type;
+
+    int64_t ask_unique_id     = 0;
+    int64_t bid_unique_id     = 0;
+    SymbolType symbol         = {};
+    int64_t exec_price_1000x  = 0;
+    int64_t exec_quantity     = 0;
+
+    int32_t exchange_time     = 0;
+    int32_t local_system_time = 0;
+
+    RESERVED(4)
+};
+
+static_assert(sizeof(CompactTradeTick) == 64, "Compact tick should be 64 bytes");
+
+/// Levels are packed from level 1, i.e., asks[0] is sell 1 and bids[0] is buy 1.
+struct TD_PUBLIC_API CompactExchangeL2Snap {
+    ShmUnionType shm_union_type;
+
+    SymbolType symbol               = {};
+    int64_t price_1000x             = 0;
+
+    int64_t pre_settlement_1000x    = 0;
+    int64_t pre_close_price_1000x   = 0;
+    int64_t open_price_1000x        = 0;
+    int64_t highest_price_1000x     = 0;
+    int64_t lowest_price_1000x      = 0;
+    int64_t close_price_1000x       = 0;
+    int64_t settlement_price_1000x  = 0;
+    int64_t upper_limit_price_1000x = 0;
+    int64_t lower_limit_price_1000x = 0;
+
+    PriceQuantityPair asks[5];
+    PriceQuantityPair bids[5];
+
+    int32_t exchange_time     = 0;
+    int32_t local_system_time = 0;
+
+    RESERVED(4)
+};
+
+static_assert(sizeof(CompactExchangeL2Snap) == 192, "Compact L2 snap should be 192 bytes");
+
+/// Levels are packed from level 1, i.e., asks[0] is sell 1 and bids[0] is buy 1.
+struct TD_PUBLIC_API CompactGeneratedL2Tick {
+    ShmUnionType shm_union_type;
+
+    SymbolType symbol     = {};
+    int64_t price_1000x   = 0;
+    int64_t quantity      = 0;
+    int64_t ask_unique_id = 0;
+    int64_t bid_unique_id = 0;
+
+    PriceQuantityPair asks[5];
+    PriceQuantityPair bids[5];
+
+    int32_t exchange_time     = 0;
+    int32_t local_system_time = 0;
+
+    RESERVED(52)
+};
+
+static_assert(sizeof(CompactGeneratedL2Tick) == 192, "Compact L2 tick should be 192 bytes");
+
+struct TD_PUBLIC_API SMRegionInfo {
+    ShmUnionType record_type = ShmUnionType::invalid_shm_union;
+    uint32_t record_size     = 0;
+    /// Offset from the start of segment, where the mate info is.
+    uint64_t offset          = 0;
+    /// Size in bytes, including the mate info.
+    uint64_t size            = 0;
+};
+
+static_assert(sizeof(SMRegionInfo) == 24, "SMRegionInfo should be 24 bytes");
+
+/// Header at the start of segment in compact layout, which describes the
+/// regions of order ticks, trade ticks, exchange l2 snaps and generated l2
+/// ticks in order. Segments in legacy layout have no header.
+struct TD_PUBLIC_API SMSegmentHeader {
+    char magic[8]         = {'T', 'D', 'S', 'H', 'M', '\0', '\0', '\0'};
+    uint32_t version      = 2;
+    uint32_t header_size  = 0;
+    uint32_t region_count = 0;
+    uint32_t padding      = 0;
+    SMRegionInfo regions[4];
+    RESERVED(136)
+};
+
+static_assert(sizeof(SMSegmentHeader) == 256, "SMSegmentHeader should be 256 bytes");
+
 #pragma pack(pop)
 
+enum class ShmLayout
+{
+    /// 256-byte records, regions start at the beginning of segment.
+    legacy,
+    /// SMSegmentHeader, then 64-byte order/trade records and 192-byte l2
+    /// records.
+    compact,
+};
+
+enum class ShmPrefault
+{
+    /// Pages are faulted in by the first write to them.
+    none,
+    /// Pages are faulted in by a background thread, region heads first.
+    background,
+    /// Pages are faulted in before the constructor returns.
+    eager,
+};
+
+enum class ShmHugePage
+{
+    none,
+    /// Advise transparent huge pages, which takes effect if shmem_enabled of
+    /// the kernel is advise or always.
+    transparent,
+    /// Back the segment with a file on hugetlbfs instead of /dev/shm. Readers
+    /// map the file <huge page path>/<shm name>.
+    hugetlbfs,
+};
+
+class ShmLastValueCache;
+
 /// ShmReporter writes market data to shared memory.
+///
+/// The segment is made of regions of order ticks, trade ticks, exchange l2
+/// snaps and generated l2 ticks in order, after SMSegmentHeader in compact
+/// layout. Each region starts with its mate info, whose region_size tells
+/// where the next region starts. Records of the previous run are not cleared,
+/// readers must only read records below the count of mate info.
+///
+/// Readers should call check_layout() on the segment before reading records.
 class TD_PUBLIC_API ShmReporter final: private AppBase<>, public NopReporter
 {
 public:
+    /// @param region_sizes Sizes of regions in MB, shm_size GB is split into
+    /// equal quarters if all are 0.
     explicit ShmReporter(
         const std::string& shm_name               = "trade_data",
         const std::string& shm_mutex_name         = "trade_data_mutex",
         int shm_size                              = 1,
-        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>()
+        const std::shared_ptr<IReporter>& outside = std::make_shared<NopReporter>(),
+        const std::array<size_t, 4>& region_sizes = {},
+        ShmPrefault prefault                      = ShmPrefault::background,
+        ShmHugePage huge_page                     = ShmHugePage::none,
+        const std::string& huge_page_path         = "/dev/hugepages",
+        uint32_t last_value_cache_slots           = 0,
+        ShmLayout layout                          = ShmLayout::legacy
     );
-    ~ShmReporter() override = default;
+    ~ShmReporter() override;
+
+public:
+    /// Tell the layout of a mapped segment and check that it matches records
+    /// of this build.
+    /// @throw std::runtime_error if the segment is invalid.
+    static ShmLayout check_layout(const void* segment, size_t size);
+
+    struct SegmentSize {
+        size_t header_size  = 0;
+        size_t segment_size = 0;
+    };
+
+    /// Size of the segment holding regions of region_sizes bytes. With huge
+    /// pages, the header takes a whole huge page so that regions stay
+    /// aligned to it, and the segment is rounded up to a multiple of it as
+    /// hugetlbfs requires.
+    /// @param huge_page_size 0 if huge pages are not used.
+    static SegmentSize size_segment(const std::array<size_t, 4>& region_sizes, ShmLayout layout, size_t huge_page_size);
 
     /// Market data.
 public:
@@ -216,40 +449,66 @@ public:
     void exchange_trade_tick_arrived(std::shared_ptr<types::TradeTick> trade_tick) override;
     void exchange_l2_snap_arrived(std::shared_ptr<types::ExchangeL2Snap> exchange_l2_snap) override;
     void l2_tick_generated(std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick) override;
+    void ranged_tick_generated(std::shared_ptr<types::RangedTick> ranged_tick) override;
 
 private:
+    void do_ranged_tick_report(const std::shared_ptr<types::RangedTick>& ranged_tick);
     void do_exchange_order_tick_report(const std::shared_ptr<types::OrderTick>& order_tick);
     void do_exchange_trade_tick_report(const std::shared_ptr<types::TradeTick>& trade_tick);
     void do_exchange_l2_snap_report(const std::shared_ptr<types::ExchangeL2Snap>& exchange_l2_snap);
     void do_generated_l2_tick_report(const std::shared_ptr<types::GeneratedL2Tick>& generated_l2_tick);
 
 private:
-    /// Return the start memory address of trade area.
-    boost::interprocess::offset_t trade_offset();
+    /// Records of a region, in either layout.
+    struct RegionCursor {
+        u_char* start   = nullptr;
+        u_char* current = nullptr;
+        u_char* end     = nullptr;
+    };
+
+    /// @return Record to write, from the start of region again if full.
+    template<typename Record>
+    Record& next(RegionCursor& cursor);
+
+private:
+    /// @return 0 if huge pages are not used.
+    static size_t huge_page_size(ShmHugePage huge_page, const std::string& huge_page_path);
+    void map_segment(const std::string& shm_name, size_t size, ShmHugePage huge_page, const std::string& huge_page_path);
+    /// Fault in pages of all regions chunk by chunk, so that heads of regions
+    /// which are written first are ready first.
+    void prefault();
+    static void prefault(u_char* address, size_t size);
 
 private:
-    boost::interprocess::shared_memory_object m_shm;
+    std::unique_ptr<boost::interprocess::shared_memory_object> m_shm;
+    std::unique_ptr<boost::interprocess::file_mapping> m_huge_page_file;
     boost::interprocess::named_upgradable_mutex m_named_mutex;
-    std::shared_ptr<boost::interprocess::mapped_region> m_order_tick_region;
-    std::shared_ptr<boost::interprocess::mapped_region> m_trade_tick_region;
-    std::shared_ptr<boost::interprocess::mapped_region> m_exchange_l2_snap_region;
-    std::shared_ptr<boost::interprocess::mapped_region> m_generated_l2_tick_region;
+    std::unique_ptr<boost::interprocess::mapped_region> m_segment;
+    /// Order tick, trade tick, exchange l2 snap and generated l2 tick.
+    std::array<size_t, 4> m_region_sizes;
+    std::array<u_char*, 4> m_region_addresses;
     SMTickMateInfo* m_order_tick_mate_info;
     SMTickMateInfo* m_trade_tick_mate_info;
     SMExchangeL2SnapMateInfo* m_exchange_l2_snap_mate_info;
     SMGeneratedL2TickMateInfo* m_generated_l2_tick_mate_info;
-    /// Store the start/current memory address of tick area.
-    OrderTick* m_order_tick_start;
-    OrderTick* m_order_tick_current;
-    TradeTick* m_trade_tick_start;
-    TradeTick* m_trade_tick_current;
-    ExchangeL2Snap* m_exchange_l2_snap_start;
-    ExchangeL2Snap* m_exchange_l2_snap_current;
-    GeneratedL2Tick* m_generated_l2_tick_start;
-    GeneratedL2Tick* m_generated_l2_tick_current;
+    /// Order tick, trade tick, exchange l2 snap and generated l2 tick.
+    std::array<RegionCursor, 4> m_cursors;
+    ShmLayout m_layout;
+
+private:
+    /// Nullptr if disabled.
+    std::unique_ptr<ShmLastValueCache> m_last_value_cache;
+
+private:
+    std::atomic<bool> m_is_prefaulting = false;
+    std::thread m_prefault_thread;
 
 private:
     static constexpr boost::interprocess::offset_t GB = 1024 * 1024 * 1024;
+    static constexpr size_t MB                        = 1024 * 1024;
+    /// Header takes a page so that regions stay page aligned, or a huge page
+    /// if huge pages are used.
+    static constexpr size_t header_region_size        = 4096;
 
 private:
     std::shared_ptr<IReporter> m_outside;
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include "IReporter.hpp"
+
+namespace trade::reporter
+{
+
+/// Reporters composed at compile time, for deployments with a fixed set of
+/// sinks.
+///
+/// A sink is any type with some of the IReporter methods, called directly so
+/// that they can be inlined. Methods a sink does not have are skipped, and
+/// batch methods fall back to the per-event ones. A sink may also be held by
+/// pointer, e.g. std::shared_ptr<ShmReporter>, mark its class final to avoid
+/// virtual calls.
+///
+/// The pipeline itself is an IReporter, so the only virtual call left is the
+/// one from the producer, e.g. Booker, into the pipeline.
+template<typename... Sinks>
+class StaticPipeline final: public IReporter
+{
+public:
+    StaticPipeline() = default;
+    explicit StaticPipeline(Sinks... sinks) : m_sinks(std::move(sinks)...) {}
+    ~StaticPipeline() override = default;
+
+public:
+    template<size_t I>
+    [[nodiscard]] auto& sink() { return deref(std::get<I>(m_sinks)); }
+
+    /// Order.
+public:
+    void broker_accepted(const std::shared_ptr<types::BrokerAcceptance> broker_acceptance) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.broker_accepted(broker_acceptance); }) sink.broker_accepted(broker_acceptance); });
+    }
+    void exchange_accepted(const std::shared_ptr<types::ExchangeAcceptance> exchange_acceptance) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.exchange_accepted(exchange_acceptance); }) sink.exchange_accepted(exchange_acceptance); });
+    }
+    void order_rejected(const std::shared_ptr<types::OrderRejection> order_rejection) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.order_rejected(order_rejection); }) sink.order_rejected(order_rejection); });
+    }
+
+    /// Cancel.
+public:
+    void cancel_broker_accepted(const std::shared_ptr<types::CancelBrokerAcceptance> cancel_broker_acceptance) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.cancel_broker_accepted(cancel_broker_acceptance); }) sink.cancel_broker_accepted(cancel_broker_acceptance); });
+    }
+    void cancel_exchange_accepted(const std::shared_ptr<types::CancelExchangeAcceptance> cancel_exchange_acceptance) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.cancel_exchange_accepted(cancel_exchange_acceptance); }) sink.cancel_exchange_accepted(cancel_exchange_acceptance); });
+    }
+    void cancel_success(const std::shared_ptr<types::CancelSuccess> cancel_success) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.cancel_success(cancel_success); }) sink.cancel_success(cancel_success); });
+    }
+    void cancel_order_rejected(const std::shared_ptr<types::CancelOrderRejection> cancel_order_rejection) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.cancel_order_rejected(cancel_order_rejection); }) sink.cancel_order_rejected(cancel_order_rejection); });
+    }
+
+    /// Trade.
+public:
+    void trade_accepted(const std::shared_ptr<types::Trade> trade) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.trade_accepted(trade); }) sink.trade_accepted(trade); });
+    }
+
+    /// Market data.
+public:
+    void exchange_order_tick_arrived(const std::shared_ptr<types::OrderTick> order_tick) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.exchange_order_tick_arrived(order_tick); }) sink.exchange_order_tick_arrived(order_tick); });
+    }
+    void exchange_trade_tick_arrived(const std::shared_ptr<types::TradeTick> trade_tick) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.exchange_trade_tick_arrived(trade_tick); }) sink.exchange_trade_tick_arrived(trade_tick); });
+    }
+    void exchange_l2_snap_arrived(const std::shared_ptr<types::ExchangeL2Snap> exchange_l2_snap) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.exchange_l2_snap_arrived(exchange_l2_snap); }) sink.exchange_l2_snap_arrived(exchange_l2_snap); });
+    }
+    void l2_tick_generated(const std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.l2_tick_generated(generated_l2_tick); }) sink.l2_tick_generated(generated_l2_tick); });
+    }
+    void ranged_tick_generated(const std::shared_ptr<types::RangedTick> ranged_tick) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.ranged_tick_generated(ranged_tick); }) sink.ranged_tick_generated(ranged_tick); });
+    }
+    void md_seq_gap_detected(const std::shared_ptr<types::SeqGap> seq_gap) override
+    {
+        each([&](auto& sink) { if constexpr (requires { sink.md_seq_gap_detected(seq_gap); }) sink.md_seq_gap_detected(seq_gap); });
+    }
+
+    /// Market data in batch.
+public:
+    void exchange_order_ticks_arrived(const std::span<const std::shared_ptr<types::OrderTick>> order_ticks) override
+    {
+        each([&](auto& sink) {
+            if constexpr (requires { sink.exchange_order_ticks_arrived(order_ticks); })
+                sink.exchange_order_ticks_arrived(order_ticks);
+            else if constexpr (requires { sink.exchange_order_tick_arrived(order_ticks.front()); })
+                for (const auto& order_tick : order_ticks) sink.exchange_order_tick_arrived(order_tick);
+        });
+    }
+    void exchange_trade_ticks_arrived(const std::span<const std::shared_ptr<types::TradeTick>> trade_ticks) override
+    {
+        each([&](auto& sink) {
+            if constexpr (requires { sink.exchange_trade_ticks_arrived(trade_ticks); })
+                sink.exchange_trade_ticks_arrived(trade_ticks);
+            else if constexpr (requires { sink.exchange_trade_tick_arrived(trade_ticks.front()); })
+                for (const auto& trade_tick : trade_ticks) sink.exchange_trade_tick_arrived(trade_tick);
+        });
+    }
+    void exchange_l2_snaps_arrived(const std::span<const std::shared_ptr<types::ExchangeL2Snap>> exchange_l2_snaps) override
+    {
+        each([&](auto& sink) {
+            if constexpr (requires { sink.exchange_l2_snaps_arrived(exchange_l2_snaps); })
+                sink.exchange_l2_snaps_arrived(exchange_l2_snaps);
+            else if constexpr (requires { sink.exchange_l2_snap_arrived(exchange_l2_snaps.front()); })
+                for (const auto& exchange_l2_snap : exchange_l2_snaps) sink.exchange_l2_snap_arrived(exchange_l2_snap);
+        });
+    }
+    void l2_ticks_generated(const std::span<const std::shared_ptr<types::GeneratedL2Tick>> generated_l2_ticks) override
+    {
+        each([&](auto& sink) {
+            if constexpr (requires { sink.l2_ticks_generated(generated_l2_ticks); })
+                sink.l2_ticks_generated(generated_l2_ticks);
+            else if constexpr (requires { sink.l2_tick_generated(generated_l2_ticks.front()); })
+                for (const auto& generated_l2_tick : generated_l2_ticks) sink.l2_tick_generated(generated_l2_tick);
+        });
+    }
+    void ranged_ticks_generated(const std::span<const std::shared_ptr<types::RangedTick>> ranged_ticks) override
+    {
+        each([&](auto& sink) {
+            if constexpr (requires { sink.ranged_ticks_generated(ranged_ticks); })
+                sink.ranged_ticks_generated(ranged_ticks);
+            else if constexpr (requires { sink.ranged_tick_generated(ranged_ticks.front()); })
+                for (const auto& ranged_tick : ranged_ticks) sink.ranged_tick_generated(ranged_tick);
+        });
+    }
+
+private:
+    template<typename T>
+    static auto& deref(T& sink)
+    {
+        if constexpr (requires { *sink; })
+            return *sink;
+        else
+            return sink;
+    }
+
+    /// Calls sinks in the order of template arguments.
+    template<typename F>
+    void each(F&& f)
+    {
+        std::apply([&f](auto&... sinks) { (f(deref(sinks)), ...); }, m_sinks);
+    }
+
+private:
+    std::tuple<Sinks...> m_sinks;
+};
+
+} // namespace trade::reporter
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace trade::utilities
+{
+
+/// Encodes integer columns as zigzag varints of deltas, so that slowly
+/// changing values like prices and times take one or two bytes per row, and
+/// floating point columns (as bit patterns) as varints of XOR with previous
+/// value, so that repeated values take one byte per row.
+class ColumnCodec
+{
+public:
+    static void encode_delta(const std::span<const int64_t> column, std::string& out)
+    {
+        uint64_t previous = 0;
+
+        for (const auto value : column) {
+            put_varint(zigzag(static_cast<int64_t>(static_cast<uint64_t>(value) - previous)), out);
+            previous = static_cast<uint64_t>(value);
+        }
+    }
+
+    /// @return false if in is not rows encoded values.
+    static bool decode_delta(const std::string_view in, const size_t rows, std::vector<int64_t>& column)
+    {
+        const char* it    = in.data();
+        const char* end   = in.data() + in.size();
+        uint64_t previous = 0;
+
+        column.reserve(column.size() + rows);
+
+        for (size_t row = 0; row < rows; row++) {
+            uint64_t value;
+
+            if (!get_varint(it, end, value)) [[unlikely]]
+                return false;
+
+            previous += static_cast<uint64_t>(unzigzag(value));
+            column.push_back(static_cast<int64_t>(previous));
+        }
+
+        return it == end;
+    }
+
+    static void encode_xor(const std::span<const int64_t> column, std::string& out)
+    {
+        uint64_t previous = 0;
+
+        for (const auto value : column) {
+            put_varint(static_cast<uint64_t>(value) ^ previous, out);
+            previous = static_cast<uint64_t>(value);
+        }
+    }
+
+    /// @return false if in is not rows encoded values.
+    static bool decode_xor(const std::string_view in, const size_t rows, std::vector<int64_t>& column)
+    {
+        const char* it    = in.data();
+        const char* end   = in.data() + in.size();
+        uint64_t previous = 0;
+
+        column.reserve(column.size() + rows);
+
+        for (size_t row = 0; row < rows; row++) {
+            uint64_t value;
+
+            if (!get_varint(it, end, value)) [[unlikely]]
+                return false;
+
+            previous ^= value;
+            column.push_back(static_cast<int64_t>(previous));
+        }
+
+        return it == end;
+    }
+
+public:
+    static void put_varint(uint64_t value, std::string& out)
+    {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<char>(value));
+    }
+
+    /// @return false if the varint is truncated or longer than 10 bytes.
+    static bool get_varint(const char*& it, const char* end, uint64_t& value)
+    {
+        value = 0;
+
+        for (int shift = 0; shift < 64 && it != end; shift += 7) {
+            const auto byte = static_cast<uint8_t>(*it++);
+
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+
+            if ((byte & 0x80) == 0) [[likely]]
+                return true;
+        }
+
+        return false;
+    }
+
+    static uint64_t zigzag(const int64_t value)
+    {
+        return static_cast<uint64_t>(value) << 1 ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    static int64_t unzigzag(const uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+};
+
+} // namespace trade::utilities
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+namespace trade::utilities
+{
+
+/// Parses fixed-width ASCII decimal fields (up to 8 digits), e.g. the
+/// six-digit symbols in raw market data, 8 bytes at a time (SWAR) without
+/// branching on every digit.
+template<size_t Width>
+class DigitParser
+{
+    static_assert(Width > 0 && Width <= 8, "DigitParser supports 1 to 8 digits");
+    static_assert(std::endian::native == std::endian::little, "DigitParser requires little-endian system");
+
+public:
+    /// @return Parsed value, -1 if any of the first Width bytes is not a
+    /// digit.
+    int64_t operator()(const char* field) const
+    {
+        uint64_t chunk;
+
+        if constexpr (Width == 8) {
+            std::memcpy(&chunk, field, 8);
+        }
+        else {
+            /// Left-pad with '0' to 8 digits, the first character goes to the
+            /// lowest byte.
+            uint64_t digits = 0;
+            std::memcpy(&digits, field, Width);
+            chunk = digits << (8 - Width) * 8 | zeros >> Width * 8;
+        }
+
+        if (!all_digits(chunk)) [[unlikely]]
+            return -1;
+
+        chunk -= zeros;
+        chunk  = chunk * 10 + (chunk >> 8) & 0x00FF00FF00FF00FF;
+        chunk  = chunk * 100 + (chunk >> 16) & 0x0000FFFF0000FFFF;
+        chunk  = chunk * 10000 + (chunk >> 32) & 0x00000000FFFFFFFF;
+
+        return static_cast<int64_t>(chunk);
+    }
+
+    int64_t operator()(const unsigned char* field) const
+    {
+        return operator()(reinterpret_cast<const char*>(field));
+    }
+
+    /// @return true if the byte right after the field is not a digit, which
+    /// means the field is not a prefix of a longer number.
+    static bool terminated(const char* field)
+    {
+        return field[Width] < '0' || field[Width] > '9';
+    }
+
+private:
+    static bool all_digits(const uint64_t chunk)
+    {
+        /// High nibbles of '0'-'9' are 3, and adding 6 to low nibbles does
+        /// not carry into high nibbles.
+        return ((chunk & 0xF0F0F0F0F0F0F0F0) | ((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4) == 0x3333333333333333;
+    }
+
+private:
+    static constexpr uint64_t zeros = 0x3030303030303030;
+};
+
+} // namespace trade::utilities
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <vector>
+
+#include "SeqGapDetector.hpp"
+
+namespace trade::utilities
+{
+
+/// Arbitrates identical feeds published on redundant lines (A/B) by
+/// per-channel sequence, keeping only the first arrival of each sequence.
+template<typename KeyType, size_t WindowSize = 4096>
+class FeedArbitrator
+{
+public:
+    struct LineStats {
+        uint64_t received  = 0;
+        /// Arrived first and forwarded.
+        uint64_t wins      = 0;
+        /// Arrived after the same sequence from any line.
+        uint64_t losses    = 0;
+        /// Too old to tell, dropped.
+        uint64_t stales    = 0;
+        /// Lag behind the winner, summed up over losses.
+        int64_t total_lag  = 0;
+        int64_t max_lag    = 0;
+    };
+
+public:
+    explicit FeedArbitrator(const size_t line_size) : m_lines(line_size) {}
+    ~FeedArbitrator() = default;
+
+public:
+    /// @param arrival Arrival time of the message, in any unit, to measure
+    /// lag between lines.
+    /// @return true if this is the first arrival of the sequence.
+    bool arbitrate(const size_t line, const KeyType& channel, const uint64_t seq, const int64_t arrival)
+    {
+        auto& stats = m_lines[line];
+        auto& state = m_channels[channel];
+
+        stats.received++;
+
+        uint64_t missing;
+
+        switch (state.detector.check(seq, missing)) {
+        case SeqGapResult::in_order:
+        case SeqGapResult::gap:
+        case SeqGapResult::reorder:
+        case SeqGapResult::reset: {
+            state.arrivals[seq % WindowSize] = arrival;
+            stats.wins++;
+            return true;
+        }
+        case SeqGapResult::duplicate: {
+            const auto lag   = arrival - state.arrivals[seq % WindowSize];
+            stats.total_lag += lag;
+            stats.max_lag    = std::max(stats.max_lag, lag);
+            stats.losses++;
+            return false;
+        }
+        case SeqGapResult::stale: {
+            stats.stales++;
+            return false;
+        }
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] size_t line_size() const { return m_lines.size(); }
+    [[nodiscard]] const LineStats& stats(const size_t line) const { return m_lines[line]; }
+
+    /// Ratio of sequences first delivered by this line.
+    [[nodiscard]] double win_rate(const size_t line) const
+    {
+        uint64_t forwarded = 0;
+
+        for (const auto& stats : m_lines)
+            forwarded += stats.wins;
+
+        return forwarded == 0 ? 0. : static_cast<double>(m_lines[line].wins) / static_cast<double>(forwarded);
+    }
+
+    /// Average lag behind the winner when losing.
+    [[nodiscard]] double average_lag(const size_t line) const
+    {
+        const auto& stats = m_lines[line];
+        return stats.losses == 0 ? 0. : static_cast<double>(stats.total_lag) / static_cast<double>(stats.losses);
+    }
+
+private:
+    struct ChannelState {
+        SeqGapDetector<WindowSize> detector;
+        std::array<int64_t, WindowSize> arrivals {};
+    };
+
+    std::vector<LineStats> m_lines;
+    std::map<KeyType, ChannelState> m_channels;
+};
+
+} // namespace trade::utilities
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace trade::utilities
+{
+
+/// Runs tasks on a pool of threads. Tasks of the same key run one at a time
+/// in the order posted, tasks of different keys run in parallel, so that a
+/// slow task only holds up later tasks of its own key.
+///
+/// A task is called with the index of the thread running it, for resources
+/// owned by each thread.
+template<typename Key>
+class KeyedExecutor
+{
+public:
+    using Task = std::function<void(size_t)>;
+
+    explicit KeyedExecutor(const size_t threads)
+    {
+        m_threads.reserve(std::max<size_t>(threads, 1));
+
+        for (size_t index = 0; index < std::max<size_t>(threads, 1); index++)
+            m_threads.emplace_back(&KeyedExecutor::work, this, index);
+    }
+
+    ~KeyedExecutor() { stop(); }
+
+    KeyedExecutor(const KeyedExecutor&)            = delete;
+    KeyedExecutor& operator=(const KeyedExecutor&) = delete;
+
+public:
+    /// Tasks already posted are run before threads exit, no task may be
+    /// posted after.
+    void stop()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_is_stopping = true;
+        }
+
+        m_cv.notify_all();
+
+        for (auto& thread : m_threads)
+            thread.joinable() ? thread.join() : void();
+    }
+
+    /// Task must not throw.
+    void post(const Key& key, Task task)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+
+            /// A key is in strands while it is ready or running, a key
+            /// posted for the first time is ready at once.
+            const auto [it, is_new] = m_strands.try_emplace(key);
+            it->second.push_back(std::move(task));
+
+            is_new ? m_ready.push_back(key) : void();
+
+            m_pending++;
+            m_max_pending = std::max(m_max_pending, m_pending);
+        }
+
+        m_cv.notify_one();
+    }
+
+    [[nodiscard]] size_t size() const { return m_threads.size(); }
+
+    /// Tasks posted but not finished at most.
+    [[nodiscard]] size_t max_pending() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_max_pending;
+    }
+
+private:
+    void work(const size_t index)
+    {
+        while (true) {
+            Key key;
+            Task task;
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait(lock, [this] { return !m_ready.empty() || m_is_stopping; });
+
+                if (m_ready.empty())
+                    return;
+
+                key = std::move(m_ready.front());
+                m_ready.pop_front();
+
+                task = std::move(m_strands[key].front());
+                m_strands[key].pop_front();
+            }
+
+            task(index);
+
+            bool is_ready = false;
+
+            {
+                std::lock_guard lock(m_mutex);
+
+                m_pending--;
+
+                /// Requeued behind other keys, so that a busy key does not
+                /// starve them.
+                const auto it = m_strands.find(key);
+                it->second.empty() ? void(m_strands.erase(it)) : m_ready.push_back(std::move(key));
+                is_ready = !m_ready.empty();
+            }
+
+            is_ready ? m_cv.notify_one() : void();
+        }
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    /// Key -> Tasks not started yet.
+    std::unordered_map<Key, std::deque<Task>> m_strands;
+    /// Keys with tasks to run and none running.
+    std::deque<Key> m_ready;
+    size_t m_pending     = 0;
+    size_t m_max_pending = 0;
+    bool m_is_stopping   = false;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace trade::utilities
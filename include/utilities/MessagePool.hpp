@@ -0,0 +1,186 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <boost/lockfree/queue.hpp>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace trade::utilities
+{
+
+/// Recycles protobuf messages instead of allocating one per event.
+///
+/// The pool belongs to the thread creating it, where acquire() must be
+/// called. Messages handed out are cleared and returned to the pool when the
+/// last std::shared_ptr is dropped. Messages dropped on the owner thread go
+/// back to the free list directly, those dropped on other threads, e.g.
+/// reporter threads, go through a lock-free queue that the owner drains when
+/// the free list runs out, so that they never contend with the owner.
+///
+/// A message is pooled together with the control block of its
+/// std::shared_ptr, so that neither is allocated per message. The pool
+/// outlives its handle until all messages are returned.
+template<typename T>
+class MessagePool final
+{
+public:
+    static constexpr size_t default_capacity     = 64 * 1024;
+    static constexpr size_t default_preallocated = 1024;
+
+public:
+    /// Messages more than capacity are freed when returned.
+    explicit MessagePool(const size_t capacity = default_capacity, const size_t preallocated = 0)
+        : m_core(new Core(capacity, preallocated))
+    {
+    }
+
+    ~MessagePool() { m_core->close(); }
+
+    MessagePool(const MessagePool&)            = delete;
+    MessagePool& operator=(const MessagePool&) = delete;
+
+public:
+    /// Pool of the calling thread.
+    static const std::shared_ptr<MessagePool>& local()
+    {
+        thread_local const auto pool = std::make_shared<MessagePool>(default_capacity, default_preallocated);
+        return pool;
+    }
+
+    /// Must be called on the owner thread.
+    [[nodiscard]] std::shared_ptr<T> acquire() { return m_core->acquire(); }
+
+    /// Messages ready on the owner thread, not counting those in the queue.
+    [[nodiscard]] size_t available() const { return m_core->free.size(); }
+
+private:
+    /// Room for the control block made by std::allocate_shared, checked when
+    /// it is allocated.
+    static constexpr size_t control_size = 64;
+
+    struct Entry {
+        T message;
+        alignas(std::max_align_t) std::byte control[control_size];
+    };
+
+    /// Owned by the control block, nothing but a lifetime.
+    struct Lease {
+    };
+
+    struct Core;
+
+    /// Hands out the control block room of one entry and returns the entry
+    /// when the control block is freed.
+    template<typename U>
+    struct Allocator {
+        using value_type = U;
+
+        Core* core;
+        Entry* entry;
+
+        Allocator(Core* core, Entry* entry) : core(core), entry(entry) {}
+
+        template<typename V>
+        Allocator(const Allocator<V>& other) : core(other.core), entry(other.entry) {}
+
+        U* allocate([[maybe_unused]] const size_t n)
+        {
+            static_assert(sizeof(U) <= control_size && alignof(U) <= alignof(std::max_align_t), "Control block does not fit in entry");
+
+            return reinterpret_cast<U*>(entry->control);
+        }
+
+        void deallocate(U*, size_t) { core->release(entry); }
+
+        template<typename V>
+        bool operator==(const Allocator<V>& other) const { return entry == other.entry; }
+    };
+
+    struct Core {
+        Core(const size_t capacity, const size_t preallocated)
+            : capacity(capacity),
+              owner(std::this_thread::get_id()),
+              returned(capacity)
+        {
+            free.reserve(capacity);
+
+            for (size_t i = 0; i < std::min(preallocated, capacity); i++)
+                free.push_back(new Entry);
+        }
+
+        ~Core()
+        {
+            for (const auto entry : free)
+                delete entry;
+
+            returned.consume_all([](const Entry* entry) { delete entry; });
+        }
+
+        std::shared_ptr<T> acquire()
+        {
+            if (free.empty()) [[unlikely]]
+                returned.consume_all([this](Entry* entry) { free.push_back(entry); });
+
+            Entry* entry;
+
+            if (free.empty()) [[unlikely]] {
+                entry = new Entry;
+            }
+            else {
+                entry = free.back();
+                free.pop_back();
+            }
+
+            leased++;
+
+            return std::shared_ptr<T>(std::allocate_shared<Lease>(Allocator<Lease>(this, entry)), &entry->message);
+        }
+
+        void release(Entry* entry)
+        {
+            entry->message.Clear();
+
+            if (std::this_thread::get_id() == owner && !is_closed) {
+                leased--;
+                free.size() < capacity ? free.push_back(entry) : delete entry;
+
+                return;
+            }
+
+            returned.bounded_push(entry) ? void() : delete entry;
+
+            /// Last access to the core, see close().
+            if (returns.fetch_add(1, std::memory_order_acq_rel) + 1 == 0) [[unlikely]]
+                delete this;
+        }
+
+        /// Returns counted after this reach 0 when all leased messages are
+        /// back, by whichever thread returns the last one.
+        void close()
+        {
+            is_closed = true;
+
+            if (returns.fetch_sub(leased, std::memory_order_acq_rel) == leased)
+                delete this;
+        }
+
+        const size_t capacity;
+        const std::thread::id owner;
+        /// Only accessed by the owner thread.
+        std::vector<Entry*> free;
+        /// Handed out and not returned on the owner thread.
+        int64_t leased = 0;
+        bool is_closed = false;
+        /// Returned by other threads, or by any thread once closed.
+        boost::lockfree::queue<Entry*> returned;
+        std::atomic<int64_t> returns = 0;
+    };
+
+private:
+    Core* const m_core;
+};
+
+} // namespace trade::utilities
@@ -1,9 +1,19 @@
 #pragma once
 
 #include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <fcntl.h>
 #include <fmt/format.h>
+#include <functional>
+#include <future>
 #include <google/protobuf/message.h>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_map>
 #include <zmq.h>
 
 #include "networks.pb.h"
@@ -67,6 +77,22 @@ public:
         return std::make_tuple(message_id, message_buffer.begin() + HEAD_SIZE<>);
     }
 
+    /// Unserialize a message in place, e.g., in a ZeroMQ frame.
+    /// @return The message ID and the start of raw message body, whose size
+    /// is size - HEAD_SIZE. The message ID will be 0 if the message is invalid.
+    static auto deserialize(const u_char* message, const size_t size)
+    {
+        if (size < 4)
+            return std::make_tuple(types::MessageID::invalid_message_id, message + size);
+
+        const auto message_id = static_cast<types::MessageID>(parse_int32(message));
+
+        if (message_id < types::MessageID_MIN || message_id > types::MessageID_MAX) [[unlikely]]
+            return std::make_tuple(types::MessageID::invalid_message_id, message + HEAD_SIZE<>);
+
+        return std::make_tuple(message_id, message + HEAD_SIZE<>);
+    }
+
 public:
     template<typename T = int>
     constexpr static T HEAD_SIZE = T(4);
@@ -259,6 +285,645 @@ private:
     std::vector<u_char> m_message_buffer;
 };
 
+/// Sends replies of AsyncRRServer from threads other than its I/O thread.
+///
+/// Each thread needs its own replier, since ZeroMQ sockets are not thread
+/// safe.
+class AsyncRRReplier
+{
+public:
+    AsyncRRReplier(const std::string& address, const ZMQContextPtr& context) : m_zmq_context(context)
+    {
+        m_zmq_socket.reset(zmq_socket(m_zmq_context.get(), ZMQ_PUSH));
+
+        constexpr int linger_ms = 0;
+        zmq_setsockopt(m_zmq_socket.get(), ZMQ_LINGER, &linger_ms, sizeof(linger_ms));
+
+        const auto code = zmq_connect(m_zmq_socket.get(), address.c_str());
+
+        if (code != 0) {
+            throw std::runtime_error(fmt::format("Failed to connect ZMQ socket to {}: {}", address, std::string(zmq_strerror(errno))));
+        }
+    }
+
+public:
+    void send(const uint64_t correlation_id, const types::MessageID message_id, const google::protobuf::Message& message_body)
+    {
+        Serializer::serialize(message_id, message_body, m_message_buffer);
+
+        zmq_send(m_zmq_socket.get(), &correlation_id, sizeof(correlation_id), ZMQ_SNDMORE);
+        zmq_send(m_zmq_socket.get(), m_message_buffer.data(), m_message_buffer.size(), 0);
+    }
+
+private:
+    ZMQContextPtr m_zmq_context;
+    ZMQSocketPtr m_zmq_socket;
+
+private:
+    std::vector<u_char> m_message_buffer;
+};
+
+struct AsyncRRServerMetrics {
+    size_t requests         = 0;
+    size_t replies          = 0;
+    /// Requests received but not replied yet.
+    size_t in_flight        = 0;
+    size_t max_in_flight    = 0;
+    /// From receiving a request to sending its reply.
+    int64_t total_latency_ns = 0;
+    int64_t max_latency_ns   = 0;
+};
+
+/// Encapsulate a ZeroMQ ROUTER socket for creating a request-reply server that
+/// replies asynchronously.
+///
+/// Unlike RRServer, requests are not answered in lockstep. The I/O thread
+/// calling poll() receives requests of all clients and tags each with a
+/// correlation id, whose reply can be sent later in any order, either by
+/// send() on the I/O thread or by an AsyncRRReplier on other threads. Routing
+/// frames of the request, i.e., identity of peer, the empty delimiter of REQ
+/// clients and the request id of DEALER clients, are kept on the I/O thread
+/// and sent back with the reply, so that both REQ and DEALER clients work.
+class AsyncRRServer
+{
+public:
+    explicit AsyncRRServer(
+        const std::string& address,
+        const ZMQContextPtr& context = nullptr,
+        const int timeout_ms         = 100
+    )
+        : m_timeout_ms(timeout_ms),
+          m_replies_address(fmt::format("inproc://async_rr_server_replies_{}", static_cast<void*>(this)))
+    {
+        if (context != nullptr)
+            m_zmq_context = context;
+        else
+            m_zmq_context.reset(zmq_ctx_new(), ZMQContextPtrDeleter());
+
+        m_zmq_socket.reset(zmq_socket(m_zmq_context.get(), ZMQ_ROUTER));
+
+        auto code = zmq_bind(m_zmq_socket.get(), address.c_str());
+
+        if (code != 0) {
+            throw std::runtime_error(fmt::format("Failed to bind ZMQ socket at {}: {}", address, std::string(zmq_strerror(errno))));
+        }
+
+        m_zmq_replies.reset(zmq_socket(m_zmq_context.get(), ZMQ_PULL));
+
+        code = zmq_bind(m_zmq_replies.get(), m_replies_address.c_str());
+
+        if (code != 0) {
+            throw std::runtime_error(fmt::format("Failed to bind ZMQ socket at {}: {}", m_replies_address, std::string(zmq_strerror(errno))));
+        }
+    }
+
+public:
+    /// Wait up to timeout for requests or replies, forward ready replies to
+    /// clients, then call handler(correlation_id, message_id, body, body_size)
+    /// for each request received. The body is only valid during the call.
+    template<typename Handler>
+    void poll(Handler&& handler)
+    {
+        zmq_pollitem_t items[] = {
+            {m_zmq_socket.get(), 0, ZMQ_POLLIN, 0},
+            {m_zmq_replies.get(), 0, ZMQ_POLLIN, 0},
+        };
+
+        if (zmq_poll(items, 2, m_timeout_ms) <= 0)
+            return;
+
+        (items[1].revents & ZMQ_POLLIN) ? flush() : void();
+
+        if ((items[0].revents & ZMQ_POLLIN) == 0)
+            return;
+
+        /// Bounded so that replies are not starved by a flood of requests.
+        for (size_t i = 0; i < max_requests_per_poll; i++) {
+            if (!receive(handler))
+                break;
+        }
+    }
+
+    /// Send reply of a request on the I/O thread.
+    void send(const uint64_t correlation_id, const types::MessageID message_id, const google::protobuf::Message& message_body)
+    {
+        Serializer::serialize(message_id, message_body, m_message_buffer);
+        forward(correlation_id, m_message_buffer.data(), m_message_buffer.size());
+    }
+
+    /// Forward replies sent by repliers without waiting.
+    void flush()
+    {
+        zmq_msg_t correlation_frame, body_frame;
+
+        while (true) {
+            zmq_msg_init(&correlation_frame);
+
+            if (zmq_msg_recv(&correlation_frame, m_zmq_replies.get(), ZMQ_DONTWAIT) < 0) {
+                zmq_msg_close(&correlation_frame);
+                return;
+            }
+
+            uint64_t correlation_id = 0;
+            std::memcpy(&correlation_id, zmq_msg_data(&correlation_frame), std::min(sizeof(correlation_id), zmq_msg_size(&correlation_frame)));
+            zmq_msg_close(&correlation_frame);
+
+            /// Parts of a multipart message arrive together.
+            zmq_msg_init(&body_frame);
+            zmq_msg_recv(&body_frame, m_zmq_replies.get(), 0);
+            forward(correlation_id, static_cast<const u_char*>(zmq_msg_data(&body_frame)), zmq_msg_size(&body_frame));
+            zmq_msg_close(&body_frame);
+        }
+    }
+
+    /// Replier for other threads.
+    [[nodiscard]] AsyncRRReplier replier() const
+    {
+        return AsyncRRReplier(m_replies_address, m_zmq_context);
+    }
+
+    [[nodiscard]] const AsyncRRServerMetrics& metrics() const
+    {
+        return m_metrics;
+    }
+
+    /// Identity of the client sent a request not replied yet, i.e., its first
+    /// routing frame, empty if not found.
+    [[nodiscard]] std::string_view peer(const uint64_t correlation_id) const
+    {
+        const auto it = m_pending.find(correlation_id);
+        return it == m_pending.end() || it->second.envelope.empty() ? std::string_view() : std::string_view(it->second.envelope.front());
+    }
+
+private:
+    struct Pending {
+        std::vector<std::string> envelope;
+        std::chrono::steady_clock::time_point received_time;
+    };
+
+    template<typename Handler>
+    bool receive(Handler& handler)
+    {
+        std::vector<std::string> envelope;
+        zmq_msg_t frame;
+
+        /// Frames before the last one are routing frames.
+        while (true) {
+            zmq_msg_init(&frame);
+
+            if (zmq_msg_recv(&frame, m_zmq_socket.get(), ZMQ_DONTWAIT) < 0) {
+                zmq_msg_close(&frame);
+                return false;
+            }
+
+            if (!zmq_msg_more(&frame))
+                break;
+
+            envelope.emplace_back(static_cast<const char*>(zmq_msg_data(&frame)), zmq_msg_size(&frame));
+            zmq_msg_close(&frame);
+        }
+
+        const auto correlation_id = ++m_last_correlation_id;
+
+        m_pending.emplace(correlation_id, Pending {std::move(envelope), std::chrono::steady_clock::now()});
+
+        m_metrics.requests++;
+        m_metrics.in_flight     = m_pending.size();
+        m_metrics.max_in_flight = std::max(m_metrics.max_in_flight, m_metrics.in_flight);
+
+        const auto size                     = zmq_msg_size(&frame);
+        const auto [message_id, message_it] = Serializer::deserialize(static_cast<const u_char*>(zmq_msg_data(&frame)), size);
+
+        handler(correlation_id, message_id, message_it, size < Serializer::HEAD_SIZE<size_t> ? 0 : size - Serializer::HEAD_SIZE<size_t>);
+
+        zmq_msg_close(&frame);
+
+        return true;
+    }
+
+    void forward(const uint64_t correlation_id, const u_char* message, const size_t size)
+    {
+        const auto it = m_pending.find(correlation_id);
+
+        if (it == m_pending.end()) [[unlikely]]
+            return;
+
+        for (const auto& frame : it->second.envelope)
+            zmq_send(m_zmq_socket.get(), frame.data(), frame.size(), ZMQ_SNDMORE);
+
+        zmq_send(m_zmq_socket.get(), message, size, ZMQ_DONTWAIT);
+
+        const auto latency_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - it->second.received_time).count();
+
+        m_metrics.replies++;
+        m_metrics.total_latency_ns += latency_ns;
+        m_metrics.max_latency_ns    = std::max(m_metrics.max_latency_ns, latency_ns);
+
+        m_pending.erase(it);
+        m_metrics.in_flight = m_pending.size();
+    }
+
+private:
+    static constexpr size_t max_requests_per_poll = 256;
+
+private:
+    const int m_timeout_ms;
+    const std::string m_replies_address;
+    ZMQContextPtr m_zmq_context;
+    ZMQSocketPtr m_zmq_socket;
+    ZMQSocketPtr m_zmq_replies;
+
+private:
+    uint64_t m_last_correlation_id = 0;
+    std::unordered_map<uint64_t, Pending> m_pending;
+    AsyncRRServerMetrics m_metrics;
+    std::vector<u_char> m_message_buffer;
+};
+
+enum class AsyncRRStatus
+{
+    ok,
+    timeout,
+    cancelled,
+};
+
+/// Reply of AsyncRRClient, which owns the received ZeroMQ frame so that the
+/// body is read in place without copying.
+class AsyncRRReply
+{
+public:
+    explicit AsyncRRReply(const AsyncRRStatus status = AsyncRRStatus::cancelled) : m_status(status), m_frame()
+    {
+        zmq_msg_init(&m_frame);
+    }
+    /// Take over a received frame.
+    explicit AsyncRRReply(zmq_msg_t& frame) : m_status(AsyncRRStatus::ok), m_frame()
+    {
+        zmq_msg_init(&m_frame);
+        zmq_msg_move(&m_frame, &frame);
+    }
+    AsyncRRReply(AsyncRRReply&& other) noexcept : m_status(other.m_status), m_frame()
+    {
+        zmq_msg_init(&m_frame);
+        zmq_msg_move(&m_frame, &other.m_frame);
+    }
+    AsyncRRReply& operator=(AsyncRRReply&& other) noexcept
+    {
+        m_status = other.m_status;
+        zmq_msg_move(&m_frame, &other.m_frame);
+        return *this;
+    }
+    ~AsyncRRReply()
+    {
+        zmq_msg_close(&m_frame);
+    }
+
+public:
+    [[nodiscard]] AsyncRRStatus status() const
+    {
+        return m_status;
+    }
+
+    /// Invalid message ID if not ok.
+    [[nodiscard]] types::MessageID message_id() const
+    {
+        return std::get<0>(Serializer::deserialize(data(), size()));
+    }
+
+    /// Raw message body in the frame.
+    [[nodiscard]] std::span<const u_char> body() const
+    {
+        return size() < Serializer::HEAD_SIZE<size_t> ? std::span<const u_char> {} : std::span(data() + Serializer::HEAD_SIZE<size_t>, size() - Serializer::HEAD_SIZE<size_t>);
+    }
+
+    /// Parse the body, which is empty if the reply is invalid.
+    template<typename ReturnedMessageType>
+    [[nodiscard]] ReturnedMessageType parse() const
+    {
+        ReturnedMessageType returned_message;
+
+        if (message_id() != types::MessageID::invalid_message_id)
+            returned_message.ParseFromArray(body().data(), static_cast<int>(body().size()));
+
+        return returned_message;
+    }
+
+private:
+    [[nodiscard]] const u_char* data() const
+    {
+        return static_cast<const u_char*>(zmq_msg_data(const_cast<zmq_msg_t*>(&m_frame)));
+    }
+
+    [[nodiscard]] size_t size() const
+    {
+        return zmq_msg_size(&m_frame);
+    }
+
+private:
+    AsyncRRStatus m_status;
+    zmq_msg_t m_frame;
+};
+
+/// Encapsulate a ZeroMQ DEALER socket for creating a request-reply client that
+/// keeps many requests in flight.
+///
+/// Requests can be sent from any thread. They are forwarded by the I/O thread
+/// of the client, with the request id followed by an empty delimiter as the
+/// routing frames, which REP and ROUTER servers both send back with the reply.
+/// Replies are matched by request id in any order, and complete the future or
+/// callback of the request on the I/O thread. Requests not replied within
+/// timeout complete with AsyncRRStatus::timeout, and replies arriving later
+/// are dropped.
+class AsyncRRClient
+{
+public:
+    using Callback = std::function<void(AsyncRRReply&&)>;
+
+    struct Request {
+        uint64_t request_id;
+        std::future<AsyncRRReply> reply;
+    };
+
+public:
+    /// @param timeout Default timeout of requests, never time out if zero.
+    explicit AsyncRRClient(
+        const std::string& address,
+        const ZMQContextPtr& context              = nullptr,
+        const std::chrono::milliseconds& timeout = std::chrono::milliseconds(3000)
+    )
+        : m_timeout(timeout),
+          m_requests_address(fmt::format("inproc://async_rr_client_requests_{}", static_cast<void*>(this)))
+    {
+        if (context != nullptr)
+            m_zmq_context = context;
+        else
+            m_zmq_context.reset(zmq_ctx_new(), ZMQContextPtrDeleter());
+
+        m_zmq_socket.reset(zmq_socket(m_zmq_context.get(), ZMQ_DEALER));
+
+        constexpr int linger_ms = 0;
+        zmq_setsockopt(m_zmq_socket.get(), ZMQ_LINGER, &linger_ms, sizeof(linger_ms));
+
+        auto code = zmq_connect(m_zmq_socket.get(), address.c_str());
+
+        if (code != 0) {
+            throw std::runtime_error(fmt::format("Failed to connect ZMQ socket to {}: {}", address, std::string(zmq_strerror(errno))));
+        }
+
+        m_zmq_requests.reset(zmq_socket(m_zmq_context.get(), ZMQ_PULL));
+
+        code = zmq_bind(m_zmq_requests.get(), m_requests_address.c_str());
+
+        if (code != 0) {
+            throw std::runtime_error(fmt::format("Failed to bind ZMQ socket at {}: {}", m_requests_address, std::string(zmq_strerror(errno))));
+        }
+
+        m_zmq_submitter.reset(zmq_socket(m_zmq_context.get(), ZMQ_PUSH));
+        zmq_setsockopt(m_zmq_submitter.get(), ZMQ_LINGER, &linger_ms, sizeof(linger_ms));
+        zmq_connect(m_zmq_submitter.get(), m_requests_address.c_str());
+
+        m_io_thread = std::thread([this] { this->io_loop(); });
+    }
+    ~AsyncRRClient()
+    {
+        m_is_running = false;
+        m_io_thread.join();
+
+        /// Complete requests left.
+        for (auto& [request_id, pending] : m_pending)
+            complete(pending, AsyncRRReply(AsyncRRStatus::cancelled));
+    }
+
+public:
+    /// Send a request and complete the future when replied.
+    [[nodiscard]] Request request(
+        const types::MessageID message_id,
+        const google::protobuf::Message& message,
+        const std::optional<std::chrono::milliseconds>& timeout = std::nullopt
+    )
+    {
+        Pending pending;
+        auto reply = pending.promise.get_future();
+
+        const auto request_id = submit(message_id, message, std::move(pending), timeout.value_or(m_timeout));
+
+        return Request {request_id, std::move(reply)};
+    }
+
+    /// Send a request and call callback on the I/O thread when replied.
+    /// @return Request id for cancel().
+    uint64_t request(
+        const types::MessageID message_id,
+        const google::protobuf::Message& message,
+        Callback callback,
+        const std::optional<std::chrono::milliseconds>& timeout = std::nullopt
+    )
+    {
+        Pending pending;
+        pending.callback = std::move(callback);
+
+        return submit(message_id, message, std::move(pending), timeout.value_or(m_timeout));
+    }
+
+    /// Complete the request with AsyncRRStatus::cancelled, its reply will be
+    /// dropped.
+    /// @return false if the request has completed.
+    bool cancel(const uint64_t request_id)
+    {
+        std::unique_lock lock(m_pending_mutex);
+
+        const auto it = m_pending.find(request_id);
+
+        if (it == m_pending.end())
+            return false;
+
+        auto pending = std::move(it->second);
+        m_pending.erase(it);
+        lock.unlock();
+
+        complete(pending, AsyncRRReply(AsyncRRStatus::cancelled));
+
+        return true;
+    }
+
+    [[nodiscard]] size_t in_flight() const
+    {
+        std::lock_guard lock(m_pending_mutex);
+        return m_pending.size();
+    }
+
+private:
+    struct Pending {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+        std::promise<AsyncRRReply> promise;
+        Callback callback;
+    };
+
+    uint64_t submit(const types::MessageID message_id, const google::protobuf::Message& message, Pending&& pending, const std::chrono::milliseconds& timeout)
+    {
+        if (timeout.count() > 0)
+            pending.deadline = std::chrono::steady_clock::now() + timeout;
+
+        std::lock_guard lock(m_submit_mutex);
+
+        const auto request_id = ++m_last_request_id;
+
+        {
+            std::lock_guard pending_lock(m_pending_mutex);
+            m_pending.emplace(request_id, std::move(pending));
+        }
+
+        Serializer::serialize(message_id, message, m_message_buffer);
+
+        zmq_send(m_zmq_submitter.get(), &request_id, sizeof(request_id), ZMQ_SNDMORE);
+        zmq_send(m_zmq_submitter.get(), m_message_buffer.data(), m_message_buffer.size(), 0);
+
+        return request_id;
+    }
+
+    void io_loop()
+    {
+        zmq_pollitem_t items[] = {
+            {m_zmq_socket.get(), 0, ZMQ_POLLIN, 0},
+            {m_zmq_requests.get(), 0, ZMQ_POLLIN, 0},
+        };
+
+        while (m_is_running) {
+            if (zmq_poll(items, 2, poll_timeout_ms) > 0) {
+                (items[1].revents & ZMQ_POLLIN) ? forward_requests() : void();
+                (items[0].revents & ZMQ_POLLIN) ? receive_replies() : void();
+            }
+
+            expire();
+        }
+    }
+
+    void forward_requests()
+    {
+        zmq_msg_t frame;
+
+        while (true) {
+            zmq_msg_init(&frame);
+
+            if (zmq_msg_recv(&frame, m_zmq_requests.get(), ZMQ_DONTWAIT) < 0) {
+                zmq_msg_close(&frame);
+                return;
+            }
+
+            /// Request id, empty delimiter and body without copying.
+            zmq_msg_send(&frame, m_zmq_socket.get(), ZMQ_SNDMORE);
+            zmq_send(m_zmq_socket.get(), nullptr, 0, ZMQ_SNDMORE);
+
+            zmq_msg_init(&frame);
+            zmq_msg_recv(&frame, m_zmq_requests.get(), 0);
+            zmq_msg_send(&frame, m_zmq_socket.get(), 0);
+        }
+    }
+
+    void receive_replies()
+    {
+        zmq_msg_t frame;
+
+        while (true) {
+            zmq_msg_init(&frame);
+
+            if (zmq_msg_recv(&frame, m_zmq_socket.get(), ZMQ_DONTWAIT) < 0) {
+                zmq_msg_close(&frame);
+                return;
+            }
+
+            uint64_t request_id = 0;
+            std::memcpy(&request_id, zmq_msg_data(&frame), std::min(sizeof(request_id), zmq_msg_size(&frame)));
+
+            /// Skip to the body after the empty delimiter.
+            while (zmq_msg_more(&frame)) {
+                zmq_msg_close(&frame);
+                zmq_msg_init(&frame);
+                zmq_msg_recv(&frame, m_zmq_socket.get(), 0);
+            }
+
+            AsyncRRReply reply(frame);
+            zmq_msg_close(&frame);
+
+            std::unique_lock lock(m_pending_mutex);
+
+            const auto it = m_pending.find(request_id);
+
+            /// Timed out or cancelled.
+            if (it == m_pending.end())
+                continue;
+
+            auto pending = std::move(it->second);
+            m_pending.erase(it);
+            lock.unlock();
+
+            complete(pending, std::move(reply));
+        }
+    }
+
+    void expire()
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now < m_next_expiry)
+            return;
+
+        m_next_expiry = now + std::chrono::milliseconds(poll_timeout_ms);
+
+        std::vector<Pending> expired;
+
+        {
+            std::lock_guard lock(m_pending_mutex);
+
+            for (auto it = m_pending.begin(); it != m_pending.end();) {
+                if (it->second.deadline <= now) {
+                    expired.push_back(std::move(it->second));
+                    it = m_pending.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
+        for (auto& pending : expired)
+            complete(pending, AsyncRRReply(AsyncRRStatus::timeout));
+    }
+
+    static void complete(Pending& pending, AsyncRRReply&& reply)
+    {
+        pending.callback == nullptr ? pending.promise.set_value(std::move(reply)) : pending.callback(std::move(reply));
+    }
+
+private:
+    /// Timeouts are checked at this granularity.
+    static constexpr int poll_timeout_ms = 10;
+
+private:
+    const std::chrono::milliseconds m_timeout;
+    const std::string m_requests_address;
+    ZMQContextPtr m_zmq_context;
+    /// Used by the I/O thread only.
+    ZMQSocketPtr m_zmq_socket;
+    ZMQSocketPtr m_zmq_requests;
+    /// Guarded by m_submit_mutex.
+    ZMQSocketPtr m_zmq_submitter;
+
+private:
+    std::mutex m_submit_mutex;
+    uint64_t m_last_request_id = 0;
+    std::vector<u_char> m_message_buffer;
+
+private:
+    mutable std::mutex m_pending_mutex;
+    std::unordered_map<uint64_t, Pending> m_pending;
+    std::chrono::steady_clock::time_point m_next_expiry;
+
+private:
+    std::atomic<bool> m_is_running = true;
+    std::thread m_io_thread;
+};
+
 /// Encapsulate raw UDP multicast socket.
 ///
 /// This class manages the lifecycle of a raw socket, handling the
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace trade::utilities
+{
+
+enum class SeqGapResult {
+    in_order,  /// The next expected one.
+    gap,       /// Jumped forward, sequences in between are missing.
+    duplicate, /// Already received.
+    reorder,   /// A missing sequence arrived late but still in window.
+    stale,     /// Too old to tell, fell out of window.
+    reset,     /// Jumped far backward, the feed restarted and is tracked from here.
+};
+
+/// Tracks sequence numbers of one channel with a sliding bitmap window of
+/// the latest WindowSize sequences, telling gaps, duplicates and reorders
+/// apart in O(1).
+///
+/// A sequence at least reset_distance behind the highest one is taken as a
+/// restart of the feed, e.g. by exchange or gateway, rather than a stale one,
+/// and tracking starts over from it.
+template<size_t WindowSize = 4096>
+class SeqGapDetector
+{
+    static_assert(WindowSize > 0 && WindowSize % 64 == 0, "WindowSize should be a multiple of 64");
+
+public:
+    using Result = SeqGapResult;
+
+public:
+    explicit SeqGapDetector(const uint64_t reset_distance = WindowSize * 16) : m_reset_distance(std::max<uint64_t>(reset_distance, WindowSize)) {}
+    ~SeqGapDetector() = default;
+
+public:
+    /// @param missing Sequences skipped over if the result is gap.
+    Result check(const uint64_t seq, uint64_t& missing)
+    {
+        missing = 0;
+
+        if (m_received++ == 0) [[unlikely]] {
+            m_first   = seq;
+            m_highest = seq;
+            set(seq);
+            return Result::in_order;
+        }
+
+        if (seq > m_highest) [[likely]] {
+            advance(seq);
+
+            missing   = seq - m_highest - 1;
+            m_highest = seq;
+            set(seq);
+
+            if (missing == 0) [[likely]]
+                return Result::in_order;
+
+            m_gaps += missing;
+            return Result::gap;
+        }
+
+        if (m_highest - seq >= m_reset_distance) [[unlikely]] {
+            m_window.fill(0);
+            m_first   = seq;
+            m_highest = seq;
+            set(seq);
+
+            m_resets++;
+            return Result::reset;
+        }
+
+        if (m_highest - seq >= WindowSize) {
+            m_stales++;
+            return Result::stale;
+        }
+
+        if (test(seq)) {
+            m_duplicates++;
+            return Result::duplicate;
+        }
+
+        set(seq);
+        m_reorders++;
+
+        /// Sequences before the first one were never counted as gaps.
+        seq > m_first ? void(m_filled++) : void();
+
+        return Result::reorder;
+    }
+
+    [[nodiscard]] uint64_t highest() const { return m_highest; }
+    [[nodiscard]] uint64_t received() const { return m_received; }
+    /// Sequences ever skipped over, including those arrived late.
+    [[nodiscard]] uint64_t gaps() const { return m_gaps; }
+    [[nodiscard]] uint64_t duplicates() const { return m_duplicates; }
+    [[nodiscard]] uint64_t reorders() const { return m_reorders; }
+    [[nodiscard]] uint64_t stales() const { return m_stales; }
+    [[nodiscard]] uint64_t resets() const { return m_resets; }
+    /// Sequences skipped over and never filled.
+    [[nodiscard]] uint64_t missing() const { return m_gaps - m_filled; }
+
+private:
+    /// Clear bits of sequences (m_highest, seq] which are reused by window.
+    void advance(const uint64_t seq)
+    {
+        if (seq - m_highest >= WindowSize) {
+            m_window.fill(0);
+            return;
+        }
+
+        for (uint64_t i = m_highest + 1; i <= seq; i++)
+            m_window[i % WindowSize / 64] &= ~(uint64_t(1) << i % 64);
+    }
+
+    void set(const uint64_t seq) { m_window[seq % WindowSize / 64] |= uint64_t(1) << seq % 64; }
+    [[nodiscard]] bool test(const uint64_t seq) const { return m_window[seq % WindowSize / 64] >> seq % 64 & 1; }
+
+private:
+    std::array<uint64_t, WindowSize / 64> m_window {};
+    /// At least WindowSize, so that a reset is never in window.
+    const uint64_t m_reset_distance;
+    uint64_t m_first      = 0;
+    uint64_t m_highest    = 0;
+    uint64_t m_received   = 0;
+    uint64_t m_gaps       = 0;
+    uint64_t m_duplicates = 0;
+    uint64_t m_reorders   = 0;
+    /// Reorders filling gaps.
+    uint64_t m_filled     = 0;
+    uint64_t m_stales     = 0;
+    uint64_t m_resets     = 0;
+};
+
+} // namespace trade::utilities
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <boost/noncopyable.hpp>
+#include <chrono>
 #include <fmt/format.h>
-#include <mutex>
 
 namespace trade::utilities
 {
@@ -11,7 +12,13 @@ namespace trade::utilities
 /// used in distributed computing.
 /// See https://en.wikipedia.org/wiki/Snowflake_ID and
 /// https://blog.twitter.com/engineering/en_us/a/2010/announcing-snowflake.
-template<int64_t TEpoch, typename Lock = std::mutex>
+///
+/// Timestamp and sequence of the last ID are kept in one atomic word updated
+/// by CAS, so that no thread ever waits on a lock. Time never goes backwards:
+/// the clock is anchored to steady_clock at construction, and a timestamp
+/// behind the last one keeps counting on the last one. Threads only wait,
+/// spinning, when all sequences of the millisecond are used up.
+template<int64_t TEpoch>
 class SnowFlaker: private boost::noncopyable
 {
 public:
@@ -33,33 +40,64 @@ public:
 
     [[nodiscard]] int64_t next()
     {
-        std::lock_guard lock(m_lock);
+        return compose(reserve_state(1));
+    }
 
-        auto timestamp = millisecond();
-        if (m_last_timestamp == timestamp) {
-            m_sequence = m_sequence + 1 & SEQUENCE_MASK;
-            if (m_sequence == 0) {
-                timestamp = waitForNextMillis(m_last_timestamp);
-            }
-        }
-        else {
-            m_sequence = 0;
+    [[nodiscard]] int64_t operator()()
+    {
+        return next();
+    }
+
+    /// Reserve count consecutive IDs of one millisecond at once.
+    /// @return The first ID, the others follow it one by one.
+    [[nodiscard]] int64_t reserve(const int64_t count)
+    {
+        if (count <= 0 || count > SEQUENCE_MASK + 1) {
+            throw std::runtime_error(fmt::format("Reserved ID count should be between 1 and {}", SEQUENCE_MASK + 1));
         }
 
-        m_last_timestamp = timestamp;
+        return compose(reserve_state(count));
+    }
 
-        return timestamp - TWEPOCH << TIMESTAMP_LEFT_SHIFT
-             | m_datacenter_id << DATACENTER_ID_SHIFT
-             | m_worker_id << WORKER_ID_SHIFT
-             | m_sequence;
+private:
+    /// @return State of the first reserved ID.
+    [[nodiscard]] int64_t reserve_state(const int64_t count)
+    {
+        auto last = m_state.load(std::memory_order_relaxed);
+
+        while (true) {
+            const auto timestamp      = millisecond() - TWEPOCH;
+            const auto last_timestamp = last >> SEQUENCE_BITS;
+
+            int64_t first;
+
+            if (timestamp > last_timestamp) {
+                first = timestamp << SEQUENCE_BITS;
+            }
+            else if ((last & SEQUENCE_MASK) + count <= SEQUENCE_MASK) [[likely]] {
+                /// Same millisecond, or clock behind the last one.
+                first = last + 1;
+            }
+            else {
+                /// Sequences exhausted, never borrow from the future.
+                static_cast<void>(waitForNextMillis(last_timestamp + TWEPOCH));
+                last = m_state.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (m_state.compare_exchange_weak(last, first + count - 1, std::memory_order_relaxed)) [[likely]]
+                return first;
+        }
     }
 
-    [[nodiscard]] int64_t operator()()
+    [[nodiscard]] int64_t compose(const int64_t state) const noexcept
     {
-        return next();
+        return (state >> SEQUENCE_BITS) << TIMESTAMP_LEFT_SHIFT
+             | m_datacenter_id << DATACENTER_ID_SHIFT
+             | m_worker_id << WORKER_ID_SHIFT
+             | state & SEQUENCE_MASK;
     }
 
-private:
     [[nodiscard]] int64_t millisecond() const noexcept
     {
         const auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start_time_point);
@@ -76,8 +114,6 @@ private:
     }
 
 private:
-    using lock_type                               = Lock;
-
     static constexpr int64_t TWEPOCH              = TEpoch;
     static constexpr int64_t WORKER_ID_BITS       = 5L;
     static constexpr int64_t DATACENTER_ID_BITS   = 5L;
@@ -93,11 +129,49 @@ private:
     SteadyClockType m_start_time_point               = std::chrono::steady_clock::now();
 
     int64_t m_start_millisecond                   = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    int64_t m_last_timestamp                      = -1;
     int64_t m_worker_id                           = 0;
     int64_t m_datacenter_id                       = 0;
-    int64_t m_sequence                            = 0;
-    lock_type m_lock;
+    /// Timestamp since epoch and sequence of the last ID, in its own cache line.
+    alignas(64) std::atomic<int64_t> m_state      = SEQUENCE_MASK;
+};
+
+/// Hands out IDs reserved from SnowFlaker in blocks, without any shared write
+/// until the block runs out. Meant to be owned by one thread, e.g.
+/// thread_local. IDs of different blocks are unique but only roughly ordered
+/// by time.
+template<int64_t TEpoch>
+class SnowFlakerBlock: private boost::noncopyable
+{
+public:
+    static constexpr int64_t default_block_size = 64;
+
+public:
+    explicit SnowFlakerBlock(SnowFlaker<TEpoch>& snow_flaker, const int64_t block_size = default_block_size)
+        : m_snow_flaker(snow_flaker),
+          m_block_size(block_size)
+    {
+    }
+
+    [[nodiscard]] int64_t next()
+    {
+        if (m_next == m_end) [[unlikely]] {
+            m_next = m_snow_flaker.reserve(m_block_size);
+            m_end  = m_next + m_block_size;
+        }
+
+        return m_next++;
+    }
+
+    [[nodiscard]] int64_t operator()()
+    {
+        return next();
+    }
+
+private:
+    SnowFlaker<TEpoch>& m_snow_flaker;
+    const int64_t m_block_size;
+    int64_t m_next = 0;
+    int64_t m_end  = 0;
 };
 
 /// Singleton class.
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace trade::utilities
+{
+
+/// Bitmap indexed by numeric six-digit symbols, e.g. 600000 for SSE 600000.
+/// It is safe to update it from one thread while testing it from others.
+class SymbolBitmap
+{
+public:
+    static constexpr int64_t capacity = 1000000;
+
+public:
+    SymbolBitmap()  = default;
+    ~SymbolBitmap() = default;
+
+public:
+    [[nodiscard]] bool test(const int64_t symbol) const
+    {
+        if (symbol < 0 || symbol >= capacity) [[unlikely]]
+            return false;
+
+        return m_words[symbol / 64].load(std::memory_order_relaxed) >> symbol % 64 & 1;
+    }
+
+    /// @return false if symbol is out of range.
+    bool set(const int64_t symbol)
+    {
+        if (symbol < 0 || symbol >= capacity) [[unlikely]]
+            return false;
+
+        m_words[symbol / 64].fetch_or(uint64_t(1) << symbol % 64, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// @return false if symbol is out of range.
+    bool reset(const int64_t symbol)
+    {
+        if (symbol < 0 || symbol >= capacity) [[unlikely]]
+            return false;
+
+        m_words[symbol / 64].fetch_and(~(uint64_t(1) << symbol % 64), std::memory_order_relaxed);
+        return true;
+    }
+
+    void set_all()
+    {
+        for (auto& word : m_words)
+            word.store(~uint64_t(0), std::memory_order_relaxed);
+    }
+
+    void reset_all()
+    {
+        for (auto& word : m_words)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] int64_t count() const
+    {
+        int64_t count = 0;
+
+        for (const auto& word : m_words)
+            count += std::popcount(word.load(std::memory_order_relaxed));
+
+        return count;
+    }
+
+private:
+    static_assert(capacity % 64 == 0);
+    std::array<std::atomic<uint64_t>, capacity / 64> m_words {};
+};
+
+} // namespace trade::utilities
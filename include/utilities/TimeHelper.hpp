@@ -11,12 +11,14 @@
 #endif
 
 #include <chrono>
+#include <ctime>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
 #include <google/protobuf/timestamp.pb.h>
 #include <google/protobuf/util/time_util.h>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 namespace trade::utilities
 {
@@ -215,6 +217,45 @@ public:
     }
 };
 
+/// Now<std::string> which formats local time only when the millisecond
+/// changes and the date/time part only when the second changes.
+/// Not thread-safe, use one instance per thread.
+class CachedNow
+{
+public:
+    /// Returns the current local time in format 2000-01-01 08:00:00.000.
+    /// The returned view is valid until next call.
+    std::string_view operator()()
+    {
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        if (milliseconds == m_last_milliseconds) [[likely]]
+            return {m_buffer, length};
+
+        if (milliseconds / 1000 != m_last_milliseconds / 1000) {
+            const std::time_t now_c = milliseconds / 1000;
+            std::tm local_time {};
+
+            /// std::localtime shares its result between threads.
+            localtime_r(&now_c, &local_time);
+
+            fmt::format_to(m_buffer, "{:%Y-%m-%d %H:%M:%S}.", local_time);
+        }
+
+        fmt::format_to(m_buffer + length - 3, "{:03d}", milliseconds % 1000);
+
+        m_last_milliseconds = milliseconds;
+
+        return {m_buffer, length};
+    }
+
+private:
+    static constexpr size_t length = 23;
+
+    char m_buffer[length + 1] {};
+    int64_t m_last_milliseconds = -1;
+};
+
 template<typename>
 class Date
 {
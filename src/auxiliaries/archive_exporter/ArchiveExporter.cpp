@@ -0,0 +1,203 @@
+#include <csignal>
+#include <ctime>
+#include <fmt/chrono.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+
+#include "auxiliaries/archive_exporter/ArchiveExporter.h"
+#include "info.h"
+
+trade::ArchiveExporter::ArchiveExporter(const int argc, char* argv[])
+    : AppBase("archive_exporter")
+{
+    m_instances.emplace(this);
+    m_is_running = argv_parse(argc, argv);
+}
+
+int trade::ArchiveExporter::run()
+{
+    if (!m_is_running) {
+        return m_exit_code;
+    }
+
+    const std::filesystem::path input(m_arguments["input"].as<std::string>());
+    const std::filesystem::path output(m_arguments["output"].as<std::string>());
+
+    if (!exists(input)) {
+        logger->error("{} does not exist", input.string());
+        return EXIT_FAILURE;
+    }
+
+    /// Keep relative paths of archives under input folder.
+    const auto to_output = [&input, &output](const std::filesystem::path& archive) {
+        auto path = output.empty() ? archive : output / (is_directory(input) ? relative(archive, input) : archive.filename());
+        return path.replace_extension(".csv");
+    };
+
+    if (is_regular_file(input)) {
+        export_archive(input, to_output(input));
+        return m_exit_code;
+    }
+
+    for (const auto& file : std::filesystem::recursive_directory_iterator(input)) {
+        if (!m_is_running)
+            return EXIT_FAILURE;
+
+        if (file.is_regular_file() && file.path().extension() == reporter::archive::extension)
+            export_archive(file.path(), to_output(file.path()));
+    }
+
+    return m_exit_code;
+}
+
+int trade::ArchiveExporter::stop(int signal)
+{
+    spdlog::info("App exiting since received signal {}", signal);
+
+    m_is_running = false;
+
+    return 0;
+}
+
+void trade::ArchiveExporter::signal(const int signal)
+{
+    switch (signal) {
+    case SIGINT:
+    case SIGTERM: {
+        for (const auto& instance : m_instances) {
+            instance->stop(signal);
+        }
+
+        break;
+    }
+    default: {
+        spdlog::info("Signal {} omitted", signal);
+    }
+    }
+}
+
+bool trade::ArchiveExporter::argv_parse(const int argc, char* argv[])
+{
+    boost::program_options::options_description desc("Allowed options");
+
+    /// Help and version.
+    desc.add_options()("help,h", "print help message");
+    desc.add_options()("version,v", "print version string and exit");
+
+    desc.add_options()("debug,d", "enable debug output");
+
+    /// Input and output.
+    desc.add_options()("input,i", boost::program_options::value<std::string>()->default_value("./output"), "archive file, or folder to export all archives in");
+    desc.add_options()("output,o", boost::program_options::value<std::string>()->default_value(""), "output folder, next to archives if empty");
+
+    /// Filter.
+    desc.add_options()("column,c", boost::program_options::value<std::string>(), "only export rows whose column is in [from, to], e.g. exchange_time");
+    desc.add_options()("from", boost::program_options::value<int64_t>()->default_value(std::numeric_limits<int64_t>::min()), "lower bound of column");
+    desc.add_options()("to", boost::program_options::value<int64_t>()->default_value(std::numeric_limits<int64_t>::max()), "upper bound of column");
+
+    try {
+        store(parse_command_line(argc, argv, desc), m_arguments);
+    }
+    catch (const boost::wrapexcept<boost::program_options::unknown_option>& e) {
+        std::cout << e.what() << std::endl;
+        m_exit_code = EXIT_FAILURE;
+        return false;
+    }
+
+    notify(m_arguments);
+
+/// contains() is not support on Windows platforms.
+#if WIN32
+    #define contains(s) count(s) > 1
+#endif
+
+    if (m_arguments.contains("help")) {
+        std::cout << desc;
+        return false;
+    }
+
+    if (m_arguments.contains("version")) {
+        std::cout << fmt::format("{} {}", app_name(), trade_VERSION) << std::endl;
+        return false;
+    }
+
+    if (m_arguments.contains("debug")) {
+        spdlog::set_level(spdlog::level::debug);
+        this->logger->set_level(spdlog::level::debug);
+    }
+
+#if WIN32
+    #undef contains
+#endif
+
+    return true;
+}
+
+void trade::ArchiveExporter::export_archive(const std::filesystem::path& input, const std::filesystem::path& output)
+{
+    try {
+        reporter::ArchiveReader reader(input.string());
+
+        const auto table = m_arguments.contains("column")
+                             ? reader.read(m_arguments["column"].as<std::string>(), m_arguments["from"].as<int64_t>(), m_arguments["to"].as<int64_t>())
+                             : reader.read();
+
+        create_directories(output.parent_path());
+
+        std::ofstream out(output);
+        write_csv(table, reader.symbol(), out);
+
+        logger->info("Exported {} rows of {} to {}", table.rows(), input.string(), output.string());
+    }
+    catch (const std::runtime_error& e) {
+        logger->error("Failed to export {}: {}", input.string(), e.what());
+        m_exit_code = EXIT_FAILURE;
+    }
+}
+
+void trade::ArchiveExporter::write_csv(const reporter::archive::Table& table, const std::string& symbol, std::ostream& out)
+{
+    std::string buffer = "symbol";
+
+    for (const auto& column : table.columns)
+        fmt::format_to(std::back_inserter(buffer), ",{}", column.name);
+
+    buffer.push_back('\n');
+
+    for (size_t row = 0; row < table.rows(); row++) {
+        buffer.append(symbol);
+
+        for (size_t i = 0; i < table.columns.size(); i++) {
+            const auto value = table.values[i][row];
+
+            switch (table.columns[i].type) {
+            case reporter::archive::ColumnType::integer: {
+                fmt::format_to(std::back_inserter(buffer), ",{}", value);
+                break;
+            }
+            case reporter::archive::ColumnType::floating: {
+                fmt::format_to(std::back_inserter(buffer), ",{}", table.floating(i, row));
+                break;
+            }
+            case reporter::archive::ColumnType::timestamp: {
+                const std::time_t seconds = value / 1000;
+                fmt::format_to(std::back_inserter(buffer), ",{:%Y-%m-%d %H:%M:%S}.{:03d}", *std::localtime(&seconds), value % 1000);
+                break;
+            }
+            }
+        }
+
+        buffer.push_back('\n');
+
+        if (buffer.size() >= 1024 * 1024) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+std::set<trade::ArchiveExporter*> trade::ArchiveExporter::m_instances;
@@ -0,0 +1,11 @@
+#include <csignal>
+
+#include "auxiliaries/archive_exporter/ArchiveExporter.h"
+
+auto main(const int argc, char* argv[]) -> int
+{
+    std::signal(SIGINT, trade::ArchiveExporter::signal);
+
+    trade::ArchiveExporter archive_exporter(argc, argv);
+    return archive_exporter.run();
+}
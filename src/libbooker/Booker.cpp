@@ -2,6 +2,7 @@
 
 #include "libbooker/Booker.h"
 #include "libbooker/BookerCommonData.h"
+#include "utilities/MessagePool.hpp"
 #include "utilities/TimeHelper.hpp"
 #include "utilities/ToJSON.hpp"
 
@@ -114,7 +115,7 @@ bool trade::booker::Booker::trade(const TradeTickPtr& trade_tick)
     if ((exchange_time >= 92500 && exchange_time < 93000)
         || (exchange_time >= 145700 && exchange_time <= 151000)) [[unlikely]] {
         /// Report trade.
-        const auto generated_l2_tick = std::make_shared<types::GeneratedL2Tick>();
+        const auto generated_l2_tick = utilities::MessagePool<types::GeneratedL2Tick>::local()->acquire();
 
         generated_l2_tick->set_symbol(trade_tick->symbol());
         generated_l2_tick->set_price_1000x(trade_tick->exec_price_1000x());
@@ -133,7 +134,7 @@ bool trade::booker::Booker::trade(const TradeTickPtr& trade_tick)
         }
 
         assert(generated_l2_tick->ask_levels_size() == 5 && generated_l2_tick->bid_levels_size() == 5);
-        m_reporter->l2_tick_generated(generated_l2_tick);
+        report(generated_l2_tick);
 
         return true;
     }
@@ -207,6 +208,36 @@ void trade::booker::Booker::switch_to_continuous_stage()
     logger->info("Switched to continuous trade stage at {}", utilities::Now<std::string>()());
 }
 
+void trade::booker::Booker::begin_batch()
+{
+    m_is_batching = true;
+}
+
+void trade::booker::Booker::end_batch()
+{
+    m_is_batching = false;
+
+    if (!m_pending_l2_ticks.empty()) {
+        m_reporter->l2_ticks_generated(m_pending_l2_ticks);
+        m_pending_l2_ticks.clear();
+    }
+
+    if (!m_pending_ranged_ticks.empty()) {
+        m_reporter->ranged_ticks_generated(m_pending_ranged_ticks);
+        m_pending_ranged_ticks.clear();
+    }
+}
+
+void trade::booker::Booker::report(const GeneratedL2TickPtr& generated_l2_tick)
+{
+    m_is_batching ? m_pending_l2_ticks.push_back(generated_l2_tick) : m_reporter->l2_tick_generated(generated_l2_tick);
+}
+
+void trade::booker::Booker::report(const RangedTickPtr& ranged_tick)
+{
+    m_is_batching ? m_pending_ranged_ticks.push_back(ranged_tick) : m_reporter->ranged_tick_generated(ranged_tick);
+}
+
 void trade::booker::Booker::auction(const OrderWrapperPtr& order_wrapper)
 {
     switch (order_wrapper->order_type()) {
@@ -270,7 +301,7 @@ void trade::booker::Booker::on_trade(
     m_md_validator.has_value() ? m_md_validator.value().l2_tick_generated(latest_l2_tick) : void(); /// Feed to validator first.
 
     assert(latest_l2_tick->ask_levels_size() == 5 && latest_l2_tick->bid_levels_size() == 5);
-    m_reporter->l2_tick_generated(latest_l2_tick);
+    report(latest_l2_tick);
 }
 
 void trade::booker::Booker::on_reject(const OrderWrapperPtr& order, const char* reason)
@@ -285,7 +316,7 @@ void trade::booker::Booker::on_fill(
     const liquibook::book::Price fill_price
 )
 {
-    const auto latest_l2_tick = std::make_shared<types::GeneratedL2Tick>();
+    const auto latest_l2_tick = utilities::MessagePool<types::GeneratedL2Tick>::local()->acquire();
 
     /// Store to m_generated_l2_ticks first.
     m_generated_l2_ticks[order->symbol()] = latest_l2_tick;
@@ -324,7 +355,7 @@ void trade::booker::Booker::on_replace_reject(const OrderWrapperPtr& order, cons
 
 trade::booker::OrderTickPtr trade::booker::Booker::create_virtual_sse_order_tick(const TradeTickPtr& trade_tick, const types::SideType side)
 {
-    auto order_tick = std::make_shared<types::OrderTick>();
+    auto order_tick = utilities::MessagePool<types::OrderTick>::local()->acquire();
 
     switch (side) {
     case types::SideType::buy: {
@@ -356,7 +387,7 @@ trade::booker::OrderTickPtr trade::booker::Booker::create_virtual_szse_order_tic
     if (!m_market_order.contains(trade_tick->symbol()))
         return nullptr;
 
-    auto order_tick = std::make_shared<types::OrderTick>();
+    auto order_tick = utilities::MessagePool<types::OrderTick>::local()->acquire();
 
     order_tick->set_unique_id(m_market_order[trade_tick->symbol()]->unique_id());
     order_tick->set_order_type(types::OrderType::limit);
@@ -413,7 +444,7 @@ void trade::booker::Booker::refresh_range(
     });
     m_ranged_ticks[symbol].erase(subrange.begin(), m_ranged_ticks[symbol].end());
 
-    const auto generated_ranged_tick = std::make_shared<types::RangedTick>();
+    const auto generated_ranged_tick = utilities::MessagePool<types::RangedTick>::local()->acquire();
 
     /// Common data.
     generated_ranged_tick->set_symbol(symbol);
@@ -424,7 +455,7 @@ void trade::booker::Booker::refresh_range(
     generate_level_price(symbol, generated_ranged_tick);
 
     /// Weighted prices.
-    const auto& latest_l2_prices = std::make_shared<types::GeneratedL2Tick>();
+    const auto& latest_l2_prices = utilities::MessagePool<types::GeneratedL2Tick>::local()->acquire();
 
     generate_level_price(symbol, latest_l2_prices);
 
@@ -443,7 +474,7 @@ void trade::booker::Booker::refresh_range(
         generated_ranged_tick->set_start_time(minus_3_seconds(align_time(exchange_time)));
         generated_ranged_tick->set_end_time(align_time(exchange_time));
 
-        m_reporter->ranged_tick_generated(generated_ranged_tick);
+        report(generated_ranged_tick);
     }
     else {
         const auto first_ranged_tick = m_ranged_ticks[symbol].front();
@@ -497,7 +528,7 @@ void trade::booker::Booker::refresh_range(
     /// Clear ranged ticks.
     m_ranged_ticks[symbol].clear();
 
-    m_reporter->ranged_tick_generated(generated_ranged_tick);
+    report(generated_ranged_tick);
 }
 
 void trade::booker::Booker::add_range_snap(const OrderTickPtr& order_tick)
@@ -507,7 +538,7 @@ void trade::booker::Booker::add_range_snap(const OrderTickPtr& order_tick)
     if (!((time >= 93000000 && time <= 113000000) || (time >= 130000000 && time <= 150000000)))
         return;
 
-    const auto ranged_tick = std::make_shared<types::RangedTick>();
+    const auto ranged_tick = utilities::MessagePool<types::RangedTick>::local()->acquire();
 
     ranged_tick->set_symbol(order_tick->symbol());
     ranged_tick->set_exchange_date(order_tick->exchange_date());
@@ -573,7 +604,7 @@ void trade::booker::Booker::add_range_snap(
     if (!((time > 93000000 && time < 113000000) || (time > 130000000 && time < 150000000)))
         return;
 
-    const auto ranged_tick = std::make_shared<types::RangedTick>();
+    const auto ranged_tick = utilities::MessagePool<types::RangedTick>::local()->acquire();
 
     ranged_tick->set_symbol(order->symbol());
     ranged_tick->set_exchange_date(order->exchange_date());
@@ -14,7 +14,7 @@ void trade::broker::CTPBroker::start_login() noexcept
 {
     BrokerProxy::start_login();
 
-    m_trader_impl = std::make_unique<CTPTraderImpl>(config, m_holder, m_reporter, this);
+    m_trader_impl = std::make_unique<CTPTraderImpl>(config, m_holder, trade_reporter(), this);
 }
 
 void trade::broker::CTPBroker::start_logout() noexcept
@@ -25,26 +25,14 @@ void trade::broker::CTPBroker::start_logout() noexcept
     m_trader_impl.reset();
 }
 
-std::shared_ptr<trade::types::NewOrderRsp> trade::broker::CTPBroker::new_order(const std::shared_ptr<types::NewOrderReq> new_order_req)
+void trade::broker::CTPBroker::send_order(const std::shared_ptr<types::NewOrderReq> new_order_req, const std::shared_ptr<types::NewOrderRsp> new_order_rsp)
 {
-    auto new_order_rsp = BrokerProxy::new_order(new_order_req);
-    if (new_order_rsp->has_rejection_code())
-        return new_order_rsp;
-
     m_trader_impl->new_order(new_order_req, new_order_rsp);
-
-    return new_order_rsp;
 }
 
-std::shared_ptr<trade::types::NewCancelRsp> trade::broker::CTPBroker::cancel_order(const std::shared_ptr<types::NewCancelReq> new_cancel_req)
+void trade::broker::CTPBroker::send_cancel(const std::shared_ptr<types::NewCancelReq> new_cancel_req, const std::shared_ptr<types::NewCancelRsp> new_cancel_rsp)
 {
-    auto new_cancel_rsp = BrokerProxy::cancel_order(new_cancel_req);
-    if (new_cancel_rsp->has_rejection_code())
-        return new_cancel_rsp;
-
     m_trader_impl->cancel_order(new_cancel_req, new_cancel_rsp);
-
-    return new_cancel_rsp;
 }
 
 void trade::broker::CTPBroker::subscribe(const std::unordered_set<std::string>& symbols)
@@ -1,3 +1,5 @@
+#include <charconv>
+#include <cstring>
 #include <google/protobuf/util/time_util.h>
 #include <regex>
 #include <utility>
@@ -49,6 +51,10 @@ void trade::broker::CTPTraderImpl::new_order(
     const std::shared_ptr<types::NewOrderRsp>& new_order_rsp
 )
 {
+    /// OrderRef must increase in a session, orders from several workers are
+    /// numbered and submitted one at a time.
+    std::unique_lock insert_lock(m_insert_mutex);
+
     const auto [request_seq, unique_id] = new_id_pair();
 
     CThostFtdcInputOrderField input_order_field {};
@@ -80,16 +86,35 @@ void trade::broker::CTPTraderImpl::new_order(
     input_order_field.MinVolume           = 1;
     input_order_field.ForceCloseReason    = THOST_FTDC_FCC_NotForceClose;
 
+    /// Cached before submitted, @OnRtnOrder may arrive before ReqOrderInsert
+    /// returns.
+    OrderState order_state;
+
+    order_state.order.set_unique_id(new_order_req->unique_id());
+    order_state.order.set_symbol(new_order_req->symbol());
+    order_state.order.set_side(new_order_req->side());
+    order_state.order.set_position_side(new_order_req->position_side());
+    order_state.order.set_price(new_order_req->price());
+    order_state.order.set_quantity(new_order_req->quantity());
+    order_state.order.set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    m_order_states.insert(request_seq, std::move(order_state));
+
     /// @OnRspOrderInsert.
     const auto code = m_trader_api->ReqOrderInsert(&input_order_field, request_seq);
+    insert_lock.unlock();
+
     if (code != 0) {
         logger->error("Failed to call ReqOrderInsert: returned code {}", code);
 
+        /// Never reaches SDK, no callback will come for it.
+        m_order_states.erase(request_seq);
+
         new_order_rsp->set_request_id(new_order_req->request_id());
         new_order_rsp->set_unique_id(INVALID_ID);
         new_order_rsp->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
         new_order_rsp->set_rejection_code(types::RejectionCode::unknown);
-        new_order_rsp->set_rejection_reason("CTP API returned with code {}", code);
+        new_order_rsp->set_rejection_reason(fmt::format("CTP API returned with code {}", code));
 
         return;
     }
@@ -106,10 +131,17 @@ void trade::broker::CTPTraderImpl::cancel_order(
 {
     const auto [request_seq, request_id] = new_id_pair();
 
-    /// If original raw order id is not specified in request, query it from
-    /// holder.
+    /// If original raw order id is not specified in request, find it in
+    /// cached orders, or query it from holder.
     if (!new_cancel_req->has_original_raw_order_id()) {
-        const auto orders = m_holder->query_orders_by_unique_id(new_cancel_req->original_unique_id());
+        auto orders = std::make_shared<types::Orders>();
+
+        if (const auto order = m_order_states.find(new_cancel_req->original_unique_id()); order.has_value()) [[likely]] {
+            orders->add_orders()->CopyFrom(order.value());
+        }
+        else {
+            orders = m_holder->query_orders_by_unique_id(new_cancel_req->original_unique_id());
+        }
 
         if (orders->orders_size() != 1) {
             new_cancel_rsp->set_request_id(new_cancel_req->request_id());
@@ -636,124 +668,136 @@ void trade::broker::CTPTraderImpl::OnRtnOrder(CThostFtdcOrderField* pOrder)
 
     NULLPTR_CHECKER(pOrder);
 
-    logger->debug("New CThostFtdcOrder {} arrived with status {} and submit status {}", CTPCommonData::to_exchange_id(pOrder->ExchangeID, pOrder->OrderSysID), pOrder->OrderStatus, pOrder->OrderSubmitStatus);
+    const auto exchange_id = CTPCommonData::to_exchange_id(pOrder->ExchangeID, pOrder->OrderSysID);
 
-    using OrderRefType = std::tuple_element_t<0, decltype(new_id_pair())>;
-    OrderRefType order_ref;
+    logger->debug("New CThostFtdcOrder {} arrived with status {} and submit status {}", exchange_id, pOrder->OrderStatus, pOrder->OrderSubmitStatus);
 
-    try {
-        /// TThostFtdcOrderRefType is char[13], so we can use std::stoi.
-        /// UINT32_MAX is 4,294,967,295.
-        order_ref = std::stoi(pOrder->OrderRef);
-    }
-    catch (const std::exception& e) {
-        logger->warn("Can not convert OrderRef {} to OrderRefType: {}", pOrder->OrderRef, e.what());
-        return;
-    }
+    /// No OrderSysID before the order is accepted by exchange.
+    const bool has_order_sys_id = std::string_view(pOrder->OrderSysID).find_first_not_of(' ') != std::string_view::npos;
 
-    auto unique_id = get_by_seq_id(order_ref);
+    OrderEvents events;
 
-    std::shared_ptr<types::Orders> orders;
-    types::Order order;
+    const auto on_order = [&events, pOrder, &exchange_id, has_order_sys_id](OrderState& state) {
+        if (!state.order.has_broker_id()) {
+            state.order.set_broker_id(CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
+            events.is_broker_accepted = true;
+        }
 
-    /// No unique_id in AppBase means that the order not submitted by this
-    /// instance.
-    if (!unique_id.has_value()) {
-        /// Check if the order is already in holder.
-        orders = m_holder->query_orders_by_exchange_id(CTPCommonData::to_exchange_id(pOrder->ExchangeID, pOrder->OrderSysID));
-        if (orders->orders().empty()) {
-            /// Insert the new outside order into holder.
-            order.set_unique_id(snow_flaker());
-            order.set_broker_id(CTPCommonData::to_broker_id(m_common_data.m_front_id, m_common_data.m_session_id, pOrder->OrderRef));
-            order.set_exchange_id(CTPCommonData::to_exchange_id(pOrder->ExchangeID, pOrder->OrderSysID));
-            order.set_symbol(pOrder->InstrumentID);
-            order.set_side(CTPCommonData::to_side(pOrder->Direction));
-            order.set_position_side(CTPCommonData::to_position_side(pOrder->CombOffsetFlag[0]));
-            order.set_price(pOrder->LimitPrice);
-            order.set_quantity(pOrder->VolumeTotalOriginal);
-            order.set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
+        if (!state.order.has_exchange_id() && has_order_sys_id) {
+            state.order.set_exchange_id(exchange_id);
+            events.is_exchange_accepted = true;
+        }
 
-            orders->add_orders()->CopyFrom(order);
+        if (pOrder->OrderStatus == THOST_FTDC_OST_Canceled && state.status != THOST_FTDC_OST_Canceled) {
+            /// Canceled by exchange if new order is rejected.
+            events.is_rejected       = pOrder->OrderSubmitStatus == THOST_FTDC_OSS_InsertRejected;
+            events.is_canceled       = !events.is_rejected;
+            events.canceled_quantity = pOrder->VolumeTotalOriginal - pOrder->VolumeTraded;
+        }
 
-            m_holder->update_orders(orders);
+        events.is_cancel_rejected = pOrder->OrderSubmitStatus == THOST_FTDC_OSS_CancelRejected && state.submit_status != THOST_FTDC_OSS_CancelRejected;
 
-            logger->info("Assigned new unique_id {} to new outside order {} from ip {} mac {} and inserted into holder", order.unique_id(), CTPCommonData::to_exchange_id(pOrder->ExchangeID, pOrder->OrderSysID), pOrder->IPAddress, pOrder->MacAddress);
-        }
-        else {
-            /// Use queried order from holder.
-            assert(orders->orders_size() == 1);
-            order     = orders->mutable_orders()->at(0);
-            unique_id = std::make_optional(order.unique_id());
+        state.traded_quantity = pOrder->VolumeTraded;
+        state.status          = pOrder->OrderStatus;
+        state.submit_status   = pOrder->OrderSubmitStatus;
+
+        if (events.is_persisted()) {
+            state.order.set_allocated_update_time(utilities::Now<google::protobuf::Timestamp*>()());
         }
-    }
-    else {
-        /// Use unique_id to query from holder.
-        orders = m_holder->query_orders_by_unique_id(unique_id.value());
 
-        /// No broker_id/exchange_id in holder means that the order is newly
-        /// accepted.
-        if (order.broker_id().empty()) {
-            const auto broker_acceptance = std::make_shared<types::BrokerAcceptance>();
+        events.is_empty() ? void() : events.order.CopyFrom(state.order);
+    };
 
-            broker_acceptance->set_unique_id(unique_id.value());
-            broker_acceptance->set_broker_id(order.broker_id());
-            broker_acceptance->set_allocated_broker_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+    /// OrderRef is only unique in the session submitted it.
+    OrderStateCache::OrderRefType order_ref = 0;
 
-            m_reporter->broker_accepted(broker_acceptance);
+    const char* order_ref_end = pOrder->OrderRef + std::strlen(pOrder->OrderRef);
+    const bool is_own         = pOrder->FrontID == m_common_data.m_front_id
+                           && pOrder->SessionID == m_common_data.m_session_id
+                           && std::from_chars(pOrder->OrderRef, order_ref_end, order_ref).ec == std::errc();
 
-            const auto exchange_acceptance = std::make_shared<types::ExchangeAcceptance>();
+    const bool is_cached = (is_own && m_order_states.modify_by_order_ref(order_ref, on_order))
+                        || (has_order_sys_id && m_order_states.modify_by_exchange_id(exchange_id, on_order));
 
-            exchange_acceptance->set_unique_id(unique_id.value());
-            exchange_acceptance->set_exchange_id(order.exchange_id());
-            exchange_acceptance->set_allocated_exchange_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+    if (!is_cached) [[unlikely]] {
+        if (!has_order_sys_id) {
+            logger->debug("Ignored outside order {} not accepted by exchange yet", CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
+            return;
+        }
 
-            m_reporter->exchange_accepted(exchange_acceptance);
+        OrderState order_state;
 
-            /// Update broker_id/exchange_id.
-            order.set_broker_id(CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
-            order.set_exchange_id(CTPCommonData::to_exchange_id(pOrder->ExchangeID, pOrder->OrderSysID));
-            order.set_allocated_update_time(utilities::Now<google::protobuf::Timestamp*>()());
+        /// Check if the order is already in holder, only when first seen.
+        const auto orders = m_holder->query_orders_by_exchange_id(exchange_id);
 
-            m_holder->update_orders(orders);
+        if (orders->orders().empty()) {
+            /// Insert the new outside order into holder.
+            order_state.order.set_unique_id(snow_flaker());
+            order_state.order.set_broker_id(CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
+            order_state.order.set_exchange_id(exchange_id);
+            order_state.order.set_symbol(pOrder->InstrumentID);
+            order_state.order.set_side(CTPCommonData::to_side(pOrder->Direction));
+            order_state.order.set_position_side(CTPCommonData::to_position_side(pOrder->CombOffsetFlag[0]));
+            order_state.order.set_price(pOrder->LimitPrice);
+            order_state.order.set_quantity(pOrder->VolumeTotalOriginal);
+            order_state.order.set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
+            order_state.order.set_allocated_update_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+            const auto new_orders = std::make_shared<types::Orders>();
+            new_orders->add_orders()->CopyFrom(order_state.order);
+
+            m_holder->update_orders(new_orders);
+
+            logger->info("Assigned new unique_id {} to new outside order {} from ip {} mac {} and inserted into holder", order_state.order.unique_id(), exchange_id, pOrder->IPAddress, pOrder->MacAddress);
         }
+        else {
+            /// Use queried order from holder.
+            assert(orders->orders_size() == 1);
+            order_state.order.CopyFrom(orders->orders(0));
+        }
+
+        m_order_states.insert(std::move(order_state));
+        m_order_states.modify_by_exchange_id(exchange_id, on_order);
     }
 
-    switch (pOrder->OrderStatus) {
-    case THOST_FTDC_OST_Canceled: {
-        switch (pOrder->OrderSubmitStatus) {
-            /// If new order is rejected by exchange.
-        case THOST_FTDC_OSS_InsertRejected: {
-            const auto order_rejection = std::make_shared<types::OrderRejection>();
+    if (events.is_rejected || events.is_cancel_rejected) {
+        events.reason = utilities::GB2312ToUTF8()(pOrder->StatusMsg);
+    }
 
-            order_rejection->set_original_unique_id(unique_id.value());
-            order_rejection->set_original_broker_id(CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
-            order_rejection->set_original_exchange_id(CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
-            order_rejection->set_rejection_code(types::RejectionCode::unknown);
-            order_rejection->set_rejection_reason(utilities::GB2312ToUTF8()(pOrder->StatusMsg));
-            order_rejection->set_allocated_rejection_time(utilities::Now<google::protobuf::Timestamp*>()());
+    events.report(*m_reporter);
 
-            m_reporter->order_rejected(order_rejection);
+    /// Written behind by holder, broker_id/exchange_id are kept in memory
+    /// here in the meantime.
+    if (events.is_persisted()) {
+        const auto orders = std::make_shared<types::Orders>();
+        orders->add_orders()->CopyFrom(events.order);
 
-            break;
-        }
-            /// If cancel order is rejected by exchange.
-        case THOST_FTDC_OSS_CancelRejected: {
-            const auto cancel_order_rejection = std::make_shared<types::CancelOrderRejection>();
+        m_holder->update_orders(orders);
+    }
+}
 
-            cancel_order_rejection->set_original_unique_id(unique_id.value());
-            cancel_order_rejection->set_original_broker_id(CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
-            cancel_order_rejection->set_original_exchange_id(CTPCommonData::to_broker_id(pOrder->FrontID, pOrder->SessionID, pOrder->OrderRef));
-            cancel_order_rejection->set_rejection_code(types::RejectionCode::unknown);
-            cancel_order_rejection->set_rejection_reason(utilities::GB2312ToUTF8()(pOrder->StatusMsg));
-            cancel_order_rejection->set_allocated_rejection_time(utilities::Now<google::protobuf::Timestamp*>()());
+void trade::broker::CTPTraderImpl::OnRtnTrade(CThostFtdcTradeField* pTrade)
+{
+    CThostFtdcTraderSpi::OnRtnTrade(pTrade);
 
-            m_reporter->cancel_order_rejected(cancel_order_rejection);
+    NULLPTR_CHECKER(pTrade);
 
-            break;
-        }
-        default: break;
-        }
-    default: break;
-    }
+    const auto exchange_id = CTPCommonData::to_exchange_id(pTrade->ExchangeID, pTrade->OrderSysID);
+
+    logger->debug("New CThostFtdcTrade {} of order {} arrived with price {} and volume {}", pTrade->TradeID, exchange_id, pTrade->Price, pTrade->Volume);
+
+    std::shared_ptr<types::Trade> trade;
+
+    /// Order callback with OrderSysID always arrives before trade callbacks
+    /// of the order, so that the order is cached by its exchange_id.
+    const bool is_cached = m_order_states.modify_by_exchange_id(exchange_id, [&trade, pTrade](OrderState& state) {
+        trade = state.fill(pTrade->TradeID, pTrade->Price, pTrade->Volume);
+    });
+
+    if (!is_cached) [[unlikely]] {
+        logger->error("Ignored trade {} of unknown order {}", pTrade->TradeID, exchange_id);
+        return;
     }
+
+    trade == nullptr ? void() : m_reporter->trade_accepted(trade);
 }
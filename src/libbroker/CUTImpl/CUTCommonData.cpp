@@ -180,22 +180,30 @@ std::tuple<std::string, std::string> trade::broker::CUTCommonData::from_exchange
     return std::make_tuple(exchange, order_sys_id);
 }
 
-int64_t trade::broker::CUTCommonData::get_symbol_from_message(const std::vector<u_char>& message)
+int64_t trade::broker::CUTCommonData::get_symbol_from_message(const std::span<const u_char> message)
 {
-    int64_t symbol = 0;
-
-    try {
-        switch (message.size()) {
-        case sizeof(SSEHpfTick): symbol = std::stoll(reinterpret_cast<const SSEHpfTick*>(message.data())->m_symbol_id); break;
-        case sizeof(SSEHpfL2Snap): symbol = std::stoll(reinterpret_cast<const SSEHpfL2Snap*>(message.data())->m_symbol_id); break;
-        case sizeof(SZSEHpfOrderTick): symbol = std::stoll(reinterpret_cast<const SZSEHpfOrderTick*>(message.data())->m_header.m_symbol); break;
-        case sizeof(SZSEHpfTradeTick): symbol = std::stoll(reinterpret_cast<const SZSEHpfTradeTick*>(message.data())->m_header.m_symbol); break;
-        case sizeof(SZSEHpfL2Snap): symbol = std::stoll(reinterpret_cast<const SZSEHpfL2Snap*>(message.data())->m_header.m_symbol); break;
-        default: break;
-        }
+    const char* symbol_id;
+
+    switch (message.size()) {
+    case sizeof(SSEHpfTick): symbol_id = reinterpret_cast<const SSEHpfTick*>(message.data())->m_symbol_id; break;
+    case sizeof(SSEHpfL2Snap): symbol_id = reinterpret_cast<const SSEHpfL2Snap*>(message.data())->m_symbol_id; break;
+    case sizeof(SZSEHpfOrderTick): symbol_id = reinterpret_cast<const SZSEHpfOrderTick*>(message.data())->m_header.m_symbol; break;
+    case sizeof(SZSEHpfTradeTick): symbol_id = reinterpret_cast<const SZSEHpfTradeTick*>(message.data())->m_header.m_symbol; break;
+    case sizeof(SZSEHpfL2Snap): symbol_id = reinterpret_cast<const SZSEHpfL2Snap*>(message.data())->m_header.m_symbol; break;
+    default: return 0;
     }
-    catch (...) {
-        symbol = -1;
+
+    /// Six digits followed by non-digit is the common case, which is parsed
+    /// without std::stoll.
+    int64_t symbol = utilities::DigitParser<6>()(symbol_id);
+
+    if (symbol < 0 || !utilities::DigitParser<6>::terminated(symbol_id)) [[unlikely]] {
+        try {
+            symbol = std::stoll(symbol_id);
+        }
+        catch (...) {
+            symbol = -1;
+        }
     }
 
     /// Symbols that not start with "0", "3" or "6" is invalid.
@@ -206,9 +214,26 @@ int64_t trade::broker::CUTCommonData::get_symbol_from_message(const std::vector<
     return symbol;
 }
 
+std::tuple<trade::types::ExchangeType, int64_t, int64_t> trade::broker::CUTCommonData::get_channel_seq_from_message(const std::span<const u_char> message)
+{
+    switch (message.size()) {
+    case sizeof(SSEHpfTick): {
+        const auto raw_tick = reinterpret_cast<const SSEHpfTick*>(message.data());
+        return {types::ExchangeType::sse, raw_tick->m_channel_id, raw_tick->m_tick_index};
+    }
+    case sizeof(SZSEHpfOrderTick):
+    case sizeof(SZSEHpfTradeTick): {
+        /// Order and trade ticks share the same sequence of a channel.
+        const auto raw_header = reinterpret_cast<const SZSEHpfPackageHead*>(message.data());
+        return {types::ExchangeType::szse, raw_header->m_channel_num, raw_header->m_sequence_num};
+    }
+    default: return {types::ExchangeType::invalid_exchange, 0, 0};
+    }
+}
+
 trade::booker::TradeTickPtr trade::broker::CUTCommonData::x_ost_forward_to_trade_from_order(booker::OrderTickPtr& order_tick)
 {
-    auto trade_tick = std::make_shared<types::TradeTick>();
+    auto trade_tick = utilities::MessagePool<types::TradeTick>::local()->acquire();
 
     trade_tick->set_ask_unique_id(order_tick->x_ost_sse_ask_unique_id());
     trade_tick->set_bid_unique_id(order_tick->x_ost_sse_bid_unique_id());
@@ -226,7 +251,7 @@ trade::booker::TradeTickPtr trade::broker::CUTCommonData::x_ost_forward_to_trade
 
 trade::booker::OrderTickPtr trade::broker::CUTCommonData::x_ost_forward_to_order_from_trade(booker::TradeTickPtr& trade_tick)
 {
-    auto order_tick = std::make_shared<types::OrderTick>();
+    auto order_tick = utilities::MessagePool<types::OrderTick>::local()->acquire();
 
     order_tick->set_unique_id(std::max(trade_tick->ask_unique_id(), trade_tick->bid_unique_id()));
     order_tick->set_order_type(trade_tick->x_ost_szse_exe_type());
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cmath>
+#include <poll.h>
 #include <utility>
 
 #include "libbroker/CUTImpl/CUTCommonData.h"
@@ -16,6 +18,8 @@ trade::broker::CUTMdImpl::CUTMdImpl(
     std::shared_ptr<reporter::IReporter> reporter
 ) : AppBase("CUTMdImpl", std::move(config)),
     m_booker_thread_size(AppBase::config->get<size_t>("Performance.BookerConcurrency", std::thread::hardware_concurrency())),
+    m_batch_size(std::max<size_t>(AppBase::config->get<size_t>("Performance.BatchSize", 32), 1)),
+    m_max_batch_latency(AppBase::config->get<int64_t>("Performance.MaxBatchLatency", 50)),
     m_holder(std::move(holder)),
     m_reporter(std::move(reporter))
 {
@@ -23,17 +27,28 @@ trade::broker::CUTMdImpl::CUTMdImpl(
 
 void trade::broker::CUTMdImpl::subscribe(const std::unordered_set<std::string>& symbols)
 {
-    if (!symbols.empty()) {
-        throw std::runtime_error("Subscribing for specific symbols is not supported for CUTMdImpl yet");
+    /// Subscribe all symbols if none specified.
+    if (symbols.empty())
+        m_subscribed_symbols.set_all();
+
+    for (const auto& symbol : symbols) {
+        if (!m_subscribed_symbols.set(to_symbol_index(symbol)))
+            logger->error("Failed to subscribe {}: not a six-digit symbol", symbol);
     }
 
-    m_is_running = true;
+    logger->info("Subscribed {} symbols", m_subscribed_symbols.count());
+
+    /// Subscribing while running only updates symbols.
+    if (m_is_running.exchange(true))
+        return;
 
     /// Create booker threads.
     /// Ensure that m_message_buffers does not undergo resizing.
     /// TODO: Is it necessary?
     m_message_buffers.reserve(m_booker_thread_size);
 
+    m_is_receiving = true;
+
     for (size_t i = 0; i < m_booker_thread_size; i++) {
         auto& message_buffer = m_message_buffers.emplace_back(new MessageBufferType);
 
@@ -48,10 +63,20 @@ void trade::broker::CUTMdImpl::subscribe(const std::unordered_set<std::string>&
 
 void trade::broker::CUTMdImpl::unsubscribe(const std::unordered_set<std::string>& symbols)
 {
+    /// Unsubscribing specific symbols only updates symbols, keep running.
     if (!symbols.empty()) {
-        throw std::runtime_error("Unsubscribing for specific symbols is not supported for CUTMdImpl yet");
+        for (const auto& symbol : symbols) {
+            if (!m_subscribed_symbols.reset(to_symbol_index(symbol)))
+                logger->error("Failed to unsubscribe {}: not a six-digit symbol", symbol);
+        }
+
+        logger->info("Subscribed {} symbols", m_subscribed_symbols.count());
+
+        return;
     }
 
+    m_subscribed_symbols.reset_all();
+
     m_is_running = false;
 
     m_tick_receiver_thread.joinable() ? m_tick_receiver_thread.join() : void();
@@ -67,6 +92,14 @@ void trade::broker::CUTMdImpl::unsubscribe(const std::unordered_set<std::string>
     }
 }
 
+int64_t trade::broker::CUTMdImpl::to_symbol_index(const std::string& symbol)
+{
+    if (symbol.size() != 6 || !std::ranges::all_of(symbol, [](const char c) { return c >= '0' && c <= '9'; }))
+        return -1;
+
+    return std::stoll(symbol);
+}
+
 pcap_t* trade::broker::CUTMdImpl::init_pcap_handle(
     const std::string& interface,
     const std::string& filter
@@ -86,12 +119,36 @@ pcap_t* trade::broker::CUTMdImpl::init_pcap_handle(
         }
     }
     else {
-        /// Open network interface.
-        handle = pcap_open_live(interface.c_str(), BUFSIZ, 1, 1000, errbuf);
+        if (std::filesystem::is_regular_file(interface)) {
+            /// Replay from PCAP file.
+            handle = pcap_open_offline(interface.c_str(), errbuf);
 
-        if (handle == nullptr) {
-            logger->error("Failed to capture packets from {}: {}", interface, errbuf);
-            return nullptr;
+            if (handle == nullptr) {
+                logger->error("Failed to read PCAP file {}: {}", interface, errbuf);
+                return nullptr;
+            }
+        }
+        else {
+            /// Open network interface in immediate mode, otherwise packets are
+            /// handed over in blocks retired by read timeout, which delays
+            /// batches beyond max batch latency in quiet periods.
+            handle = pcap_create(interface.c_str(), errbuf);
+
+            if (handle == nullptr) {
+                logger->error("Failed to capture packets from {}: {}", interface, errbuf);
+                return nullptr;
+            }
+
+            pcap_set_snaplen(handle, BUFSIZ);
+            pcap_set_promisc(handle, 1);
+            pcap_set_timeout(handle, static_cast<int>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(m_max_batch_latency).count(), 1)));
+            pcap_set_immediate_mode(handle, 1);
+
+            if (pcap_activate(handle) < 0) {
+                logger->error("Failed to capture packets from {}: {}", interface, pcap_geterr(handle));
+                pcap_close(handle);
+                return nullptr;
+            }
         }
 
         /// Set capture filter.
@@ -143,35 +200,198 @@ pcap_dumper_t* trade::broker::CUTMdImpl::init_pcap_dumper(
     return dumper;
 }
 
+int64_t trade::broker::CUTMdImpl::next_packet(const std::vector<pcap_t*>& handles, std::vector<LinePacket>& lines) const
+{
+    int64_t earliest = -1;
+
+    for (size_t i = 0; i < handles.size(); i++) {
+        auto& line = lines[i];
+
+        if (line.packet == nullptr && !line.exhausted) {
+            switch (pcap_next_ex(handles[i], &line.header, &line.packet)) {
+            case 1: break;
+            case 0: line.packet = nullptr; break;
+            case PCAP_ERROR_BREAK: {
+                /// No more packets in PCAP file.
+                line.packet    = nullptr;
+                line.exhausted = true;
+                break;
+            }
+            default: {
+                logger->error("Failed to read packet from line {}: {}", i, pcap_geterr(handles[i]));
+                line.packet    = nullptr;
+                line.exhausted = true;
+            }
+            }
+        }
+
+        if (line.packet == nullptr)
+            continue;
+
+        /// Replaying PCAP files of both lines are merged by capture time.
+        if (earliest < 0 || timercmp(&line.header->ts, &lines[earliest].header->ts, <))
+            earliest = static_cast<int64_t>(i);
+    }
+
+    return earliest;
+}
+
+bool trade::broker::CUTMdImpl::arbitrate(
+    const size_t line,
+    const pcap_pkthdr& header,
+    const std::span<const u_char> payload
+)
+{
+    const auto [exchange, channel, seq] = CUTCommonData::get_channel_seq_from_message(payload);
+
+    /// Messages without sequence can not be arbitrated, take them from line A
+    /// only.
+    if (exchange == types::ExchangeType::invalid_exchange)
+        return line == 0;
+
+    const int64_t arrival = header.ts.tv_sec * 1000000 + header.ts.tv_usec;
+
+    return m_feed_arbitrator->arbitrate(line, {exchange, channel}, seq, arrival);
+}
+
 void trade::broker::CUTMdImpl::tick_receiver()
 {
-    pcap_pkthdr header {};
     size_t udp_payload_length;
 
-    /// Interface to capture packets.
+    /// Interface or PCAP file to capture packets.
     const auto interface = config->get<std::string>("Server.Interface", "any");
+    /// Interface or PCAP file of B line, leave it empty to capture A line only.
+    const auto backup_interface = config->get<std::string>("Server.BackupInterface", "");
     /// Capture filter.
     const auto filter = config->get<std::string>("Server.CaptureFilter", "udp");
     /// Open dump file.
     const auto dump_file = config->get<std::string>("Server.DumpFile", "");
 
-    /// Initialize pcap handle and dumper.
-    const auto handle = init_pcap_handle(interface, filter);
-    const auto dumper = init_pcap_dumper(handle, dump_file);
+    /// Initialize pcap handles and dumper.
+    std::vector handles {init_pcap_handle(interface, filter)};
+
+    if (!backup_interface.empty()) {
+        if (filter == "stdin") {
+            logger->warn("Backup interface {} is ignored since reading from stdin", backup_interface);
+        }
+        else {
+            handles.push_back(init_pcap_handle(backup_interface, filter));
+            m_feed_arbitrator = std::make_unique<utilities::FeedArbitrator<std::tuple<types::ExchangeType, int64_t>>>(handles.size());
+
+            logger->info("Arbitrating lines {} and {}", interface, backup_interface);
+        }
+    }
+
+    if (std::ranges::any_of(handles, [](const pcap_t* handle) { return handle == nullptr; })) {
+        logger->error("Failed to initialize capture, tick receiver exits");
+        std::ranges::for_each(handles, [](pcap_t* handle) { handle != nullptr ? pcap_close(handle) : void(); });
+        m_is_receiving = false;
+        return;
+    }
+
+    /// Poll lines in turn instead of blocking on any of them, and wait on
+    /// their descriptors when none is ready, until the earliest pending batch
+    /// expires. Even a single line is polled, so that a partial batch never
+    /// waits for a read timeout.
+    std::vector<pollfd> readable_fds;
+    char errbuf[PCAP_ERRBUF_SIZE];
+
+    for (const auto handle : handles) {
+        pcap_setnonblock(handle, 1, errbuf);
+        readable_fds.push_back({.fd = pcap_get_selectable_fd(handle), .events = POLLIN, .revents = 0});
+    }
+
+    /// Sleep instead if any line can not be waited on.
+    std::ranges::any_of(readable_fds, [](const pollfd& fd) { return fd.fd < 0; }) ? readable_fds.clear() : void();
+
+    const auto dumper = init_pcap_dumper(handles.front(), dump_file);
+
+    std::vector<LinePacket> lines(handles.size());
+
+    /// Pending messages per booker shard.
+    std::vector<MessageBatch> batches(m_message_buffers.size());
+
+    for (auto& batch : batches)
+        batch.messages.reserve(m_batch_size);
+
+    /// Interval to dump feed stats, 0 to disable.
+    const std::chrono::seconds feed_stats_interval(config->get<int64_t>("Performance.SeqStatsInterval", 60));
+    auto last_feed_stats_dump = std::chrono::steady_clock::now();
+
+    /// Publishes batches which have waited too long.
+    const auto flush_expired = [this, &batches](const std::chrono::steady_clock::time_point now) {
+        for (size_t i = 0; i < batches.size(); i++) {
+            if (!batches[i].messages.empty() && now - batches[i].first_arrival >= m_max_batch_latency)
+                flush(batches[i], *m_message_buffers[i]);
+        }
+    };
+
+    /// Time until the earliest pending batch expires, at most idle_timeout so
+    /// that stopping is noticed.
+    const auto until_expiry = [this, &batches](const std::chrono::steady_clock::time_point now) {
+        constexpr std::chrono::microseconds idle_timeout(100000);
+
+        auto timeout = idle_timeout;
+
+        for (const auto& batch : batches) {
+            if (!batch.messages.empty())
+                timeout = std::min(timeout, std::chrono::duration_cast<std::chrono::microseconds>(batch.first_arrival + m_max_batch_latency - now));
+        }
+
+        return std::max(timeout, std::chrono::microseconds::zero());
+    };
+
+    /// Non-blocking lines have nothing to read.
+    const auto wait_readable = [&readable_fds](const std::chrono::microseconds timeout) {
+        if (readable_fds.empty()) {
+            std::this_thread::sleep_for(timeout);
+            return;
+        }
+
+        const auto seconds   = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        const timespec spec {.tv_sec = seconds.count(), .tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - seconds).count()};
+
+        ppoll(readable_fds.data(), readable_fds.size(), &spec, nullptr);
+    };
 
     while (m_is_running) {
-        const u_char* packet = pcap_next(handle, &header);
+        const auto line = next_packet(handles, lines);
 
-        if (packet == nullptr) {
-            if (filter == "stdin") {
+        if (line < 0) {
+            if (std::ranges::all_of(lines, &LinePacket::exhausted)) {
                 m_is_running = false;
                 logger->info("No more packets to read");
+                continue;
             }
+
+            /// Only batches waited long enough are published, as if a packet
+            /// arrived now.
+            const auto now = std::chrono::steady_clock::now();
+            flush_expired(now);
+
+            wait_readable(until_expiry(now));
             continue;
         }
 
+        const auto header = lines[line].header;
+        const auto packet = std::exchange(lines[line].packet, nullptr);
+
+        const auto payload = utilities::UdpPayloadGetter()(packet, header->caplen, udp_payload_length);
+
+        /// Drop what has been delivered by the other line.
+        if (m_feed_arbitrator != nullptr && !arbitrate(line, *header, {payload, udp_payload_length}))
+            continue;
+
         if (dumper != nullptr)
-            pcap_dump(reinterpret_cast<u_char*>(dumper), &header, packet);
+            pcap_dump(reinterpret_cast<u_char*>(dumper), header, packet);
+
+        check_seq({payload, udp_payload_length});
+
+        const int64_t symbol = CUTCommonData::get_symbol_from_message({payload, udp_payload_length});
+
+        /// Drop unsubscribed symbols before any allocation.
+        if (symbol <= 0 || !m_subscribed_symbols.test(symbol))
+            continue;
 
         /// boost::freelock::queue imposes a constraint that its elements
         /// must have trivial destructors. Consequently, usage of
@@ -180,37 +400,138 @@ void trade::broker::CUTMdImpl::tick_receiver()
         /// TODO: Use memory pool to implement this.
         const auto message = new std::vector<u_char>(max_udp_size);
 
-        const auto payload = utilities::UdpPayloadGetter()(packet, header.caplen, udp_payload_length);
-
         /// Copy udp payload to message.
         message->resize(udp_payload_length);
         std::copy_n(payload, udp_payload_length, message->begin());
 
-        const int64_t symbol = CUTCommonData::get_symbol_from_message(*message);
+        const auto now   = std::chrono::steady_clock::now();
+        const auto shard = symbol % m_message_buffers.size();
+        auto& batch      = batches[shard];
 
-        if (symbol <= 0) {
-            delete message;
-            continue;
-        }
+        if (batch.messages.empty())
+            batch.first_arrival = now;
 
-        /// For gradual sleep time.
-        static size_t full_counter = 0;
+        batch.messages.push_back(message);
 
-        while (!m_message_buffers[symbol % m_message_buffers.size()]->push(message)) {
-            if (!m_is_running) [[unlikely]]
-                break;
+        if (batch.messages.size() >= m_batch_size)
+            flush(batch, *m_message_buffers[shard]);
 
-            logger->warn("Message buffer is full, which may cause data dropping. Sleeping {}ms", std::pow(2, full_counter));
-            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int64_t>(std::pow(2, full_counter++))));
-        }
+        flush_expired(now);
 
-        full_counter = 0;
+        if (feed_stats_interval.count() > 0 && now - last_feed_stats_dump >= feed_stats_interval) [[unlikely]] {
+            dump_feed_stats();
+            last_feed_stats_dump = now;
+        }
     }
 
-    handle != nullptr ? pcap_close(handle) : void();
+    dump_feed_stats();
+
+    /// Publish what is left, booker threads drain it before exiting.
+    for (size_t i = 0; i < batches.size(); i++)
+        flush(batches[i], *m_message_buffers[i]);
+
+    m_is_receiving = false;
+
+    std::ranges::for_each(handles, pcap_close);
     dumper != nullptr ? pcap_dump_close(dumper) : void();
 }
 
+void trade::broker::CUTMdImpl::flush(MessageBatch& batch, MessageBufferType& message_buffer) const
+{
+    auto begin = batch.messages.cbegin();
+
+    /// For gradual sleep time.
+    size_t full_counter = 0;
+
+    /// Publish the whole batch with as few index updates as possible.
+    /// Bookers keep consuming until the receiver is done, even if stopping.
+    while ((begin = message_buffer.push(begin, batch.messages.cend())) != batch.messages.cend()) {
+        logger->warn("Message buffer is full, which may cause data dropping. Sleeping {}ms", std::pow(2, full_counter));
+        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int64_t>(std::pow(2, full_counter++))));
+    }
+
+    batch.messages.clear();
+}
+
+void trade::broker::CUTMdImpl::check_seq(const std::span<const u_char> message)
+{
+    const auto [exchange, channel, seq] = CUTCommonData::get_channel_seq_from_message(message);
+
+    if (exchange == types::ExchangeType::invalid_exchange)
+        return;
+
+    auto& detector = m_seq_gap_detectors[{exchange, channel}];
+    uint64_t missing;
+
+    switch (detector.check(seq, missing)) {
+    case utilities::SeqGapResult::in_order: [[likely]] return;
+    case utilities::SeqGapResult::duplicate:
+    case utilities::SeqGapResult::reorder: return;
+    case utilities::SeqGapResult::stale: {
+        logger->warn("Stale sequence {} received from channel {} of {}, which is out of tracking window", seq, channel, types::ExchangeType_Name(exchange));
+        return;
+    }
+    case utilities::SeqGapResult::reset: {
+        logger->warn("Sequence of channel {} of {} reset to {}, tracking it from there", channel, types::ExchangeType_Name(exchange), seq);
+        return;
+    }
+    case utilities::SeqGapResult::gap: break;
+    }
+
+    const auto seq_gap = std::make_shared<types::SeqGap>();
+
+    seq_gap->set_exchange(exchange);
+    seq_gap->set_channel(channel);
+    seq_gap->set_expected_seq(seq - static_cast<int64_t>(missing));
+    seq_gap->set_received_seq(seq);
+    seq_gap->set_missing(static_cast<int64_t>(missing));
+    seq_gap->set_total_gaps(static_cast<int64_t>(detector.gaps()));
+    seq_gap->set_total_duplicates(static_cast<int64_t>(detector.duplicates()));
+    seq_gap->set_total_reorders(static_cast<int64_t>(detector.reorders()));
+
+    m_reporter->md_seq_gap_detected(seq_gap);
+}
+
+void trade::broker::CUTMdImpl::dump_feed_stats() const
+{
+    for (const auto& [key, detector] : m_seq_gap_detectors) {
+        const auto& [exchange, channel] = key;
+
+        logger->info(
+            "Channel {:<4} of {}: received {}, highest {}, gaps {}, missing {}, duplicates {}, reorders {}, stales {}, resets {}",
+            channel,
+            types::ExchangeType_Name(exchange),
+            detector.received(),
+            detector.highest(),
+            detector.gaps(),
+            detector.missing(),
+            detector.duplicates(),
+            detector.reorders(),
+            detector.stales(),
+            detector.resets()
+        );
+    }
+
+    if (m_feed_arbitrator == nullptr)
+        return;
+
+    for (size_t line = 0; line < m_feed_arbitrator->line_size(); line++) {
+        const auto& stats = m_feed_arbitrator->stats(line);
+
+        logger->info(
+            "Line {}: received {}, wins {} ({:.2f}%), losses {}, stales {}, average lag {:.1f}us, max lag {}us",
+            static_cast<char>('A' + line),
+            stats.received,
+            stats.wins,
+            m_feed_arbitrator->win_rate(line) * 100,
+            stats.losses,
+            stats.stales,
+            m_feed_arbitrator->average_lag(line),
+            stats.max_lag
+        );
+    }
+}
+
 void trade::broker::CUTMdImpl::booker(MessageBufferType& message_buffer)
 {
     booker::Booker booker(
@@ -220,70 +541,98 @@ void trade::broker::CUTMdImpl::booker(MessageBufferType& message_buffer)
         config->get<bool>("Performance.EnableAdvancedCalculating", false)
     ); /// TODO: Initialize tradable symbols here.
 
-    while (m_is_running) {
-        std::vector<u_char>* message;
+    std::vector<MessageType> messages(m_batch_size);
+    TickBatch ticks;
 
-        if (!message_buffer.pop(message))
-            continue;
+    while (true) {
+        const auto popped = message_buffer.pop(messages.data(), messages.size());
 
-        booker::OrderTickPtr order_tick;
-        booker::TradeTickPtr trade_tick;
-        booker::ExchangeL2SnapPtr generated_l2_tick;
-
-        switch (message->size()) {
-        case sizeof(SSEHpfTick): order_tick = CUTCommonData::to_order_tick<SSEHpfTick>(*message); break;
-        case sizeof(SSEHpfL2Snap): generated_l2_tick = CUTCommonData::to_l2_tick<SSEHpfL2Snap>(*message); break;
-        case sizeof(SZSEHpfOrderTick): order_tick = CUTCommonData::to_order_tick<SZSEHpfOrderTick>(*message); break;
-        case sizeof(SZSEHpfTradeTick): trade_tick = CUTCommonData::to_trade_tick<SZSEHpfTradeTick>(*message); break;
-        case sizeof(SZSEHpfL2Snap): generated_l2_tick = CUTCommonData::to_l2_tick<SZSEHpfL2Snap>(*message); break;
-        default: break;
-        }
+        if (popped == 0) {
+            /// Exit only after the receiver published its last batch and the
+            /// buffer is drained.
+            if (!m_is_receiving && message_buffer.read_available() == 0)
+                break;
 
-        /// SSE has no raw trade tick. We tell it by order type.
-        if (order_tick != nullptr && order_tick->order_type() == types::OrderType::fill) {
-            trade_tick = CUTCommonData::x_ost_forward_to_trade_from_order(order_tick);
-            assert(order_tick == nullptr);
+            continue;
         }
 
-        /// SZSE reports cancel orders as trade tick.
-        /// In this case, forward it to order tick.
-        if (trade_tick != nullptr && trade_tick->x_ost_szse_exe_type() == types::OrderType::cancel) {
-            order_tick = CUTCommonData::x_ost_forward_to_order_from_trade(trade_tick);
-            assert(trade_tick == nullptr);
+        booker.begin_batch();
+
+        for (size_t i = 0; i < popped; i++) {
+            book(booker, *messages[i], ticks);
+
+            /// boost::freelock::queue imposes a constraint that its elements
+            /// must have trivial destructors. Consequently, usage of
+            /// std::unique_ptr/std::shared_ptr is not viable here.
+            /// We need delete message manually.
+            delete messages[i];
         }
 
-        if (order_tick != nullptr) {
-            if (order_tick->exchange_time() >= 93000000) [[likely]]
-                booker.switch_to_continuous_stage();
+        booker.end_batch();
+
+        m_reporter->exchange_order_ticks_arrived(ticks.order_ticks);
+        m_reporter->exchange_trade_ticks_arrived(ticks.trade_ticks);
+        m_reporter->exchange_l2_snaps_arrived(ticks.l2_snaps);
+
+        ticks.order_ticks.clear();
+        ticks.trade_ticks.clear();
+        ticks.l2_snaps.clear();
+    }
+}
 
-            logger->debug("Received order tick: {}", utilities::ToJSON()(*order_tick));
+void trade::broker::CUTMdImpl::book(booker::Booker& booker, const std::vector<u_char>& message, TickBatch& ticks) const
+{
+    booker::OrderTickPtr order_tick;
+    booker::TradeTickPtr trade_tick;
+    booker::ExchangeL2SnapPtr generated_l2_tick;
+
+    switch (message.size()) {
+    case sizeof(SSEHpfTick): order_tick = CUTCommonData::to_order_tick<SSEHpfTick>(message); break;
+    case sizeof(SSEHpfL2Snap): generated_l2_tick = CUTCommonData::to_l2_tick<SSEHpfL2Snap>(message); break;
+    case sizeof(SZSEHpfOrderTick): order_tick = CUTCommonData::to_order_tick<SZSEHpfOrderTick>(message); break;
+    case sizeof(SZSEHpfTradeTick): trade_tick = CUTCommonData::to_trade_tick<SZSEHpfTradeTick>(message); break;
+    case sizeof(SZSEHpfL2Snap): generated_l2_tick = CUTCommonData::to_l2_tick<SZSEHpfL2Snap>(message); break;
+    default: break;
+    }
 
-            booker.add(order_tick);
+    /// SSE has no raw trade tick. We tell it by order type.
+    if (order_tick != nullptr && order_tick->order_type() == types::OrderType::fill) {
+        trade_tick = CUTCommonData::x_ost_forward_to_trade_from_order(order_tick);
+        assert(order_tick == nullptr);
+    }
 
-            m_reporter->exchange_order_tick_arrived(order_tick);
-        }
+    /// SZSE reports cancel orders as trade tick.
+    /// In this case, forward it to order tick.
+    if (trade_tick != nullptr && trade_tick->x_ost_szse_exe_type() == types::OrderType::cancel) {
+        order_tick = CUTCommonData::x_ost_forward_to_order_from_trade(trade_tick);
+        assert(trade_tick == nullptr);
+    }
 
-        if (trade_tick != nullptr) {
-            if (trade_tick->exchange_time() >= 93000000) [[likely]]
-                booker.switch_to_continuous_stage();
+    if (order_tick != nullptr) {
+        if (order_tick->exchange_time() >= 93000000) [[likely]]
+            booker.switch_to_continuous_stage();
 
-            logger->debug("Received trade tick: {}", utilities::ToJSON()(*trade_tick));
+        logger->debug("Received order tick: {}", utilities::ToJSON()(*order_tick));
 
-            booker.trade(trade_tick);
+        booker.add(order_tick);
 
-            m_reporter->exchange_trade_tick_arrived(trade_tick);
-        }
+        ticks.order_ticks.push_back(order_tick);
+    }
 
-        if (generated_l2_tick != nullptr) {
-            logger->debug("Received l2 tick: {}", utilities::ToJSON()(*generated_l2_tick));
+    if (trade_tick != nullptr) {
+        if (trade_tick->exchange_time() >= 93000000) [[likely]]
+            booker.switch_to_continuous_stage();
 
-            m_reporter->exchange_l2_snap_arrived(generated_l2_tick);
-        }
+        logger->debug("Received trade tick: {}", utilities::ToJSON()(*trade_tick));
 
-        /// boost::freelock::queue imposes a constraint that its elements
-        /// must have trivial destructors. Consequently, usage of
-        /// std::unique_ptr/std::shared_ptr is not viable here.
-        /// We need delete message manually.
-        delete message;
+        booker.trade(trade_tick);
+
+        ticks.trade_ticks.push_back(trade_tick);
+    }
+
+    if (generated_l2_tick != nullptr) {
+        logger->debug("Received l2 tick: {}", utilities::ToJSON()(*generated_l2_tick));
+
+        ticks.l2_snaps.push_back(generated_l2_tick);
     }
 }
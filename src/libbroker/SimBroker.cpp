@@ -0,0 +1,59 @@
+#include "libbroker/SimBroker.h"
+
+trade::broker::SimBroker::SimBroker(
+    const std::string& config_path,
+    const std::shared_ptr<holder::IHolder>& holder,
+    const std::shared_ptr<reporter::IReporter>& reporter
+) : BrokerProxy("SimBroker", holder, reporter, config_path)
+{
+}
+
+void trade::broker::SimBroker::start_login() noexcept
+{
+    BrokerProxy::start_login();
+
+    m_trader_impl = std::make_shared<SimTraderImpl>(config, m_holder, trade_reporter(), m_reporter, this);
+}
+
+void trade::broker::SimBroker::start_logout() noexcept
+{
+    BrokerProxy::start_logout();
+
+    /// Md impls keep trader impl as their reporter.
+    unsubscribe({});
+    m_trader_impl.reset();
+}
+
+void trade::broker::SimBroker::send_order(const std::shared_ptr<types::NewOrderReq> new_order_req, const std::shared_ptr<types::NewOrderRsp> new_order_rsp)
+{
+    m_trader_impl->new_order(new_order_req, new_order_rsp);
+}
+
+void trade::broker::SimBroker::send_cancel(const std::shared_ptr<types::NewCancelReq> new_cancel_req, const std::shared_ptr<types::NewCancelRsp> new_cancel_rsp)
+{
+    m_trader_impl->cancel_order(new_cancel_req, new_cancel_rsp);
+}
+
+void trade::broker::SimBroker::subscribe(const std::unordered_set<std::string>& symbols)
+{
+    /// Orders are matched only if trade is logged in before.
+    const std::shared_ptr<reporter::IReporter> md_reporter = m_trader_impl != nullptr ? m_trader_impl : m_reporter;
+
+    if (config->get<std::string>("Server.TickFile", "").empty()) {
+        m_pcap_md_impl = std::make_unique<CUTMdImpl>(config, m_holder, md_reporter);
+        m_pcap_md_impl->subscribe(symbols);
+    }
+    else {
+        m_csv_md_impl = std::make_unique<SimMdImpl>(config, m_holder, md_reporter);
+        m_csv_md_impl->subscribe(symbols);
+    }
+}
+
+void trade::broker::SimBroker::unsubscribe(const std::unordered_set<std::string>& symbols)
+{
+    m_pcap_md_impl != nullptr ? m_pcap_md_impl->unsubscribe(symbols) : void();
+    m_pcap_md_impl.reset();
+
+    m_csv_md_impl != nullptr ? m_csv_md_impl->unsubscribe(symbols) : void();
+    m_csv_md_impl.reset();
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <fast-cpp-csv-parser/csv.h>
+#include <utility>
+
+#include "libbroker/SimImpl/SimMdImpl.h"
+
+trade::broker::SimMdImpl::SimMdImpl(
+    std::shared_ptr<ConfigType> config,
+    std::shared_ptr<holder::IHolder> holder,
+    std::shared_ptr<reporter::IReporter> reporter
+) : AppBase("SimMdImpl", std::move(config)),
+    m_batch_size(std::max<size_t>(AppBase::config->get<size_t>("Performance.BatchSize", 32), 1)),
+    m_replay_speed(AppBase::config->get<double>("Simulation.ReplaySpeed", 0)),
+    m_holder(std::move(holder)),
+    m_reporter(std::move(reporter))
+{
+}
+
+trade::broker::SimMdImpl::~SimMdImpl()
+{
+    unsubscribe({});
+}
+
+void trade::broker::SimMdImpl::subscribe(const std::unordered_set<std::string>& symbols)
+{
+    if (m_is_running.exchange(true)) {
+        logger->warn("Replay is running, subscription of {} symbols ignored", symbols.size());
+        return;
+    }
+
+    m_replayer_thread.joinable() ? m_replayer_thread.join() : void();
+    m_replayer_thread = std::thread(&SimMdImpl::replayer, this, symbols);
+}
+
+void trade::broker::SimMdImpl::unsubscribe(const std::unordered_set<std::string>& symbols)
+{
+    if (!symbols.empty())
+        return;
+
+    m_is_running = false;
+
+    m_replayer_thread.joinable() ? m_replayer_thread.join() : void();
+}
+
+void trade::broker::SimMdImpl::replayer(const std::unordered_set<std::string> symbols)
+{
+    const auto tick_file = config->get<std::string>("Server.TickFile");
+
+    booker::Booker booker(
+        {},
+        m_reporter,
+        config->get<bool>("Performance.EnableVerification", false),
+        config->get<bool>("Performance.EnableAdvancedCalculating", false)
+    );
+
+    std::vector<booker::OrderTickPtr> order_ticks;
+    std::vector<booker::TradeTickPtr> trade_ticks;
+
+    /// Reports ticks booked since last flush.
+    const auto flush = [this, &booker, &order_ticks, &trade_ticks] {
+        booker.end_batch();
+
+        m_reporter->exchange_order_ticks_arrived(order_ticks);
+        m_reporter->exchange_trade_ticks_arrived(trade_ticks);
+
+        order_ticks.clear();
+        trade_ticks.clear();
+
+        booker.begin_batch();
+    };
+
+    size_t rows = 0;
+
+    try {
+        io::CSVReader<8> in(tick_file);
+
+        in.read_header(
+            io::ignore_extra_column,
+            "symbol",
+            "ask_unique_id",
+            "bid_unique_id",
+            "order_type",
+            "price",
+            "quantity",
+            "date",
+            "time"
+        );
+
+        std::string symbol;
+        int64_t ask_unique_id;
+        int64_t bid_unique_id;
+        char order_type;
+        double price;
+        int64_t quantity;
+        int64_t date;
+        int64_t time;
+
+        const auto start        = std::chrono::steady_clock::now();
+        int64_t first_timestamp = -1;
+
+        booker.begin_batch();
+
+        while (m_is_running && in.read_row(symbol, ask_unique_id, bid_unique_id, order_type, price, quantity, date, time)) {
+            if (!symbols.empty() && !symbols.contains(symbol))
+                continue;
+
+            /// time example: 20210701092500000.
+            const int64_t exchange_time = time % 1000000000;
+
+            /// Paced by exchange time, ticks are not held while waiting.
+            if (m_replay_speed > 0) {
+                const int64_t timestamp = to_milliseconds(exchange_time);
+                first_timestamp < 0 ? void(first_timestamp = timestamp) : void();
+
+                const auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>((timestamp - first_timestamp) / m_replay_speed));
+
+                if (due > std::chrono::steady_clock::now()) {
+                    flush();
+                    std::this_thread::sleep_until(due);
+                }
+            }
+
+            exchange_time >= 93000000 ? booker.switch_to_continuous_stage() : void();
+
+            if (const auto type = to_order_type(order_type); type == types::OrderType::fill) {
+                const auto trade_tick = std::make_shared<types::TradeTick>();
+
+                trade_tick->set_ask_unique_id(ask_unique_id);
+                trade_tick->set_bid_unique_id(bid_unique_id);
+                trade_tick->set_symbol(symbol);
+                trade_tick->set_exec_price_1000x(static_cast<int64_t>(price * 1000));
+                trade_tick->set_exec_quantity(quantity);
+                trade_tick->set_exchange_date(date);
+                trade_tick->set_exchange_time(exchange_time);
+
+                booker.trade(trade_tick);
+
+                trade_ticks.push_back(trade_tick);
+            }
+            else if (type != types::OrderType::invalid_order_type) {
+                const auto order_tick = std::make_shared<types::OrderTick>();
+
+                order_tick->set_unique_id(ask_unique_id + bid_unique_id);
+                order_tick->set_order_type(type);
+                order_tick->set_symbol(symbol);
+                order_tick->set_side(ask_unique_id == 0 ? types::SideType::buy : types::SideType::sell);
+                order_tick->set_price_1000x(static_cast<int64_t>(price * 1000));
+                order_tick->set_quantity(quantity);
+                order_tick->set_exchange_date(date);
+                order_tick->set_exchange_time(exchange_time);
+
+                booker.add(order_tick);
+
+                order_ticks.push_back(order_tick);
+            }
+            else {
+                logger->error("Invalid order type {} of {} at {}", order_type, symbol, time);
+                continue;
+            }
+
+            ++rows % m_batch_size == 0 ? flush() : void();
+        }
+    }
+    catch (const std::exception& e) {
+        logger->error("Failed to replay {}: {}", tick_file, e.what());
+    }
+
+    flush();
+    booker.end_batch();
+
+    logger->info("Replayed {} ticks from {}", rows, tick_file);
+}
+
+trade::types::OrderType trade::broker::SimMdImpl::to_order_type(const char order_type)
+{
+    switch (order_type) {
+    case 'L': return types::OrderType::limit;
+    case 'M': return types::OrderType::market;
+    case 'B': return types::OrderType::best_price;
+    case 'C': return types::OrderType::cancel;
+    case 'T': return types::OrderType::fill;
+    default: return types::OrderType::invalid_order_type;
+    }
+}
+
+int64_t trade::broker::SimMdImpl::to_milliseconds(const int64_t time)
+{
+    return (time / 10000000 * 3600 + time / 100000 % 100 * 60 + time / 1000 % 100) * 1000 + time % 1000;
+}
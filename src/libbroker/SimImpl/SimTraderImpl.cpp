@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "libbroker/SimImpl/SimTraderImpl.h"
+#include "utilities/TimeHelper.hpp"
+
+trade::broker::SimTraderImpl::SimTraderImpl(
+    std::shared_ptr<ConfigType> config,
+    std::shared_ptr<holder::IHolder> holder,
+    std::shared_ptr<reporter::IReporter> reporter,
+    const std::shared_ptr<reporter::IReporter>& md_reporter,
+    utilities::LoginSyncer* parent
+) : AppBase("SimTraderImpl", std::move(config)),
+    NopReporter(md_reporter),
+    m_broker_latency(AppBase::config->get<int64_t>("Simulation.BrokerLatency", 100)),
+    m_exchange_latency(AppBase::config->get<int64_t>("Simulation.ExchangeLatency", 500)),
+    m_holder(std::move(holder)),
+    m_reporter(std::move(reporter)),
+    m_md_reporter(md_reporter),
+    m_parent(parent)
+{
+    m_scheduler_thread = std::thread(&SimTraderImpl::scheduler, this);
+
+    logger->info("Logged in to simulated exchange with broker latency {}us and exchange latency {}us", m_broker_latency.count(), m_exchange_latency.count());
+
+    m_parent->notify_login_success();
+}
+
+trade::broker::SimTraderImpl::~SimTraderImpl()
+{
+    {
+        std::lock_guard lock(m_events_mutex);
+        m_is_running = false;
+    }
+
+    m_events_cv.notify_one();
+
+    /// Pending events are still run.
+    m_scheduler_thread.joinable() ? m_scheduler_thread.join() : void();
+
+    logger->info("Logged out from simulated exchange with {} orders working", m_matcher.size());
+
+    m_parent->notify_logout_success();
+}
+
+void trade::broker::SimTraderImpl::new_order(
+    const std::shared_ptr<types::NewOrderReq>& new_order_req,
+    const std::shared_ptr<types::NewOrderRsp>& new_order_rsp
+)
+{
+    /// Kept as the order in holder, written with broker_id/exchange_id once
+    /// accepted by exchange.
+    const auto orders = std::make_shared<types::Orders>();
+    const auto order  = orders->add_orders();
+
+    order->set_unique_id(new_order_req->unique_id());
+    order->set_symbol(new_order_req->symbol());
+    order->set_side(new_order_req->side());
+    order->set_position_side(new_order_req->position_side());
+    order->set_price(new_order_req->price());
+    order->set_quantity(new_order_req->quantity());
+    order->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    schedule(std::chrono::steady_clock::now() + m_broker_latency, [this, orders] {
+        broker_order(orders);
+    });
+}
+
+void trade::broker::SimTraderImpl::cancel_order(
+    const std::shared_ptr<types::NewCancelReq>& new_cancel_req,
+    const std::shared_ptr<types::NewCancelRsp>& new_cancel_rsp
+)
+{
+    schedule(std::chrono::steady_clock::now() + m_broker_latency, [this, new_cancel_req] {
+        broker_cancel(new_cancel_req);
+    });
+}
+
+void trade::broker::SimTraderImpl::l2_tick_generated(const std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick)
+{
+    std::vector<SimMatcher::Fill> fills;
+
+    {
+        std::lock_guard lock(m_matcher_mutex);
+        m_matcher.update(*generated_l2_tick, fills);
+    }
+
+    report(fills);
+
+    NopReporter::l2_tick_generated(generated_l2_tick);
+}
+
+void trade::broker::SimTraderImpl::exchange_order_ticks_arrived(const std::span<const std::shared_ptr<types::OrderTick>> order_ticks)
+{
+    m_md_reporter->exchange_order_ticks_arrived(order_ticks);
+}
+
+void trade::broker::SimTraderImpl::exchange_trade_ticks_arrived(const std::span<const std::shared_ptr<types::TradeTick>> trade_ticks)
+{
+    m_md_reporter->exchange_trade_ticks_arrived(trade_ticks);
+}
+
+void trade::broker::SimTraderImpl::exchange_l2_snaps_arrived(const std::span<const std::shared_ptr<types::ExchangeL2Snap>> exchange_l2_snaps)
+{
+    m_md_reporter->exchange_l2_snaps_arrived(exchange_l2_snaps);
+}
+
+void trade::broker::SimTraderImpl::l2_ticks_generated(const std::span<const std::shared_ptr<types::GeneratedL2Tick>> generated_l2_ticks)
+{
+    std::vector<SimMatcher::Fill> fills;
+
+    {
+        std::lock_guard lock(m_matcher_mutex);
+
+        for (const auto& generated_l2_tick : generated_l2_ticks)
+            m_matcher.update(*generated_l2_tick, fills);
+    }
+
+    report(fills);
+
+    m_md_reporter->l2_ticks_generated(generated_l2_ticks);
+}
+
+void trade::broker::SimTraderImpl::ranged_ticks_generated(const std::span<const std::shared_ptr<types::RangedTick>> ranged_ticks)
+{
+    m_md_reporter->ranged_ticks_generated(ranged_ticks);
+}
+
+void trade::broker::SimTraderImpl::broker_order(const std::shared_ptr<types::Orders>& orders)
+{
+    const auto& order = orders->orders(0);
+
+    /// Checked by broker as a real counter does.
+    if (order.quantity() <= 0 || order.price() <= 0) [[unlikely]] {
+        const auto order_rejection = std::make_shared<types::OrderRejection>();
+
+        order_rejection->set_original_unique_id(order.unique_id());
+        order_rejection->set_rejection_code(order.quantity() <= 0 ? types::RejectionCode::invalid_quantity : types::RejectionCode::invalid_price);
+        order_rejection->set_rejection_reason("Rejected by simulated broker");
+        order_rejection->set_allocated_rejection_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+        m_reporter->order_rejected(order_rejection);
+
+        return;
+    }
+
+    const auto broker_acceptance = std::make_shared<types::BrokerAcceptance>();
+
+    broker_acceptance->set_unique_id(order.unique_id());
+    broker_acceptance->set_broker_id(to_broker_id(order.unique_id()));
+    broker_acceptance->set_allocated_broker_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    m_reporter->broker_accepted(broker_acceptance);
+
+    schedule(std::chrono::steady_clock::now() + m_exchange_latency, [this, orders] {
+        exchange_order(orders);
+    });
+}
+
+void trade::broker::SimTraderImpl::broker_cancel(const std::shared_ptr<types::NewCancelReq>& new_cancel_req)
+{
+    const auto cancel_broker_acceptance = std::make_shared<types::CancelBrokerAcceptance>();
+
+    cancel_broker_acceptance->set_original_unique_id(new_cancel_req->original_unique_id());
+    cancel_broker_acceptance->set_original_broker_id(to_broker_id(new_cancel_req->original_unique_id()));
+    cancel_broker_acceptance->set_allocated_broker_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    m_reporter->cancel_broker_accepted(cancel_broker_acceptance);
+
+    schedule(std::chrono::steady_clock::now() + m_exchange_latency, [this, new_cancel_req] {
+        exchange_cancel(new_cancel_req);
+    });
+}
+
+void trade::broker::SimTraderImpl::exchange_order(const std::shared_ptr<types::Orders>& orders)
+{
+    const auto order        = orders->mutable_orders(0);
+    const int64_t unique_id = order->unique_id();
+
+    std::vector<SimMatcher::Fill> fills;
+    bool is_added;
+
+    {
+        std::lock_guard lock(m_matcher_mutex);
+
+        is_added = m_matcher.add(
+            unique_id,
+            order->symbol(),
+            order->side() == types::SideType::buy,
+            std::llround(order->price() * 1000),
+            order->quantity(),
+            fills
+        );
+    }
+
+    if (!is_added) [[unlikely]] {
+        const auto order_rejection = std::make_shared<types::OrderRejection>();
+
+        order_rejection->set_original_unique_id(unique_id);
+        order_rejection->set_original_broker_id(to_broker_id(unique_id));
+        order_rejection->set_rejection_code(types::RejectionCode::repeated_unique_id);
+        order_rejection->set_rejection_reason("Rejected by simulated exchange");
+        order_rejection->set_allocated_rejection_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+        m_reporter->order_rejected(order_rejection);
+
+        return;
+    }
+
+    const auto exchange_acceptance = std::make_shared<types::ExchangeAcceptance>();
+
+    exchange_acceptance->set_unique_id(unique_id);
+    exchange_acceptance->set_exchange_id(to_exchange_id(unique_id));
+    exchange_acceptance->set_allocated_exchange_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    m_reporter->exchange_accepted(exchange_acceptance);
+
+    report(fills);
+
+    /// Written behind by holder, broker_id/exchange_id are kept in memory
+    /// until then.
+    order->set_broker_id(to_broker_id(unique_id));
+    order->set_exchange_id(to_exchange_id(unique_id));
+    order->set_allocated_update_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    m_holder->update_orders(orders);
+}
+
+void trade::broker::SimTraderImpl::exchange_cancel(const std::shared_ptr<types::NewCancelReq>& new_cancel_req)
+{
+    const int64_t unique_id = new_cancel_req->original_unique_id();
+
+    std::optional<int64_t> canceled_quantity;
+
+    {
+        std::lock_guard lock(m_matcher_mutex);
+        canceled_quantity = m_matcher.cancel(unique_id);
+    }
+
+    if (!canceled_quantity.has_value()) {
+        const auto cancel_order_rejection = std::make_shared<types::CancelOrderRejection>();
+
+        cancel_order_rejection->set_original_unique_id(unique_id);
+        cancel_order_rejection->set_original_broker_id(to_broker_id(unique_id));
+        cancel_order_rejection->set_original_exchange_id(to_exchange_id(unique_id));
+        /// Unknown orders are not told from filled ones.
+        cancel_order_rejection->set_rejection_code(types::RejectionCode::all_trade);
+        cancel_order_rejection->set_rejection_reason("Order is not working on simulated exchange");
+        cancel_order_rejection->set_allocated_rejection_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+        m_reporter->cancel_order_rejected(cancel_order_rejection);
+
+        return;
+    }
+
+    const auto cancel_exchange_acceptance = std::make_shared<types::CancelExchangeAcceptance>();
+
+    cancel_exchange_acceptance->set_original_unique_id(unique_id);
+    cancel_exchange_acceptance->set_original_broker_id(to_broker_id(unique_id));
+    cancel_exchange_acceptance->set_original_exchange_id(to_exchange_id(unique_id));
+    cancel_exchange_acceptance->set_allocated_exchange_acceptance_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    m_reporter->cancel_exchange_accepted(cancel_exchange_acceptance);
+
+    const auto cancel_success = std::make_shared<types::CancelSuccess>();
+
+    cancel_success->set_original_unique_id(unique_id);
+    cancel_success->set_original_broker_id(to_broker_id(unique_id));
+    cancel_success->set_original_exchange_id(to_exchange_id(unique_id));
+    cancel_success->set_canceled_quantity(canceled_quantity.value());
+    cancel_success->set_allocated_canceled_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+    m_reporter->cancel_success(cancel_success);
+}
+
+void trade::broker::SimTraderImpl::report(const std::vector<SimMatcher::Fill>& fills) const
+{
+    for (const auto& fill : fills) {
+        const auto trade = std::make_shared<types::Trade>();
+
+        trade->set_unique_id(fill.unique_id);
+        trade->set_broker_id(to_broker_id(fill.unique_id));
+        trade->set_exchange_id(to_exchange_id(fill.unique_id));
+        trade->set_symbol(fill.symbol);
+        trade->set_side(fill.is_buy ? types::SideType::buy : types::SideType::sell);
+        trade->set_price(static_cast<double>(fill.price_1000x) / 1000);
+        trade->set_quantity(fill.quantity);
+        trade->set_cumulative_quantity(fill.cumulative_quantity);
+        trade->set_allocated_creation_time(utilities::Now<google::protobuf::Timestamp*>()());
+
+        m_reporter->trade_accepted(trade);
+    }
+}
+
+std::string trade::broker::SimTraderImpl::to_broker_id(const int64_t unique_id)
+{
+    return std::to_string(unique_id);
+}
+
+std::string trade::broker::SimTraderImpl::to_exchange_id(const int64_t unique_id)
+{
+    return fmt::format("SIM:{}", unique_id);
+}
+
+void trade::broker::SimTraderImpl::schedule(const std::chrono::steady_clock::time_point due, std::function<void()> task)
+{
+    {
+        std::lock_guard lock(m_events_mutex);
+
+        m_events.push_back({due, m_event_seq++, std::move(task)});
+        std::ranges::push_heap(m_events, std::greater<>());
+    }
+
+    m_events_cv.notify_one();
+}
+
+void trade::broker::SimTraderImpl::scheduler()
+{
+    std::unique_lock lock(m_events_mutex);
+
+    while (true) {
+        if (m_events.empty()) {
+            if (!m_is_running)
+                break;
+
+            m_events_cv.wait(lock);
+            continue;
+        }
+
+        /// Woken up earlier by a new event, which may be due before.
+        if (const auto due = m_events.front().due; std::chrono::steady_clock::now() < due) {
+            m_events_cv.wait_until(lock, due);
+            continue;
+        }
+
+        std::ranges::pop_heap(m_events, std::greater<>());
+
+        const auto task = std::move(m_events.back().task);
+        m_events.pop_back();
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+
+#include "libholder/MemoryHolder.h"
+#include "utilities/ToJSON.hpp"
+
+trade::holder::MemoryHolder::MemoryHolder(
+    const std::string& snapshot_path,
+    const std::chrono::seconds snapshot_interval
+) : AppBase("MemoryHolder"),
+    m_snapshot_path(snapshot_path),
+    m_snapshot_interval(snapshot_interval)
+{
+    if (m_snapshot_path.empty())
+        return;
+
+    restore();
+
+    if (m_snapshot_interval.count() > 0) {
+        m_snapshot_thread = std::thread(&MemoryHolder::snapshot_periodically, this);
+    }
+}
+
+trade::holder::MemoryHolder::~MemoryHolder()
+{
+    {
+        std::lock_guard lock(m_running_mutex);
+        m_is_running = false;
+    }
+
+    m_running_cv.notify_one();
+
+    if (m_snapshot_thread.joinable())
+        m_snapshot_thread.join();
+
+    if (m_snapshot_path.empty())
+        return;
+
+    try {
+        snapshot();
+    }
+    catch (const std::exception& e) {
+        logger->error("Failed to snapshot on exit: {}", e.what());
+    }
+}
+
+int64_t trade::holder::MemoryHolder::update_symbols(const std::shared_ptr<types::Symbols> symbols)
+{
+    for (const auto& symbol : symbols->symbols())
+        m_symbols.put(symbol.symbol(), std::make_shared<const types::Symbol>(symbol));
+
+    return symbols->symbols_size();
+}
+
+std::shared_ptr<trade::types::Symbols> trade::holder::MemoryHolder::query_symbols_by_symbol(const std::string& symbol)
+{
+    auto symbols = std::make_shared<types::Symbols>();
+
+    const auto kept = m_symbols.find(symbol);
+    kept == nullptr ? void() : symbols->add_symbols()->CopyFrom(*kept);
+
+    return symbols;
+}
+
+std::shared_ptr<trade::types::Symbols> trade::holder::MemoryHolder::query_symbols_by_exchange(const types::ExchangeType exchange)
+{
+    auto symbols = std::make_shared<types::Symbols>();
+
+    /// Scanned, symbols are few and rarely queried by exchange.
+    m_symbols.for_each([&symbols, exchange](const types::Symbol& symbol) {
+        symbol.exchange() == exchange ? symbols->add_symbols()->CopyFrom(symbol) : void();
+    });
+
+    return symbols;
+}
+
+int64_t trade::holder::MemoryHolder::update_funds(const std::shared_ptr<types::Funds> funds)
+{
+    for (const auto& fund : funds->funds())
+        m_funds.put(fund.account_id(), std::make_shared<const types::Fund>(fund));
+
+    return funds->funds_size();
+}
+
+std::shared_ptr<trade::types::Funds> trade::holder::MemoryHolder::query_funds_by_account_id(const std::string& account_id)
+{
+    auto funds = std::make_shared<types::Funds>();
+
+    const auto kept = m_funds.find(account_id);
+    kept == nullptr ? void() : funds->add_funds()->CopyFrom(*kept);
+
+    return funds;
+}
+
+int64_t trade::holder::MemoryHolder::update_positions(const std::shared_ptr<types::Positions> positions)
+{
+    for (const auto& position : positions->positions())
+        m_positions.put(position.symbol(), std::make_shared<const types::Position>(position));
+
+    return positions->positions_size();
+}
+
+std::shared_ptr<trade::types::Positions> trade::holder::MemoryHolder::query_positions_by_symbol(const std::string& symbol)
+{
+    auto positions = std::make_shared<types::Positions>();
+
+    const auto kept = m_positions.find(symbol);
+    kept == nullptr ? void() : positions->add_positions()->CopyFrom(*kept);
+
+    return positions;
+}
+
+int64_t trade::holder::MemoryHolder::update_orders(const std::shared_ptr<types::Orders> orders)
+{
+    for (const auto& order : orders->orders()) {
+        if (order.unique_id() == INVALID_ID) {
+            logger->warn("No Unique ID for order: {}", utilities::ToJSON()(order));
+            continue;
+        }
+
+        /// Message is copied before locking the shard of order.
+        auto kept = std::make_shared<const types::Order>(order);
+
+        /// Indexes are updated under the lock of order, so that updates of
+        /// the same order never interleave.
+        m_orders.put(order.unique_id(), std::move(kept), [this, &order](const std::shared_ptr<const types::Order>& previous) {
+            const bool is_broker_id_changed   = previous == nullptr || previous->broker_id() != order.broker_id() || previous->has_broker_id() != order.has_broker_id();
+            const bool is_exchange_id_changed = previous == nullptr || previous->exchange_id() != order.exchange_id() || previous->has_exchange_id() != order.has_exchange_id();
+
+            if (is_broker_id_changed) {
+                previous != nullptr && previous->has_broker_id() ? unindex(m_broker_ids, previous->broker_id(), order.unique_id()) : void();
+                order.has_broker_id() ? index(m_broker_ids, order.broker_id(), order.unique_id()) : void();
+            }
+
+            if (is_exchange_id_changed) {
+                previous != nullptr && previous->has_exchange_id() ? unindex(m_exchange_ids, previous->exchange_id(), order.unique_id()) : void();
+                order.has_exchange_id() ? index(m_exchange_ids, order.exchange_id(), order.unique_id()) : void();
+            }
+        });
+    }
+
+    return orders->orders_size();
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::MemoryHolder::query_orders_by_unique_id(const int64_t unique_id)
+{
+    auto orders = std::make_shared<types::Orders>();
+
+    const auto kept = m_orders.find(unique_id);
+    kept == nullptr ? void() : orders->add_orders()->CopyFrom(*kept);
+
+    return orders;
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::MemoryHolder::query_orders_by_broker_id(const std::string& broker_id)
+{
+    return query_orders_by(m_broker_ids, broker_id, &types::Order::broker_id);
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::MemoryHolder::query_orders_by_exchange_id(const std::string& exchange_id)
+{
+    return query_orders_by(m_exchange_ids, exchange_id, &types::Order::exchange_id);
+}
+
+void trade::holder::MemoryHolder::snapshot() const
+{
+    std::lock_guard lock(m_snapshot_mutex);
+
+    types::Symbols symbols;
+    m_symbols.for_each([&symbols](const types::Symbol& symbol) { symbols.add_symbols()->CopyFrom(symbol); });
+
+    types::Funds funds;
+    m_funds.for_each([&funds](const types::Fund& fund) { funds.add_funds()->CopyFrom(fund); });
+
+    types::Positions positions;
+    m_positions.for_each([&positions](const types::Position& position) { positions.add_positions()->CopyFrom(position); });
+
+    types::Orders orders;
+    m_orders.for_each([&orders](const types::Order& order) { orders.add_orders()->CopyFrom(order); });
+
+    const std::filesystem::path path = m_snapshot_path;
+    const std::filesystem::path temp = m_snapshot_path + ".tmp";
+
+    if (path.has_parent_path() && !exists(path.parent_path())) {
+        create_directories(path.parent_path());
+    }
+
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+
+        file.write(snapshot_magic, sizeof(snapshot_magic));
+        file.write(reinterpret_cast<const char*>(&snapshot_version), sizeof(snapshot_version));
+
+        /// Each table is a size followed by the serialized message.
+        for (const google::protobuf::Message* message : std::initializer_list<const google::protobuf::Message*> {&symbols, &funds, &positions, &orders}) {
+            const std::string bytes = message->SerializeAsString();
+            const uint64_t size     = bytes.size();
+
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        file.flush();
+
+        if (!file) {
+            throw std::runtime_error(fmt::format("Failed to write snapshot {}", temp.string()));
+        }
+    }
+
+    /// Readers of snapshot never see a partial file.
+    std::filesystem::rename(temp, path);
+
+    logger->info("Snapshot {} symbols, {} funds, {} positions and {} orders to {}", symbols.symbols_size(), funds.funds_size(), positions.positions_size(), orders.orders_size(), m_snapshot_path);
+}
+
+void trade::holder::MemoryHolder::index(ShardedMap<std::string, UniqueIds>& index, const std::string& id, const int64_t unique_id)
+{
+    index.modify(id, [unique_id](const std::shared_ptr<const UniqueIds>& unique_ids) {
+        auto modified = unique_ids == nullptr ? std::make_shared<UniqueIds>() : std::make_shared<UniqueIds>(*unique_ids);
+        modified->push_back(unique_id);
+        return std::shared_ptr<const UniqueIds>(std::move(modified));
+    });
+}
+
+void trade::holder::MemoryHolder::unindex(ShardedMap<std::string, UniqueIds>& index, const std::string& id, const int64_t unique_id)
+{
+    index.modify(id, [unique_id](const std::shared_ptr<const UniqueIds>& unique_ids) -> std::shared_ptr<const UniqueIds> {
+        if (unique_ids == nullptr)
+            return nullptr;
+
+        auto modified = std::make_shared<UniqueIds>(*unique_ids);
+        std::erase(*modified, unique_id);
+
+        return modified->empty() ? nullptr : std::shared_ptr<const UniqueIds>(std::move(modified));
+    });
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::MemoryHolder::query_orders_by(
+    const ShardedMap<std::string, UniqueIds>& index,
+    const std::string& id,
+    const std::string& (types::Order::*id_of)() const
+) const
+{
+    auto orders = std::make_shared<types::Orders>();
+
+    const auto unique_ids = index.find(id);
+
+    if (unique_ids == nullptr)
+        return orders;
+
+    for (const auto unique_id : *unique_ids) {
+        const auto kept = m_orders.find(unique_id);
+
+        kept != nullptr && (*kept.*id_of)() == id ? orders->add_orders()->CopyFrom(*kept) : void();
+    }
+
+    return orders;
+}
+
+void trade::holder::MemoryHolder::restore()
+{
+    if (!std::filesystem::exists(m_snapshot_path)) {
+        logger->info("No snapshot {} to restore", m_snapshot_path);
+        return;
+    }
+
+    const auto file_size = std::filesystem::file_size(m_snapshot_path);
+    std::ifstream file(m_snapshot_path, std::ios::binary);
+
+    char magic[sizeof(snapshot_magic)];
+    uint32_t version = 0;
+
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+
+    if (!file || std::memcmp(magic, snapshot_magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(fmt::format("{} is not a snapshot of MemoryHolder", m_snapshot_path));
+    }
+
+    if (version != snapshot_version) {
+        throw std::runtime_error(fmt::format("Snapshot {} of version {} is not supported, expected {}", m_snapshot_path, version, snapshot_version));
+    }
+
+    const auto symbols   = std::make_shared<types::Symbols>();
+    const auto funds     = std::make_shared<types::Funds>();
+    const auto positions = std::make_shared<types::Positions>();
+    const auto orders    = std::make_shared<types::Orders>();
+
+    for (google::protobuf::Message* message : std::initializer_list<google::protobuf::Message*> {symbols.get(), funds.get(), positions.get(), orders.get()}) {
+        uint64_t size = 0;
+        file.read(reinterpret_cast<char*>(&size), sizeof(size));
+
+        if (!file || size > file_size) {
+            throw std::runtime_error(fmt::format("Snapshot {} is truncated or corrupted", m_snapshot_path));
+        }
+
+        std::string bytes(size, '\0');
+        file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+        if (!file || !message->ParseFromString(bytes)) {
+            throw std::runtime_error(fmt::format("Snapshot {} is truncated or corrupted", m_snapshot_path));
+        }
+    }
+
+    update_symbols(symbols);
+    update_funds(funds);
+    update_positions(positions);
+    update_orders(orders);
+
+    logger->info("Restored {} symbols, {} funds, {} positions and {} orders from {}", symbols->symbols_size(), funds->funds_size(), positions->positions_size(), orders->orders_size(), m_snapshot_path);
+}
+
+void trade::holder::MemoryHolder::snapshot_periodically()
+{
+    std::unique_lock lock(m_running_mutex);
+
+    while (!m_running_cv.wait_for(lock, m_snapshot_interval, [this] { return !m_is_running; })) {
+        lock.unlock();
+
+        try {
+            snapshot();
+        }
+        catch (const std::exception& e) {
+            logger->error("Failed to snapshot: {}", e.what());
+        }
+
+        lock.lock();
+    }
+}
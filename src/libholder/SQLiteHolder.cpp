@@ -1,12 +1,20 @@
+#include <algorithm>
 #include <filesystem>
 #include <fmt/format.h>
+#include <fmt/ranges.h>
 #include <google/protobuf/util/json_util.h>
+#include <google/protobuf/util/time_util.h>
+#include <utility>
+#include <vector>
 
 #include "libholder/SQLiteHolder.h"
-#include "utilities/TimeHelper.hpp"
 #include "utilities/ToJSON.hpp"
 
-trade::holder::SQLiteHolder::SQLiteHolder(const std::string& db_path)
+trade::holder::SQLiteHolder::SQLiteHolder(
+    const std::string& db_path,
+    const std::string& journal_mode,
+    const std::string& synchronous
+)
     : AppBase("SQLiteHolder"),
       m_symbol_table_name("symbols"),
       m_fund_table_name("funds"),
@@ -37,13 +45,26 @@ trade::holder::SQLiteHolder::SQLiteHolder(const std::string& db_path)
         throw std::runtime_error(fmt::format("Failed to enable foreign keys: {}", std::string(sqlite3_errmsg(m_db.get()))));
     }
 
+    /// WAL with synchronous NORMAL syncs on checkpoints only rather than every commit.
+    set_pragma("journal_mode", journal_mode, {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"});
+    set_pragma("synchronous", synchronous, {"OFF", "NORMAL", "FULL", "EXTRA"});
+
+    check_schema_version();
     prepare_database();
 }
 
+trade::holder::SQLiteBatch trade::holder::SQLiteHolder::batch()
+{
+    return SQLiteBatch(*this);
+}
+
 int64_t trade::holder::SQLiteHolder::update_symbols(const std::shared_ptr<types::Symbols> symbols)
 {
     start_transaction();
 
+    /// First failure, rolling back the whole update.
+    auto code = SQLITE_OK;
+
     for (const auto& symbol : symbols->symbols()) {
         sqlite3_reset(m_insert_symbols.get());
 
@@ -56,12 +77,11 @@ int64_t trade::holder::SQLiteHolder::update_symbols(const std::shared_ptr<types:
         m_exec_code = sqlite3_step(m_insert_symbols.get());
         if (m_exec_code != SQLITE_DONE) {
             logger->error("Failed to insert symbol {}: {}", symbol.symbol(), std::string(sqlite3_errmsg(m_db.get())));
+            code == SQLITE_OK ? void(code = m_exec_code) : void();
         }
     }
 
-    commit_or_rollback(SQLITE_OK);
-
-    return symbols->symbols_size();
+    return commit_or_rollback(code) ? symbols->symbols_size() : 0;
 }
 
 std::shared_ptr<trade::types::Symbols> trade::holder::SQLiteHolder::query_symbols_by_symbol(const std::string& symbol)
@@ -78,6 +98,9 @@ int64_t trade::holder::SQLiteHolder::update_funds(const std::shared_ptr<types::F
 {
     start_transaction();
 
+    /// First failure, rolling back the whole update.
+    auto code = SQLITE_OK;
+
     for (const auto& fund : funds->funds()) {
         sqlite3_reset(m_insert_funds.get());
 
@@ -87,23 +110,20 @@ int64_t trade::holder::SQLiteHolder::update_funds(const std::shared_ptr<types::F
         sqlite3_bind_double(m_insert_funds.get(), 4, fund.frozen_fund());
         sqlite3_bind_double(m_insert_funds.get(), 5, fund.frozen_margin());
         sqlite3_bind_double(m_insert_funds.get(), 6, fund.frozen_commission());
-        sqlite3_bind_text(m_insert_funds.get(), 7, utilities::ToTime<std::string>()(fund.update_time()).c_str(), SQLITE_AUTO_LENGTH, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(m_insert_funds.get(), 7, to_nanoseconds(fund.update_time()));
 
         m_exec_code = sqlite3_step(m_insert_funds.get());
         if (m_exec_code != SQLITE_DONE) {
             logger->error("Failed to insert fund {}: {}", fund.account_id(), std::string(sqlite3_errmsg(m_db.get())));
+            code == SQLITE_OK ? void(code = m_exec_code) : void();
         }
     }
 
-    commit_or_rollback(SQLITE_OK);
-
-    return funds->funds_size();
+    return commit_or_rollback(code) ? funds->funds_size() : 0;
 }
 
 std::shared_ptr<trade::types::Funds> trade::holder::SQLiteHolder::query_funds_by_account_id(const std::string& account_id)
 {
-    start_transaction();
-
     sqlite3_reset(m_query_funds_by_account_id.get());
 
     sqlite3_bind_text(m_query_funds_by_account_id.get(), 1, account_id.c_str(), SQLITE_AUTO_LENGTH, SQLITE_TRANSIENT);
@@ -119,12 +139,13 @@ std::shared_ptr<trade::types::Funds> trade::holder::SQLiteHolder::query_funds_by
         fund.set_frozen_fund(sqlite3_column_double(m_query_funds_by_account_id.get(), 3));
         fund.set_frozen_margin(sqlite3_column_double(m_query_funds_by_account_id.get(), 4));
         fund.set_frozen_commission(sqlite3_column_double(m_query_funds_by_account_id.get(), 5));
-        fund.set_allocated_update_time(utilities::ToTime<google::protobuf::Timestamp*>()(reinterpret_cast<const char*>(sqlite3_column_text(m_query_funds_by_account_id.get(), 6))));
+        fund.set_allocated_update_time(to_timestamp(sqlite3_column_int64(m_query_funds_by_account_id.get(), 6)));
 
         funds->add_funds()->CopyFrom(fund);
     }
 
-    commit_or_rollback(SQLITE_OK);
+    /// Finish the statement to end its read transaction.
+    sqlite3_reset(m_query_funds_by_account_id.get());
 
     return funds;
 }
@@ -133,6 +154,9 @@ int64_t trade::holder::SQLiteHolder::update_positions(const std::shared_ptr<type
 {
     start_transaction();
 
+    /// First failure, rolling back the whole update.
+    auto code = SQLITE_OK;
+
     for (const auto& position : positions->positions()) {
         sqlite3_reset(m_insert_positions.get());
 
@@ -153,23 +177,20 @@ int64_t trade::holder::SQLiteHolder::update_positions(const std::shared_ptr<type
                                      : sqlite3_bind_null(m_insert_positions.get(), 9);
         position.has_open_cost() ? sqlite3_bind_double(m_insert_positions.get(), 10, position.open_cost())
                                  : sqlite3_bind_null(m_insert_positions.get(), 10);
-        sqlite3_bind_text(m_insert_positions.get(), 11, utilities::ToTime<std::string>()(position.update_time()).c_str(), SQLITE_AUTO_LENGTH, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(m_insert_positions.get(), 11, to_nanoseconds(position.update_time()));
 
         m_exec_code = sqlite3_step(m_insert_positions.get());
         if (m_exec_code != SQLITE_DONE) {
             logger->error("Failed to insert position {}: {}", position.symbol(), std::string(sqlite3_errmsg(m_db.get())));
+            code == SQLITE_OK ? void(code = m_exec_code) : void();
         }
     }
 
-    commit_or_rollback(SQLITE_OK);
-
-    return positions->positions_size();
+    return commit_or_rollback(code) ? positions->positions_size() : 0;
 }
 
 std::shared_ptr<trade::types::Positions> trade::holder::SQLiteHolder::query_positions_by_symbol(const std::string& symbol)
 {
-    start_transaction();
-
     sqlite3_reset(m_query_positions_by_symbol.get());
 
     sqlite3_bind_text(m_query_positions_by_symbol.get(), 1, symbol.c_str(), SQLITE_AUTO_LENGTH, SQLITE_TRANSIENT);
@@ -196,12 +217,13 @@ std::shared_ptr<trade::types::Positions> trade::holder::SQLiteHolder::query_posi
             position.set_frozen_margin(sqlite3_column_double(m_query_positions_by_symbol.get(), 8));
         if (sqlite3_column_type(m_query_positions_by_symbol.get(), 9) != SQLITE_NULL)
             position.set_open_cost(sqlite3_column_double(m_query_positions_by_symbol.get(), 9));
-        position.set_allocated_update_time(utilities::ToTime<google::protobuf::Timestamp*>()(reinterpret_cast<const char*>(sqlite3_column_text(m_query_positions_by_symbol.get(), 10))));
+        position.set_allocated_update_time(to_timestamp(sqlite3_column_int64(m_query_positions_by_symbol.get(), 10)));
 
         positions->add_positions()->CopyFrom(position);
     }
 
-    commit_or_rollback(SQLITE_OK);
+    /// Finish the statement to end its read transaction.
+    sqlite3_reset(m_query_positions_by_symbol.get());
 
     return positions;
 }
@@ -210,6 +232,9 @@ int64_t trade::holder::SQLiteHolder::update_orders(const std::shared_ptr<types::
 {
     start_transaction();
 
+    /// First failure, rolling back the whole update.
+    auto code = SQLITE_OK;
+
     for (const auto& order : orders->orders()) {
         if (order.unique_id() == INVALID_ID) {
             logger->warn("No Unique ID for order: {}", utilities::ToJSON()(order));
@@ -229,18 +254,17 @@ int64_t trade::holder::SQLiteHolder::update_orders(const std::shared_ptr<types::
                                   : sqlite3_bind_null(m_insert_orders.get(), 6);
         sqlite3_bind_double(m_insert_orders.get(), 7, order.price());
         sqlite3_bind_int64(m_insert_orders.get(), 8, order.quantity());
-        sqlite3_bind_text(m_insert_orders.get(), 9, utilities::ToTime<std::string>()(order.creation_time()).c_str(), SQLITE_AUTO_LENGTH, SQLITE_TRANSIENT);
-        sqlite3_bind_text(m_insert_orders.get(), 10, utilities::ToTime<std::string>()(order.update_time()).c_str(), SQLITE_AUTO_LENGTH, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(m_insert_orders.get(), 9, to_nanoseconds(order.creation_time()));
+        sqlite3_bind_int64(m_insert_orders.get(), 10, to_nanoseconds(order.update_time()));
 
         m_exec_code = sqlite3_step(m_insert_orders.get());
         if (m_exec_code != SQLITE_DONE) {
             logger->error("Failed to insert order {}: {}", order.unique_id(), std::string(sqlite3_errmsg(m_db.get())));
+            code == SQLITE_OK ? void(code = m_exec_code) : void();
         }
     }
 
-    commit_or_rollback(SQLITE_OK);
-
-    return orders->orders_size();
+    return commit_or_rollback(code) ? orders->orders_size() : 0;
 }
 
 std::shared_ptr<trade::types::Orders> trade::holder::SQLiteHolder::query_orders_by_unique_id(const int64_t unique_id)
@@ -260,30 +284,182 @@ std::shared_ptr<trade::types::Orders> trade::holder::SQLiteHolder::query_orders_
 
 void trade::holder::SQLiteHolder::start_transaction() const
 {
+    if (m_is_in_batch)
+        return;
+
     sqlite3_exec(m_db.get(), "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
 }
 
-void trade::holder::SQLiteHolder::commit_or_rollback(const decltype(SQLITE_OK) code) const
+bool trade::holder::SQLiteHolder::commit_or_rollback(const decltype(SQLITE_OK) code)
 {
-    if (code == SQLITE_OK) {
-        sqlite3_exec(m_db.get(), "COMMIT;", nullptr, nullptr, nullptr);
+    if (m_is_in_batch) {
+        if (code != SQLITE_OK) {
+            logger->error("Failed to execute SQL in batch: {}", std::string(sqlite3_errmsg(m_db.get())));
+            m_is_batch_failed = true;
+        }
+
+        return !m_is_batch_failed;
     }
-    else {
+
+    if (code != SQLITE_OK) {
         logger->error("Failed to execute SQL: {}", std::string(sqlite3_errmsg(m_db.get())));
+    }
+    /// No transaction to commit after preparing statements.
+    else if (sqlite3_get_autocommit(m_db.get()) != 0 || sqlite3_exec(m_db.get(), "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK) {
+        return true;
+    }
+    else {
+        logger->error("Failed to commit SQL: {}", std::string(sqlite3_errmsg(m_db.get())));
+    }
+
+    sqlite3_exec(m_db.get(), "ROLLBACK;", nullptr, nullptr, nullptr);
+
+    return false;
+}
+
+void trade::holder::SQLiteHolder::begin_batch()
+{
+    if (m_is_in_batch) {
+        throw std::runtime_error("Nested SQLite batch is not supported");
+    }
+
+    m_exec_code = sqlite3_exec(m_db.get(), "BEGIN IMMEDIATE TRANSACTION;", nullptr, nullptr, nullptr);
+
+    if (m_exec_code != SQLITE_OK) {
+        throw std::runtime_error(fmt::format("Failed to begin SQLite batch: {}", std::string(sqlite3_errmsg(m_db.get()))));
+    }
+
+    m_is_in_batch = true;
+}
+
+bool trade::holder::SQLiteHolder::end_batch(const bool is_commit)
+{
+    m_is_in_batch = false;
+
+    if (std::exchange(m_is_batch_failed, false)) {
+        is_commit ? logger->error("Rolled back SQLite batch since some statements failed") : void();
+    }
+    else if (is_commit) {
+        m_exec_code = sqlite3_exec(m_db.get(), "COMMIT;", nullptr, nullptr, nullptr);
+
+        if (m_exec_code == SQLITE_OK)
+            return true;
+
+        logger->error("Failed to commit SQLite batch: {}", std::string(sqlite3_errmsg(m_db.get())));
+    }
+
+    sqlite3_exec(m_db.get(), "ROLLBACK;", nullptr, nullptr, nullptr);
+
+    return false;
+}
+
+void trade::holder::SQLiteHolder::set_pragma(const std::string& pragma, const std::string& value, const std::initializer_list<std::string_view> values) const
+{
+    std::string upper_value = value;
+    std::ranges::transform(upper_value, upper_value.begin(), [](const unsigned char c) { return std::toupper(c); });
+
+    if (std::ranges::find(values, upper_value) == values.end()) {
+        throw std::runtime_error(fmt::format("Invalid SQLite {} {}, expected one of {}", pragma, value, values));
+    }
+
+    /// Some pragmas, e.g. journal_mode, report the value actually taking effect.
+    std::string actual_value = upper_value;
+
+    const auto code = sqlite3_exec(
+        m_db.get(),
+        fmt::format("PRAGMA {} = {};", pragma, upper_value).c_str(),
+        [](void* actual, const int columns, char** texts, char**) {
+            columns > 0 && texts[0] != nullptr ? void(*static_cast<std::string*>(actual) = texts[0]) : void();
+            return SQLITE_OK;
+        },
+        &actual_value,
+        nullptr
+    );
+
+    if (code != SQLITE_OK) {
+        throw std::runtime_error(fmt::format("Failed to set SQLite {} to {}: {}", pragma, value, std::string(sqlite3_errmsg(m_db.get()))));
+    }
+
+    logger->info("SQLite {} is {}", pragma, actual_value);
+}
+
+void trade::holder::SQLiteHolder::check_schema_version() const
+{
+    const auto query_int = [this](const char* sql) {
+        int64_t value = 0;
+
+        sqlite3_exec(
+            m_db.get(),
+            sql,
+            [](void* result, const int columns, char** texts, char**) {
+                columns > 0 && texts[0] != nullptr ? void(*static_cast<int64_t*>(result) = std::stoll(texts[0])) : void();
+                return SQLITE_OK;
+            },
+            &value,
+            nullptr
+        );
+
+        return value;
+    };
+
+    const auto version = query_int("PRAGMA user_version;");
+
+    if (version == schema_version)
+        return;
+
+    if (version != 0) {
+        throw std::runtime_error(fmt::format("SQLite schema version {} is not supported, expected {}", version, schema_version));
+    }
+
+    /// Tables of version 0 stored timestamps as text like 2000-01-01 08:00:00.000
+    /// in Asia/Shanghai, which has been UTC+8 without DST since 1991.
+    /// Converted to nanoseconds since epoch in place, missing indexes are
+    /// created along with the tables.
+    const auto to_nanoseconds = [](const std::string& column) {
+        return fmt::format("{0} = (CAST(ROUND((julianday({0}) - 2440587.5) * 86400000) AS INTEGER) - 28800000) * 1000000", column);
+    };
+
+    std::string migrate_sql = "BEGIN IMMEDIATE TRANSACTION;";
+
+    for (const auto& [table, columns] : std::initializer_list<std::pair<std::string, std::vector<std::string>>> {
+             {m_fund_table_name, {"update_time"}},
+             {m_position_table_name, {"update_time"}},
+             {m_order_table_name, {"creation_time", "update_time"}},
+         }) {
+        if (query_int(fmt::format("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = '{}';", table).c_str()) == 0)
+            continue;
+
+        for (const auto& column : columns)
+            migrate_sql += fmt::format("UPDATE {0} SET {1} WHERE typeof({2}) = 'text';", table, to_nanoseconds(column), column);
+    }
+
+    migrate_sql += fmt::format("PRAGMA user_version = {}; COMMIT;", schema_version);
+
+    char* error = nullptr;
+
+    if (sqlite3_exec(m_db.get(), migrate_sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+        const std::string message = error == nullptr ? "" : error;
+
+        sqlite3_free(error);
         sqlite3_exec(m_db.get(), "ROLLBACK;", nullptr, nullptr, nullptr);
+
+        throw std::runtime_error(fmt::format("Failed to migrate SQLite schema from version {} to {}: {}", version, schema_version, message));
     }
+
+    query_int("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table';") > 0 ? logger->info("Migrated SQLite schema from version {} to {}", version, schema_version) : void();
 }
 
 void trade::holder::SQLiteHolder::init_symbol_table()
 {
     /// Create table for symbols.
     const std::string& create_symbols_table_sql = fmt::format(
-        "CREATE TABLE IF NOT EXISTS {} ("
+        "CREATE TABLE IF NOT EXISTS {0} ("
         "symbol      TEXT NOT NULL PRIMARY KEY,"
         "symbol_name TEXT NOT NULL,"
         "exchange    TEXT NOT NULL,"
         "underlying  TEXT"
-        ");",
+        ");"
+        "CREATE INDEX IF NOT EXISTS symbol_exchange_index ON {0} (exchange);",
         m_symbol_table_name
     );
 
@@ -336,8 +512,6 @@ void trade::holder::SQLiteHolder::init_query_symbol_stmts()
 
 std::shared_ptr<trade::types::Symbols> trade::holder::SQLiteHolder::query_symbols_by(const std::string& by, const std::string& id) const
 {
-    start_transaction();
-
     sqlite3_stmt* tp_stmt;
 
     tp_stmt = m_query_symbols_by.at(by).get(); /// If no such by type, throw exception immediately.
@@ -360,7 +534,8 @@ std::shared_ptr<trade::types::Symbols> trade::holder::SQLiteHolder::query_symbol
         symbols->add_symbols()->CopyFrom(symbol);
     }
 
-    commit_or_rollback(SQLITE_OK);
+    /// Finish the statement to end its read transaction.
+    sqlite3_reset(tp_stmt);
 
     return symbols;
 }
@@ -376,7 +551,7 @@ void trade::holder::SQLiteHolder::init_fund_table()
         "frozen_fund       REAL,"
         "frozen_margin     REAL,"
         "frozen_commission REAL,"
-        "update_time       DATETIME"
+        "update_time       INTEGER"
         ");",
         m_fund_table_name
     );
@@ -435,7 +610,7 @@ void trade::holder::SQLiteHolder::init_position_table()
         "used_margin                    REAL,"
         "frozen_margin                  REAL,"
         "open_cost                      REAL,"
-        "update_time                    DATETIME"
+        "update_time                    INTEGER"
         ");",
         m_position_table_name
     );
@@ -492,8 +667,8 @@ void trade::holder::SQLiteHolder::init_order_table()
         "position_side TEXT CHECK(position_side in ('open', 'close')),"
         "price         REAL NOT NULL,"
         "quantity      INTEGER NOT NULL,"
-        "creation_time DATETIME NOT NULL,"
-        "update_time   DATETIME NOT NULL"
+        "creation_time INTEGER NOT NULL,"
+        "update_time   INTEGER NOT NULL"
         ");"
         "CREATE INDEX IF NOT EXISTS broker_id_index ON {0} (broker_id);"
         "CREATE UNIQUE INDEX IF NOT EXISTS exchange_id_index ON {0} (exchange_id);",
@@ -551,8 +726,6 @@ std::shared_ptr<trade::types::Orders> trade::holder::SQLiteHolder::query_orders_
     const std::string& id
 ) const
 {
-    start_transaction();
-
     sqlite3_stmt* tp_stmt;
 
     tp_stmt = m_query_orders_by.at(by).get(); /// If no such by type, throw exception immediately.
@@ -580,13 +753,14 @@ std::shared_ptr<trade::types::Orders> trade::holder::SQLiteHolder::query_orders_
             order.set_position_side(to_position_side(reinterpret_cast<const char*>(sqlite3_column_text(tp_stmt, 5))));
         order.set_price(sqlite3_column_double(tp_stmt, 6));
         order.set_quantity(sqlite3_column_int64(tp_stmt, 7));
-        order.set_allocated_creation_time(utilities::ToTime<google::protobuf::Timestamp*>()(reinterpret_cast<const char*>(sqlite3_column_text(tp_stmt, 8))));
-        order.set_allocated_update_time(utilities::ToTime<google::protobuf::Timestamp*>()(reinterpret_cast<const char*>(sqlite3_column_text(tp_stmt, 9))));
+        order.set_allocated_creation_time(to_timestamp(sqlite3_column_int64(tp_stmt, 8)));
+        order.set_allocated_update_time(to_timestamp(sqlite3_column_int64(tp_stmt, 9)));
 
         orders->add_orders()->CopyFrom(order);
     }
 
-    commit_or_rollback(SQLITE_OK);
+    /// Finish the statement to end its read transaction.
+    sqlite3_reset(tp_stmt);
 
     return orders;
 }
@@ -675,3 +849,44 @@ trade::types::PositionSideType trade::holder::SQLiteHolder::to_position_side(con
     if (position_side == "close") return types::PositionSideType::close;
     return types::PositionSideType::invalid_position_side;
 }
+
+int64_t trade::holder::SQLiteHolder::to_nanoseconds(const google::protobuf::Timestamp& timestamp)
+{
+    return google::protobuf::util::TimeUtil::TimestampToNanoseconds(timestamp);
+}
+
+google::protobuf::Timestamp* trade::holder::SQLiteHolder::to_timestamp(const int64_t nanoseconds)
+{
+    return new google::protobuf::Timestamp(google::protobuf::util::TimeUtil::NanosecondsToTimestamp(nanoseconds));
+}
+
+trade::holder::SQLiteBatch::SQLiteBatch(SQLiteHolder& holder)
+    : m_holder(holder)
+{
+    m_holder.begin_batch();
+}
+
+trade::holder::SQLiteBatch::~SQLiteBatch()
+{
+    m_is_done ? void() : rollback();
+}
+
+bool trade::holder::SQLiteBatch::commit()
+{
+    if (m_is_done)
+        return false;
+
+    m_is_done = true;
+
+    return m_holder.end_batch(true);
+}
+
+void trade::holder::SQLiteBatch::rollback()
+{
+    if (m_is_done)
+        return;
+
+    m_is_done = true;
+
+    m_holder.end_batch(false);
+}
@@ -0,0 +1,346 @@
+#include <fmt/format.h>
+#include <unordered_set>
+
+#include "libholder/WriteBehindHolder.h"
+#include "utilities/ToJSON.hpp"
+
+trade::holder::WriteBehindHolder::WriteBehindHolder(
+    const std::shared_ptr<IHolder>& holder,
+    const std::chrono::milliseconds max_lag,
+    const size_t batch_size
+) : AppBase("WriteBehindHolder"),
+    m_holder(holder),
+    m_max_lag(max_lag),
+    m_batch_size(std::max<size_t>(batch_size, 1))
+{
+    if (m_holder == nullptr) {
+        throw std::runtime_error("No persistent holder for WriteBehindHolder");
+    }
+
+    m_writer = std::thread(&WriteBehindHolder::write_behind, this);
+}
+
+trade::holder::WriteBehindHolder::~WriteBehindHolder()
+{
+    {
+        std::lock_guard lock(m_pending_mutex);
+        m_is_running = false;
+    }
+
+    m_pending_cv.notify_one();
+    m_writer.join();
+}
+
+int64_t trade::holder::WriteBehindHolder::update_symbols(const std::shared_ptr<types::Symbols> symbols)
+{
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->update_symbols(symbols);
+}
+
+std::shared_ptr<trade::types::Symbols> trade::holder::WriteBehindHolder::query_symbols_by_symbol(const std::string& symbol)
+{
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->query_symbols_by_symbol(symbol);
+}
+
+std::shared_ptr<trade::types::Symbols> trade::holder::WriteBehindHolder::query_symbols_by_exchange(const types::ExchangeType exchange)
+{
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->query_symbols_by_exchange(exchange);
+}
+
+int64_t trade::holder::WriteBehindHolder::update_funds(const std::shared_ptr<types::Funds> funds)
+{
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->update_funds(funds);
+}
+
+std::shared_ptr<trade::types::Funds> trade::holder::WriteBehindHolder::query_funds_by_account_id(const std::string& account_id)
+{
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->query_funds_by_account_id(account_id);
+}
+
+int64_t trade::holder::WriteBehindHolder::update_positions(const std::shared_ptr<types::Positions> positions)
+{
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->update_positions(positions);
+}
+
+std::shared_ptr<trade::types::Positions> trade::holder::WriteBehindHolder::query_positions_by_symbol(const std::string& symbol)
+{
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->query_positions_by_symbol(symbol);
+}
+
+int64_t trade::holder::WriteBehindHolder::update_orders(const std::shared_ptr<types::Orders> orders)
+{
+    std::vector<int64_t> unique_ids;
+    unique_ids.reserve(orders->orders_size());
+
+    {
+        std::unique_lock lock(m_orders_mutex);
+
+        for (const auto& order : orders->orders()) {
+            if (order.unique_id() == INVALID_ID) {
+                logger->warn("No Unique ID for order: {}", utilities::ToJSON()(order));
+                continue;
+            }
+
+            put(order);
+            unique_ids.push_back(order.unique_id());
+        }
+    }
+
+    if (!unique_ids.empty()) {
+        bool is_full;
+
+        {
+            std::lock_guard lock(m_pending_mutex);
+
+            m_pending.insert(m_pending.end(), unique_ids.begin(), unique_ids.end());
+            m_enqueued += unique_ids.size();
+
+            is_full = m_pending.size() >= m_batch_size;
+        }
+
+        is_full ? m_pending_cv.notify_one() : void();
+    }
+
+    /// Queued only, not written yet.
+    return static_cast<int64_t>(unique_ids.size());
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::WriteBehindHolder::query_orders_by_unique_id(const int64_t unique_id)
+{
+    {
+        std::shared_lock lock(m_orders_mutex);
+
+        const auto it = m_orders.find(unique_id);
+
+        if (it != m_orders.end()) [[likely]] {
+            auto orders = std::make_shared<types::Orders>();
+            orders->add_orders()->CopyFrom(it->second.order);
+            return orders;
+        }
+    }
+
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->query_orders_by_unique_id(unique_id);
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::WriteBehindHolder::query_orders_by_broker_id(const std::string& broker_id)
+{
+    auto orders = query_orders_by(m_broker_ids, broker_id);
+
+    if (orders->orders_size() > 0) [[likely]]
+        return orders;
+
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->query_orders_by_broker_id(broker_id);
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::WriteBehindHolder::query_orders_by_exchange_id(const std::string& exchange_id)
+{
+    auto orders = query_orders_by(m_exchange_ids, exchange_id);
+
+    if (orders->orders_size() > 0) [[likely]]
+        return orders;
+
+    std::lock_guard lock(m_holder_mutex);
+    return m_holder->query_orders_by_exchange_id(exchange_id);
+}
+
+void trade::holder::WriteBehindHolder::flush()
+{
+    std::unique_lock lock(m_pending_mutex);
+
+    const auto target = m_enqueued;
+
+    m_flush_until = std::max(m_flush_until, target);
+    m_pending_cv.notify_one();
+
+    m_written_cv.wait(lock, [this, target] { return m_written >= target; });
+}
+
+size_t trade::holder::WriteBehindHolder::pending() const
+{
+    std::lock_guard lock(m_pending_mutex);
+    return m_enqueued - m_written;
+}
+
+size_t trade::holder::WriteBehindHolder::kept() const
+{
+    std::shared_lock lock(m_orders_mutex);
+    return m_orders.size();
+}
+
+void trade::holder::WriteBehindHolder::put(const types::Order& order)
+{
+    auto& [kept, version] = m_orders[order.unique_id()];
+
+    if (kept.broker_id() != order.broker_id()) {
+        kept.has_broker_id() ? unindex(m_broker_ids, kept.broker_id(), order.unique_id()) : void();
+        order.has_broker_id() ? index(m_broker_ids, order.broker_id(), order.unique_id()) : void();
+    }
+
+    if (kept.exchange_id() != order.exchange_id()) {
+        kept.has_exchange_id() ? unindex(m_exchange_ids, kept.exchange_id(), order.unique_id()) : void();
+        order.has_exchange_id() ? index(m_exchange_ids, order.exchange_id(), order.unique_id()) : void();
+    }
+
+    kept.CopyFrom(order);
+    version++;
+}
+
+void trade::holder::WriteBehindHolder::evict(const int64_t unique_id)
+{
+    const auto it = m_orders.find(unique_id);
+
+    if (it == m_orders.end()) [[unlikely]]
+        return;
+
+    const auto& kept = it->second.order;
+
+    kept.has_broker_id() ? unindex(m_broker_ids, kept.broker_id(), unique_id) : void();
+    kept.has_exchange_id() ? unindex(m_exchange_ids, kept.exchange_id(), unique_id) : void();
+
+    m_orders.erase(it);
+}
+
+void trade::holder::WriteBehindHolder::index(Index& index, const std::string& id, const int64_t unique_id)
+{
+    index.emplace(id, unique_id);
+}
+
+void trade::holder::WriteBehindHolder::unindex(Index& index, const std::string& id, const int64_t unique_id)
+{
+    auto [begin, end] = index.equal_range(id);
+
+    for (; begin != end; ++begin) {
+        if (begin->second == unique_id) {
+            index.erase(begin);
+            return;
+        }
+    }
+}
+
+std::shared_ptr<trade::types::Orders> trade::holder::WriteBehindHolder::query_orders_by(const Index& index, const std::string& id) const
+{
+    auto orders = std::make_shared<types::Orders>();
+
+    std::shared_lock lock(m_orders_mutex);
+
+    const auto [begin, end] = index.equal_range(id);
+
+    for (auto it = begin; it != end; ++it)
+        orders->add_orders()->CopyFrom(m_orders.at(it->second).order);
+
+    return orders;
+}
+
+void trade::holder::WriteBehindHolder::write_behind()
+{
+    /// Orders to write, including those of failed writes.
+    std::vector<int64_t> unique_ids;
+    std::unordered_set<int64_t> seen;
+    /// Unique id -> Version written.
+    std::vector<std::pair<int64_t, uint64_t>> versions;
+    /// Consecutive failed writes.
+    int failures = 0;
+
+    while (true) {
+        uint64_t target;
+        bool is_running;
+
+        /// Backs off from a failing holder regardless of new orders or flush.
+        failures > 0 ? std::this_thread::sleep_for(std::min(m_max_lag * (1 << std::min(failures - 1, 16)), max_backoff)) : void();
+
+        {
+            std::unique_lock lock(m_pending_mutex);
+
+            m_pending_cv.wait_for(lock, failures > 0 ? std::chrono::milliseconds(0) : m_max_lag, [this] {
+                return !m_is_running || m_pending.size() >= m_batch_size || m_written < m_flush_until;
+            });
+
+            unique_ids.insert(unique_ids.end(), m_pending.begin(), m_pending.end());
+            m_pending.clear();
+
+            target     = m_enqueued;
+            is_running = m_is_running;
+        }
+
+        if (!unique_ids.empty()) {
+            const auto orders = std::make_shared<types::Orders>();
+
+            {
+                std::shared_lock lock(m_orders_mutex);
+
+                /// Only the latest state of an order changed several times is
+                /// written. An order missing was queued after its latest state
+                /// had been written and evicted already.
+                for (auto it = unique_ids.rbegin(); it != unique_ids.rend(); ++it) {
+                    const auto kept = m_orders.find(*it);
+
+                    if (kept != m_orders.end() && seen.insert(*it).second) {
+                        orders->add_orders()->CopyFrom(kept->second.order);
+                        versions.emplace_back(*it, kept->second.version);
+                    }
+                }
+            }
+
+            bool is_written = orders->orders_size() == 0;
+
+            try {
+                std::lock_guard lock(m_holder_mutex);
+
+                const auto written = is_written ? 0 : m_holder->update_orders(orders);
+
+                is_written = written == orders->orders_size();
+                is_written ? void() : logger->error("Only {} of {} orders written behind", written, orders->orders_size());
+            }
+            catch (const std::exception& e) {
+                logger->error("Failed to write behind {} orders: {}", orders->orders_size(), e.what());
+            }
+
+            failures = is_written ? 0 : failures + 1;
+
+            /// Written orders are no longer on the order path unless changed
+            /// since, later queries of them read the persistent holder.
+            if (is_written) {
+                std::unique_lock lock(m_orders_mutex);
+
+                for (const auto& [unique_id, version] : versions)
+                    m_orders.at(unique_id).version == version ? evict(unique_id) : void();
+            }
+
+            versions.clear();
+
+            /// Kept to be written again, unless stopping and retried enough.
+            if (is_written || (!is_running && failures >= max_failures_on_stop)) {
+                is_written ? void() : logger->error("Dropped {} orders not written behind", orders->orders_size());
+
+                unique_ids.clear();
+                failures = 0;
+            }
+            else {
+                unique_ids.assign(seen.begin(), seen.end());
+            }
+
+            seen.clear();
+        }
+
+        /// Written counts only move forward once all orders before are written.
+        if (failures == 0) {
+            {
+                std::lock_guard lock(m_pending_mutex);
+                m_written = target;
+            }
+
+            m_written_cv.notify_all();
+
+            if (!is_running)
+                break;
+        }
+    }
+}
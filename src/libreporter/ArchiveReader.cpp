@@ -0,0 +1,244 @@
+#include <zlib.h>
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+#include "libreporter/ArchiveReader.h"
+#include "utilities/ColumnCodec.hpp"
+
+namespace
+{
+
+template<typename T>
+bool get(std::istream& in, T& value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool get_string(std::istream& in, std::string& value)
+{
+    uint16_t size;
+
+    if (!get(in, size))
+        return false;
+
+    value.resize(size);
+    return static_cast<bool>(in.read(value.data(), size));
+}
+
+/// Compares floating point columns by value instead of bit pattern.
+bool less_equal(const trade::reporter::archive::ColumnType type, const int64_t left, const int64_t right)
+{
+    return type == trade::reporter::archive::ColumnType::floating
+             ? std::bit_cast<double>(left) <= std::bit_cast<double>(right)
+             : left <= right;
+}
+
+bool in_range(const trade::reporter::archive::ColumnType type, const int64_t value, const int64_t from, const int64_t to)
+{
+    return less_equal(type, from, value) && less_equal(type, value, to);
+}
+
+bool overlaps(const trade::reporter::archive::ColumnType type, const int64_t min, const int64_t max, const int64_t from, const int64_t to)
+{
+    return less_equal(type, min, to) && less_equal(type, from, max);
+}
+
+} // namespace
+
+trade::reporter::ArchiveReader::ArchiveReader(const std::string& path)
+    : AppBase("ArchiveReader"),
+      m_path(path),
+      m_file(path, std::ios::binary)
+{
+    if (!m_file.is_open())
+        throw std::runtime_error(fmt::format("Failed to open archive {}", m_path));
+
+    read_header();
+    read_blocks();
+}
+
+size_t trade::reporter::ArchiveReader::rows() const
+{
+    return std::accumulate(m_blocks.begin(), m_blocks.end(), size_t(0), [](const size_t rows, const Block& block) { return rows + block.rows; });
+}
+
+int trade::reporter::ArchiveReader::column_index(const std::string_view name) const
+{
+    const auto it = std::ranges::find(m_columns, name, &archive::Column::name);
+    return it == m_columns.end() ? -1 : static_cast<int>(it - m_columns.begin());
+}
+
+trade::reporter::archive::Table trade::reporter::ArchiveReader::read()
+{
+    archive::Table table {m_columns, std::vector<std::vector<int64_t>>(m_columns.size())};
+
+    for (auto& values : table.values)
+        values.reserve(rows());
+
+    for (const auto& block : m_blocks)
+        decode(block, table);
+
+    return table;
+}
+
+trade::reporter::archive::Table trade::reporter::ArchiveReader::read(const std::string_view column, const int64_t from, const int64_t to)
+{
+    const auto index = column_index(column);
+
+    if (index < 0)
+        throw std::runtime_error(fmt::format("No column {} in archive {}", column, m_path));
+
+    const auto type = m_columns[index].type;
+
+    archive::Table table {m_columns, std::vector<std::vector<int64_t>>(m_columns.size())};
+    archive::Table block_table {m_columns, std::vector<std::vector<int64_t>>(m_columns.size())};
+
+    for (const auto& block : m_blocks) {
+        const auto [min, max] = block.ranges[index];
+
+        /// Skip blocks by index.
+        if (!overlaps(type, min, max, from, to))
+            continue;
+
+        for (auto& values : block_table.values)
+            values.clear();
+
+        decode(block, block_table);
+
+        for (size_t row = 0; row < block.rows; row++) {
+            if (!in_range(type, block_table.values[index][row], from, to))
+                continue;
+
+            for (size_t i = 0; i < m_columns.size(); i++)
+                table.values[i].push_back(block_table.values[i][row]);
+        }
+    }
+
+    return table;
+}
+
+void trade::reporter::ArchiveReader::read_header()
+{
+    std::string magic(archive::file_magic.size(), '\0');
+    uint16_t version;
+    uint8_t kind;
+    uint16_t column_count;
+
+    if (!m_file.read(magic.data(), static_cast<std::streamsize>(magic.size())) || magic != archive::file_magic)
+        throw std::runtime_error(fmt::format("{} is not a tick archive", m_path));
+
+    if (!get(m_file, version) || version != archive::version)
+        throw std::runtime_error(fmt::format("Unsupported version {} of archive {}", version, m_path));
+
+    if (!get(m_file, kind) || !get_string(m_file, m_symbol) || !get(m_file, column_count))
+        throw std::runtime_error(fmt::format("Truncated header of archive {}", m_path));
+
+    m_kind = static_cast<archive::Kind>(kind);
+
+    for (uint16_t i = 0; i < column_count; i++) {
+        uint8_t type;
+        std::string name;
+
+        if (!get(m_file, type) || !get_string(m_file, name))
+            throw std::runtime_error(fmt::format("Truncated header of archive {}", m_path));
+
+        m_columns.emplace_back(std::move(name), static_cast<archive::ColumnType>(type));
+    }
+}
+
+void trade::reporter::ArchiveReader::read_blocks()
+{
+    const auto header_size = m_file.tellg();
+
+    m_file.seekg(0, std::ios::end);
+    const auto file_size = static_cast<std::streamoff>(m_file.tellg());
+    m_file.seekg(header_size);
+
+    while (true) {
+        const auto start = static_cast<std::streamoff>(m_file.tellg());
+
+        std::string magic(archive::block_magic.size(), '\0');
+        Block block {};
+        uint8_t compression;
+
+        if (!m_file.read(magic.data(), static_cast<std::streamsize>(magic.size())))
+            break;
+
+        if (magic != archive::block_magic || !get(m_file, block.rows) || !get(m_file, compression) || !get(m_file, block.raw_size) || !get(m_file, block.stored_size)) {
+            logger->warn("Ignored corrupted block at {} of {}", start, m_path);
+            break;
+        }
+
+        block.compression = static_cast<archive::Compression>(compression);
+        block.ranges.resize(m_columns.size());
+
+        for (auto& [min, max] : block.ranges)
+            get(m_file, min) && get(m_file, max);
+
+        block.offset = static_cast<std::streamoff>(m_file.tellg());
+
+        /// Last block may be truncated if the writer crashed.
+        if (!m_file || block.offset + block.stored_size > file_size) {
+            logger->warn("Ignored truncated block at {} of {}", start, m_path);
+            break;
+        }
+
+        m_file.seekg(block.stored_size, std::ios::cur);
+        m_blocks.push_back(std::move(block));
+    }
+
+    m_file.clear();
+}
+
+void trade::reporter::ArchiveReader::decode(const Block& block, archive::Table& table)
+{
+    std::string stored(block.stored_size, '\0');
+
+    m_file.seekg(block.offset);
+
+    if (!m_file.read(stored.data(), block.stored_size))
+        throw std::runtime_error(fmt::format("Failed to read block at {} of {}", block.offset, m_path));
+
+    std::string payload;
+
+    switch (block.compression) {
+    case archive::Compression::none: {
+        payload = std::move(stored);
+        break;
+    }
+    case archive::Compression::zlib: {
+        payload.resize(block.raw_size);
+        uLongf raw_size = block.raw_size;
+
+        if (uncompress(reinterpret_cast<Bytef*>(payload.data()), &raw_size, reinterpret_cast<const Bytef*>(stored.data()), block.stored_size) != Z_OK || raw_size != block.raw_size)
+            throw std::runtime_error(fmt::format("Failed to decompress block at {} of {}", block.offset, m_path));
+
+        break;
+    }
+    default: {
+        throw std::runtime_error(fmt::format("Unknown compression {} of block at {} of {}", static_cast<int>(block.compression), block.offset, m_path));
+    }
+    }
+
+    const char* it  = payload.data();
+    const char* end = payload.data() + payload.size();
+
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        uint64_t size;
+
+        if (!utilities::ColumnCodec::get_varint(it, end, size) || size > static_cast<uint64_t>(end - it))
+            throw std::runtime_error(fmt::format("Corrupted column {} of block at {} of {}", m_columns[i].name, block.offset, m_path));
+
+        const std::string_view encoded(it, size);
+        const auto decoded = m_columns[i].type == archive::ColumnType::floating
+                               ? utilities::ColumnCodec::decode_xor(encoded, block.rows, table.values[i])
+                               : utilities::ColumnCodec::decode_delta(encoded, block.rows, table.values[i]);
+
+        if (!decoded)
+            throw std::runtime_error(fmt::format("Corrupted column {} of block at {} of {}", m_columns[i].name, block.offset, m_path));
+
+        it += size;
+    }
+}
@@ -0,0 +1,339 @@
+#include <zlib.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+
+#include "libreporter/ArchiveReader.h"
+#include "libreporter/ArchiveReporter.h"
+#include "utilities/ColumnCodec.hpp"
+#include "utilities/TimeHelper.hpp"
+
+trade::reporter::ArchiveReporter::ArchiveReporter(
+    std::string output_folder,
+    const std::shared_ptr<IReporter>& outside,
+    const size_t block_rows,
+    const archive::Compression compression
+) : AppBase("ArchiveReporter"),
+    NopReporter(outside),
+    m_output_folder(std::move(output_folder)),
+    m_block_rows(std::max<size_t>(block_rows, 1)),
+    m_compression(compression),
+    m_outside(outside)
+{
+    m_output_folder.empty() ? logger->info("ArchiveReporter is disabled since no output folder is given") : void();
+}
+
+trade::reporter::ArchiveReporter::~ArchiveReporter()
+{
+    for (auto& columns : m_l2_tick_tables.columns | std::views::values)
+        write_block(columns);
+    for (auto& columns : m_ranged_tick_tables.columns | std::views::values)
+        write_block(columns);
+}
+
+void trade::reporter::ArchiveReporter::l2_tick_generated(const std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick)
+{
+    if (!m_output_folder.empty()) [[likely]] {
+        auto& columns = new_columns(m_l2_tick_tables, generated_l2_tick->symbol(), generated_l2_tick->exchange_date());
+
+        append_row(
+            columns,
+            {
+                generated_l2_tick->price_1000x(),
+                generated_l2_tick->quantity(),
+                generated_l2_tick->ask_unique_id(),
+                generated_l2_tick->bid_unique_id(),
+                generated_l2_tick->ask_levels().at(4).price_1000x(),
+                generated_l2_tick->ask_levels().at(4).quantity(),
+                generated_l2_tick->ask_levels().at(3).price_1000x(),
+                generated_l2_tick->ask_levels().at(3).quantity(),
+                generated_l2_tick->ask_levels().at(2).price_1000x(),
+                generated_l2_tick->ask_levels().at(2).quantity(),
+                generated_l2_tick->ask_levels().at(1).price_1000x(),
+                generated_l2_tick->ask_levels().at(1).quantity(),
+                generated_l2_tick->ask_levels().at(0).price_1000x(),
+                generated_l2_tick->ask_levels().at(0).quantity(),
+                generated_l2_tick->bid_levels().at(0).price_1000x(),
+                generated_l2_tick->bid_levels().at(0).quantity(),
+                generated_l2_tick->bid_levels().at(1).price_1000x(),
+                generated_l2_tick->bid_levels().at(1).quantity(),
+                generated_l2_tick->bid_levels().at(2).price_1000x(),
+                generated_l2_tick->bid_levels().at(2).quantity(),
+                generated_l2_tick->bid_levels().at(3).price_1000x(),
+                generated_l2_tick->bid_levels().at(3).quantity(),
+                generated_l2_tick->bid_levels().at(4).price_1000x(),
+                generated_l2_tick->bid_levels().at(4).quantity(),
+                /// Time.
+                generated_l2_tick->exchange_time(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count(),
+            }
+        );
+    }
+
+    m_outside->l2_tick_generated(generated_l2_tick);
+}
+
+void trade::reporter::ArchiveReporter::ranged_tick_generated(const std::shared_ptr<types::RangedTick> ranged_tick)
+{
+    if (!m_output_folder.empty()) [[likely]] {
+        auto& columns = new_columns(m_ranged_tick_tables, ranged_tick->symbol(), ranged_tick->exchange_date());
+
+        append_row(
+            columns,
+            {
+                ranged_tick->exchange_date(),
+                ranged_tick->exchange_time(),
+                ranged_tick->start_time(),
+                ranged_tick->end_time(),
+                ranged_tick->ask_levels().at(4).price_1000x(),
+                ranged_tick->ask_levels().at(3).price_1000x(),
+                ranged_tick->ask_levels().at(2).price_1000x(),
+                ranged_tick->ask_levels().at(1).price_1000x(),
+                ranged_tick->ask_levels().at(0).price_1000x(),
+                ranged_tick->bid_levels().at(0).price_1000x(),
+                ranged_tick->bid_levels().at(1).price_1000x(),
+                ranged_tick->bid_levels().at(2).price_1000x(),
+                ranged_tick->bid_levels().at(3).price_1000x(),
+                ranged_tick->bid_levels().at(4).price_1000x(),
+                ranged_tick->active_traded_sell_number(),
+                ranged_tick->active_sell_number(),
+                ranged_tick->active_sell_quantity(),
+                ranged_tick->active_sell_amount_1000x(),
+                ranged_tick->active_traded_buy_number(),
+                ranged_tick->active_buy_number(),
+                ranged_tick->active_buy_quantity(),
+                ranged_tick->active_buy_amount_1000x(),
+                std::bit_cast<int64_t>(ranged_tick->weighted_ask_price().at(4)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_ask_price().at(3)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_ask_price().at(2)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_ask_price().at(1)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_ask_price().at(0)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_bid_price().at(0)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_bid_price().at(1)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_bid_price().at(2)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_bid_price().at(3)),
+                std::bit_cast<int64_t>(ranged_tick->weighted_bid_price().at(4)),
+                ranged_tick->aggressive_sell_number(),
+                ranged_tick->aggressive_buy_number(),
+                ranged_tick->new_added_ask_1_quantity(),
+                ranged_tick->new_added_bid_1_quantity(),
+                ranged_tick->new_canceled_ask_1_quantity(),
+                ranged_tick->new_canceled_bid_1_quantity(),
+                ranged_tick->new_canceled_ask_all_quantity(),
+                ranged_tick->new_canceled_bid_all_quantity(),
+                ranged_tick->big_ask_amount_1000x(),
+                ranged_tick->big_bid_amount_1000x(),
+                ranged_tick->highest_price_1000x(),
+                ranged_tick->lowest_price_1000x(),
+                ranged_tick->ask_price_1_valid_duration_1000x(),
+                ranged_tick->bid_price_1_valid_duration_1000x(),
+            }
+        );
+    }
+
+    m_outside->ranged_tick_generated(ranged_tick);
+}
+
+trade::reporter::ArchiveReporter::Columns& trade::reporter::ArchiveReporter::new_columns(
+    Tables& tables,
+    const std::string& symbol,
+    const int64_t exchange_date
+)
+{
+    const auto it = tables.columns.find({symbol, exchange_date});
+
+    if (it != tables.columns.end()) [[likely]]
+        return it->second;
+
+    /// Rows of the previous day go to its own file before it is closed.
+    if (const auto previous = tables.dates.find(symbol); previous != tables.dates.end()) {
+        const auto stale = tables.columns.find({symbol, previous->second});
+
+        write_block(stale->second);
+        tables.columns.erase(stale);
+    }
+
+    tables.dates[symbol] = exchange_date;
+
+    const auto date = exchange_date > 0 ? std::to_string(exchange_date) : utilities::Date<std::string>()();
+    const std::filesystem::path path = fmt::format("{}/{}/{}-{}{}", m_output_folder, date, symbol, archive::to_string(tables.kind), archive::extension);
+
+    !open_file(path, tables.kind, symbol) ? logger->error("Failed to create archive {}", path.string()) : void();
+
+    const auto& schema = archive::schema(tables.kind);
+    auto& columns      = tables.columns[{symbol, exchange_date}];
+
+    columns.kind = tables.kind;
+    columns.path = path.string();
+    columns.values.resize(schema.size());
+
+    for (auto& values : columns.values)
+        values.reserve(m_block_rows);
+
+    return columns;
+}
+
+bool trade::reporter::ArchiveReporter::open_file(const std::filesystem::path& path, const archive::Kind kind, const std::string& symbol)
+{
+    const auto& schema = archive::schema(kind);
+
+    std::string header;
+
+    header.append(archive::file_magic);
+    archive::put<uint16_t>(header, archive::version);
+    archive::put<uint8_t>(header, static_cast<uint8_t>(kind));
+    archive::put_string(header, symbol);
+    archive::put<uint16_t>(header, static_cast<uint16_t>(schema.size()));
+
+    for (const auto& [name, type] : schema) {
+        archive::put<uint8_t>(header, static_cast<uint8_t>(type));
+        archive::put_string(header, name);
+    }
+
+    std::error_code error;
+    create_directories(path.parent_path(), error);
+
+    if (exists(path, error)) {
+        try {
+            const ArchiveReader reader(path.string());
+
+            if (reader.kind() == kind && reader.symbol() == symbol && reader.columns() == schema) {
+                /// Drops the block truncated by a crash, if any, so that new
+                /// blocks are not appended after it.
+                const auto end = reader.blocks().empty() ? static_cast<std::streamoff>(header.size()) : reader.blocks().back().offset + reader.blocks().back().stored_size;
+
+                resize_file(path, static_cast<uintmax_t>(end), error);
+
+                if (!error) {
+                    logger->info("Appending to archive {} of {} rows", path.string(), reader.rows());
+                    return true;
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            logger->warn("Invalid archive {}: {}", path.string(), e.what());
+        }
+
+        /// Kept for inspection instead of overwritten.
+        const auto invalid = path.string() + ".invalid";
+
+        rename(path, invalid, error);
+        logger->warn("Moved invalid archive {} to {}", path.string(), invalid);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    !file ? void() : logger->info("Opened new archive at {}", path.string());
+
+    return static_cast<bool>(file);
+}
+
+void trade::reporter::ArchiveReporter::append_row(Columns& columns, const std::initializer_list<int64_t> row)
+{
+    auto values = columns.values.begin();
+
+    for (const auto value : row)
+        (values++)->push_back(value);
+
+    if (columns.values.front().size() >= m_block_rows) [[unlikely]]
+        write_block(columns);
+}
+
+void trade::reporter::ArchiveReporter::write_block(Columns& columns)
+{
+    const auto rows = columns.values.front().size();
+
+    if (rows == 0)
+        return;
+
+    const auto& schema = archive::schema(columns.kind);
+
+    std::string payload;
+    std::string block;
+
+    block.append(archive::block_magic);
+    archive::put<uint32_t>(block, static_cast<uint32_t>(rows));
+
+    std::string encoded;
+
+    for (size_t i = 0; i < schema.size(); i++) {
+        const auto& values = columns.values[i];
+
+        encoded.clear();
+
+        if (schema[i].type == archive::ColumnType::floating) {
+            utilities::ColumnCodec::encode_xor(values, encoded);
+        }
+        else {
+            utilities::ColumnCodec::encode_delta(values, encoded);
+        }
+
+        utilities::ColumnCodec::put_varint(encoded.size(), payload);
+        payload.append(encoded);
+    }
+
+    auto compression = m_compression;
+    std::string compressed;
+
+    if (compression == archive::Compression::zlib) {
+        uLongf compressed_size = compressBound(static_cast<uLong>(payload.size()));
+        compressed.resize(compressed_size);
+
+        if (compress2(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size, reinterpret_cast<const Bytef*>(payload.data()), static_cast<uLong>(payload.size()), Z_BEST_SPEED) == Z_OK) [[likely]] {
+            compressed.resize(compressed_size);
+        }
+        else {
+            logger->warn("Failed to compress block of {}, stored uncompressed", columns.path);
+            compression = archive::Compression::none;
+        }
+    }
+
+    const auto& stored = compression == archive::Compression::none ? payload : compressed;
+
+    archive::put<uint8_t>(block, static_cast<uint8_t>(compression));
+    archive::put<uint32_t>(block, static_cast<uint32_t>(payload.size()));
+    archive::put<uint32_t>(block, static_cast<uint32_t>(stored.size()));
+
+    /// Index.
+    for (size_t i = 0; i < schema.size(); i++) {
+        const auto& values = columns.values[i];
+
+        if (schema[i].type == archive::ColumnType::floating) {
+            double min = INFINITY;
+            double max = -INFINITY;
+
+            for (const auto value : values) {
+                const auto number = std::bit_cast<double>(value);
+
+                /// NaN is never in range.
+                min = std::fmin(min, number);
+                max = std::fmax(max, number);
+            }
+
+            archive::put<int64_t>(block, std::bit_cast<int64_t>(min));
+            archive::put<int64_t>(block, std::bit_cast<int64_t>(max));
+        }
+        else {
+            const auto [min, max] = std::ranges::minmax(values);
+
+            archive::put<int64_t>(block, min);
+            archive::put<int64_t>(block, max);
+        }
+    }
+
+    block.append(stored);
+
+    std::ofstream file(columns.path, std::ios::binary | std::ios::app);
+    file.write(block.data(), static_cast<std::streamsize>(block.size()));
+
+    !file ? logger->error("Failed to write {} rows to {}", rows, columns.path) : void();
+
+    for (auto& values : columns.values)
+        values.clear();
+}
@@ -25,6 +25,7 @@ trade::reporter::AsyncReporter::AsyncReporter(std::shared_ptr<IReporter> outside
     m_exchange_l2_tick_thread    = std::thread(&AsyncReporter::do_exchange_l2_tick_arrived, this);
     m_generated_l2_tick_thread   = std::thread(&AsyncReporter::do_l2_tick_generated, this);
     m_ranged_tick_thread         = std::thread(&AsyncReporter::do_ranged_tick_generated, this);
+    m_seq_gap_thread             = std::thread(&AsyncReporter::do_md_seq_gap_detected, this);
 }
 
 trade::reporter::AsyncReporter::~AsyncReporter()
@@ -51,6 +52,7 @@ trade::reporter::AsyncReporter::~AsyncReporter()
     m_exchange_l2_tick_thread.join();
     m_generated_l2_tick_thread.join();
     m_ranged_tick_thread.join();
+    m_seq_gap_thread.join();
 }
 
 void trade::reporter::AsyncReporter::broker_accepted(const std::shared_ptr<types::BrokerAcceptance> broker_acceptance)
@@ -131,6 +133,12 @@ void trade::reporter::AsyncReporter::ranged_tick_generated(const std::shared_ptr
     while (!m_ranged_tick_buffer.push(ranged_tick));
 }
 
+void trade::reporter::AsyncReporter::md_seq_gap_detected(const std::shared_ptr<types::SeqGap> seq_gap)
+{
+    std::lock_guard lock_guard(m_seq_gap_mutex);
+    while (!m_seq_gap_buffer.push(seq_gap));
+}
+
 void trade::reporter::AsyncReporter::do_broker_accepted()
 {
     while (m_is_running || !m_broker_acceptance_buffer.empty()) {
@@ -261,3 +269,13 @@ void trade::reporter::AsyncReporter::do_ranged_tick_generated()
             m_outside->ranged_tick_generated(ranged_tick);
     }
 }
+
+void trade::reporter::AsyncReporter::do_md_seq_gap_detected()
+{
+    while (m_is_running || !m_seq_gap_buffer.empty()) {
+        std::shared_ptr<types::SeqGap> seq_gap;
+
+        if (m_seq_gap_buffer.pop(seq_gap))
+            m_outside->md_seq_gap_detected(seq_gap);
+    }
+}
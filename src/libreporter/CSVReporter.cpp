@@ -1,27 +1,54 @@
+#include <algorithm>
+#include <bit>
 #include <filesystem>
+#include <iterator>
 #include <ranges>
 
 #include "libreporter/CSVReporter.h"
-#include "utilities/TimeHelper.hpp"
+
+trade::reporter::CSVReporter::CSVReporter(
+    std::string output_folder,
+    const std::shared_ptr<IReporter>& outside,
+    const size_t max_open_files,
+    const size_t buffer_size,
+    const int64_t flush_interval_ms,
+    const size_t max_pending_size
+) : AppBase("CSVReporter"),
+    NopReporter(outside),
+    m_output_folder(std::move(output_folder)),
+    m_max_open_files(std::max<size_t>(max_open_files, 1)),
+    m_buffer_size(buffer_size),
+    m_flush_interval(flush_interval_ms),
+    m_max_pending_size(max_pending_size),
+    m_is_running(true),
+    m_outside(outside)
+{
+    m_l2_tick_buffers.last_hand_off     = std::chrono::steady_clock::now();
+    m_ranged_tick_buffers.last_hand_off = std::chrono::steady_clock::now();
+
+    m_writer_thread = std::thread(&CSVReporter::writer, this);
+}
 
 trade::reporter::CSVReporter::~CSVReporter()
 {
-    /// Flush all writers.
-    for (auto& writer : m_l2_tick_writers | std::views::values) {
-        writer.flush();
-        writer.close();
-    }
-    for (auto& writer : m_ranged_tick_writers | std::views::values) {
-        writer.flush();
-        writer.close();
-    }
+    /// Hand off all buffers, writer thread writes them before exiting.
+    for (auto& chunk : m_l2_tick_buffers.chunks | std::views::values)
+        hand_off(chunk);
+    for (auto& chunk : m_ranged_tick_buffers.chunks | std::views::values)
+        hand_off(chunk);
+
+    m_is_running = false;
+    m_chunk_cv.notify_all();
+
+    m_writer_thread.joinable() ? m_writer_thread.join() : void();
 }
 
 void trade::reporter::CSVReporter::l2_tick_generated(const std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick)
 {
-    new_l2_tick_writer(generated_l2_tick->symbol());
+    auto& chunk = new_l2_tick_buffer(generated_l2_tick->symbol());
 
-    m_l2_tick_writers[generated_l2_tick->symbol()] << fmt::format(
+    fmt::format_to(
+        std::back_inserter(chunk.data),
         "{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n",
         generated_l2_tick->symbol(),
         generated_l2_tick->price_1000x(),
@@ -50,17 +77,20 @@ void trade::reporter::CSVReporter::l2_tick_generated(const std::shared_ptr<types
         generated_l2_tick->bid_levels().at(4).quantity(),
         /// Time.
         generated_l2_tick->exchange_time(),
-        utilities::Now<std::string>()()
+        m_l2_tick_buffers.now()
     );
 
+    try_hand_off(m_l2_tick_buffers, chunk);
+
     m_outside->l2_tick_generated(generated_l2_tick);
 }
 
 void trade::reporter::CSVReporter::ranged_tick_generated(const std::shared_ptr<types::RangedTick> ranged_tick)
 {
-    new_ranged_tick_writer(ranged_tick->symbol());
+    auto& chunk = new_ranged_tick_buffer(ranged_tick->symbol());
 
-    m_ranged_tick_writers[ranged_tick->symbol()] << fmt::format(
+    fmt::format_to(
+        std::back_inserter(chunk.data),
         "{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{},{}\n",
         ranged_tick->symbol(),
         ranged_tick->exchange_date(),
@@ -111,110 +141,264 @@ void trade::reporter::CSVReporter::ranged_tick_generated(const std::shared_ptr<t
         ranged_tick->bid_price_1_valid_duration_1000x()
     );
 
+    try_hand_off(m_ranged_tick_buffers, chunk);
+
     m_outside->ranged_tick_generated(ranged_tick);
 }
 
-void trade::reporter::CSVReporter::new_l2_tick_writer(const std::string& symbol)
+trade::reporter::CSVReporter::Chunk& trade::reporter::CSVReporter::new_l2_tick_buffer(const std::string& symbol)
+{
+    return new_buffer(
+        m_l2_tick_buffers,
+        symbol,
+        "l2-tick",
+        "symbol,"
+        "price_1000x,"
+        "quantity,"
+        "ask_unique_id,"
+        "bid_unique_id,"
+        "sell_price_1000x_5,"
+        "sell_quantity_5,"
+        "sell_price_1000x_4,"
+        "sell_quantity_4,"
+        "sell_price_1000x_3,"
+        "sell_quantity_3,"
+        "sell_price_1000x_2,"
+        "sell_quantity_2,"
+        "sell_price_1000x_1,"
+        "sell_quantity_1,"
+        "buy_price_1000x_1,"
+        "buy_quantity_1,"
+        "buy_price_1000x_2,"
+        "buy_quantity_2,"
+        "buy_price_1000x_3,"
+        "buy_quantity_3,"
+        "buy_price_1000x_4,"
+        "buy_quantity_4,"
+        "buy_price_1000x_5,"
+        "buy_quantity_5,"
+        /// Time.
+        "exchange_time,"
+        "local_system_time\n"
+    );
+}
+
+trade::reporter::CSVReporter::Chunk& trade::reporter::CSVReporter::new_ranged_tick_buffer(const std::string& symbol)
+{
+    return new_buffer(
+        m_ranged_tick_buffers,
+        symbol,
+        "ranged-tick",
+        "symbol,"
+        "exchange_date,"
+        "exchange_time,"
+        "start_time,"
+        "end_time,"
+        "sell_price_1000x_5,"
+        "sell_price_1000x_4,"
+        "sell_price_1000x_3,"
+        "sell_price_1000x_2,"
+        "sell_price_1000x_1,"
+        "buy_price_1000x_1,"
+        "buy_price_1000x_2,"
+        "buy_price_1000x_3,"
+        "buy_price_1000x_4,"
+        "buy_price_1000x_5,"
+        "active_traded_sell_number,"
+        "active_sell_number,"
+        "active_sell_quantity,"
+        "active_sell_amount_1000x,"
+        "active_traded_buy_number,"
+        "active_buy_number,"
+        "active_buy_quantity,"
+        "active_buy_amount_1000x,"
+        "weighted_ask_price_5,"
+        "weighted_ask_price_4,"
+        "weighted_ask_price_3,"
+        "weighted_ask_price_2,"
+        "weighted_ask_price_1,"
+        "weighted_bid_price_1,"
+        "weighted_bid_price_2,"
+        "weighted_bid_price_3,"
+        "weighted_bid_price_4,"
+        "weighted_bid_price_5,"
+        "aggressive_sell_number,"
+        "aggressive_buy_number,"
+        "new_added_ask_1_quantity,"
+        "new_added_bid_1_quantity,"
+        "new_canceled_ask_1_quantity,"
+        "new_canceled_bid_1_quantity,"
+        "new_canceled_ask_all_quantity,"
+        "new_canceled_bid_all_quantity,"
+        "big_ask_amount_1000x,"
+        "big_bid_amount_1000x,"
+        "highest_price_1000x,"
+        "lowest_price_1000x,"
+        "ask_price_1_valid_duration_1000x,"
+        "bid_price_1_valid_duration_1000x\n"
+    );
+}
+
+trade::reporter::CSVReporter::Chunk& trade::reporter::CSVReporter::new_buffer(
+    Buffers& buffers,
+    const std::string& symbol,
+    const std::string& suffix,
+    const std::string_view header
+)
+{
+    const auto it = buffers.chunks.find(symbol);
+
+    if (it != buffers.chunks.end()) [[likely]]
+        return it->second;
+
+    const auto path = fmt::format("{}/{}/{}-{}.csv", m_output_folder, utilities::Date<std::string>()(), symbol, suffix);
+
+    logger->info("Opened new {} writer at {}", suffix, path);
+
+    auto& chunk = buffers.chunks[symbol];
+
+    chunk.path = path;
+    chunk.data.reserve(m_buffer_size);
+    chunk.data.append(header);
+
+    return chunk;
+}
+
+void trade::reporter::CSVReporter::try_hand_off(Buffers& buffers, Chunk& chunk)
+{
+    if (chunk.data.size() >= m_buffer_size) [[unlikely]]
+        hand_off(chunk);
+
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now - buffers.last_hand_off < m_flush_interval) [[likely]]
+        return;
+
+    for (auto& pending : buffers.chunks | std::views::values)
+        hand_off(pending);
+
+    buffers.last_hand_off = now;
+}
+
+void trade::reporter::CSVReporter::hand_off(Chunk& chunk)
+{
+    if (chunk.data.empty())
+        return;
+
+    {
+        std::unique_lock lock(m_chunk_mutex);
+
+        /// A chunk larger than the limit is still taken once all before are written.
+        if (m_pending_size > 0 && m_pending_size + chunk.data.size() > m_max_pending_size) [[unlikely]] {
+            const size_t stalls = ++m_stalls;
+
+            /// Logged at 1, 2, 4, ... so that a slow disk does not flood logs.
+            std::has_single_bit(stalls) ? logger->warn("CSVReporter writer is lagging with {} bytes pending, blocked {} times so far", m_pending_size, stalls) : void();
+
+            m_space_cv.wait(lock, [this, &chunk] { return m_pending_size == 0 || m_pending_size + chunk.data.size() <= m_max_pending_size; });
+        }
+
+        m_pending_size += chunk.data.size();
+
+        std::string spare;
+
+        if (!m_spare_strings.empty()) {
+            spare = std::move(m_spare_strings.back());
+            m_spare_strings.pop_back();
+        }
+
+        m_chunks.push_back({chunk.path, std::move(chunk.data)});
+        chunk.data = std::move(spare);
+    }
+
+    m_chunk_cv.notify_one();
+
+    chunk.data.reserve(m_buffer_size);
+}
+
+void trade::reporter::CSVReporter::writer()
+{
+    std::vector<Chunk> chunks;
+
+    while (true) {
+        {
+            std::unique_lock lock(m_chunk_mutex);
+            m_chunk_cv.wait(lock, [this] { return !m_chunks.empty() || !m_is_running; });
+
+            if (m_chunks.empty()) [[unlikely]]
+                break;
+
+            chunks.swap(m_chunks);
+        }
+
+        for (const auto& chunk : chunks)
+            write(chunk);
+
+        {
+            std::lock_guard lock(m_chunk_mutex);
+
+            /// Keep some strings for reuse.
+            for (auto& chunk : chunks) {
+                m_pending_size -= chunk.data.size();
+
+                if (m_spare_strings.size() >= m_max_open_files)
+                    continue;
+
+                chunk.data.clear();
+                m_spare_strings.push_back(std::move(chunk.data));
+            }
+        }
+
+        m_space_cv.notify_all();
+
+        chunks.clear();
+    }
+
+    for (auto& file : m_files | std::views::values)
+        file.first.close();
+
+    logger->info("CSVReporter writer exited, {} files written, blocked {} times for pending bytes", m_created_files.size(), m_stalls);
+}
+
+void trade::reporter::CSVReporter::write(const Chunk& chunk)
 {
-    if (!m_l2_tick_writers.contains(symbol)) [[unlikely]] {
-        const std::filesystem::path file_path = fmt::format("{}/{}/{}-l2-tick.csv", m_output_folder, utilities::Date<std::string>()(), symbol);
-
-        create_directories(std::filesystem::path(file_path).parent_path());
-        m_l2_tick_writers.emplace(symbol, std::ofstream(file_path));
-
-        logger->info("Opened new l2 tick writer at {}", file_path.string());
-
-        m_l2_tick_writers[symbol]
-            << "symbol,"
-            << "price_1000x,"
-            << "quantity,"
-            << "ask_unique_id,"
-            << "bid_unique_id,"
-            << "sell_price_1000x_5,"
-            << "sell_quantity_5,"
-            << "sell_price_1000x_4,"
-            << "sell_quantity_4,"
-            << "sell_price_1000x_3,"
-            << "sell_quantity_3,"
-            << "sell_price_1000x_2,"
-            << "sell_quantity_2,"
-            << "sell_price_1000x_1,"
-            << "sell_quantity_1,"
-            << "buy_price_1000x_1,"
-            << "buy_quantity_1,"
-            << "buy_price_1000x_2,"
-            << "buy_quantity_2,"
-            << "buy_price_1000x_3,"
-            << "buy_quantity_3,"
-            << "buy_price_1000x_4,"
-            << "buy_quantity_4,"
-            << "buy_price_1000x_5,"
-            << "buy_quantity_5,"
-            /// Time.
-            << "exchange_time,"
-            << "local_system_time"
-            << std::endl;
+    auto& file = open_file(chunk.path);
+
+    file.write(chunk.data.data(), static_cast<std::streamsize>(chunk.data.size()));
+
+    if (!file) [[unlikely]] {
+        logger->error("Failed to write {} bytes to {}", chunk.data.size(), chunk.path);
+        file.clear();
     }
 }
 
-void trade::reporter::CSVReporter::new_ranged_tick_writer(const std::string& symbol)
+std::ofstream& trade::reporter::CSVReporter::open_file(const std::string& path)
 {
-    if (!m_ranged_tick_writers.contains(symbol)) [[unlikely]] {
-        const std::filesystem::path file_path = fmt::format("{}/{}/{}-ranged-tick.csv", m_output_folder, utilities::Date<std::string>()(), symbol);
-
-        create_directories(std::filesystem::path(file_path).parent_path());
-        m_ranged_tick_writers.emplace(symbol, std::ofstream(file_path));
-
-        logger->info("Opened new ranged tick writer at {}", file_path.string());
-
-        m_ranged_tick_writers[symbol]
-            << "symbol,"
-            << "exchange_date,"
-            << "exchange_time,"
-            << "start_time,"
-            << "end_time,"
-            << "sell_price_1000x_5,"
-            << "sell_price_1000x_4,"
-            << "sell_price_1000x_3,"
-            << "sell_price_1000x_2,"
-            << "sell_price_1000x_1,"
-            << "buy_price_1000x_1,"
-            << "buy_price_1000x_2,"
-            << "buy_price_1000x_3,"
-            << "buy_price_1000x_4,"
-            << "buy_price_1000x_5,"
-            << "active_traded_sell_number,"
-            << "active_sell_number,"
-            << "active_sell_quantity,"
-            << "active_sell_amount_1000x,"
-            << "active_traded_buy_number,"
-            << "active_buy_number,"
-            << "active_buy_quantity,"
-            << "active_buy_amount_1000x,"
-            << "weighted_ask_price_5,"
-            << "weighted_ask_price_4,"
-            << "weighted_ask_price_3,"
-            << "weighted_ask_price_2,"
-            << "weighted_ask_price_1,"
-            << "weighted_bid_price_1,"
-            << "weighted_bid_price_2,"
-            << "weighted_bid_price_3,"
-            << "weighted_bid_price_4,"
-            << "weighted_bid_price_5,"
-            << "aggressive_sell_number,"
-            << "aggressive_buy_number,"
-            << "new_added_ask_1_quantity,"
-            << "new_added_bid_1_quantity,"
-            << "new_canceled_ask_1_quantity,"
-            << "new_canceled_bid_1_quantity,"
-            << "new_canceled_ask_all_quantity,"
-            << "new_canceled_bid_all_quantity,"
-            << "big_ask_amount_1000x,"
-            << "big_bid_amount_1000x,"
-            << "highest_price_1000x,"
-            << "lowest_price_1000x,"
-            << "ask_price_1_valid_duration_1000x,"
-            << "bid_price_1_valid_duration_1000x"
-            << std::endl;
+    const auto it = m_files.find(path);
+
+    if (it != m_files.end()) [[likely]] {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+        return it->second.first;
+    }
+
+    if (m_files.size() >= m_max_open_files) {
+        /// Close least recently written file.
+        m_files.erase(m_lru.back());
+        m_lru.pop_back();
     }
+
+    /// Truncate files left by previous runs, but append to those evicted in
+    /// this run.
+    const auto mode = m_created_files.insert(path).second ? std::ios::out | std::ios::trunc : std::ios::out | std::ios::app;
+
+    create_directories(std::filesystem::path(path).parent_path());
+
+    m_lru.push_front(path);
+
+    auto& file = m_files.emplace(path, std::make_pair(std::ofstream(path, mode), m_lru.begin())).first->second.first;
+
+    if (!file.is_open()) [[unlikely]]
+        logger->error("Failed to open {}", path);
+
+    return file;
 }
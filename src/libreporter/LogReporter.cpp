@@ -93,3 +93,10 @@ void trade::reporter::LogReporter::ranged_tick_generated(std::shared_ptr<types::
 
     m_outside->ranged_tick_generated(ranged_tick);
 }
+
+void trade::reporter::LogReporter::md_seq_gap_detected(const std::shared_ptr<types::SeqGap> seq_gap)
+{
+    md_logger->warn("Sequence gap detected: {}", utilities::ToJSON()(*seq_gap));
+
+    m_outside->md_seq_gap_detected(seq_gap);
+}
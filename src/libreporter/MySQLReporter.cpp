@@ -1,4 +1,152 @@
+#include <mysqlx/xdevapi.h>
+
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+
 #include "libreporter/MySQLReporter.h"
+#include "utilities/ToJSON.hpp"
+
+namespace
+{
+
+/// Session of X DevAPI to one table.
+class XDevAPISession final: public trade::reporter::MySQLReporter::Session
+{
+public:
+    XDevAPISession(
+        const std::string& url,
+        const std::string& user,
+        const std::string& password,
+        const std::string& database,
+        const std::string& table
+    ) : m_session(fmt::format("mysqlx://{}:{}@{}?connect-timeout=10", user, password, url)),
+        m_table(m_session.getSchema(database).getTable(table))
+    {
+    }
+
+    ~XDevAPISession() override
+    {
+        m_session.close();
+    }
+
+public:
+    void insert(const std::vector<std::shared_ptr<trade::types::RangedTick>>& ranged_ticks) override
+    {
+        auto statement = m_table.insert(
+            "symbol",
+            "exchange_date",
+            "exchange_time",
+            "start_time",
+            "end_time",
+            "sell_price_1000x_5",
+            "sell_price_1000x_4",
+            "sell_price_1000x_3",
+            "sell_price_1000x_2",
+            "sell_price_1000x_1",
+            "buy_price_1000x_1",
+            "buy_price_1000x_2",
+            "buy_price_1000x_3",
+            "buy_price_1000x_4",
+            "buy_price_1000x_5",
+            "active_traded_sell_number",
+            "active_sell_number",
+            "active_sell_quantity",
+            "active_sell_amount_1000x",
+            "active_traded_buy_number",
+            "active_buy_number",
+            "active_buy_quantity",
+            "active_buy_amount_1000x",
+            "weighted_ask_price_5",
+            "weighted_ask_price_4",
+            "weighted_ask_price_3",
+            "weighted_ask_price_2",
+            "weighted_ask_price_1",
+            "weighted_bid_price_1",
+            "weighted_bid_price_2",
+            "weighted_bid_price_3",
+            "weighted_bid_price_4",
+            "weighted_bid_price_5",
+            "aggressive_sell_number",
+            "aggressive_buy_number",
+            "new_added_ask_1_quantity",
+            "new_added_bid_1_quantity",
+            "new_canceled_ask_1_quantity",
+            "new_canceled_bid_1_quantity",
+            "new_canceled_ask_all_quantity",
+            "new_canceled_bid_all_quantity",
+            "big_ask_amount_1000x",
+            "big_bid_amount_1000x",
+            "highest_price_1000x",
+            "lowest_price_1000x",
+            "ask_price_1_valid_duration_1000x",
+            "bid_price_1_valid_duration_1000x"
+        );
+
+        /// All rows go in one multi-row INSERT.
+        for (const auto& ranged_tick_ptr : ranged_ticks) {
+            const auto& ranged_tick = *ranged_tick_ptr;
+
+            statement.values(
+                ranged_tick.symbol(),
+                ranged_tick.exchange_date(),
+                ranged_tick.exchange_time(),
+                ranged_tick.start_time(),
+                ranged_tick.end_time(),
+                ranged_tick.ask_levels().at(4).price_1000x(),
+                ranged_tick.ask_levels().at(3).price_1000x(),
+                ranged_tick.ask_levels().at(2).price_1000x(),
+                ranged_tick.ask_levels().at(1).price_1000x(),
+                ranged_tick.ask_levels().at(0).price_1000x(),
+                ranged_tick.bid_levels().at(0).price_1000x(),
+                ranged_tick.bid_levels().at(1).price_1000x(),
+                ranged_tick.bid_levels().at(2).price_1000x(),
+                ranged_tick.bid_levels().at(3).price_1000x(),
+                ranged_tick.bid_levels().at(4).price_1000x(),
+                ranged_tick.active_traded_sell_number(),
+                ranged_tick.active_sell_number(),
+                ranged_tick.active_sell_quantity(),
+                ranged_tick.active_sell_amount_1000x(),
+                ranged_tick.active_traded_buy_number(),
+                ranged_tick.active_buy_number(),
+                ranged_tick.active_buy_quantity(),
+                ranged_tick.active_buy_amount_1000x(),
+                ranged_tick.weighted_ask_price().at(4),
+                ranged_tick.weighted_ask_price().at(3),
+                ranged_tick.weighted_ask_price().at(2),
+                ranged_tick.weighted_ask_price().at(1),
+                ranged_tick.weighted_ask_price().at(0),
+                ranged_tick.weighted_bid_price().at(0),
+                ranged_tick.weighted_bid_price().at(1),
+                ranged_tick.weighted_bid_price().at(2),
+                ranged_tick.weighted_bid_price().at(3),
+                ranged_tick.weighted_bid_price().at(4),
+                ranged_tick.aggressive_sell_number(),
+                ranged_tick.aggressive_buy_number(),
+                ranged_tick.new_added_ask_1_quantity(),
+                ranged_tick.new_added_bid_1_quantity(),
+                ranged_tick.new_canceled_ask_1_quantity(),
+                ranged_tick.new_canceled_bid_1_quantity(),
+                ranged_tick.new_canceled_ask_all_quantity(),
+                ranged_tick.new_canceled_bid_all_quantity(),
+                ranged_tick.big_ask_amount_1000x(),
+                ranged_tick.big_bid_amount_1000x(),
+                ranged_tick.highest_price_1000x(),
+                ranged_tick.lowest_price_1000x(),
+                ranged_tick.ask_price_1_valid_duration_1000x(),
+                ranged_tick.bid_price_1_valid_duration_1000x()
+            );
+        }
+
+        statement.execute();
+    }
+
+private:
+    mysqlx::Session m_session;
+    mysqlx::Table m_table;
+};
+
+} // namespace
 
 trade::reporter::MySQLReporter::MySQLReporter(
     const std::string& url,
@@ -6,131 +154,232 @@ trade::reporter::MySQLReporter::MySQLReporter(
     const std::string& password,
     const std::string& database,
     const std::string& table,
-    const std::shared_ptr<IReporter>& outside
+    const std::shared_ptr<IReporter>& outside,
+    const size_t batch_size,
+    const int64_t flush_interval_ms,
+    const size_t buffer_capacity,
+    const size_t max_retries,
+    std::string spill_file
+) : MySQLReporter(
+        fmt::format("{} as user {}", url, user),
+        url.empty() ? SessionFactory() : [=]() -> std::unique_ptr<Session> { return std::make_unique<XDevAPISession>(url, user, password, database, table); },
+        outside,
+        batch_size,
+        flush_interval_ms,
+        buffer_capacity,
+        max_retries,
+        std::move(spill_file)
+    )
+{
+}
+
+trade::reporter::MySQLReporter::MySQLReporter(
+    std::string target,
+    SessionFactory make_session,
+    const std::shared_ptr<IReporter>& outside,
+    const size_t batch_size,
+    const int64_t flush_interval_ms,
+    const size_t buffer_capacity,
+    const size_t max_retries,
+    std::string spill_file
 ) : AppBase("MySQLReporter"),
     NopReporter(outside),
+    m_target(std::move(target)),
+    m_make_session(std::move(make_session)),
+    m_batch_size(std::max<size_t>(batch_size, 1)),
+    m_flush_interval(flush_interval_ms),
+    m_buffer_capacity(std::max(buffer_capacity, m_batch_size)),
+    m_max_retries(max_retries),
+    m_spill_file(std::move(spill_file)),
+    m_is_running(m_make_session != nullptr),
     m_outside(outside)
 {
-    try {
-        m_sess   = std::make_shared<mysqlx::Session>(fmt::format("mysqlx://{}:{}@{}?connect-timeout=10", user, password, url));
-        m_schema = std::make_shared<mysqlx::Schema>(m_sess->getSchema(database));
-        m_table  = std::make_shared<mysqlx::Table>(m_schema->getTable(table));
-    }
-    catch (const std::exception& e) {
-        logger->error("MySQLReporter failed to connect to {} as user {}: {}", url, user, e.what());
+    if (!m_is_running) {
+        logger->info("MySQLReporter is disabled since no url is given");
         return;
     }
 
-    logger->info("MySQLReporter connected to {} as user {}", url, user);
+    connect();
+
+    m_flusher_thread = std::thread(&MySQLReporter::flusher, this);
+}
+
+trade::reporter::MySQLReporter::~MySQLReporter()
+{
+    m_is_running = false;
+    m_buffer_cv.notify_all();
+
+    /// Flusher thread drains the buffer before exiting.
+    m_flusher_thread.joinable() ? m_flusher_thread.join() : void();
+
+    m_metrics.batches > 0 ? log_metrics() : void();
 }
 
 void trade::reporter::MySQLReporter::ranged_tick_generated(const std::shared_ptr<types::RangedTick> ranged_tick)
 {
-    if (m_table != nullptr)
-        m_table->insert(
-                   "symbol",
-                   "exchange_date",
-                   "exchange_time",
-                   "start_time",
-                   "end_time",
-                   "sell_price_1000x_5",
-                   "sell_price_1000x_4",
-                   "sell_price_1000x_3",
-                   "sell_price_1000x_2",
-                   "sell_price_1000x_1",
-                   "buy_price_1000x_1",
-                   "buy_price_1000x_2",
-                   "buy_price_1000x_3",
-                   "buy_price_1000x_4",
-                   "buy_price_1000x_5",
-                   "active_traded_sell_number",
-                   "active_sell_number",
-                   "active_sell_quantity",
-                   "active_sell_amount_1000x",
-                   "active_traded_buy_number",
-                   "active_buy_number",
-                   "active_buy_quantity",
-                   "active_buy_amount_1000x",
-                   "weighted_ask_price_5",
-                   "weighted_ask_price_4",
-                   "weighted_ask_price_3",
-                   "weighted_ask_price_2",
-                   "weighted_ask_price_1",
-                   "weighted_bid_price_1",
-                   "weighted_bid_price_2",
-                   "weighted_bid_price_3",
-                   "weighted_bid_price_4",
-                   "weighted_bid_price_5",
-                   "aggressive_sell_number",
-                   "aggressive_buy_number",
-                   "new_added_ask_1_quantity",
-                   "new_added_bid_1_quantity",
-                   "new_canceled_ask_1_quantity",
-                   "new_canceled_bid_1_quantity",
-                   "new_canceled_ask_all_quantity",
-                   "new_canceled_bid_all_quantity",
-                   "big_ask_amount_1000x",
-                   "big_bid_amount_1000x",
-                   "highest_price_1000x",
-                   "lowest_price_1000x",
-                   "ask_price_1_valid_duration_1000x",
-                   "bid_price_1_valid_duration_1000x"
-        )
-            .values(
-                ranged_tick->symbol(),
-                ranged_tick->exchange_date(),
-                ranged_tick->exchange_time(),
-                ranged_tick->start_time(),
-                ranged_tick->end_time(),
-                ranged_tick->ask_levels().at(4).price_1000x(),
-                ranged_tick->ask_levels().at(3).price_1000x(),
-                ranged_tick->ask_levels().at(2).price_1000x(),
-                ranged_tick->ask_levels().at(1).price_1000x(),
-                ranged_tick->ask_levels().at(0).price_1000x(),
-                ranged_tick->bid_levels().at(0).price_1000x(),
-                ranged_tick->bid_levels().at(1).price_1000x(),
-                ranged_tick->bid_levels().at(2).price_1000x(),
-                ranged_tick->bid_levels().at(3).price_1000x(),
-                ranged_tick->bid_levels().at(4).price_1000x(),
-                ranged_tick->active_traded_sell_number(),
-                ranged_tick->active_sell_number(),
-                ranged_tick->active_sell_quantity(),
-                ranged_tick->active_sell_amount_1000x(),
-                ranged_tick->active_traded_buy_number(),
-                ranged_tick->active_buy_number(),
-                ranged_tick->active_buy_quantity(),
-                ranged_tick->active_buy_amount_1000x(),
-                ranged_tick->weighted_ask_price().at(4),
-                ranged_tick->weighted_ask_price().at(3),
-                ranged_tick->weighted_ask_price().at(2),
-                ranged_tick->weighted_ask_price().at(1),
-                ranged_tick->weighted_ask_price().at(0),
-                ranged_tick->weighted_bid_price().at(0),
-                ranged_tick->weighted_bid_price().at(1),
-                ranged_tick->weighted_bid_price().at(2),
-                ranged_tick->weighted_bid_price().at(3),
-                ranged_tick->weighted_bid_price().at(4),
-                ranged_tick->aggressive_sell_number(),
-                ranged_tick->aggressive_buy_number(),
-                ranged_tick->new_added_ask_1_quantity(),
-                ranged_tick->new_added_bid_1_quantity(),
-                ranged_tick->new_canceled_ask_1_quantity(),
-                ranged_tick->new_canceled_bid_1_quantity(),
-                ranged_tick->new_canceled_ask_all_quantity(),
-                ranged_tick->new_canceled_bid_all_quantity(),
-                ranged_tick->big_ask_amount_1000x(),
-                ranged_tick->big_bid_amount_1000x(),
-                ranged_tick->highest_price_1000x(),
-                ranged_tick->lowest_price_1000x(),
-                ranged_tick->ask_price_1_valid_duration_1000x(),
-                ranged_tick->bid_price_1_valid_duration_1000x()
-            )
-            .execute();
+    if (m_is_running) [[likely]] {
+        std::unique_lock lock(m_buffer_mutex);
+
+        /// Never hold up market data for a slow database.
+        if (m_buffer.size() >= m_buffer_capacity) [[unlikely]] {
+            const size_t dropped = ++m_metrics.dropped_rows;
+
+            lock.unlock();
+
+            /// Logged at 1, 2, 4, ... so that a stalled database does not flood logs.
+            std::has_single_bit(dropped) ? logger->warn("MySQLReporter buffer is full with {} rows, dropped {} rows so far", m_buffer_capacity, dropped) : void();
+
+            m_outside->ranged_tick_generated(ranged_tick);
+            return;
+        }
+
+        m_buffer.push_back(ranged_tick);
+
+        m_metrics.queue_depth = m_buffer.size();
+        m_metrics.max_queue_depth = std::max(m_metrics.max_queue_depth.load(), m_buffer.size());
+
+        if (m_buffer.size() >= m_batch_size)
+            m_buffer_cv.notify_one();
+    }
 
     m_outside->ranged_tick_generated(ranged_tick);
 }
 
-trade::reporter::MySQLReporter::~MySQLReporter()
+bool trade::reporter::MySQLReporter::connect()
+{
+    try {
+        m_session = m_make_session();
+    }
+    catch (const std::exception& e) {
+        logger->error("MySQLReporter failed to connect to {}: {}", m_target, e.what());
+
+        m_session = nullptr;
+
+        return false;
+    }
+
+    logger->info("MySQLReporter connected to {}", m_target);
+
+    return true;
+}
+
+void trade::reporter::MySQLReporter::flusher()
+{
+    std::vector<std::shared_ptr<types::RangedTick>> ranged_ticks;
+    ranged_ticks.reserve(m_batch_size);
+
+    while (true) {
+        {
+            std::unique_lock lock(m_buffer_mutex);
+
+            m_buffer_cv.wait_for(lock, m_flush_interval, [this] {
+                return m_buffer.size() >= m_batch_size || !m_is_running;
+            });
+
+            if (m_buffer.empty()) {
+                if (!m_is_running)
+                    break;
+
+                continue;
+            }
+
+            const auto size = std::min(m_buffer.size(), m_batch_size);
+
+            std::move(m_buffer.begin(), m_buffer.begin() + static_cast<int64_t>(size), std::back_inserter(ranged_ticks));
+            m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<int64_t>(size));
+
+            m_metrics.queue_depth = m_buffer.size();
+        }
+
+        flush(ranged_ticks);
+        ranged_ticks.clear();
+    }
+}
+
+void trade::reporter::MySQLReporter::flush(const std::vector<std::shared_ptr<types::RangedTick>>& ranged_ticks)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    bool inserted = false;
+
+    for (size_t retry = 0; retry <= m_max_retries && !inserted; retry++) {
+        if (retry > 0) {
+            /// Once stopping, a failed batch is spilled at once, so that an
+            /// unreachable database does not hold up exiting.
+            if (!m_is_running)
+                break;
+
+            m_metrics.retries++;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * (1 << std::min<size_t>(retry, 6))));
+        }
+
+        /// Reconnect if connection was lost, but not once stopping.
+        if (m_session == nullptr && (!m_is_running || !connect()))
+            continue;
+
+        try {
+            m_session->insert(ranged_ticks);
+            inserted = true;
+        }
+        catch (const std::exception& e) {
+            logger->error("MySQLReporter failed to insert {} rows (attempt {}/{}): {}", ranged_ticks.size(), retry + 1, m_max_retries + 1, e.what());
+            m_session = nullptr;
+        }
+    }
+
+    if (inserted)
+        m_metrics.inserted_rows += ranged_ticks.size();
+    else
+        spill(ranged_ticks);
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    m_metrics.batches++;
+    m_metrics.last_batch_size = ranged_ticks.size();
+    m_metrics.last_flush_us   = elapsed;
+    m_metrics.max_flush_us    = std::max(m_metrics.max_flush_us.load(), elapsed);
+    m_metrics.total_flush_us += elapsed;
+
+    logger->debug("MySQLReporter flushed {} rows in {}us, {} rows buffered", ranged_ticks.size(), elapsed, m_metrics.queue_depth.load());
+}
+
+void trade::reporter::MySQLReporter::spill(const std::vector<std::shared_ptr<types::RangedTick>>& ranged_ticks)
+{
+    if (m_spill_file.empty()) {
+        logger->error("MySQLReporter dropped {} rows since no spill file is set", ranged_ticks.size());
+        m_metrics.dropped_rows += ranged_ticks.size();
+        return;
+    }
+
+    if (!m_spill_stream.is_open()) {
+        const auto directory = std::filesystem::path(m_spill_file).parent_path();
+        if (!directory.empty() && !exists(directory))
+            create_directories(directory);
+
+        m_spill_stream.open(m_spill_file, std::ios::app);
+    }
+
+    for (const auto& ranged_tick : ranged_ticks)
+        m_spill_stream << utilities::ToJSON()(*ranged_tick) << '\n';
+
+    m_spill_stream.flush();
+
+    logger->warn("MySQLReporter spilled {} rows to {}", ranged_ticks.size(), m_spill_file);
+    m_metrics.spilled_rows += ranged_ticks.size();
+}
+
+void trade::reporter::MySQLReporter::log_metrics() const
 {
-    m_sess != nullptr ? m_sess->close() : void();
+    logger->info(
+        "MySQLReporter inserted {} rows in {} batches, spilled {}, dropped {}, retried {} times, max queue depth {}, average flush {}us, max flush {}us",
+        m_metrics.inserted_rows.load(),
+        m_metrics.batches.load(),
+        m_metrics.spilled_rows.load(),
+        m_metrics.dropped_rows.load(),
+        m_metrics.retries.load(),
+        m_metrics.max_queue_depth.load(),
+        m_metrics.batches == 0 ? 0 : m_metrics.total_flush_us / static_cast<int64_t>(m_metrics.batches),
+        m_metrics.max_flush_us.load()
+    );
 }
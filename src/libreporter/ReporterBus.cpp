@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <type_traits>
+
+#include "libreporter/ReporterBus.h"
+
+namespace
+{
+
+/// Calls the reporter method of the event type.
+struct Deliverer {
+    trade::reporter::IReporter& reporter;
+
+    /// Order.
+    void operator()(const std::shared_ptr<trade::types::BrokerAcceptance>& event) const { reporter.broker_accepted(event); }
+    void operator()(const std::shared_ptr<trade::types::ExchangeAcceptance>& event) const { reporter.exchange_accepted(event); }
+    void operator()(const std::shared_ptr<trade::types::OrderRejection>& event) const { reporter.order_rejected(event); }
+
+    /// Cancel.
+    void operator()(const std::shared_ptr<trade::types::CancelBrokerAcceptance>& event) const { reporter.cancel_broker_accepted(event); }
+    void operator()(const std::shared_ptr<trade::types::CancelExchangeAcceptance>& event) const { reporter.cancel_exchange_accepted(event); }
+    void operator()(const std::shared_ptr<trade::types::CancelSuccess>& event) const { reporter.cancel_success(event); }
+    void operator()(const std::shared_ptr<trade::types::CancelOrderRejection>& event) const { reporter.cancel_order_rejected(event); }
+
+    /// Trade.
+    void operator()(const std::shared_ptr<trade::types::Trade>& event) const { reporter.trade_accepted(event); }
+
+    /// Market data.
+    void operator()(const std::shared_ptr<trade::types::OrderTick>& event) const { reporter.exchange_order_tick_arrived(event); }
+    void operator()(const std::shared_ptr<trade::types::TradeTick>& event) const { reporter.exchange_trade_tick_arrived(event); }
+    void operator()(const std::shared_ptr<trade::types::ExchangeL2Snap>& event) const { reporter.exchange_l2_snap_arrived(event); }
+    void operator()(const std::shared_ptr<trade::types::GeneratedL2Tick>& event) const { reporter.l2_tick_generated(event); }
+    void operator()(const std::shared_ptr<trade::types::RangedTick>& event) const { reporter.ranged_tick_generated(event); }
+    void operator()(const std::shared_ptr<trade::types::SeqGap>& event) const { reporter.md_seq_gap_detected(event); }
+};
+
+/// Market data may be dropped by a lagging sink, order lifecycle events and
+/// seq gaps are kept for audit.
+template<typename T>
+constexpr bool is_droppable = std::is_same_v<T, trade::types::OrderTick>
+                           || std::is_same_v<T, trade::types::TradeTick>
+                           || std::is_same_v<T, trade::types::ExchangeL2Snap>
+                           || std::is_same_v<T, trade::types::GeneratedL2Tick>
+                           || std::is_same_v<T, trade::types::RangedTick>;
+
+template<typename Event>
+bool is_droppable_event(const Event& event)
+{
+    return std::visit([]<typename T>(const std::shared_ptr<T>&) { return is_droppable<T>; }, event);
+}
+
+} // namespace
+
+trade::reporter::ReporterBus::ReporterBus()
+    : AppBase("ReporterBus")
+{
+}
+
+trade::reporter::ReporterBus::~ReporterBus()
+{
+    for (const auto& sink : m_sinks) {
+        {
+            std::lock_guard lock(sink->mutex);
+            sink->is_running = false;
+        }
+
+        sink->not_empty.notify_all();
+        sink->not_full.notify_all();
+    }
+
+    /// Sink threads drain their queues before exiting.
+    for (const auto& sink : m_sinks) {
+        sink->thread.joinable() ? sink->thread.join() : void();
+
+        logger->info(
+            "Sink {} delivered {} events, dropped {}, conflated {}, max depth {}",
+            sink->options.name,
+            sink->stats.delivered.load(),
+            sink->stats.dropped.load(),
+            sink->stats.conflated.load(),
+            sink->stats.max_depth.load()
+        );
+    }
+}
+
+void trade::reporter::ReporterBus::add_sink(std::shared_ptr<IReporter> sink, SinkOptions options)
+{
+    auto new_sink      = std::make_unique<Sink>();
+    new_sink->reporter = std::move(sink);
+    new_sink->options  = std::move(options);
+
+    new_sink->options.capacity = std::max<size_t>(new_sink->options.capacity, 1);
+
+    if (!new_sink->options.is_inline)
+        new_sink->thread = std::thread(&ReporterBus::consume, this, std::ref(*new_sink));
+
+    logger->info(
+        "Added sink {} ({}, priority {}, capacity {}, overflow policy {})",
+        new_sink->options.name,
+        new_sink->options.is_inline ? "inline" : "threaded",
+        new_sink->options.priority,
+        new_sink->options.capacity,
+        static_cast<int>(new_sink->options.overflow_policy)
+    );
+
+    m_sinks.push_back(std::move(new_sink));
+
+    std::ranges::stable_sort(m_sinks, [](const auto& left, const auto& right) {
+        if (left->options.is_inline != right->options.is_inline)
+            return left->options.is_inline;
+
+        return left->options.priority > right->options.priority;
+    });
+}
+
+const trade::reporter::ReporterBus::SinkStats* trade::reporter::ReporterBus::stats(const std::string& name) const
+{
+    const auto it = std::ranges::find_if(m_sinks, [&name](const auto& sink) { return sink->options.name == name; });
+    return it == m_sinks.end() ? nullptr : &(*it)->stats;
+}
+
+void trade::reporter::ReporterBus::broker_accepted(const std::shared_ptr<types::BrokerAcceptance> broker_acceptance)
+{
+    publish(broker_acceptance);
+}
+
+void trade::reporter::ReporterBus::exchange_accepted(const std::shared_ptr<types::ExchangeAcceptance> exchange_acceptance)
+{
+    publish(exchange_acceptance);
+}
+
+void trade::reporter::ReporterBus::order_rejected(const std::shared_ptr<types::OrderRejection> order_rejection)
+{
+    publish(order_rejection);
+}
+
+void trade::reporter::ReporterBus::cancel_broker_accepted(const std::shared_ptr<types::CancelBrokerAcceptance> cancel_broker_acceptance)
+{
+    publish(cancel_broker_acceptance);
+}
+
+void trade::reporter::ReporterBus::cancel_exchange_accepted(const std::shared_ptr<types::CancelExchangeAcceptance> cancel_exchange_acceptance)
+{
+    publish(cancel_exchange_acceptance);
+}
+
+void trade::reporter::ReporterBus::cancel_success(const std::shared_ptr<types::CancelSuccess> cancel_success)
+{
+    publish(cancel_success);
+}
+
+void trade::reporter::ReporterBus::cancel_order_rejected(const std::shared_ptr<types::CancelOrderRejection> cancel_order_rejection)
+{
+    publish(cancel_order_rejection);
+}
+
+void trade::reporter::ReporterBus::trade_accepted(const std::shared_ptr<types::Trade> trade)
+{
+    publish(trade);
+}
+
+void trade::reporter::ReporterBus::exchange_order_tick_arrived(const std::shared_ptr<types::OrderTick> order_tick)
+{
+    publish(order_tick);
+}
+
+void trade::reporter::ReporterBus::exchange_trade_tick_arrived(const std::shared_ptr<types::TradeTick> trade_tick)
+{
+    publish(trade_tick);
+}
+
+void trade::reporter::ReporterBus::exchange_l2_snap_arrived(const std::shared_ptr<types::ExchangeL2Snap> exchange_l2_snap)
+{
+    publish(exchange_l2_snap, exchange_l2_snap->symbol());
+}
+
+void trade::reporter::ReporterBus::l2_tick_generated(const std::shared_ptr<types::GeneratedL2Tick> generated_l2_tick)
+{
+    publish(generated_l2_tick, generated_l2_tick->symbol());
+}
+
+void trade::reporter::ReporterBus::ranged_tick_generated(const std::shared_ptr<types::RangedTick> ranged_tick)
+{
+    publish(ranged_tick, ranged_tick->symbol());
+}
+
+void trade::reporter::ReporterBus::md_seq_gap_detected(const std::shared_ptr<types::SeqGap> seq_gap)
+{
+    publish(seq_gap);
+}
+
+void trade::reporter::ReporterBus::exchange_order_ticks_arrived(const std::span<const std::shared_ptr<types::OrderTick>> order_ticks)
+{
+    publish(order_ticks, &IReporter::exchange_order_ticks_arrived, false);
+}
+
+void trade::reporter::ReporterBus::exchange_trade_ticks_arrived(const std::span<const std::shared_ptr<types::TradeTick>> trade_ticks)
+{
+    publish(trade_ticks, &IReporter::exchange_trade_ticks_arrived, false);
+}
+
+void trade::reporter::ReporterBus::exchange_l2_snaps_arrived(const std::span<const std::shared_ptr<types::ExchangeL2Snap>> exchange_l2_snaps)
+{
+    publish(exchange_l2_snaps, &IReporter::exchange_l2_snaps_arrived, true);
+}
+
+void trade::reporter::ReporterBus::l2_ticks_generated(const std::span<const std::shared_ptr<types::GeneratedL2Tick>> generated_l2_ticks)
+{
+    publish(generated_l2_ticks, &IReporter::l2_ticks_generated, true);
+}
+
+void trade::reporter::ReporterBus::ranged_ticks_generated(const std::span<const std::shared_ptr<types::RangedTick>> ranged_ticks)
+{
+    publish(ranged_ticks, &IReporter::ranged_ticks_generated, true);
+}
+
+void trade::reporter::ReporterBus::publish(const Event& event, const std::string_view symbol)
+{
+    for (const auto& sink : m_sinks) {
+        if (sink->options.is_inline) {
+            deliver(*sink->reporter, event);
+            ++sink->stats.delivered;
+        }
+        else {
+            push(*sink, event, symbol);
+        }
+    }
+}
+
+template<typename T>
+void trade::reporter::ReporterBus::publish(
+    const std::span<const std::shared_ptr<T>> events,
+    void (IReporter::*method)(std::span<const std::shared_ptr<T>>),
+    const bool is_conflatable
+)
+{
+    if (events.empty()) [[unlikely]]
+        return;
+
+    for (const auto& sink : m_sinks) {
+        if (sink->options.is_inline) {
+            ((*sink->reporter).*method)(events);
+            sink->stats.delivered += events.size();
+            continue;
+        }
+
+        std::unique_lock lock(sink->mutex);
+
+        for (const auto& event : events)
+            enqueue(*sink, lock, event, is_conflatable ? std::string_view(event->symbol()) : std::string_view());
+
+        lock.unlock();
+        sink->not_empty.notify_one();
+    }
+}
+
+void trade::reporter::ReporterBus::push(Sink& sink, const Event& event, const std::string_view symbol)
+{
+    std::unique_lock lock(sink.mutex);
+
+    enqueue(sink, lock, event, symbol);
+
+    lock.unlock();
+    sink.not_empty.notify_one();
+}
+
+void trade::reporter::ReporterBus::enqueue(Sink& sink, std::unique_lock<std::mutex>& lock, const Event& event, const std::string_view symbol)
+{
+    const bool conflatable = sink.options.overflow_policy == OverflowPolicy::conflate && !symbol.empty();
+
+    std::string key;
+
+    if (conflatable) {
+        key.reserve(symbol.size() + 1);
+        key.push_back(static_cast<char>(event.index()));
+        key.append(symbol);
+
+        const auto it = sink.latest.find(key);
+
+        /// Replace the queued one if it is not consumed yet.
+        if (it != sink.latest.end() && it->second >= sink.head_seq) {
+            sink.queue[it->second - sink.head_seq] = event;
+            ++sink.stats.conflated;
+            return;
+        }
+    }
+
+    if (sink.queue.size() >= sink.options.capacity) [[unlikely]] {
+        if (sink.options.overflow_policy == OverflowPolicy::drop_oldest && drop(sink, event)) {
+            const size_t dropped = ++sink.stats.dropped;
+
+            /// Logged at powers of two to stay quiet under a long stall.
+            std::has_single_bit(dropped) ? logger->warn("Sink {} is lagging, dropped {} events so far", sink.options.name, dropped) : void();
+
+            if (sink.queue.size() >= sink.options.capacity)
+                return;
+        }
+        else {
+            /// Consumer may be sleeping on events queued earlier in the batch.
+            sink.not_empty.notify_one();
+            sink.not_full.wait(lock, [&sink] { return sink.queue.size() < sink.options.capacity || !sink.is_running; });
+        }
+    }
+
+    sink.queue.push_back(event);
+
+    conflatable ? void(sink.latest[key] = sink.head_seq + sink.queue.size() - 1) : void();
+
+    sink.queue.size() > sink.stats.max_depth ? void(sink.stats.max_depth = sink.queue.size()) : void();
+}
+
+bool trade::reporter::ReporterBus::drop(Sink& sink, const Event& event)
+{
+    const auto it = std::ranges::find_if(sink.queue, is_droppable_event<Event>);
+
+    if (it == sink.queue.end())
+        return is_droppable_event(event);
+
+    /// Sequences of queued events are only kept for conflate.
+    sink.queue.erase(it);
+
+    return true;
+}
+
+void trade::reporter::ReporterBus::consume(Sink& sink)
+{
+    std::vector<Event> events;
+
+    while (true) {
+        {
+            std::unique_lock lock(sink.mutex);
+            sink.not_empty.wait(lock, [&sink] { return !sink.queue.empty() || !sink.is_running; });
+
+            if (sink.queue.empty()) [[unlikely]]
+                break;
+
+            /// Take events in batch to hold the lock shortly.
+            const auto size = std::min<size_t>(sink.queue.size(), 256);
+
+            std::move(sink.queue.begin(), sink.queue.begin() + static_cast<std::ptrdiff_t>(size), std::back_inserter(events));
+            sink.queue.erase(sink.queue.begin(), sink.queue.begin() + static_cast<std::ptrdiff_t>(size));
+            sink.head_seq += size;
+        }
+
+        sink.not_full.notify_all();
+
+        for (const auto& event : events) {
+            try {
+                deliver(*sink.reporter, event);
+            }
+            catch (const std::exception& e) {
+                logger->error("Sink {} failed to handle event: {}", sink.options.name, e.what());
+            }
+        }
+
+        sink.stats.delivered += events.size();
+        events.clear();
+    }
+}
+
+void trade::reporter::ReporterBus::deliver(IReporter& reporter, const Event& event)
+{
+    std::visit(Deliverer {reporter}, event);
+}
@@ -0,0 +1,170 @@
+#include <bit>
+#include <fmt/format.h>
+
+#include "libreporter/ShmLastValueCache.h"
+#include "utilities/MakeAssignable.hpp"
+#include "utilities/TimeHelper.hpp"
+
+trade::reporter::ShmLastValueCache::ShmLastValueCache(const std::string& shm_name, const uint32_t slot_capacity)
+    : AppBase("ShmLastValueCache"),
+      m_shm(boost::interprocess::open_or_create, shm_name.c_str(), boost::interprocess::read_write)
+{
+    const auto size = segment_size(slot_capacity);
+
+    m_shm.truncate(static_cast<boost::interprocess::offset_t>(size));
+    m_region = std::make_unique<boost::interprocess::mapped_region>(m_shm, boost::interprocess::read_write, 0, size);
+
+    const auto address = static_cast<u_char*>(m_region->get_address());
+
+    /// The table is small, clear it all so that no stale value survives.
+    std::memset(address, 0, size);
+
+    m_header    = new (address) SMLastValueCacheHeader;
+    m_directory = reinterpret_cast<SMDirectoryEntry*>(address + sizeof(SMLastValueCacheHeader));
+    m_slots     = reinterpret_cast<SMLastValueSlot*>(address + slots_offset(slot_capacity));
+
+    for (uint32_t i = 0; i < directory_size(slot_capacity); i++)
+        new (m_directory + i) SMDirectoryEntry;
+
+    m_header->slot_capacity  = slot_capacity;
+    m_header->directory_size = directory_size(slot_capacity);
+    m_header->epoch.store(utilities::Now<int64_t>()(), std::memory_order_release);
+
+    logger->info("Created/Opened last value cache {} with {} slots ({} bytes)", shm_name, slot_capacity, size);
+}
+
+bool trade::reporter::ShmLastValueCache::update(const GeneratedL2Tick& generated_l2_tick)
+{
+    const auto slot = acquire_slot(generated_l2_tick.symbol);
+
+    if (slot < 0) [[unlikely]]
+        return false;
+
+    write(m_slots[slot].generated_l2_tick, generated_l2_tick);
+    return true;
+}
+
+bool trade::reporter::ShmLastValueCache::update(const ExchangeL2Snap& exchange_l2_snap)
+{
+    const auto slot = acquire_slot(exchange_l2_snap.symbol);
+
+    if (slot < 0) [[unlikely]]
+        return false;
+
+    write(m_slots[slot].exchange_l2_snap, exchange_l2_snap);
+    return true;
+}
+
+bool trade::reporter::ShmLastValueCache::update(const RangedTick& ranged_tick)
+{
+    const auto slot = acquire_slot(ranged_tick.symbol);
+
+    if (slot < 0) [[unlikely]]
+        return false;
+
+    write(m_slots[slot].ranged_tick, ranged_tick);
+    return true;
+}
+
+size_t trade::reporter::ShmLastValueCache::segment_size(const uint32_t slot_capacity)
+{
+    return slots_offset(slot_capacity) + slot_capacity * sizeof(SMLastValueSlot);
+}
+
+size_t trade::reporter::ShmLastValueCache::slots_offset(const uint32_t slot_capacity)
+{
+    const auto directory_end = sizeof(SMLastValueCacheHeader) + directory_size(slot_capacity) * sizeof(SMDirectoryEntry);
+
+    /// Keep slots aligned to cache line.
+    return (directory_end + alignof(SMLastValueSlot) - 1) / alignof(SMLastValueSlot) * alignof(SMLastValueSlot);
+}
+
+uint32_t trade::reporter::ShmLastValueCache::directory_size(const uint32_t slot_capacity)
+{
+    /// At most half full, so that probing stays short.
+    return std::bit_ceil(std::max<uint32_t>(slot_capacity, 1) * 2);
+}
+
+uint64_t trade::reporter::ShmLastValueCache::hash(const std::string_view symbol)
+{
+    /// FNV-1a.
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (const auto c : symbol) {
+        hash ^= static_cast<u_char>(c);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+int32_t trade::reporter::ShmLastValueCache::acquire_slot(const SymbolType& symbol)
+{
+    const std::string_view code(symbol, strnlen(symbol, sizeof(SymbolType)));
+    const auto mask = m_header->directory_size - 1;
+
+    for (auto i = hash(code) & mask;; i = (i + 1) & mask) {
+        auto& entry = m_directory[i];
+
+        /// Updates are serialized, readers only rely on the release store.
+        if (const auto slot = entry.slot.load(std::memory_order_relaxed); slot >= 0) {
+            if (code == entry.symbol) [[likely]]
+                return slot;
+
+            continue;
+        }
+
+        const auto slot = m_header->slot_count.load(std::memory_order_relaxed);
+
+        if (slot >= m_header->slot_capacity) [[unlikely]] {
+            m_is_full_warned ? void() : logger->warn("Last value cache is full, {} is not cached", code);
+            m_is_full_warned = true;
+            return -1;
+        }
+
+        M_A {entry.symbol} = code;
+
+        entry.slot.store(static_cast<int32_t>(slot), std::memory_order_release);
+        m_header->slot_count.store(slot + 1, std::memory_order_release);
+
+        return static_cast<int32_t>(slot);
+    }
+}
+
+trade::reporter::ShmLastValueCacheReader::ShmLastValueCacheReader(const std::string& shm_name)
+    : m_shm(boost::interprocess::open_only, shm_name.c_str(), boost::interprocess::read_only),
+      m_region(m_shm, boost::interprocess::read_only)
+{
+    const auto address = static_cast<const u_char*>(m_region.get_address());
+
+    m_header = reinterpret_cast<const SMLastValueCacheHeader*>(address);
+
+    if (m_region.get_size() < sizeof(SMLastValueCacheHeader) || std::memcmp(m_header->magic, SMLastValueCacheHeader().magic, sizeof(m_header->magic)) != 0)
+        throw std::runtime_error(fmt::format("{} is not a last value cache", shm_name));
+
+    if (m_header->version != SMLastValueCacheHeader().version)
+        throw std::runtime_error(fmt::format("Unsupported version {} of last value cache {}", m_header->version, shm_name));
+
+    if (m_region.get_size() < ShmLastValueCache::segment_size(m_header->slot_capacity))
+        throw std::runtime_error(fmt::format("Last value cache {} is truncated", shm_name));
+
+    m_directory = reinterpret_cast<const SMDirectoryEntry*>(address + sizeof(SMLastValueCacheHeader));
+    m_slots     = reinterpret_cast<const SMLastValueSlot*>(address + ShmLastValueCache::slots_offset(m_header->slot_capacity));
+}
+
+int32_t trade::reporter::ShmLastValueCacheReader::slot(const std::string_view symbol) const
+{
+    const auto mask = m_header->directory_size - 1;
+
+    for (auto i = ShmLastValueCache::hash(symbol) & mask;; i = (i + 1) & mask) {
+        const auto& entry = m_directory[i];
+        const auto slot   = entry.slot.load(std::memory_order_acquire);
+
+        /// Empty entry ends probing.
+        if (slot < 0)
+            return -1;
+
+        if (symbol == std::string_view(entry.symbol, strnlen(entry.symbol, sizeof(SymbolType))))
+            return slot;
+    }
+}
@@ -1,54 +1,470 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <numeric>
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/vfs.h>
+    #include <unistd.h>
+#endif
+
+#include "libreporter/ShmLastValueCache.h"
 #include "libreporter/ShmReporter.h"
 #include "utilities/MakeAssignable.hpp"
 #include "utilities/TimeHelper.hpp"
 
 #define REMOVE_DATE(time) (time % 1000000000)
 
+namespace
+{
+
+void fill(trade::reporter::OrderTick& record, const trade::types::OrderTick& order_tick)
+{
+    record.shm_union_type = trade::reporter::ShmUnionType::order_tick_from_exchange;
+
+    record.unique_id      = order_tick.unique_id();
+    /// TODO: Use convertor here.
+    if (order_tick.order_type() == trade::types::OrderType::cancel)
+        record.order_type = static_cast<trade::reporter::OrderType>(order_tick.order_type());
+    else
+        record.order_type = static_cast<trade::reporter::OrderType>(order_tick.side());
+    M_A {record.symbol}      = order_tick.symbol();
+    record.price_1000x       = order_tick.price_1000x();
+    record.quantity          = order_tick.quantity();
+
+    record.exhange_time      = REMOVE_DATE(order_tick.exchange_time());
+    record.local_system_time = REMOVE_DATE(trade::utilities::Now<int64_t>()());
+}
+
+void fill(trade::reporter::CompactOrderTick& record, const trade::types::OrderTick& order_tick)
+{
+    record.shm_union_type = trade::reporter::ShmUnionType::order_tick_from_exchange;
+
+    if (order_tick.order_type() == trade::types::OrderType::cancel)
+        record.order_type = static_cast<trade::reporter::OrderType>(order_tick.order_type());
+    else
+        record.order_type = static_cast<trade::reporter::OrderType>(order_tick.side());
+    record.unique_id         = order_tick.unique_id();
+    M_A {record.symbol}      = order_tick.symbol();
+    record.price_1000x       = order_tick.price_1000x();
+    record.quantity          = order_tick.quantity();
+
+    record.exchange_time     = static_cast<int32_t>(REMOVE_DATE(order_tick.exchange_time()));
+    record.local_system_time = static_cast<int32_t>(REMOVE_DATE(trade::utilities::Now<int64_t>()()));
+}
+
+void fill(trade::reporter::TradeTick& record, const trade::types::TradeTick& trade_tick)
+{
+    record.shm_union_type    = trade::reporter::ShmUnionType::trade_tick_from_exchange;
+
+    record.ask_unique_id     = trade_tick.ask_unique_id();
+    record.bid_unique_id     = trade_tick.bid_unique_id();
+    M_A {record.symbol}      = trade_tick.symbol();
+    record.exec_price_1000x  = trade_tick.exec_price_1000x();
+    record.exec_quantity     = trade_tick.exec_quantity();
+
+    record.exchange_time     = REMOVE_DATE(trade_tick.exchange_time());
+    record.local_system_time = REMOVE_DATE(trade::utilities::Now<int64_t>()());
+}
+
+void fill(trade::reporter::CompactTradeTick& record, const trade::types::TradeTick& trade_tick)
+{
+    record.shm_union_type    = trade::reporter::ShmUnionType::trade_tick_from_exchange;
+
+    record.ask_unique_id     = trade_tick.ask_unique_id();
+    record.bid_unique_id     = trade_tick.bid_unique_id();
+    M_A {record.symbol}      = trade_tick.symbol();
+    record.exec_price_1000x  = trade_tick.exec_price_1000x();
+    record.exec_quantity     = trade_tick.exec_quantity();
+
+    record.exchange_time     = static_cast<int32_t>(REMOVE_DATE(trade_tick.exchange_time()));
+    record.local_system_time = static_cast<int32_t>(REMOVE_DATE(trade::utilities::Now<int64_t>()()));
+}
+
+/// Fields other than levels are the same in both layouts.
+template<typename Record>
+void fill_snap_prices(Record& record, const trade::types::ExchangeL2Snap& exchange_l2_snap)
+{
+    record.shm_union_type          = trade::reporter::ShmUnionType::l2_snap_from_exchange;
+
+    M_A {record.symbol}            = exchange_l2_snap.symbol();
+    record.price_1000x             = static_cast<int64_t>(exchange_l2_snap.price() * 1000.);
+
+    record.pre_settlement_1000x    = static_cast<int64_t>(exchange_l2_snap.pre_settlement() * 1000.);
+    record.pre_close_price_1000x   = static_cast<int64_t>(exchange_l2_snap.pre_close_price() * 1000.);
+    record.open_price_1000x        = static_cast<int64_t>(exchange_l2_snap.open_price() * 1000.);
+    record.highest_price_1000x     = static_cast<int64_t>(exchange_l2_snap.highest_price() * 1000.);
+    record.lowest_price_1000x      = static_cast<int64_t>(exchange_l2_snap.lowest_price() * 1000.);
+    record.close_price_1000x       = static_cast<int64_t>(exchange_l2_snap.close_price() * 1000.);
+    record.settlement_price_1000x  = static_cast<int64_t>(exchange_l2_snap.settlement_price() * 1000.);
+    record.upper_limit_price_1000x = static_cast<int64_t>(exchange_l2_snap.upper_limit_price() * 1000.);
+    record.lower_limit_price_1000x = static_cast<int64_t>(exchange_l2_snap.lower_limit_price() * 1000.);
+}
+
+void fill(trade::reporter::ExchangeL2Snap& record, const trade::types::ExchangeL2Snap& exchange_l2_snap)
+{
+    fill_snap_prices(record, exchange_l2_snap);
+
+    record.sell_5.price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_5() * 1000.);
+    record.sell_5.quantity    = exchange_l2_snap.sell_quantity_5();
+    record.sell_4.price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_4() * 1000.);
+    record.sell_4.quantity    = exchange_l2_snap.sell_quantity_4();
+    record.sell_3.price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_3() * 1000.);
+    record.sell_3.quantity    = exchange_l2_snap.sell_quantity_3();
+    record.sell_2.price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_2() * 1000.);
+    record.sell_2.quantity    = exchange_l2_snap.sell_quantity_2();
+    record.sell_1.price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_1() * 1000.);
+    record.sell_1.quantity    = exchange_l2_snap.sell_quantity_1();
+    record.buy_1.price_1000x  = static_cast<int64_t>(exchange_l2_snap.buy_price_1() * 1000.);
+    record.buy_1.quantity     = exchange_l2_snap.buy_quantity_1();
+    record.buy_2.price_1000x  = static_cast<int64_t>(exchange_l2_snap.buy_price_2() * 1000.);
+    record.buy_2.quantity     = exchange_l2_snap.buy_quantity_2();
+    record.buy_3.price_1000x  = static_cast<int64_t>(exchange_l2_snap.buy_price_3() * 1000.);
+    record.buy_3.quantity     = exchange_l2_snap.buy_quantity_3();
+    record.buy_4.price_1000x  = static_cast<int64_t>(exchange_l2_snap.buy_price_4() * 1000.);
+    record.buy_4.quantity     = exchange_l2_snap.buy_quantity_4();
+    record.buy_5.price_1000x  = static_cast<int64_t>(exchange_l2_snap.buy_price_5() * 1000.);
+    record.buy_5.quantity     = exchange_l2_snap.buy_quantity_5();
+
+    record.exchange_time      = REMOVE_DATE(exchange_l2_snap.exchange_time());
+    record.local_system_time  = REMOVE_DATE(trade::utilities::Now<int64_t>()());
+}
+
+void fill(trade::reporter::CompactExchangeL2Snap& record, const trade::types::ExchangeL2Snap& exchange_l2_snap)
+{
+    fill_snap_prices(record, exchange_l2_snap);
+
+    record.asks[0].price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_1() * 1000.);
+    record.asks[0].quantity    = exchange_l2_snap.sell_quantity_1();
+    record.asks[1].price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_2() * 1000.);
+    record.asks[1].quantity    = exchange_l2_snap.sell_quantity_2();
+    record.asks[2].price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_3() * 1000.);
+    record.asks[2].quantity    = exchange_l2_snap.sell_quantity_3();
+    record.asks[3].price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_4() * 1000.);
+    record.asks[3].quantity    = exchange_l2_snap.sell_quantity_4();
+    record.asks[4].price_1000x = static_cast<int64_t>(exchange_l2_snap.sell_price_5() * 1000.);
+    record.asks[4].quantity    = exchange_l2_snap.sell_quantity_5();
+    record.bids[0].price_1000x = static_cast<int64_t>(exchange_l2_snap.buy_price_1() * 1000.);
+    record.bids[0].quantity    = exchange_l2_snap.buy_quantity_1();
+    record.bids[1].price_1000x = static_cast<int64_t>(exchange_l2_snap.buy_price_2() * 1000.);
+    record.bids[1].quantity    = exchange_l2_snap.buy_quantity_2();
+    record.bids[2].price_1000x = static_cast<int64_t>(exchange_l2_snap.buy_price_3() * 1000.);
+    record.bids[2].quantity    = exchange_l2_snap.buy_quantity_3();
+    record.bids[3].price_1000x = static_cast<int64_t>(exchange_l2_snap.buy_price_4() * 1000.);
+    record.bids[3].quantity    = exchange_l2_snap.buy_quantity_4();
+    record.bids[4].price_1000x = static_cast<int64_t>(exchange_l2_snap.buy_price_5() * 1000.);
+    record.bids[4].quantity    = exchange_l2_snap.buy_quantity_5();
+
+    record.exchange_time       = static_cast<int32_t>(REMOVE_DATE(exchange_l2_snap.exchange_time()));
+    record.local_system_time   = static_cast<int32_t>(REMOVE_DATE(trade::utilities::Now<int64_t>()()));
+}
+
+void fill(trade::reporter::GeneratedL2Tick& record, const trade::types::GeneratedL2Tick& generated_l2_tick)
+{
+    record.shm_union_type     = trade::reporter::ShmUnionType::generated_l2_tick;
+
+    M_A {record.symbol}       = generated_l2_tick.symbol();
+    record.price_1000x        = generated_l2_tick.price_1000x();
+    record.quantity           = generated_l2_tick.quantity();
+    record.ask_unique_id      = generated_l2_tick.ask_unique_id();
+    record.bid_unique_id      = generated_l2_tick.bid_unique_id();
+
+    record.sell_5.price_1000x = generated_l2_tick.ask_levels().at(4).price_1000x();
+    record.sell_5.quantity    = generated_l2_tick.ask_levels().at(4).quantity();
+    record.sell_4.price_1000x = generated_l2_tick.ask_levels().at(3).price_1000x();
+    record.sell_4.quantity    = generated_l2_tick.ask_levels().at(3).quantity();
+    record.sell_3.price_1000x = generated_l2_tick.ask_levels().at(2).price_1000x();
+    record.sell_3.quantity    = generated_l2_tick.ask_levels().at(2).quantity();
+    record.sell_2.price_1000x = generated_l2_tick.ask_levels().at(1).price_1000x();
+    record.sell_2.quantity    = generated_l2_tick.ask_levels().at(1).quantity();
+    record.sell_1.price_1000x = generated_l2_tick.ask_levels().at(0).price_1000x();
+    record.sell_1.quantity    = generated_l2_tick.ask_levels().at(0).quantity();
+    record.buy_1.price_1000x  = generated_l2_tick.bid_levels().at(0).price_1000x();
+    record.buy_1.quantity     = generated_l2_tick.bid_levels().at(0).quantity();
+    record.buy_2.price_1000x  = generated_l2_tick.bid_levels().at(1).price_1000x();
+    record.buy_2.quantity     = generated_l2_tick.bid_levels().at(1).quantity();
+    record.buy_3.price_1000x  = generated_l2_tick.bid_levels().at(2).price_1000x();
+    record.buy_3.quantity     = generated_l2_tick.bid_levels().at(2).quantity();
+    record.buy_4.price_1000x  = generated_l2_tick.bid_levels().at(3).price_1000x();
+    record.buy_4.quantity     = generated_l2_tick.bid_levels().at(3).quantity();
+    record.buy_5.price_1000x  = generated_l2_tick.bid_levels().at(4).price_1000x();
+    record.buy_5.quantity     = generated_l2_tick.bid_levels().at(4).quantity();
+
+    record.exchange_time      = REMOVE_DATE(generated_l2_tick.exchange_time());
+    record.local_system_time  = REMOVE_DATE(trade::utilities::Now<int64_t>()());
+}
+
+void fill(trade::reporter::CompactGeneratedL2Tick& record, const trade::types::GeneratedL2Tick& generated_l2_tick)
+{
+    record.shm_union_type = trade::reporter::ShmUnionType::generated_l2_tick;
+
+    M_A {record.symbol}   = generated_l2_tick.symbol();
+    record.price_1000x    = generated_l2_tick.price_1000x();
+    record.quantity       = generated_l2_tick.quantity();
+    record.ask_unique_id  = generated_l2_tick.ask_unique_id();
+    record.bid_unique_id  = generated_l2_tick.bid_unique_id();
+
+    for (int i = 0; i < 5; i++) {
+        record.asks[i].price_1000x = generated_l2_tick.ask_levels().at(i).price_1000x();
+        record.asks[i].quantity    = generated_l2_tick.ask_levels().at(i).quantity();
+        record.bids[i].price_1000x = generated_l2_tick.bid_levels().at(i).price_1000x();
+        record.bids[i].quantity    = generated_l2_tick.bid_levels().at(i).quantity();
+    }
+
+    record.exchange_time     = static_cast<int32_t>(REMOVE_DATE(generated_l2_tick.exchange_time()));
+    record.local_system_time = static_cast<int32_t>(REMOVE_DATE(trade::utilities::Now<int64_t>()()));
+}
+
+void fill(trade::reporter::RangedTick& record, const trade::types::RangedTick& ranged_tick)
+{
+    record.shm_union_type                   = trade::reporter::ShmUnionType::ranged_tick;
+
+    M_A {record.symbol}                     = ranged_tick.symbol();
+    record.start_time                       = REMOVE_DATE(ranged_tick.start_time());
+    record.end_time                         = REMOVE_DATE(ranged_tick.end_time());
+
+    record.active_traded_sell_number        = ranged_tick.active_traded_sell_number();
+    record.active_sell_number               = ranged_tick.active_sell_number();
+    record.active_sell_quantity             = ranged_tick.active_sell_quantity();
+    record.active_sell_amount_1000x         = ranged_tick.active_sell_amount_1000x();
+    record.active_traded_buy_number         = ranged_tick.active_traded_buy_number();
+    record.active_buy_number                = ranged_tick.active_buy_number();
+    record.active_buy_quantity              = ranged_tick.active_buy_quantity();
+    record.active_buy_amount_1000x          = ranged_tick.active_buy_amount_1000x();
+
+    record.aggressive_sell_number           = ranged_tick.aggressive_sell_number();
+    record.aggressive_buy_number            = ranged_tick.aggressive_buy_number();
+
+    record.new_added_ask_1_quantity         = ranged_tick.new_added_ask_1_quantity();
+    record.new_added_bid_1_quantity         = ranged_tick.new_added_bid_1_quantity();
+    record.new_canceled_ask_1_quantity      = ranged_tick.new_canceled_ask_1_quantity();
+    record.new_canceled_bid_1_quantity      = ranged_tick.new_canceled_bid_1_quantity();
+    record.new_canceled_ask_all_quantity    = ranged_tick.new_canceled_ask_all_quantity();
+    record.new_canceled_bid_all_quantity    = ranged_tick.new_canceled_bid_all_quantity();
+
+    record.big_ask_amount_1000x             = ranged_tick.big_ask_amount_1000x();
+    record.big_bid_amount_1000x             = ranged_tick.big_bid_amount_1000x();
+
+    record.highest_price_1000x              = ranged_tick.highest_price_1000x();
+    record.lowest_price_1000x               = ranged_tick.lowest_price_1000x();
+
+    record.ask_price_1_valid_duration_1000x = ranged_tick.ask_price_1_valid_duration_1000x();
+    record.bid_price_1_valid_duration_1000x = ranged_tick.bid_price_1_valid_duration_1000x();
+
+    record.exchange_time                    = REMOVE_DATE(ranged_tick.exchange_time());
+    record.local_system_time                = REMOVE_DATE(trade::utilities::Now<int64_t>()());
+}
+
+/// Types and sizes of records in regions of order tick, trade tick, exchange
+/// l2 snap and generated l2 tick.
+constexpr std::array region_record_types = {
+    trade::reporter::ShmUnionType::order_tick_from_exchange,
+    trade::reporter::ShmUnionType::trade_tick_from_exchange,
+    trade::reporter::ShmUnionType::l2_snap_from_exchange,
+    trade::reporter::ShmUnionType::generated_l2_tick,
+};
+
+constexpr std::array<size_t, 4> legacy_record_sizes = {
+    sizeof(trade::reporter::OrderTick),
+    sizeof(trade::reporter::TradeTick),
+    sizeof(trade::reporter::ExchangeL2Snap),
+    sizeof(trade::reporter::GeneratedL2Tick),
+};
+
+constexpr std::array<size_t, 4> compact_record_sizes = {
+    sizeof(trade::reporter::CompactOrderTick),
+    sizeof(trade::reporter::CompactTradeTick),
+    sizeof(trade::reporter::CompactExchangeL2Snap),
+    sizeof(trade::reporter::CompactGeneratedL2Tick),
+};
+
+/// All mate infos have the same size and keep region_size after two fields.
+static_assert(sizeof(trade::reporter::SMTickMateInfo) == sizeof(trade::reporter::SMExchangeL2SnapMateInfo));
+static_assert(sizeof(trade::reporter::SMTickMateInfo) == sizeof(trade::reporter::SMGeneratedL2TickMateInfo));
+
+} // namespace
+
 trade::reporter::ShmReporter::ShmReporter(
     const std::string& shm_name,
     const std::string& shm_mutex_name,
     const int shm_size,
-    const std::shared_ptr<IReporter>& outside
+    const std::shared_ptr<IReporter>& outside,
+    const std::array<size_t, 4>& region_sizes,
+    const ShmPrefault prefault,
+    const ShmHugePage huge_page,
+    const std::string& huge_page_path,
+    const uint32_t last_value_cache_slots,
+    const ShmLayout layout
 )
     : AppBase("ShmReporter"),
       NopReporter(outside),
-      m_shm(boost::interprocess::open_or_create, shm_name.c_str(), boost::interprocess::read_write),
       m_named_mutex(boost::interprocess::open_or_create, shm_mutex_name.c_str()),
+      m_region_sizes(),
+      m_region_addresses(),
+      m_layout(layout),
       m_outside(outside)
 {
-    m_shm.truncate(shm_size * GB);
+    const bool is_equally_split = std::ranges::all_of(region_sizes, [](const size_t size) { return size == 0; });
+
+    for (size_t i = 0; i < m_region_sizes.size(); i++) {
+        m_region_sizes[i] = is_equally_split ? shm_size * GB / 4 : region_sizes[i] * MB;
+
+        if (m_region_sizes[i] < sizeof(ShmUnion) * 2) [[unlikely]]
+            throw std::runtime_error(fmt::format("Region {} of shared memory {} is too small: {} bytes", i, shm_name, m_region_sizes[i]));
+    }
+
+    const auto [header_size, segment_size] = size_segment(m_region_sizes, m_layout, huge_page_size(huge_page, huge_page_path));
+
+    map_segment(shm_name, segment_size, huge_page, huge_page_path);
+
+    /// Regions are next to each other.
+    m_region_addresses[0] = static_cast<u_char*>(m_segment->get_address()) + header_size;
+
+    for (size_t i = 1; i < m_region_addresses.size(); i++)
+        m_region_addresses[i] = m_region_addresses[i - 1] + m_region_sizes[i - 1];
+
+    m_order_tick_mate_info        = reinterpret_cast<SMTickMateInfo*>(m_region_addresses[0]);
+    m_trade_tick_mate_info        = reinterpret_cast<SMTickMateInfo*>(m_region_addresses[1]);
+    m_exchange_l2_snap_mate_info  = reinterpret_cast<SMExchangeL2SnapMateInfo*>(m_region_addresses[2]);
+    m_generated_l2_tick_mate_info = reinterpret_cast<SMGeneratedL2TickMateInfo*>(m_region_addresses[3]);
+
+    /// Only reset mate infos instead of clearing the whole segment, which
+    /// takes seconds and faults in every page.
+    *m_order_tick_mate_info        = {};
+    *m_trade_tick_mate_info        = {};
+    *m_exchange_l2_snap_mate_info  = {};
+    *m_generated_l2_tick_mate_info = {};
+
+    m_order_tick_mate_info->region_size        = m_region_sizes[0];
+    m_trade_tick_mate_info->region_size        = m_region_sizes[1];
+    m_exchange_l2_snap_mate_info->region_size  = m_region_sizes[2];
+    m_generated_l2_tick_mate_info->region_size = m_region_sizes[3];
+
+    /// Assign cursors with start address, records after mate info.
+    const auto& record_sizes = m_layout == ShmLayout::compact ? compact_record_sizes : legacy_record_sizes;
+
+    for (size_t i = 0; i < m_cursors.size(); i++) {
+        const size_t record_count = (m_region_sizes[i] - sizeof(SMTickMateInfo)) / record_sizes[i];
+
+        m_cursors[i].start        = m_region_addresses[i] + sizeof(SMTickMateInfo);
+        m_cursors[i].current      = m_cursors[i].start;
+        m_cursors[i].end          = m_cursors[i].start + record_count * record_sizes[i];
+    }
+
+    if (m_layout == ShmLayout::compact) {
+        const auto header    = static_cast<SMSegmentHeader*>(m_segment->get_address());
+
+        *header              = {};
+        header->header_size  = header_size;
+        header->region_count = m_region_sizes.size();
+
+        for (size_t i = 0; i < m_region_sizes.size(); i++) {
+            header->regions[i].record_type = region_record_types[i];
+            header->regions[i].record_size = record_sizes[i];
+            header->regions[i].offset      = m_region_addresses[i] - static_cast<u_char*>(m_segment->get_address());
+            header->regions[i].size        = m_region_sizes[i];
+        }
+    }
+
+    if (last_value_cache_slots > 0)
+        m_last_value_cache = std::make_unique<ShmLastValueCache>(shm_name + "_lvc", last_value_cache_slots);
+
+    switch (prefault) {
+    case ShmPrefault::none: break;
+    case ShmPrefault::background: {
+        m_is_prefaulting   = true;
+        m_prefault_thread = std::thread([this] { this->prefault(); });
+        break;
+    }
+    case ShmPrefault::eager: {
+        m_is_prefaulting = true;
+        this->prefault();
+        break;
+    }
+    }
+}
+
+trade::reporter::ShmReporter::~ShmReporter()
+{
+    m_is_prefaulting = false;
+    m_prefault_thread.joinable() ? m_prefault_thread.join() : void();
+}
+
+trade::reporter::ShmLayout trade::reporter::ShmReporter::check_layout(const void* segment, const size_t size)
+{
+    const auto address = static_cast<const u_char*>(segment);
+    const auto header  = static_cast<const SMSegmentHeader*>(segment);
+
+    if (size >= sizeof(SMSegmentHeader) && std::memcmp(header->magic, SMSegmentHeader {}.magic, sizeof(header->magic)) == 0) {
+        if (header->version != SMSegmentHeader {}.version)
+            throw std::runtime_error(fmt::format("Unsupported shared memory layout version {}, expected {}", header->version, SMSegmentHeader {}.version));
+
+        if (header->region_count != region_record_types.size())
+            throw std::runtime_error(fmt::format("Unexpected region count {} of shared memory", header->region_count));
+
+        for (size_t i = 0; i < region_record_types.size(); i++) {
+            const auto& region = header->regions[i];
+
+            if (region.record_type != region_record_types[i] || region.record_size != compact_record_sizes[i])
+                throw std::runtime_error(fmt::format("Region {} of shared memory holds records of type {} and size {}, expected type {} and size {}", i, static_cast<int>(region.record_type), region.record_size, static_cast<int>(region_record_types[i]), compact_record_sizes[i]));
+
+            if (region.offset < header->header_size || region.size < sizeof(SMTickMateInfo) || region.offset + region.size > size)
+                throw std::runtime_error(fmt::format("Region {} of shared memory is out of segment of {} bytes", i, size));
+        }
 
-    boost::interprocess::offset_t allocated_shm_size;
-    m_shm.get_size(allocated_shm_size);
+        return ShmLayout::compact;
+    }
+
+    /// Legacy segments written before region_size was added are split into
+    /// equal quarters.
+    size_t offset = 0;
+
+    for (size_t i = 0; i < region_record_types.size(); i++) {
+        if (offset + sizeof(SMTickMateInfo) > size)
+            throw std::runtime_error(fmt::format("Region {} of shared memory is out of segment of {} bytes", i, size));
 
-    logger->info("Created/Opened shared memory {} with size {}GB ({} bytes)", m_shm.get_name(), allocated_shm_size / GB, allocated_shm_size);
+        const auto region_size = reinterpret_cast<const SMTickMateInfo*>(address + offset)->region_size;
+        const auto next        = offset + (region_size == 0 ? size / 4 : region_size);
 
-    /// Map areas of shared memory with same size.
-    m_order_tick_region           = std::make_shared<boost::interprocess::mapped_region>(m_shm, boost::interprocess::read_write, 0 * allocated_shm_size / 4, allocated_shm_size / 4);
-    m_trade_tick_region           = std::make_shared<boost::interprocess::mapped_region>(m_shm, boost::interprocess::read_write, 1 * allocated_shm_size / 4, allocated_shm_size / 4);
-    m_exchange_l2_snap_region     = std::make_shared<boost::interprocess::mapped_region>(m_shm, boost::interprocess::read_write, 2 * allocated_shm_size / 4, allocated_shm_size / 4);
-    m_generated_l2_tick_region    = std::make_shared<boost::interprocess::mapped_region>(m_shm, boost::interprocess::read_write, 3 * allocated_shm_size / 4, allocated_shm_size / 4);
+        if (next > size || next - offset < sizeof(SMTickMateInfo))
+            throw std::runtime_error(fmt::format("Region {} of shared memory is out of segment of {} bytes", i, size));
+
+        offset = next;
+    }
 
-    m_order_tick_mate_info        = static_cast<SMTickMateInfo*>(m_order_tick_region->get_address());
-    m_trade_tick_mate_info        = static_cast<SMTickMateInfo*>(m_trade_tick_region->get_address());
-    m_exchange_l2_snap_mate_info  = static_cast<SMExchangeL2SnapMateInfo*>(m_exchange_l2_snap_region->get_address());
-    m_generated_l2_tick_mate_info = static_cast<SMGeneratedL2TickMateInfo*>(m_generated_l2_tick_region->get_address());
+    return ShmLayout::legacy;
+}
 
-    /// Set memory areas.
-    memset(m_order_tick_region->get_address(), 0, allocated_shm_size / 4);
-    memset(m_trade_tick_region->get_address(), 0, allocated_shm_size / 4);
-    memset(m_exchange_l2_snap_region->get_address(), 0, allocated_shm_size / 4);
-    memset(m_generated_l2_tick_region->get_address(), 0, allocated_shm_size / 4);
+trade::reporter::ShmReporter::SegmentSize trade::reporter::ShmReporter::size_segment(
+    const std::array<size_t, 4>& region_sizes,
+    const ShmLayout layout,
+    const size_t huge_page_size
+)
+{
+    const size_t page_size   = std::max<size_t>(huge_page_size, 1);
+    const size_t header_size = layout == ShmLayout::compact ? std::max(header_region_size, huge_page_size) : 0;
+    const size_t size        = header_size + std::accumulate(region_sizes.begin(), region_sizes.end(), size_t(0));
 
-    /// Assign pointers with start address.
-    m_order_tick_start          = reinterpret_cast<OrderTick*>(m_order_tick_mate_info + 1);
-    m_order_tick_current        = m_order_tick_start;
-    m_trade_tick_start          = reinterpret_cast<TradeTick*>(m_trade_tick_mate_info + 1);
-    m_trade_tick_current        = m_trade_tick_start;
-    m_exchange_l2_snap_start    = reinterpret_cast<ExchangeL2Snap*>(m_exchange_l2_snap_mate_info + 1);
-    m_exchange_l2_snap_current  = m_exchange_l2_snap_start;
-    m_generated_l2_tick_start   = reinterpret_cast<GeneratedL2Tick*>(m_generated_l2_tick_mate_info + 1);
-    m_generated_l2_tick_current = m_generated_l2_tick_start;
+    return {header_size, (size + page_size - 1) / page_size * page_size};
+}
+
+template<typename Record>
+Record& trade::reporter::ShmReporter::next(RegionCursor& cursor)
+{
+    /// Check if shared memory is full.
+    if (cursor.current + sizeof(Record) > cursor.end) [[unlikely]] {
+        logger->warn("Shared memory of tick is full");
+        cursor.current = cursor.start;
+    }
+
+    const auto record  = reinterpret_cast<Record*>(cursor.current);
+    cursor.current    += sizeof(Record);
+
+    return *record;
 }
 
 void trade::reporter::ShmReporter::exchange_order_tick_arrived(const std::shared_ptr<types::OrderTick> order_tick)
@@ -75,171 +491,209 @@ void trade::reporter::ShmReporter::l2_tick_generated(const std::shared_ptr<types
     m_outside->l2_tick_generated(generated_l2_tick);
 }
 
+void trade::reporter::ShmReporter::ranged_tick_generated(const std::shared_ptr<types::RangedTick> ranged_tick)
+{
+    do_ranged_tick_report(ranged_tick);
+    m_outside->ranged_tick_generated(ranged_tick);
+}
+
+void trade::reporter::ShmReporter::do_ranged_tick_report(const std::shared_ptr<types::RangedTick>& ranged_tick)
+{
+    /// Ranged ticks are only kept in last value cache.
+    if (m_last_value_cache == nullptr)
+        return;
+
+    RangedTick record;
+    fill(record, *ranged_tick);
+
+    /// Slots of new symbols are claimed by one writer at a time.
+    boost::interprocess::scoped_lock lock(m_named_mutex);
+
+    m_last_value_cache->update(record);
+}
+
 void trade::reporter::ShmReporter::do_exchange_order_tick_report(const std::shared_ptr<types::OrderTick>& order_tick)
 {
-    /// Check if shared memory is full.
-    if (m_order_tick_current - m_order_tick_start > m_order_tick_region->get_size() / sizeof(OrderTick)) {
-        logger->warn("Shared memory of tick is full");
-        m_order_tick_current = m_order_tick_start;
+    boost::interprocess::scoped_lock lock(m_named_mutex);
+
+    m_layout == ShmLayout::compact ? fill(next<CompactOrderTick>(m_cursors[0]), *order_tick) : fill(next<OrderTick>(m_cursors[0]), *order_tick);
+
+    m_order_tick_mate_info->tick_count++;
+    m_order_tick_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
+}
+
+void trade::reporter::ShmReporter::do_exchange_trade_tick_report(const std::shared_ptr<types::TradeTick>& trade_tick)
+{
+    boost::interprocess::scoped_lock lock(m_named_mutex);
+
+    m_layout == ShmLayout::compact ? fill(next<CompactTradeTick>(m_cursors[1]), *trade_tick) : fill(next<TradeTick>(m_cursors[1]), *trade_tick);
+
+    m_trade_tick_mate_info->tick_count++;
+    m_trade_tick_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
+}
+
+void trade::reporter::ShmReporter::do_exchange_l2_snap_report(const std::shared_ptr<types::ExchangeL2Snap>& exchange_l2_snap)
+{
+    boost::interprocess::scoped_lock lock(m_named_mutex);
+
+    if (m_layout == ShmLayout::compact) {
+        fill(next<CompactExchangeL2Snap>(m_cursors[2]), *exchange_l2_snap);
+
+        /// Last value cache keeps records of legacy layout.
+        if (m_last_value_cache != nullptr) {
+            ExchangeL2Snap record;
+            fill(record, *exchange_l2_snap);
+            m_last_value_cache->update(record);
+        }
     }
+    else {
+        auto& record = next<ExchangeL2Snap>(m_cursors[2]);
+        fill(record, *exchange_l2_snap);
 
-    /// Writing scope.
-    {
-        boost::interprocess::scoped_lock lock(m_named_mutex);
+        m_last_value_cache == nullptr ? void() : void(m_last_value_cache->update(record));
+    }
 
-        m_order_tick_current->shm_union_type = ShmUnionType::order_tick_from_exchange;
+    m_exchange_l2_snap_mate_info->exchange_l2_snap_count++;
+    m_exchange_l2_snap_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
+}
+
+void trade::reporter::ShmReporter::do_generated_l2_tick_report(const std::shared_ptr<types::GeneratedL2Tick>& generated_l2_tick)
+{
+    boost::interprocess::scoped_lock lock(m_named_mutex);
 
-        m_order_tick_current->unique_id      = order_tick->unique_id();
-        /// TODO: Use convertor here.
-        if (order_tick->order_type() == types::OrderType::cancel)
-            m_order_tick_current->order_type = static_cast<OrderType>(order_tick->order_type());
-        else
-            m_order_tick_current->order_type = static_cast<OrderType>(order_tick->side());
-        M_A {m_order_tick_current->symbol}      = order_tick->symbol();
-        m_order_tick_current->price_1000x       = order_tick->price_1000x();
-        m_order_tick_current->quantity          = order_tick->quantity();
+    if (m_layout == ShmLayout::compact) {
+        fill(next<CompactGeneratedL2Tick>(m_cursors[3]), *generated_l2_tick);
 
-        m_order_tick_current->exhange_time      = REMOVE_DATE(order_tick->exchange_time());
-        m_order_tick_current->local_system_time = REMOVE_DATE(utilities::Now<int64_t>()());
+        /// Last value cache keeps records of legacy layout.
+        if (m_last_value_cache != nullptr) {
+            GeneratedL2Tick record;
+            fill(record, *generated_l2_tick);
+            m_last_value_cache->update(record);
+        }
+    }
+    else {
+        auto& record = next<GeneratedL2Tick>(m_cursors[3]);
+        fill(record, *generated_l2_tick);
 
-        m_order_tick_current++;
-        m_order_tick_mate_info->tick_count++;
-        m_order_tick_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
+        m_last_value_cache == nullptr ? void() : void(m_last_value_cache->update(record));
     }
+
+    m_generated_l2_tick_mate_info->generated_l2_tick_count++;
+    m_generated_l2_tick_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
 }
 
-void trade::reporter::ShmReporter::do_exchange_trade_tick_report(const std::shared_ptr<types::TradeTick>& trade_tick)
+size_t trade::reporter::ShmReporter::huge_page_size(const ShmHugePage huge_page, const std::string& huge_page_path)
 {
-    /// Check if shared memory is full.
-    if (m_trade_tick_current - m_trade_tick_start > m_trade_tick_region->get_size() / sizeof(TradeTick)) {
-        logger->warn("Shared memory of tick is full");
-        m_trade_tick_current = m_trade_tick_start;
+    switch (huge_page) {
+    case ShmHugePage::none: return 0;
+    case ShmHugePage::transparent: {
+        /// PMD size, which is 2MB on x86-64.
+        size_t size = 2 * MB;
+        std::ifstream("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size") >> size;
+        return size;
     }
+    case ShmHugePage::hugetlbfs: {
+#ifdef __linux__
+        /// Block size of hugetlbfs is its huge page size, which may be set by
+        /// pagesize option of the mount.
+        struct statfs stat {};
+
+        if (::statfs(huge_page_path.c_str(), &stat) != 0)
+            throw std::runtime_error(fmt::format("Failed to get huge page size of {}: {}", huge_page_path, std::strerror(errno)));
+
+        return static_cast<size_t>(stat.f_bsize);
+#else
+        return 0;
+#endif
+    }
+    }
+
+    return 0;
+}
 
-    /// Writing scope.
-    {
-        boost::interprocess::scoped_lock lock(m_named_mutex);
+void trade::reporter::ShmReporter::map_segment(
+    const std::string& shm_name,
+    const size_t size,
+    const ShmHugePage huge_page,
+    const std::string& huge_page_path
+)
+{
+    if (huge_page == ShmHugePage::hugetlbfs) {
+#ifdef __linux__
+        const auto path = fmt::format("{}/{}", huge_page_path, shm_name);
+
+        /// Files on hugetlbfs can only be sized by ftruncate(), to a multiple
+        /// of huge page size, which size is rounded up to.
+        const int fd = ::open(path.c_str(), O_CREAT | O_RDWR, 0666);
+
+        if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            const int error = errno;
+            fd < 0 ? void() : void(::close(fd));
+            throw std::runtime_error(fmt::format("Failed to create {} with size {} bytes: {}", path, size, std::strerror(error)));
+        }
+
+        ::close(fd);
+
+        m_huge_page_file = std::make_unique<boost::interprocess::file_mapping>(path.c_str(), boost::interprocess::read_write);
+        m_segment        = std::make_unique<boost::interprocess::mapped_region>(*m_huge_page_file, boost::interprocess::read_write, 0, size);
+
+        logger->info("Created/Opened huge page backed shared memory {} with size {} bytes", path, size);
+#else
+        throw std::runtime_error("Huge page backed shared memory is only supported on Linux");
+#endif
+        return;
+    }
 
-        m_trade_tick_current->shm_union_type    = ShmUnionType::trade_tick_from_exchange;
+    m_shm = std::make_unique<boost::interprocess::shared_memory_object>(boost::interprocess::open_or_create, shm_name.c_str(), boost::interprocess::read_write);
+    m_shm->truncate(static_cast<boost::interprocess::offset_t>(size));
 
-        m_trade_tick_current->ask_unique_id     = trade_tick->ask_unique_id();
-        m_trade_tick_current->bid_unique_id     = trade_tick->bid_unique_id();
-        M_A {m_trade_tick_current->symbol}      = trade_tick->symbol();
-        m_trade_tick_current->exec_price_1000x  = trade_tick->exec_price_1000x();
-        m_trade_tick_current->exec_quantity     = trade_tick->exec_quantity();
+    m_segment = std::make_unique<boost::interprocess::mapped_region>(*m_shm, boost::interprocess::read_write, 0, size);
 
-        m_trade_tick_current->exchange_time     = REMOVE_DATE(trade_tick->exchange_time());
-        m_trade_tick_current->local_system_time = REMOVE_DATE(utilities::Now<int64_t>()());
+    logger->info("Created/Opened shared memory {} with size {} bytes", m_shm->get_name(), size);
 
-        m_trade_tick_current++;
-        m_trade_tick_mate_info->tick_count++;
-        m_trade_tick_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
+    if (huge_page == ShmHugePage::transparent) {
+#ifdef __linux__
+        if (::madvise(m_segment->get_address(), size, MADV_HUGEPAGE) != 0)
+            logger->warn("Failed to advise huge pages for shared memory {}: {}", m_shm->get_name(), std::strerror(errno));
+#else
+        logger->warn("Transparent huge pages are only supported on Linux");
+#endif
     }
 }
 
-void trade::reporter::ShmReporter::do_exchange_l2_snap_report(const std::shared_ptr<types::ExchangeL2Snap>& exchange_l2_snap)
+void trade::reporter::ShmReporter::prefault()
 {
-    /// Check if shared memory is full.
-    if (m_exchange_l2_snap_current - m_exchange_l2_snap_start > m_exchange_l2_snap_region->get_size() / sizeof(ExchangeL2Snap)) {
-        logger->warn("Shared memory of tick is full");
-        m_exchange_l2_snap_current = m_exchange_l2_snap_start;
-    }
-
-    /// Writing scope.
-    {
-        boost::interprocess::scoped_lock lock(m_named_mutex);
-
-        m_exchange_l2_snap_current->shm_union_type          = ShmUnionType::l2_snap_from_exchange;
-
-        M_A {m_generated_l2_tick_current->symbol}           = exchange_l2_snap->symbol();
-        m_exchange_l2_snap_current->price_1000x             = static_cast<int64_t>(exchange_l2_snap->price() * 1000.);
-
-        m_exchange_l2_snap_current->pre_settlement_1000x    = static_cast<int64_t>(exchange_l2_snap->pre_settlement() * 1000.);
-        m_exchange_l2_snap_current->pre_close_price_1000x   = static_cast<int64_t>(exchange_l2_snap->pre_close_price() * 1000.);
-        m_exchange_l2_snap_current->open_price_1000x        = static_cast<int64_t>(exchange_l2_snap->open_price() * 1000.);
-        m_exchange_l2_snap_current->highest_price_1000x     = static_cast<int64_t>(exchange_l2_snap->highest_price() * 1000.);
-        m_exchange_l2_snap_current->lowest_price_1000x      = static_cast<int64_t>(exchange_l2_snap->lowest_price() * 1000.);
-        m_exchange_l2_snap_current->close_price_1000x       = static_cast<int64_t>(exchange_l2_snap->close_price() * 1000.);
-        m_exchange_l2_snap_current->settlement_price_1000x  = static_cast<int64_t>(exchange_l2_snap->settlement_price() * 1000.);
-        m_exchange_l2_snap_current->upper_limit_price_1000x = static_cast<int64_t>(exchange_l2_snap->upper_limit_price() * 1000.);
-        m_exchange_l2_snap_current->lower_limit_price_1000x = static_cast<int64_t>(exchange_l2_snap->lower_limit_price() * 1000.);
-
-        m_exchange_l2_snap_current->sell_5.price_1000x      = static_cast<int64_t>(exchange_l2_snap->sell_price_5() * 1000.);
-        m_exchange_l2_snap_current->sell_5.quantity         = exchange_l2_snap->sell_quantity_5();
-        m_exchange_l2_snap_current->sell_4.price_1000x      = static_cast<int64_t>(exchange_l2_snap->sell_price_4() * 1000.);
-        m_exchange_l2_snap_current->sell_4.quantity         = exchange_l2_snap->sell_quantity_4();
-        m_exchange_l2_snap_current->sell_3.price_1000x      = static_cast<int64_t>(exchange_l2_snap->sell_price_3() * 1000.);
-        m_exchange_l2_snap_current->sell_3.quantity         = exchange_l2_snap->sell_quantity_3();
-        m_exchange_l2_snap_current->sell_2.price_1000x      = static_cast<int64_t>(exchange_l2_snap->sell_price_2() * 1000.);
-        m_exchange_l2_snap_current->sell_2.quantity         = exchange_l2_snap->sell_quantity_2();
-        m_exchange_l2_snap_current->sell_1.price_1000x      = static_cast<int64_t>(exchange_l2_snap->sell_price_1() * 1000.);
-        m_exchange_l2_snap_current->sell_1.quantity         = exchange_l2_snap->sell_quantity_1();
-        m_exchange_l2_snap_current->buy_1.price_1000x       = static_cast<int64_t>(exchange_l2_snap->buy_price_1() * 1000.);
-        m_exchange_l2_snap_current->buy_1.quantity          = exchange_l2_snap->buy_quantity_1();
-        m_exchange_l2_snap_current->buy_2.price_1000x       = static_cast<int64_t>(exchange_l2_snap->buy_price_2() * 1000.);
-        m_exchange_l2_snap_current->buy_2.quantity          = exchange_l2_snap->buy_quantity_2();
-        m_exchange_l2_snap_current->buy_3.price_1000x       = static_cast<int64_t>(exchange_l2_snap->buy_price_3() * 1000.);
-        m_exchange_l2_snap_current->buy_3.quantity          = exchange_l2_snap->buy_quantity_3();
-        m_exchange_l2_snap_current->buy_4.price_1000x       = static_cast<int64_t>(exchange_l2_snap->buy_price_4() * 1000.);
-        m_exchange_l2_snap_current->buy_4.quantity          = exchange_l2_snap->buy_quantity_4();
-        m_exchange_l2_snap_current->buy_5.price_1000x       = static_cast<int64_t>(exchange_l2_snap->buy_price_5() * 1000.);
-        m_exchange_l2_snap_current->buy_5.quantity          = exchange_l2_snap->buy_quantity_5();
-
-        m_exchange_l2_snap_current->exchange_time           = REMOVE_DATE(exchange_l2_snap->exchange_time());
-        m_exchange_l2_snap_current->local_system_time       = REMOVE_DATE(utilities::Now<int64_t>()());
-
-        m_exchange_l2_snap_current++;
-        m_exchange_l2_snap_mate_info->exchange_l2_snap_count++;
-        m_exchange_l2_snap_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
+    static constexpr size_t chunk_size = 64 * MB;
+
+    const auto start    = std::chrono::steady_clock::now();
+    const auto max_size = *std::ranges::max_element(m_region_sizes);
+
+    for (size_t offset = 0; offset < max_size; offset += chunk_size) {
+        for (size_t i = 0; i < m_region_sizes.size(); i++) {
+            if (!m_is_prefaulting) [[unlikely]]
+                return;
+
+            if (offset < m_region_sizes[i])
+                prefault(m_region_addresses[i] + offset, std::min(chunk_size, m_region_sizes[i] - offset));
+        }
     }
+
+    m_is_prefaulting = false;
+
+    logger->info("Prefaulted shared memory in {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
 }
 
-void trade::reporter::ShmReporter::do_generated_l2_tick_report(const std::shared_ptr<types::GeneratedL2Tick>& generated_l2_tick)
+void trade::reporter::ShmReporter::prefault(u_char* address, const size_t size)
 {
-    /// Check if shared memory is full.
-    if (m_generated_l2_tick_current - m_generated_l2_tick_start > m_generated_l2_tick_region->get_size() / sizeof(ExchangeL2Snap)) {
-        logger->warn("Shared memory of tick is full");
-        m_generated_l2_tick_current = m_generated_l2_tick_start;
-    }
-
-    /// Writing scope.
-    {
-        boost::interprocess::scoped_lock lock(m_named_mutex);
-
-        m_generated_l2_tick_current->shm_union_type     = ShmUnionType::generated_l2_tick;
-
-        M_A {m_generated_l2_tick_current->symbol}       = generated_l2_tick->symbol();
-        m_generated_l2_tick_current->price_1000x        = generated_l2_tick->price_1000x();
-        m_generated_l2_tick_current->quantity           = generated_l2_tick->quantity();
-        m_generated_l2_tick_current->ask_unique_id      = generated_l2_tick->ask_unique_id();
-        m_generated_l2_tick_current->bid_unique_id      = generated_l2_tick->bid_unique_id();
-
-        m_generated_l2_tick_current->sell_5.price_1000x = generated_l2_tick->ask_levels().at(4).price_1000x(),
-        m_generated_l2_tick_current->sell_5.quantity    = generated_l2_tick->ask_levels().at(4).quantity(),
-        m_generated_l2_tick_current->sell_4.price_1000x = generated_l2_tick->ask_levels().at(3).price_1000x(),
-        m_generated_l2_tick_current->sell_4.quantity    = generated_l2_tick->ask_levels().at(3).quantity(),
-        m_generated_l2_tick_current->sell_3.price_1000x = generated_l2_tick->ask_levels().at(2).price_1000x(),
-        m_generated_l2_tick_current->sell_3.quantity    = generated_l2_tick->ask_levels().at(2).quantity(),
-        m_generated_l2_tick_current->sell_2.price_1000x = generated_l2_tick->ask_levels().at(1).price_1000x(),
-        m_generated_l2_tick_current->sell_2.quantity    = generated_l2_tick->ask_levels().at(1).quantity(),
-        m_generated_l2_tick_current->sell_1.price_1000x = generated_l2_tick->ask_levels().at(0).price_1000x(),
-        m_generated_l2_tick_current->sell_1.quantity    = generated_l2_tick->ask_levels().at(0).quantity(),
-        m_generated_l2_tick_current->buy_1.price_1000x  = generated_l2_tick->bid_levels().at(0).price_1000x(),
-        m_generated_l2_tick_current->buy_1.quantity     = generated_l2_tick->bid_levels().at(0).quantity(),
-        m_generated_l2_tick_current->buy_2.price_1000x  = generated_l2_tick->bid_levels().at(1).price_1000x(),
-        m_generated_l2_tick_current->buy_2.quantity     = generated_l2_tick->bid_levels().at(1).quantity(),
-        m_generated_l2_tick_current->buy_3.price_1000x  = generated_l2_tick->bid_levels().at(2).price_1000x(),
-        m_generated_l2_tick_current->buy_3.quantity     = generated_l2_tick->bid_levels().at(2).quantity(),
-        m_generated_l2_tick_current->buy_4.price_1000x  = generated_l2_tick->bid_levels().at(3).price_1000x(),
-        m_generated_l2_tick_current->buy_4.quantity     = generated_l2_tick->bid_levels().at(3).quantity(),
-        m_generated_l2_tick_current->buy_5.price_1000x  = generated_l2_tick->bid_levels().at(4).price_1000x(),
-        m_generated_l2_tick_current->buy_5.quantity     = generated_l2_tick->bid_levels().at(4).quantity(),
-
-        m_generated_l2_tick_current->exchange_time      = REMOVE_DATE(generated_l2_tick->exchange_time());
-        m_generated_l2_tick_current->local_system_time  = REMOVE_DATE(utilities::Now<int64_t>()());
-
-        m_generated_l2_tick_current++;
-        m_generated_l2_tick_mate_info->generated_l2_tick_count++;
-        m_generated_l2_tick_mate_info->last_update_time = REMOVE_DATE(utilities::Now<int64_t>()());
-    }
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+    /// Since Linux 5.14, fault in writable pages without touching them.
+    if (::madvise(address, size, MADV_POPULATE_WRITE) == 0)
+        return;
+#endif
+
+    /// Reading a page of shared mapping faults it in as well.
+    const auto page_size = boost::interprocess::mapped_region::get_page_size();
+
+    for (size_t offset = 0; offset < size; offset += page_size)
+        static_cast<void>(*static_cast<volatile u_char*>(address + offset));
 }
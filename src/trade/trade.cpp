@@ -1,6 +1,7 @@
 #include <csignal>
 #include <fmt/ranges.h>
 #include <iostream>
+#include <thread>
 
 /// BUG: <mysqlx/xdevapi.h> must be included before <pcap/pcap.h>?
 #include "libreporter/MySQLReporter.h"
@@ -8,13 +9,18 @@
 #include "info.h"
 #include "libbroker/CTPBroker.h"
 #include "libbroker/CUTBroker.h"
+#include "libbroker/SimBroker.h"
+#include "libholder/MemoryHolder.h"
 #include "libholder/SQLiteHolder.h"
-#include "libreporter/AsyncReporter.h"
+#include "libholder/WriteBehindHolder.h"
+#include "libreporter/ArchiveReporter.h"
 #include "libreporter/CSVReporter.h"
 #include "libreporter/LogReporter.h"
+#include "libreporter/ReporterBus.h"
 #include "libreporter/ShmReporter.h"
 #include "libreporter/SubReporter.h"
 #include "trade/trade.h"
+#include "utilities/KeyedExecutor.hpp"
 #include "utilities/NetworkHelper.hpp"
 
 trade::Trade::Trade(const int argc, char* argv[])
@@ -41,6 +47,7 @@ int trade::Trade::run()
         return EXIT_FAILURE;
     }
 
+    /// Sinks are independent of each other, the bus delivers events to them.
     const auto log_reporter   = std::make_shared<reporter::LogReporter>();
     const auto mysql_reporter = std::make_shared<reporter::MySQLReporter>(
         config->get<std::string>("Output.MySQLUrl", ""),
@@ -48,23 +55,88 @@ int trade::Trade::run()
         config->get<std::string>("Output.MySQLPassword", ""),
         config->get<std::string>("Output.MySQLDatabase", ""),
         config->get<std::string>("Output.MySQLTable", ""),
-        log_reporter
+        std::make_shared<reporter::NopReporter>(),
+        config->get<size_t>("Output.MySQLBatchSize", 1000),
+        config->get<int64_t>("Output.MySQLFlushInterval", 1000),
+        config->get<size_t>("Output.MySQLBufferCapacity", 100000),
+        config->get<size_t>("Output.MySQLMaxRetries", 3),
+        config->get<std::string>("Output.MySQLSpillFile", "")
     );
-    const auto csv_reporter = std::make_shared<reporter::CSVReporter>(config->get<std::string>("Output.CSVOutputFolder"), mysql_reporter);
-    const auto sub_reporter = std::make_shared<reporter::SubReporter>(10100, csv_reporter);
-    const auto shm_reporter = std::make_shared<reporter::ShmReporter>(
+    const auto archive_reporter = std::make_shared<reporter::ArchiveReporter>(
+        config->get<std::string>("Output.ArchiveOutputFolder", ""),
+        std::make_shared<reporter::NopReporter>(),
+        config->get<size_t>("Output.ArchiveBlockRows", 4096),
+        config->get<std::string>("Output.ArchiveCompression", "zlib") == "none" ? reporter::archive::Compression::none : reporter::archive::Compression::zlib
+    );
+    const auto csv_reporter = std::make_shared<reporter::CSVReporter>(
+        config->get<std::string>("Output.CSVOutputFolder"),
+        std::make_shared<reporter::NopReporter>(),
+        config->get<size_t>("Output.CSVMaxOpenFiles", 256),
+        config->get<size_t>("Output.CSVBufferSize", 64 * 1024),
+        config->get<int64_t>("Output.CSVFlushInterval", 1000),
+        config->get<size_t>("Output.CSVMaxPendingSize", 64 * 1024 * 1024)
+    );
+    const auto sub_reporter = std::make_shared<reporter::SubReporter>(10100);
+    const auto shm_prefault  = config->get<std::string>("Output.ShmPrefault", "background");
+    const auto shm_huge_page = config->get<std::string>("Output.ShmHugePage", "none");
+    const auto shm_layout    = config->get<std::string>("Output.ShmLayout", "legacy");
+    const auto shm_reporter  = std::make_shared<reporter::ShmReporter>(
         config->get<std::string>("Output.ShmName"),
         config->get<std::string>("Output.ShmMutexName"),
         config->get<size_t>("Output.ShmSize"),
-        sub_reporter
+        std::make_shared<reporter::NopReporter>(),
+        std::array {
+            config->get<size_t>("Output.ShmOrderTickRegionSize", 0),
+            config->get<size_t>("Output.ShmTradeTickRegionSize", 0),
+            config->get<size_t>("Output.ShmExchangeL2SnapRegionSize", 0),
+            config->get<size_t>("Output.ShmGeneratedL2TickRegionSize", 0),
+        },
+        shm_prefault == "none" ? reporter::ShmPrefault::none : shm_prefault == "eager" ? reporter::ShmPrefault::eager : reporter::ShmPrefault::background,
+        shm_huge_page == "transparent" ? reporter::ShmHugePage::transparent : shm_huge_page == "hugetlbfs" ? reporter::ShmHugePage::hugetlbfs : reporter::ShmHugePage::none,
+        config->get<std::string>("Output.ShmHugePagePath", "/dev/hugepages"),
+        config->get<uint32_t>("Output.ShmLastValueCacheSlots", 8192),
+        shm_layout == "compact" ? reporter::ShmLayout::compact : reporter::ShmLayout::legacy
     );
-    const auto async_reporter = std::make_shared<reporter::AsyncReporter>(sub_reporter);
+
+    const auto capacity     = config->get<size_t>("Output.BusQueueCapacity", 64 * 1024);
+    const auto reporter_bus = std::make_shared<reporter::ReporterBus>();
+
+    /// Shm consumers never wait on disk or database sinks, which run on the
+    /// same producer thread, so no queued sink may block on market data.
+    reporter_bus->add_sink(shm_reporter, {.name = "shm", .is_inline = true, .priority = 100});
+    /// Subscribers only need the latest depth, which may overtake older
+    /// events of other symbols when conflated.
+    reporter_bus->add_sink(sub_reporter, {.name = "sub", .priority = 90, .capacity = capacity, .overflow_policy = reporter::OverflowPolicy::conflate});
+    /// A stalled disk or database loses the oldest market data, counted in
+    /// dropped of its stats.
+    reporter_bus->add_sink(csv_reporter, {.name = "csv", .priority = 50, .capacity = capacity, .overflow_policy = reporter::OverflowPolicy::drop_oldest});
+    reporter_bus->add_sink(archive_reporter, {.name = "archive", .priority = 50, .capacity = capacity, .overflow_policy = reporter::OverflowPolicy::drop_oldest});
+    reporter_bus->add_sink(mysql_reporter, {.name = "mysql", .priority = 10, .capacity = capacity, .overflow_policy = reporter::OverflowPolicy::drop_oldest});
+    /// Only market data is dropped, order lifecycle events are always logged.
+    reporter_bus->add_sink(log_reporter, {.name = "log", .capacity = capacity, .overflow_policy = reporter::OverflowPolicy::drop_oldest});
 
     /// Reporter.
-    m_reporter = async_reporter;
+    m_reporter = reporter_bus;
 
     /// Holder.
-    m_holder = std::make_shared<holder::SQLiteHolder>();
+    if (config->get<std::string>("Holder.Type", "SQLite") == "Memory") {
+        m_holder = std::make_shared<holder::MemoryHolder>(
+            config->get<std::string>("Holder.SnapshotPath", ""),
+            std::chrono::seconds(config->get<int64_t>("Holder.SnapshotInterval", 60))
+        );
+    }
+    else {
+        /// Orders are kept in memory and written to database behind the order path.
+        m_holder = std::make_shared<holder::WriteBehindHolder>(
+            std::make_shared<holder::SQLiteHolder>(
+                config->get<std::string>("Holder.DatabasePath", ":memory:"),
+                config->get<std::string>("Holder.JournalMode", "WAL"),
+                config->get<std::string>("Holder.Synchronous", "NORMAL")
+            ),
+            std::chrono::milliseconds(config->get<int64_t>("Holder.OrderWriteBehindLag", 100)),
+            config->get<size_t>("Holder.OrderWriteBehindBatch", 1024)
+        );
+    }
 
     if (config->get<std::string>("Broker.Type") == "CTP") {
         m_broker = std::make_shared<broker::CTPBroker>(
@@ -80,6 +152,13 @@ int trade::Trade::run()
             m_reporter
         );
     }
+    else if (config->get<std::string>("Broker.Type") == "Sim") {
+        m_broker = std::make_shared<broker::SimBroker>(
+            config->get<std::string>("Broker.Config"),
+            m_holder,
+            m_reporter
+        );
+    }
     else {
         logger->error("Unsupported broker type {}", config->get<std::string>("Broker.Type"));
         return EXIT_FAILURE;
@@ -227,69 +306,155 @@ bool trade::Trade::argv_parse(const int argc, char* argv[])
 
 int trade::Trade::network_events() const
 {
-    utilities::RRServer server(config->get<std::string>("Server.APIAddress"));
+    utilities::AsyncRRServer server(config->get<std::string>("Server.APIAddress"));
 
     logger->info("Bound ZMQ socket at {}", config->get<std::string>("Server.APIAddress"));
 
-    std::vector<u_char> message_buffer;
+    /// Requests are decoded on this I/O thread and handled by a pool of
+    /// broker workers. Requests of a client are handled in order one at a
+    /// time, those of other clients in parallel, so that a slow broker call
+    /// only holds up its own client.
+    std::vector<utilities::AsyncRRReplier> repliers;
+    const auto broker_workers = std::max<size_t>(config->get<size_t>("Server.BrokerWorkers", 4), 1);
+
+    for (size_t i = 0; i < broker_workers; i++)
+        repliers.push_back(server.replier());
 
-    while (m_is_running) {
-        const auto [message_id, message_body_it] = server.receive(message_buffer);
+    utilities::KeyedExecutor<std::string> broker_jobs(broker_workers);
 
-        switch (message_id) {
-        case types::MessageID::unix_sig: {
-            types::UnixSig unix_sig;
-            unix_sig.ParseFromArray(message_body_it.base(), static_cast<int>(message_buffer.size() - utilities::Serializer::HEAD_SIZE<>));
+    const auto dispatch = [&](const uint64_t correlation_id, const types::MessageID message_id, const std::shared_ptr<google::protobuf::Message>& request) {
+        broker_jobs.post(std::string(server.peer(correlation_id)), [this, &repliers, correlation_id, message_id, request](const size_t worker) {
+            auto& replier = repliers[worker];
 
-            if (m_is_running) {
-                /// Make sure the unix_sig message is send by itself in @signal.
-                /// Client has no promise to stop server.
-                logger->warn("Unexpected signal {} received", unix_sig.sig());
+            switch (message_id) {
+            case types::MessageID::new_order_req: {
+                const auto new_order_rsp = m_broker->new_order(std::static_pointer_cast<types::NewOrderReq>(request));
+                replier.send(correlation_id, types::MessageID::new_order_rsp, *new_order_rsp);
+                break;
+            }
+            case types::MessageID::new_cancel_req: {
+                const auto new_cancel_rsp = m_broker->cancel_order(std::static_pointer_cast<types::NewCancelReq>(request));
+                replier.send(correlation_id, types::MessageID::new_cancel_rsp, *new_cancel_rsp);
+                break;
+            }
+            case types::MessageID::new_cancel_all_req: {
+                const auto new_cancel_all_rsp = m_broker->cancel_all(std::static_pointer_cast<types::NewCancelAllReq>(request));
+                replier.send(correlation_id, types::MessageID::new_cancel_all_rsp, *new_cancel_all_rsp);
+                break;
             }
-            else {
-                server.send(types::MessageID::unix_sig, unix_sig);
-                logger->info("Network event loop exited since received signal {}", unix_sig.sig());
-                return 0;
+            case types::MessageID::new_orders_req: {
+                const auto new_orders_rsp = m_broker->new_orders(std::static_pointer_cast<types::NewOrdersReq>(request));
+                replier.send(correlation_id, types::MessageID::new_orders_rsp, *new_orders_rsp);
+                break;
             }
+            case types::MessageID::new_cancels_req: {
+                const auto new_cancels_rsp = m_broker->cancel_orders(std::static_pointer_cast<types::NewCancelsReq>(request));
+                replier.send(correlation_id, types::MessageID::new_cancels_rsp, *new_cancels_rsp);
+                break;
+            }
+            default: break;
+            }
+        });
+    };
+
+    const auto log_metrics = [this, &server, &broker_jobs] {
+        const auto& metrics = server.metrics();
+
+        logger->info(
+            "Served {} requests, {} in flight (max {}), {} broker jobs at most, latency avg {}us max {}us",
+            metrics.replies,
+            metrics.in_flight,
+            metrics.max_in_flight,
+            broker_jobs.max_pending(),
+            metrics.replies == 0 ? 0 : metrics.total_latency_ns / static_cast<int64_t>(metrics.replies) / 1000,
+            metrics.max_latency_ns / 1000
+        );
+    };
+
+    const auto metrics_interval = std::chrono::seconds(config->get<int64_t>("Server.MetricsInterval", 60));
+    auto last_metrics_time      = std::chrono::steady_clock::now();
+    bool is_serving             = true;
+
+    while (m_is_running && is_serving) {
+        server.poll([&](const uint64_t correlation_id, const types::MessageID message_id, const u_char* message_body, const size_t message_body_size) {
+            switch (message_id) {
+            case types::MessageID::unix_sig: {
+                types::UnixSig unix_sig;
+                unix_sig.ParseFromArray(message_body, static_cast<int>(message_body_size));
+
+                if (m_is_running) {
+                    /// Make sure the unix_sig message is send by itself in @signal.
+                    /// Client has no promise to stop server.
+                    logger->warn("Unexpected signal {} received", unix_sig.sig());
+                }
+                else {
+                    logger->info("Network event loop exiting since received signal {}", unix_sig.sig());
+                    is_serving = false;
+                }
+
+                server.send(correlation_id, types::MessageID::unix_sig, unix_sig);
+
+                break;
+            }
+            case types::MessageID::new_order_req: {
+                const auto new_order_req = std::make_shared<types::NewOrderReq>();
+                new_order_req->ParseFromArray(message_body, static_cast<int>(message_body_size));
 
-            server.send(types::MessageID::unix_sig, unix_sig);
+                dispatch(correlation_id, message_id, new_order_req);
 
-            break;
-        }
-        case types::MessageID::new_order_req: {
-            const auto new_order_req = std::make_shared<types::NewOrderReq>();
-            new_order_req->ParseFromArray(message_body_it.base(), static_cast<int>(message_buffer.size()));
+                break;
+            }
+            case types::MessageID::new_cancel_req: {
+                const auto new_cancel_req = std::make_shared<types::NewCancelReq>();
+                new_cancel_req->ParseFromArray(message_body, static_cast<int>(message_body_size));
 
-            const auto new_order_rsp = m_broker->new_order(new_order_req);
+                dispatch(correlation_id, message_id, new_cancel_req);
 
-            server.send(types::MessageID::new_order_rsp, *new_order_rsp);
+                break;
+            }
+            case types::MessageID::new_cancel_all_req: {
+                const auto new_cancel_all_req = std::make_shared<types::NewCancelAllReq>();
+                new_cancel_all_req->ParseFromArray(message_body, static_cast<int>(message_body_size));
 
-            break;
-        }
-        case types::MessageID::new_cancel_req: {
-            const auto new_cancel_req = std::make_shared<types::NewCancelReq>();
-            new_cancel_req->ParseFromArray(message_body_it.base(), static_cast<int>(message_buffer.size()));
+                dispatch(correlation_id, message_id, new_cancel_all_req);
 
-            const auto new_cancel_rsp = m_broker->cancel_order(new_cancel_req);
+                break;
+            }
+            case types::MessageID::new_orders_req: {
+                const auto new_orders_req = std::make_shared<types::NewOrdersReq>();
+                new_orders_req->ParseFromArray(message_body, static_cast<int>(message_body_size));
 
-            server.send(types::MessageID::new_cancel_rsp, *new_cancel_rsp);
+                dispatch(correlation_id, message_id, new_orders_req);
 
-            break;
-        }
-        case types::MessageID::new_cancel_all_req: {
-            const auto new_cancel_all_req = std::make_shared<types::NewCancelAllReq>();
-            new_cancel_all_req->ParseFromArray(message_body_it.base(), static_cast<int>(message_buffer.size()));
+                break;
+            }
+            case types::MessageID::new_cancels_req: {
+                const auto new_cancels_req = std::make_shared<types::NewCancelsReq>();
+                new_cancels_req->ParseFromArray(message_body, static_cast<int>(message_body_size));
 
-            const auto new_cancel_all_rsp = m_broker->cancel_all(new_cancel_all_req);
+                dispatch(correlation_id, message_id, new_cancels_req);
 
-            server.send(types::MessageID::new_cancel_all_rsp, *new_cancel_all_rsp);
+                break;
+            }
+            default: {
+                /// Clients would wait forever without a reply.
+                server.send(correlation_id, types::MessageID::invalid_message_id, types::EmptyMessage {});
+                break;
+            }
+            }
+        });
 
-            break;
-        }
-        default: break;
+        if (std::chrono::steady_clock::now() - last_metrics_time >= metrics_interval) [[unlikely]] {
+            log_metrics();
+            last_metrics_time = std::chrono::steady_clock::now();
         }
     }
 
+    /// Reply requests already accepted before exiting.
+    broker_jobs.stop();
+    server.flush();
+
+    log_metrics();
     logger->info("Network event loop exited");
 
     return 0;
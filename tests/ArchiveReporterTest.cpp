@@ -0,0 +1,150 @@
+#include <catch.hpp>
+#include <filesystem>
+#include <fstream>
+
+#include "libreporter/ArchiveReader.h"
+#include "libreporter/ArchiveReporter.h"
+
+namespace
+{
+
+std::shared_ptr<trade::types::RangedTick> make_ranged_tick(const int64_t index, const int64_t exchange_date = 20240102)
+{
+    const auto tick = std::make_shared<trade::types::RangedTick>();
+
+    tick->set_symbol("600875.SH");
+    tick->set_exchange_date(exchange_date);
+    tick->set_exchange_time(93000000 + index * 3000);
+    tick->set_active_buy_quantity(index * 100);
+
+    for (int level = 0; level < 5; level++) {
+        tick->add_ask_levels()->set_price_1000x(10000 + level * 10 + index % 3);
+        tick->add_bid_levels()->set_price_1000x(9990 - level * 10 - index % 3);
+        tick->add_weighted_ask_price(10.005 + level);
+        tick->add_weighted_bid_price(index % 2 == 0 ? 9.995 - level : 0.);
+    }
+
+    return tick;
+}
+
+} // namespace
+
+TEST_CASE("Archive writing and reading", "[ArchiveReporter]")
+{
+    const auto folder = std::filesystem::temp_directory_path() / "trade_archive_for_unit_test";
+    const auto path   = (folder / "20240102" / "600875.SH-ranged-tick.tdca").string();
+
+    std::filesystem::remove_all(folder);
+
+    const auto compression = GENERATE(trade::reporter::archive::Compression::none, trade::reporter::archive::Compression::zlib);
+
+    {
+        /// Blocks of 100 rows and a partial one on destruction.
+        const auto reporter = std::make_shared<trade::reporter::ArchiveReporter>(folder.string(), std::make_shared<trade::reporter::NopReporter>(), 100, compression);
+
+        for (int64_t index = 0; index < 250; index++)
+            reporter->ranged_tick_generated(make_ranged_tick(index));
+    }
+
+    trade::reporter::ArchiveReader reader(path);
+
+    CHECK(reader.kind() == trade::reporter::archive::Kind::ranged_tick);
+    CHECK(reader.symbol() == "600875.SH");
+    CHECK(reader.columns() == trade::reporter::archive::schema(trade::reporter::archive::Kind::ranged_tick));
+    CHECK(reader.blocks().size() == 3);
+    CHECK(reader.rows() == 250);
+
+    SECTION("Read all rows")
+    {
+        const auto table         = reader.read();
+        const auto exchange_time = reader.column_index("exchange_time");
+        const auto ask_price_1   = reader.column_index("sell_price_1000x_1");
+        const auto weighted_bid  = reader.column_index("weighted_bid_price_1");
+
+        REQUIRE(table.rows() == 250);
+
+        for (size_t row = 0; row < table.rows(); row++) {
+            const auto expected = make_ranged_tick(static_cast<int64_t>(row));
+
+            CHECK(table.values[exchange_time][row] == expected->exchange_time());
+            CHECK(table.values[ask_price_1][row] == expected->ask_levels(0).price_1000x());
+            CHECK(table.floating(weighted_bid, row) == expected->weighted_bid_price(0));
+        }
+    }
+
+    SECTION("Read rows in range")
+    {
+        /// Rows 50 to 149, covering the first two blocks.
+        const auto table = reader.read("exchange_time", 93000000 + 50 * 3000, 93000000 + 149 * 3000);
+
+        CHECK(table.rows() == 100);
+        CHECK(table.values[reader.column_index("active_buy_quantity")].front() == 5000);
+
+        CHECK(reader.read("exchange_time", 0, 92959999).rows() == 0);
+        CHECK_THROWS(reader.read("no_such_column", 0, 0));
+    }
+
+    SECTION("Ignore truncated block")
+    {
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+        trade::reporter::ArchiveReader truncated(path);
+
+        CHECK(truncated.blocks().size() == 2);
+        CHECK(truncated.read().rows() == 200);
+    }
+
+    SECTION("Append on restart")
+    {
+        /// Truncated block of the crashed run is dropped.
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+        {
+            const auto reporter = std::make_shared<trade::reporter::ArchiveReporter>(folder.string(), std::make_shared<trade::reporter::NopReporter>(), 100, compression);
+
+            for (int64_t index = 250; index < 300; index++)
+                reporter->ranged_tick_generated(make_ranged_tick(index));
+        }
+
+        trade::reporter::ArchiveReader appended(path);
+        const auto table = appended.read();
+
+        CHECK(appended.blocks().size() == 3);
+        REQUIRE(table.rows() == 250);
+        CHECK(table.values[appended.column_index("exchange_time")][199] == make_ranged_tick(199)->exchange_time());
+        CHECK(table.values[appended.column_index("exchange_time")][200] == make_ranged_tick(250)->exchange_time());
+    }
+
+    SECTION("Invalid archive moved aside")
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "not an archive";
+
+        {
+            const auto reporter = std::make_shared<trade::reporter::ArchiveReporter>(folder.string(), std::make_shared<trade::reporter::NopReporter>(), 100, compression);
+            reporter->ranged_tick_generated(make_ranged_tick(0));
+        }
+
+        CHECK(trade::reporter::ArchiveReader(path).rows() == 1);
+        CHECK(std::filesystem::file_size(path + ".invalid") == 14);
+    }
+
+    SECTION("New file on new day")
+    {
+        const auto next_day = (folder / "20240103" / "600875.SH-ranged-tick.tdca").string();
+
+        {
+            const auto reporter = std::make_shared<trade::reporter::ArchiveReporter>(folder.string(), std::make_shared<trade::reporter::NopReporter>(), 100, compression);
+
+            reporter->ranged_tick_generated(make_ranged_tick(250));
+            reporter->ranged_tick_generated(make_ranged_tick(0, 20240103));
+            reporter->ranged_tick_generated(make_ranged_tick(1, 20240103));
+        }
+
+        CHECK(trade::reporter::ArchiveReader(path).rows() == 251);
+        CHECK(trade::reporter::ArchiveReader(next_day).rows() == 2);
+    }
+
+    CHECK_THROWS(trade::reporter::ArchiveReader((folder / "no_such_file").string()));
+
+    std::filesystem::remove_all(folder);
+}
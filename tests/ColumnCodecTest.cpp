@@ -0,0 +1,94 @@
+#include <bit>
+#include <catch.hpp>
+#include <limits>
+#include <random>
+
+#include "utilities/ColumnCodec.hpp"
+
+TEST_CASE("ColumnCodec", "[ColumnCodec]")
+{
+    SECTION("Zigzag")
+    {
+        CHECK(trade::utilities::ColumnCodec::zigzag(0) == 0);
+        CHECK(trade::utilities::ColumnCodec::zigzag(-1) == 1);
+        CHECK(trade::utilities::ColumnCodec::zigzag(1) == 2);
+        CHECK(trade::utilities::ColumnCodec::unzigzag(trade::utilities::ColumnCodec::zigzag(std::numeric_limits<int64_t>::min())) == std::numeric_limits<int64_t>::min());
+        CHECK(trade::utilities::ColumnCodec::unzigzag(trade::utilities::ColumnCodec::zigzag(std::numeric_limits<int64_t>::max())) == std::numeric_limits<int64_t>::max());
+    }
+
+    SECTION("Delta round trip")
+    {
+        /// Prices around 10.000 and times going forward.
+        const std::vector<int64_t> prices {10000, 10010, 10010, 9990, 10000, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), 0};
+        const std::vector<int64_t> times {93000000, 93000010, 93000010, 93000520, 93001000};
+
+        std::string encoded;
+        trade::utilities::ColumnCodec::encode_delta(times, encoded);
+
+        /// First value takes 4 bytes, the rest 1 or 2.
+        CHECK(encoded.size() <= 4 + 2 * (times.size() - 1));
+
+        std::vector<int64_t> decoded;
+        CHECK(trade::utilities::ColumnCodec::decode_delta(encoded, times.size(), decoded));
+        CHECK(decoded == times);
+
+        encoded.clear();
+        decoded.clear();
+        trade::utilities::ColumnCodec::encode_delta(prices, encoded);
+        CHECK(trade::utilities::ColumnCodec::decode_delta(encoded, prices.size(), decoded));
+        CHECK(decoded == prices);
+    }
+
+    SECTION("XOR round trip")
+    {
+        std::vector<int64_t> values;
+
+        for (const double value : {0., 10.5, 10.5, 10.5, -3.25, std::numeric_limits<double>::quiet_NaN()})
+            values.push_back(std::bit_cast<int64_t>(value));
+
+        std::string encoded;
+        trade::utilities::ColumnCodec::encode_xor(values, encoded);
+
+        std::vector<int64_t> decoded;
+        CHECK(trade::utilities::ColumnCodec::decode_xor(encoded, values.size(), decoded));
+        CHECK(decoded == values);
+    }
+
+    SECTION("Reject malformed input")
+    {
+        std::string encoded;
+        trade::utilities::ColumnCodec::encode_delta(std::vector<int64_t> {1, 2, 300}, encoded);
+
+        std::vector<int64_t> decoded;
+        CHECK_FALSE(trade::utilities::ColumnCodec::decode_delta(encoded, 4, decoded));
+        decoded.clear();
+        CHECK_FALSE(trade::utilities::ColumnCodec::decode_delta(encoded, 2, decoded));
+        decoded.clear();
+        CHECK_FALSE(trade::utilities::ColumnCodec::decode_delta(encoded.substr(0, encoded.size() - 1), 3, decoded));
+        decoded.clear();
+        CHECK_FALSE(trade::utilities::ColumnCodec::decode_xor(std::string(11, '\xff'), 1, decoded));
+    }
+
+    SECTION("Random round trip")
+    {
+        std::mt19937_64 engine(20240101);
+        std::vector<int64_t> values(10000);
+
+        for (auto& value : values)
+            value = static_cast<int64_t>(engine());
+
+        std::string encoded;
+        std::vector<int64_t> decoded;
+
+        trade::utilities::ColumnCodec::encode_delta(values, encoded);
+        CHECK(trade::utilities::ColumnCodec::decode_delta(encoded, values.size(), decoded));
+        CHECK(decoded == values);
+
+        encoded.clear();
+        decoded.clear();
+
+        trade::utilities::ColumnCodec::encode_xor(values, encoded);
+        CHECK(trade::utilities::ColumnCodec::decode_xor(encoded, values.size(), decoded));
+        CHECK(decoded == values);
+    }
+}
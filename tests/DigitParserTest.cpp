@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <catch.hpp>
+#include <random>
+#include <string>
+
+#include "utilities/DigitParser.hpp"
+
+namespace
+{
+
+/// What std::stoll gives on a validated fixed-width field.
+template<size_t Width>
+int64_t reference(const char* field)
+{
+    if (!std::all_of(field, field + Width, [](const char c) { return c >= '0' && c <= '9'; }))
+        return -1;
+
+    return std::stoll(std::string(field, Width));
+}
+
+template<size_t Width>
+void fuzz(std::mt19937_64& engine)
+{
+    /// Mostly digits, sometimes bytes around and far from them.
+    std::uniform_int_distribution<int> digit('0', '9');
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> dice(0, 31);
+
+    char field[Width + 1] {};
+
+    for (int i = 0; i < 100000; i++) {
+        for (size_t j = 0; j < Width; j++)
+            field[j] = static_cast<char>(dice(engine) == 0 ? byte(engine) : digit(engine));
+
+        CHECK(trade::utilities::DigitParser<Width>()(field) == reference<Width>(field));
+    }
+}
+
+} // namespace
+
+TEST_CASE("DigitParser", "[DigitParser]")
+{
+    SECTION("Parse fixed-width digits")
+    {
+        CHECK(trade::utilities::DigitParser<6>()("600000") == 600000);
+        CHECK(trade::utilities::DigitParser<6>()("000001") == 1);
+        CHECK(trade::utilities::DigitParser<6>()("999999") == 999999);
+        CHECK(trade::utilities::DigitParser<8>()("20210701") == 20210701);
+        CHECK(trade::utilities::DigitParser<1>()("7") == 7);
+    }
+
+    SECTION("Reject non-digits")
+    {
+        CHECK(trade::utilities::DigitParser<6>()("60000 ") == -1);
+        CHECK(trade::utilities::DigitParser<6>()("/00000") == -1);
+        CHECK(trade::utilities::DigitParser<6>()(":00000") == -1);
+        CHECK(trade::utilities::DigitParser<6>()("-00001") == -1);
+        CHECK(trade::utilities::DigitParser<6>()("\xff\xff\xff\xff\xff\xff") == -1);
+    }
+
+    SECTION("Tell terminated fields")
+    {
+        CHECK(trade::utilities::DigitParser<6>::terminated("600000"));
+        CHECK(trade::utilities::DigitParser<6>::terminated("600000 "));
+        CHECK_FALSE(trade::utilities::DigitParser<6>::terminated("6000001"));
+    }
+
+    SECTION("Equivalent to std::stoll")
+    {
+        std::mt19937_64 engine(20240101);
+
+        fuzz<1>(engine);
+        fuzz<4>(engine);
+        fuzz<6>(engine);
+        fuzz<8>(engine);
+    }
+}
@@ -0,0 +1,52 @@
+#include <catch.hpp>
+
+#include "utilities/FeedArbitrator.hpp"
+
+TEST_CASE("FeedArbitrator", "[FeedArbitrator]")
+{
+    SECTION("Forward first arrival only")
+    {
+        trade::utilities::FeedArbitrator<int64_t> arbitrator(2);
+
+        for (uint64_t seq = 1; seq <= 1000; seq++) {
+            /// Line A always leads by 5.
+            CHECK(arbitrator.arbitrate(0, 1, seq, static_cast<int64_t>(seq * 10)));
+            CHECK_FALSE(arbitrator.arbitrate(1, 1, seq, static_cast<int64_t>(seq * 10 + 5)));
+        }
+
+        CHECK(arbitrator.stats(0).wins == 1000);
+        CHECK(arbitrator.stats(1).losses == 1000);
+        CHECK(arbitrator.win_rate(0) == 1.);
+        CHECK(arbitrator.average_lag(1) == 5.);
+        CHECK(arbitrator.stats(1).max_lag == 5);
+    }
+
+    SECTION("Mask loss of single line")
+    {
+        trade::utilities::FeedArbitrator<int64_t> arbitrator(2);
+        uint64_t forwarded = 0;
+
+        for (uint64_t seq = 1; seq <= 1000; seq++) {
+            /// Line A loses every 10th sequence and line B every 7th.
+            if (seq % 10 != 0)
+                forwarded += arbitrator.arbitrate(0, 1, seq, 0);
+            if (seq % 7 != 0)
+                forwarded += arbitrator.arbitrate(1, 1, seq, 0);
+        }
+
+        /// Only those lost on both lines are missing.
+        CHECK(forwarded == 1000 - 1000 / 70);
+        CHECK(arbitrator.stats(1).wins == 100 - 1000 / 70);
+    }
+
+    SECTION("Arbitrate channels independently")
+    {
+        trade::utilities::FeedArbitrator<int64_t> arbitrator(2);
+
+        CHECK(arbitrator.arbitrate(0, 1, 1, 0));
+        CHECK(arbitrator.arbitrate(1, 2, 1, 0));
+        CHECK_FALSE(arbitrator.arbitrate(1, 1, 1, 0));
+        CHECK_FALSE(arbitrator.arbitrate(0, 2, 1, 0));
+        CHECK(arbitrator.win_rate(0) == 0.5);
+    }
+}
@@ -0,0 +1,95 @@
+#include <atomic>
+#include <catch.hpp>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "utilities/KeyedExecutor.hpp"
+
+TEST_CASE("Running tasks by key", "[KeyedExecutor]")
+{
+    SECTION("Tasks of the same key in order")
+    {
+        std::mutex mutex;
+        std::vector<int> tasks[2];
+        std::atomic<int> running[2] = {0, 0};
+        std::atomic<bool> is_overlapped = false;
+
+        {
+            trade::utilities::KeyedExecutor<std::string> executor(4);
+
+            for (int i = 0; i < 1000; i++) {
+                executor.post(i % 2 == 0 ? "even" : "odd", [&, i](size_t) {
+                    /// Never two tasks of the same key at once.
+                    ++running[i % 2] > 1 ? void(is_overlapped = true) : void();
+
+                    {
+                        std::lock_guard lock(mutex);
+                        tasks[i % 2].push_back(i);
+                    }
+
+                    running[i % 2]--;
+                });
+            }
+        }
+
+        REQUIRE(tasks[0].size() == 500);
+        REQUIRE(tasks[1].size() == 500);
+
+        for (int i = 0; i < 500; i++) {
+            CHECK(tasks[0][i] == i * 2);
+            CHECK(tasks[1][i] == i * 2 + 1);
+        }
+
+        CHECK_FALSE(is_overlapped);
+    }
+
+    SECTION("Slow key never blocks other keys")
+    {
+        std::atomic<bool> is_held   = true;
+        std::atomic<bool> is_served = false;
+        std::atomic<bool> is_ahead = false;
+
+        trade::utilities::KeyedExecutor<std::string> executor(2);
+
+        executor.post("slow", [&is_held](size_t) {
+            while (is_held)
+                std::this_thread::yield();
+        });
+
+        /// Queued behind the slow one of its key.
+        executor.post("slow", [&is_ahead, &is_served](size_t) { is_ahead = !is_served; });
+
+        executor.post("fast", [&is_served](size_t) { is_served = true; });
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (!is_served && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+
+        CHECK(is_served);
+
+        is_held = false;
+        executor.stop();
+
+        CHECK_FALSE(is_ahead);
+        CHECK(executor.max_pending() == 3);
+    }
+
+    SECTION("Index of thread running the task")
+    {
+        std::atomic<size_t> max_index = 0;
+
+        trade::utilities::KeyedExecutor<int> executor(3);
+
+        CHECK(executor.size() == 3);
+
+        for (int i = 0; i < 100; i++)
+            executor.post(i, [&max_index](const size_t index) { max_index = std::max<size_t>(max_index, index); });
+
+        executor.stop();
+
+        CHECK(max_index < 3);
+    }
+}
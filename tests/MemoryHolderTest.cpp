@@ -0,0 +1,149 @@
+#include <catch.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "libholder/MemoryHolder.h"
+#include "libholder/SQLiteHolder.h"
+#include "utilities/HolderSuite.hpp"
+
+namespace
+{
+
+/// A global holder for testing.
+auto memory_holder = std::make_shared<trade::holder::MemoryHolder>();
+
+std::shared_ptr<trade::types::Orders> make_order(const int64_t unique_id, const std::string& broker_id, const std::string& exchange_id = "")
+{
+    const auto orders = std::make_shared<trade::types::Orders>();
+    const auto order  = orders->add_orders();
+
+    order->set_unique_id(unique_id);
+    order->set_broker_id(broker_id);
+    exchange_id.empty() ? void() : order->set_exchange_id(exchange_id);
+    order->set_symbol("600000.SH");
+    order->set_side(trade::types::SideType::buy);
+    order->set_price(10.0);
+    order->set_quantity(100);
+
+    return orders;
+}
+
+std::string snapshot_path()
+{
+    return (std::filesystem::temp_directory_path() / "trade_memory_holder_test" / "holder.snapshot").string();
+}
+
+} // namespace
+
+TEST_CASE("Memory model write and read test", "[MemoryHolder]")
+{
+    HolderSuite::write_and_read(memory_holder);
+}
+
+TEST_CASE("Memory holder indexes and snapshots", "[MemoryHolder]")
+{
+    std::filesystem::remove_all(std::filesystem::path(snapshot_path()).parent_path());
+
+    SECTION("Move indexes with order")
+    {
+        trade::holder::MemoryHolder holder;
+
+        holder.update_orders(make_order(1, "100"));
+        holder.update_orders(make_order(1, "101", "SH101"));
+
+        CHECK(holder.query_orders_by_broker_id("100")->orders_size() == 0);
+        CHECK(holder.query_orders_by_broker_id("101")->orders_size() == 1);
+        CHECK(holder.query_orders_by_exchange_id("SH101")->orders(0).unique_id() == 1);
+    }
+
+    SECTION("Orders sharing broker id")
+    {
+        trade::holder::MemoryHolder holder;
+
+        holder.update_orders(make_order(1, "100"));
+        holder.update_orders(make_order(2, "100"));
+
+        CHECK(holder.query_orders_by_broker_id("100")->orders_size() == 2);
+    }
+
+    SECTION("Restore from snapshot")
+    {
+        {
+            trade::holder::MemoryHolder holder(snapshot_path());
+
+            holder.update_orders(make_order(1, "100", "SH100"));
+
+            const auto funds = std::make_shared<trade::types::Funds>();
+            funds->add_funds()->set_account_id("account_id");
+            funds->mutable_funds(0)->set_available_fund(1000);
+            holder.update_funds(funds);
+        }
+
+        trade::holder::MemoryHolder holder(snapshot_path());
+
+        REQUIRE(holder.query_orders_by_exchange_id("SH100")->orders_size() == 1);
+        CHECK(holder.query_orders_by_broker_id("100")->orders(0).unique_id() == 1);
+        CHECK(holder.query_funds_by_account_id("account_id")->funds(0).available_fund() == 1000);
+    }
+
+    SECTION("Snapshot periodically")
+    {
+        trade::holder::MemoryHolder holder(snapshot_path(), std::chrono::seconds(1));
+
+        holder.update_orders(make_order(1, "100"));
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (!std::filesystem::exists(snapshot_path()) && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        CHECK(std::filesystem::exists(snapshot_path()));
+    }
+
+    SECTION("Refuse corrupted snapshot")
+    {
+        std::filesystem::create_directories(std::filesystem::path(snapshot_path()).parent_path());
+        std::ofstream(snapshot_path()) << "not a snapshot";
+
+        CHECK_THROWS_AS(trade::holder::MemoryHolder(snapshot_path()), std::runtime_error);
+    }
+
+    std::filesystem::remove_all(std::filesystem::path(snapshot_path()).parent_path());
+}
+
+TEST_CASE("Memory holder querying benchmark", "[.][MemoryHolder][benchmark]")
+{
+    constexpr int64_t orders = 100000;
+
+    const auto measure = [](trade::holder::IHolder& holder) {
+        for (int64_t i = 1; i <= orders; i++)
+            holder.update_orders(make_order(i, fmt::format("broker_id_{}", i)));
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int64_t i = 1; i <= orders; i++)
+            CHECK(holder.query_orders_by_unique_id(i)->orders_size() == 1);
+
+        const auto by_unique_id_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / orders;
+
+        const auto broker_id_start = std::chrono::steady_clock::now();
+
+        for (int64_t i = 1; i <= orders; i++)
+            CHECK(holder.query_orders_by_broker_id(fmt::format("broker_id_{}", i))->orders_size() == 1);
+
+        const auto by_broker_id_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - broker_id_start).count() / orders;
+
+        return std::make_pair(by_unique_id_us, by_broker_id_us);
+    };
+
+    trade::holder::SQLiteHolder sqlite_holder;
+    trade::holder::MemoryHolder holder;
+
+    const auto [sqlite_unique_id_us, sqlite_broker_id_us] = measure(sqlite_holder);
+    const auto [memory_unique_id_us, memory_broker_id_us] = measure(holder);
+
+    WARN(fmt::format("SQLite: {:.2f} us by unique id, {:.2f} us by broker id", sqlite_unique_id_us, sqlite_broker_id_us));
+    WARN(fmt::format("Memory: {:.2f} us by unique id, {:.2f} us by broker id", memory_unique_id_us, memory_broker_id_us));
+}
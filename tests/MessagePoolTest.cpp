@@ -0,0 +1,118 @@
+#include <catch.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "orms.pb.h"
+#include "utilities/MessagePool.hpp"
+
+TEST_CASE("Message recycling", "[MessagePool]")
+{
+    SECTION("Reuse cleared message on owner thread")
+    {
+        const auto pool = std::make_shared<trade::utilities::MessagePool<trade::types::OrderTick>>(16, 1);
+
+        auto order_tick = pool->acquire();
+        const auto raw  = order_tick.get();
+
+        CHECK(pool->available() == 0);
+
+        order_tick->set_symbol("600000.SH");
+        order_tick->set_unique_id(1);
+        order_tick.reset();
+
+        CHECK(pool->available() == 1);
+
+        const auto reused = pool->acquire();
+
+        CHECK(reused.get() == raw);
+        CHECK(reused->symbol().empty());
+        CHECK(reused->unique_id() == 0);
+    }
+
+    SECTION("Return message released on other thread")
+    {
+        const auto pool = std::make_shared<trade::utilities::MessagePool<trade::types::OrderTick>>(16);
+
+        auto order_tick = pool->acquire();
+        const auto raw  = order_tick.get();
+
+        order_tick->set_unique_id(1);
+
+        std::thread([order_tick = std::move(order_tick)]() mutable { order_tick.reset(); }).join();
+
+        /// Queued for the owner rather than put in the free list.
+        CHECK(pool->available() == 0);
+
+        const auto reused = pool->acquire();
+
+        CHECK(reused.get() == raw);
+        CHECK(reused->unique_id() == 0);
+    }
+
+    SECTION("Free messages beyond capacity")
+    {
+        const auto pool = std::make_shared<trade::utilities::MessagePool<trade::types::OrderTick>>(2);
+
+        std::vector<std::shared_ptr<trade::types::OrderTick>> order_ticks;
+
+        for (int i = 0; i < 4; i++)
+            order_ticks.push_back(pool->acquire());
+
+        order_ticks.clear();
+
+        CHECK(pool->available() == 2);
+    }
+
+    SECTION("Keep pool alive until messages returned")
+    {
+        auto pool             = std::make_shared<trade::utilities::MessagePool<trade::types::OrderTick>>(16);
+        const auto order_tick = pool->acquire();
+
+        pool.reset();
+        order_tick->set_unique_id(1);
+
+        CHECK(order_tick->unique_id() == 1);
+    }
+
+    SECTION("Return messages on other threads after pool dropped")
+    {
+        auto pool = std::make_shared<trade::utilities::MessagePool<trade::types::OrderTick>>(16);
+
+        std::vector<std::shared_ptr<trade::types::OrderTick>> order_ticks;
+
+        for (int i = 0; i < 1000; i++)
+            order_ticks.push_back(pool->acquire());
+
+        /// Returned ones are freed with the pool, the rest by the last return.
+        order_ticks.resize(500);
+        pool.reset();
+
+        std::vector<std::thread> sinks;
+
+        for (int i = 0; i < 4; i++) {
+            sinks.emplace_back([order_ticks = std::vector(order_ticks.begin() + i * 125, order_ticks.begin() + (i + 1) * 125)]() mutable {
+                for (auto& order_tick : order_ticks)
+                    order_tick.reset();
+            });
+        }
+
+        order_ticks.clear();
+
+        for (auto& sink : sinks)
+            sink.join();
+    }
+
+    SECTION("Pool of calling thread")
+    {
+        const auto& pool = trade::utilities::MessagePool<trade::types::OrderTick>::local();
+
+        CHECK(pool == trade::utilities::MessagePool<trade::types::OrderTick>::local());
+        CHECK(pool->available() == trade::utilities::MessagePool<trade::types::OrderTick>::default_preallocated);
+
+        const trade::utilities::MessagePool<trade::types::OrderTick>* other = nullptr;
+        std::thread([&other] { other = trade::utilities::MessagePool<trade::types::OrderTick>::local().get(); }).join();
+
+        CHECK(other != pool.get());
+    }
+}
@@ -0,0 +1,252 @@
+#include <atomic>
+#include <catch.hpp>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#include "libreporter/MySQLReporter.h"
+
+namespace
+{
+
+/// Rows inserted through fake sessions, shared by all sessions made.
+struct FakeDatabase {
+    /// Waits until condition holds or 5s pass.
+    template<typename Condition>
+    bool wait_until(Condition&& condition)
+    {
+        std::unique_lock lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(5), std::forward<Condition>(condition));
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    /// Sizes of inserted batches.
+    std::vector<size_t> batches;
+    /// Inserts failing before the first success.
+    size_t failures = 0;
+    size_t attempts = 0;
+    /// Inserts wait while blocked.
+    bool is_blocked   = false;
+    bool is_inserting = false;
+};
+
+class FakeSession final: public trade::reporter::MySQLReporter::Session
+{
+public:
+    explicit FakeSession(FakeDatabase& database) : m_database(database) {}
+
+public:
+    void insert(const std::vector<std::shared_ptr<trade::types::RangedTick>>& ranged_ticks) override
+    {
+        std::unique_lock lock(m_database.mutex);
+
+        m_database.attempts++;
+        m_database.is_inserting = true;
+        m_database.cv.notify_all();
+
+        m_database.cv.wait(lock, [this] { return !m_database.is_blocked; });
+        m_database.is_inserting = false;
+
+        if (m_database.attempts <= m_database.failures)
+            throw std::runtime_error("Lost connection to MySQL server");
+
+        m_database.batches.push_back(ranged_ticks.size());
+        m_database.cv.notify_all();
+    }
+
+private:
+    FakeDatabase& m_database;
+};
+
+trade::reporter::MySQLReporter::SessionFactory fake_sessions(FakeDatabase& database)
+{
+    return [&database] { return std::make_unique<FakeSession>(database); };
+}
+
+std::shared_ptr<trade::types::RangedTick> make_ranged_tick(const int64_t index)
+{
+    const auto tick = std::make_shared<trade::types::RangedTick>();
+
+    tick->set_symbol("600875.SH");
+    tick->set_exchange_time(93000000 + index * 3000);
+
+    return tick;
+}
+
+size_t rows_of(const std::vector<size_t>& batches)
+{
+    return std::accumulate(batches.begin(), batches.end(), size_t(0));
+}
+
+size_t lines_of(const std::filesystem::path& file)
+{
+    std::ifstream stream(file);
+    std::string line;
+    size_t lines = 0;
+
+    while (std::getline(stream, line))
+        lines++;
+
+    return lines;
+}
+
+} // namespace
+
+TEST_CASE("MySQL reporter with fake session", "[MySQLReporter]")
+{
+    FakeDatabase database;
+
+    SECTION("Flush batch once full")
+    {
+        {
+            trade::reporter::MySQLReporter reporter("fake", fake_sessions(database), std::make_shared<trade::reporter::NopReporter>(), 10, 3600 * 1000);
+
+            for (int64_t index = 0; index < 25; index++)
+                reporter.ranged_tick_generated(make_ranged_tick(index));
+
+            CHECK(database.wait_until([&database] { return database.batches.size() == 2; }));
+            CHECK(database.batches == std::vector<size_t> {10, 10});
+        }
+
+        /// Rest flushed when destroyed.
+        CHECK(database.batches == std::vector<size_t> {10, 10, 5});
+    }
+
+    SECTION("Flush partial batch on interval")
+    {
+        trade::reporter::MySQLReporter reporter("fake", fake_sessions(database), std::make_shared<trade::reporter::NopReporter>(), 1000, 20);
+
+        for (int64_t index = 0; index < 3; index++)
+            reporter.ranged_tick_generated(make_ranged_tick(index));
+
+        CHECK(database.wait_until([&database] { return !database.batches.empty(); }));
+        CHECK(database.batches == std::vector<size_t> {3});
+        CHECK(reporter.metrics().inserted_rows == 3);
+    }
+
+    SECTION("Retry failed insert")
+    {
+        database.failures = 1;
+
+        {
+            trade::reporter::MySQLReporter reporter("fake", fake_sessions(database), std::make_shared<trade::reporter::NopReporter>(), 2, 3600 * 1000, 100, 1);
+
+            reporter.ranged_tick_generated(make_ranged_tick(0));
+            reporter.ranged_tick_generated(make_ranged_tick(1));
+
+            CHECK(database.wait_until([&database] { return !database.batches.empty(); }));
+            CHECK(reporter.metrics().retries == 1);
+        }
+
+        CHECK(database.attempts == 2);
+        CHECK(database.batches == std::vector<size_t> {2});
+    }
+
+    SECTION("Spill batch still failing after retries")
+    {
+        const auto spill_file = std::filesystem::temp_directory_path() / "trade_mysql_reporter_test" / "spill.jsonl";
+
+        std::filesystem::remove_all(spill_file.parent_path());
+
+        database.failures = 100;
+
+        {
+            trade::reporter::MySQLReporter reporter("fake", fake_sessions(database), std::make_shared<trade::reporter::NopReporter>(), 2, 3600 * 1000, 100, 1, spill_file.string());
+
+            reporter.ranged_tick_generated(make_ranged_tick(0));
+            reporter.ranged_tick_generated(make_ranged_tick(1));
+
+            /// Retried only while running.
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+            while (reporter.metrics().spilled_rows < 2 && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        CHECK(database.attempts == 2);
+        CHECK(database.batches.empty());
+        CHECK(lines_of(spill_file) == 2);
+
+        std::filesystem::remove_all(spill_file.parent_path());
+    }
+
+    SECTION("Spill without reconnecting once stopping")
+    {
+        const auto spill_file = std::filesystem::temp_directory_path() / "trade_mysql_reporter_test" / "spill.jsonl";
+
+        std::filesystem::remove_all(spill_file.parent_path());
+
+        std::atomic<size_t> connections = 0;
+
+        {
+            trade::reporter::MySQLReporter reporter(
+                "unreachable",
+                [&connections]() -> std::unique_ptr<trade::reporter::MySQLReporter::Session> {
+                    connections++;
+                    throw std::runtime_error("Can't connect to MySQL server");
+                },
+                std::make_shared<trade::reporter::NopReporter>(),
+                100,
+                3600 * 1000,
+                100,
+                3,
+                spill_file.string()
+            );
+
+            /// Buffered until destroyed.
+            for (int64_t index = 0; index < 25; index++)
+                reporter.ranged_tick_generated(make_ranged_tick(index));
+        }
+
+        /// Only the one when constructed.
+        CHECK(connections == 1);
+        CHECK(lines_of(spill_file) == 25);
+
+        std::filesystem::remove_all(spill_file.parent_path());
+    }
+
+    SECTION("Drop rows instead of blocking producer when buffer is full")
+    {
+        {
+            /// Buffer capacity is raised to batch size.
+            trade::reporter::MySQLReporter reporter("fake", fake_sessions(database), std::make_shared<trade::reporter::NopReporter>(), 2, 3600 * 1000, 1);
+
+            {
+                std::lock_guard lock(database.mutex);
+                database.is_blocked = true;
+            }
+
+            /// First batch is taken out of buffer and held in insert.
+            reporter.ranged_tick_generated(make_ranged_tick(0));
+            reporter.ranged_tick_generated(make_ranged_tick(1));
+
+            REQUIRE(database.wait_until([&database] { return database.is_inserting; }));
+
+            reporter.ranged_tick_generated(make_ranged_tick(2));
+            reporter.ranged_tick_generated(make_ranged_tick(3));
+
+            auto producer = std::async(std::launch::async, [&reporter] { reporter.ranged_tick_generated(make_ranged_tick(4)); });
+
+            CHECK(producer.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+            CHECK(reporter.metrics().queue_depth == 2);
+            CHECK(reporter.metrics().dropped_rows == 1);
+
+            {
+                std::lock_guard lock(database.mutex);
+                database.is_blocked = false;
+            }
+
+            database.cv.notify_all();
+            producer.wait();
+
+            CHECK(reporter.metrics().max_queue_depth == 2);
+        }
+
+        CHECK(rows_of(database.batches) == 4);
+    }
+}
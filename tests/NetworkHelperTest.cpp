@@ -1,4 +1,6 @@
 #include <catch.hpp>
+#include <future>
+#include <mutex>
 #include <thread>
 
 #include "utilities/NetworkHelper.hpp"
@@ -165,6 +167,229 @@ TEST_CASE("Communication between RRServer and RRClient", "[RRServer/RRClient]")
     }
 }
 
+TEST_CASE("Communication between AsyncRRServer and RRClient", "[AsyncRRServer]")
+{
+    trade::utilities::ZMQContextPtr zmq_context;
+    zmq_context.reset(zmq_ctx_new(), trade::utilities::ZMQContextPtrDeleter());
+
+    SECTION("Replying out of order from worker thread")
+    {
+        trade::utilities::AsyncRRServer server("inproc://async_server", zmq_context);
+
+        std::mutex jobs_mutex;
+        std::vector<std::pair<uint64_t, int>> jobs;
+        std::atomic<bool> is_running = true;
+
+        /// Replies in reverse order of requests in each batch.
+        std::thread worker([&jobs_mutex, &jobs, &is_running, replier = server.replier()]() mutable {
+            while (is_running) {
+                std::vector<std::pair<uint64_t, int>> batch;
+
+                {
+                    std::lock_guard lock(jobs_mutex);
+                    batch.swap(jobs);
+                }
+
+                for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+                    trade::types::UnixSig unix_sig;
+                    unix_sig.set_sig(it->second);
+                    replier.send(it->first, trade::types::MessageID::unix_sig, unix_sig);
+                }
+
+                std::this_thread::yield();
+            }
+        });
+
+        std::atomic<size_t> mismatched = 0;
+        std::atomic<size_t> finished   = 0;
+
+        auto client_worker = [&zmq_context, &mismatched, &finished] {
+            trade::utilities::RRClient client("inproc://async_server", zmq_context);
+
+            for (int i = 0; i < insertion_batch; i++) {
+                trade::types::UnixSig send_unix_sig;
+                send_unix_sig.set_sig(i);
+
+                const auto received_unix_sig = client.request<trade::types::UnixSig>(trade::types::MessageID::unix_sig, send_unix_sig);
+
+                received_unix_sig.sig() == i ? void() : void(++mismatched);
+            }
+
+            ++finished;
+        };
+
+        std::array<std::thread, insertion_times> client_threads;
+
+        for (auto& client_thread : client_threads)
+            client_thread = std::thread(client_worker);
+
+        while (finished < insertion_times) {
+            server.poll([&jobs_mutex, &jobs](const uint64_t correlation_id, const trade::types::MessageID message_id, const u_char* message_body, const size_t message_body_size) {
+                trade::types::UnixSig unix_sig;
+                unix_sig.ParseFromArray(message_body, static_cast<int>(message_body_size));
+
+                std::lock_guard lock(jobs_mutex);
+                jobs.emplace_back(correlation_id, message_id == trade::types::MessageID::unix_sig ? unix_sig.sig() : -1);
+            });
+        }
+
+        for (auto& client_thread : client_threads)
+            client_thread.join();
+
+        is_running = false;
+        worker.join();
+
+        CHECK(mismatched == 0);
+        CHECK(server.metrics().requests == insertion_times * insertion_batch);
+        CHECK(server.metrics().replies == insertion_times * insertion_batch);
+        CHECK(server.metrics().in_flight == 0);
+    }
+
+    SECTION("Replying on I/O thread")
+    {
+        trade::utilities::AsyncRRServer server("inproc://async_server_inline", zmq_context);
+
+        int received_sig = 0;
+
+        std::thread client_thread([&zmq_context, &received_sig] {
+            trade::utilities::RRClient client("inproc://async_server_inline", zmq_context);
+
+            trade::types::UnixSig send_unix_sig;
+            send_unix_sig.set_sig(15);
+
+            received_sig = client.request<trade::types::UnixSig>(trade::types::MessageID::unix_sig, send_unix_sig).sig();
+        });
+
+        std::string peer;
+
+        while (server.metrics().replies == 0) {
+            server.poll([&server, &peer](const uint64_t correlation_id, trade::types::MessageID, const u_char* message_body, const size_t message_body_size) {
+                peer = server.peer(correlation_id);
+
+                trade::types::UnixSig unix_sig;
+                unix_sig.ParseFromArray(message_body, static_cast<int>(message_body_size));
+                server.send(correlation_id, trade::types::MessageID::unix_sig, unix_sig);
+
+                /// Not pending once replied.
+                CHECK(server.peer(correlation_id).empty());
+            });
+        }
+
+        client_thread.join();
+
+        CHECK(received_sig == 15);
+        CHECK_FALSE(peer.empty());
+    }
+}
+
+TEST_CASE("Communication between AsyncRRServer and AsyncRRClient", "[AsyncRRClient]")
+{
+    trade::utilities::ZMQContextPtr zmq_context;
+    zmq_context.reset(zmq_ctx_new(), trade::utilities::ZMQContextPtrDeleter());
+
+    trade::utilities::AsyncRRServer server("inproc://async_client_server", zmq_context, 10);
+
+    /// Server keeps requests until told to reply all in reverse order.
+    std::vector<std::pair<uint64_t, trade::types::UnixSig>> held;
+
+    const auto serve = [&server, &held](const size_t requests) {
+        while (held.size() < requests) {
+            server.poll([&held](const uint64_t correlation_id, trade::types::MessageID, const u_char* message_body, const size_t message_body_size) {
+                trade::types::UnixSig unix_sig;
+                unix_sig.ParseFromArray(message_body, static_cast<int>(message_body_size));
+                held.emplace_back(correlation_id, unix_sig);
+            });
+        }
+
+        for (auto it = held.rbegin(); it != held.rend(); ++it)
+            server.send(it->first, trade::types::MessageID::unix_sig, it->second);
+
+        held.clear();
+    };
+
+    SECTION("Many requests in flight")
+    {
+        trade::utilities::AsyncRRClient client("inproc://async_client_server", zmq_context);
+
+        std::vector<trade::utilities::AsyncRRClient::Request> requests;
+
+        for (int i = 0; i < insertion_batch; i++) {
+            trade::types::UnixSig unix_sig;
+            unix_sig.set_sig(i);
+            requests.push_back(client.request(trade::types::MessageID::unix_sig, unix_sig));
+        }
+
+        serve(insertion_batch);
+
+        for (int i = 0; i < insertion_batch; i++) {
+            const auto reply = requests[i].reply.get();
+
+            REQUIRE(reply.status() == trade::utilities::AsyncRRStatus::ok);
+            CHECK(reply.message_id() == trade::types::MessageID::unix_sig);
+            CHECK(reply.parse<trade::types::UnixSig>().sig() == i);
+        }
+
+        CHECK(client.in_flight() == 0);
+    }
+
+    SECTION("Reply by callback")
+    {
+        trade::utilities::AsyncRRClient client("inproc://async_client_server", zmq_context);
+
+        std::promise<int> received_sig;
+
+        trade::types::UnixSig unix_sig;
+        unix_sig.set_sig(15);
+        client.request(trade::types::MessageID::unix_sig, unix_sig, [&received_sig](trade::utilities::AsyncRRReply&& reply) {
+            received_sig.set_value(reply.parse<trade::types::UnixSig>().sig());
+        });
+
+        serve(1);
+
+        CHECK(received_sig.get_future().get() == 15);
+    }
+
+    SECTION("Timeout and cancellation")
+    {
+        trade::utilities::AsyncRRClient client("inproc://async_client_server", zmq_context, std::chrono::milliseconds(50));
+
+        trade::types::UnixSig unix_sig;
+        auto timed_out = client.request(trade::types::MessageID::unix_sig, unix_sig);
+        auto cancelled = client.request(trade::types::MessageID::unix_sig, unix_sig, std::chrono::milliseconds(0));
+
+        CHECK(client.cancel(cancelled.request_id));
+        CHECK_FALSE(client.cancel(cancelled.request_id));
+        CHECK(cancelled.reply.get().status() == trade::utilities::AsyncRRStatus::cancelled);
+        CHECK(timed_out.reply.get().status() == trade::utilities::AsyncRRStatus::timeout);
+
+        /// Late replies are dropped.
+        serve(2);
+        CHECK(client.in_flight() == 0);
+    }
+}
+
+TEST_CASE("Communication between RRServer and AsyncRRClient", "[AsyncRRClient]")
+{
+    trade::utilities::ZMQContextPtr zmq_context;
+    zmq_context.reset(zmq_ctx_new(), trade::utilities::ZMQContextPtrDeleter());
+
+    trade::utilities::RRServer server("inproc://lockstep_server", zmq_context);
+    trade::utilities::AsyncRRClient client("inproc://lockstep_server", zmq_context);
+
+    trade::types::UnixSig unix_sig;
+    unix_sig.set_sig(2);
+    auto request = client.request(trade::types::MessageID::unix_sig, unix_sig);
+
+    std::vector<u_char> message_buffer;
+    const auto [message_id, message_body_it] = server.receive(message_buffer);
+    CHECK(message_id == trade::types::MessageID::unix_sig);
+    server.send(trade::types::MessageID::unix_sig, unix_sig);
+
+    const auto reply = request.reply.get();
+    REQUIRE(reply.status() == trade::utilities::AsyncRRStatus::ok);
+    CHECK(reply.parse<trade::types::UnixSig>().sig() == 2);
+}
+
 TEST_CASE("Communication with UDP multicast", "[MCServer/MCClient]")
 {
     SECTION("Sending and receiving messages via IP multicast")
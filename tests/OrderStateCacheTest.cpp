@@ -0,0 +1,172 @@
+#include <catch.hpp>
+
+#include "libbroker/OrderStateCache.hpp"
+#include "libbroker/RiskEngine.hpp"
+#include "libreporter/NopReporter.hpp"
+
+namespace
+{
+
+/// Records unique ids of acceptances and cancels.
+class RecordingReporter final: public trade::reporter::NopReporter
+{
+public:
+    void broker_accepted(const std::shared_ptr<trade::types::BrokerAcceptance> broker_acceptance) override
+    {
+        broker_accepted_ids.push_back(broker_acceptance->unique_id());
+    }
+
+    void exchange_accepted(const std::shared_ptr<trade::types::ExchangeAcceptance> exchange_acceptance) override
+    {
+        exchange_accepted_ids.push_back(exchange_acceptance->unique_id());
+    }
+
+    void cancel_success(const std::shared_ptr<trade::types::CancelSuccess> cancel_success) override
+    {
+        canceled_quantities.push_back(cancel_success->canceled_quantity());
+    }
+
+public:
+    std::vector<int64_t> broker_accepted_ids;
+    std::vector<int64_t> exchange_accepted_ids;
+    std::vector<int64_t> canceled_quantities;
+};
+
+trade::broker::OrderState make_state(const int64_t unique_id, const std::string& exchange_id = "")
+{
+    trade::broker::OrderState state;
+
+    state.order.set_unique_id(unique_id);
+    exchange_id.empty() ? void() : state.order.set_exchange_id(exchange_id);
+    state.order.set_symbol("600000.SH");
+    state.order.set_quantity(100);
+
+    return state;
+}
+
+} // namespace
+
+TEST_CASE("Order state cache", "[OrderStateCache]")
+{
+    trade::broker::OrderStateCache cache;
+
+    SECTION("Find own order by OrderRef and exchange id")
+    {
+        cache.insert(1, make_state(100));
+
+        CHECK(cache.modify_by_order_ref(1, [](trade::broker::OrderState& state) { state.order.set_exchange_id("SSE:1"); }));
+        CHECK_FALSE(cache.modify_by_order_ref(2, [](trade::broker::OrderState&) {}));
+
+        int64_t unique_id = 0;
+        CHECK(cache.modify_by_exchange_id("SSE:1", [&unique_id](const trade::broker::OrderState& state) { unique_id = state.order.unique_id(); }));
+        CHECK(unique_id == 100);
+
+        REQUIRE(cache.find(100).has_value());
+        CHECK(cache.find(100)->exchange_id() == "SSE:1");
+        CHECK_FALSE(cache.find(101).has_value());
+    }
+
+    SECTION("Find outside order by exchange id only")
+    {
+        cache.insert(make_state(200, "SZSE:2"));
+
+        CHECK(cache.modify_by_exchange_id("SZSE:2", [](trade::broker::OrderState& state) { state.traded_quantity = 10; }));
+        CHECK(cache.size() == 1);
+    }
+
+    SECTION("Erase order never submitted")
+    {
+        cache.insert(1, make_state(100, "SSE:1"));
+        cache.insert(2, make_state(101));
+
+        cache.erase(1);
+        cache.erase(3);
+
+        CHECK_FALSE(cache.find(100).has_value());
+        CHECK_FALSE(cache.modify_by_order_ref(1, [](trade::broker::OrderState&) {}));
+        CHECK_FALSE(cache.modify_by_exchange_id("SSE:1", [](trade::broker::OrderState&) {}));
+        CHECK(cache.size() == 1);
+    }
+
+    SECTION("Report events")
+    {
+        RecordingReporter reporter;
+        trade::broker::OrderEvents events;
+
+        CHECK(events.is_empty());
+
+        events.is_broker_accepted   = true;
+        events.is_exchange_accepted = true;
+        events.is_canceled          = true;
+        events.canceled_quantity    = 60;
+        events.order                = make_state(300, "SSE:3").order;
+
+        CHECK(events.is_persisted());
+
+        events.report(reporter);
+
+        CHECK(reporter.broker_accepted_ids == std::vector<int64_t> {300});
+        CHECK(reporter.exchange_accepted_ids == std::vector<int64_t> {300});
+        CHECK(reporter.canceled_quantities == std::vector<int64_t> {60});
+    }
+}
+
+TEST_CASE("Fills of trade callbacks", "[OrderStateCache]")
+{
+    trade::broker::OrderStateCache cache;
+    trade::broker::RiskEngine risk_engine({.max_symbol_position = 100}, 10000);
+
+    trade::types::NewOrderReq new_order_req;
+    new_order_req.set_unique_id(100);
+    new_order_req.set_symbol("600000.SH");
+    new_order_req.set_side(trade::types::SideType::buy);
+    new_order_req.set_price(10);
+    new_order_req.set_quantity(100);
+
+    REQUIRE(risk_engine.check(new_order_req) == trade::types::RejectionCode::invalid_rejection_code);
+    REQUIRE(risk_engine.available_fund() == 9000);
+
+    auto state = make_state(100, "SSE:1");
+    state.order.set_side(trade::types::SideType::buy);
+    state.order.set_price(10);
+    cache.insert(1, std::move(state));
+
+    /// As OnRtnTrade of CTP/CUT does.
+    const auto on_rtn_trade = [&cache, &risk_engine](const std::string& trade_id, const double price, const int64_t volume) {
+        std::shared_ptr<trade::types::Trade> trade;
+
+        cache.modify_by_exchange_id("SSE:1", [&trade, &trade_id, price, volume](trade::broker::OrderState& state) {
+            trade = state.fill(trade_id, price, volume);
+        });
+
+        trade == nullptr ? void() : risk_engine.trade_accepted(trade);
+
+        return trade;
+    };
+
+    const auto first = on_rtn_trade("T1", 9.5, 30);
+
+    REQUIRE(first != nullptr);
+    CHECK(first->unique_id() == 100);
+    CHECK(first->trade_id() == "T1");
+    CHECK(first->price() == 9.5);
+    CHECK(first->cumulative_quantity() == 30);
+
+    /// Trade replayed after reconnecting is not a fill.
+    CHECK(on_rtn_trade("T1", 9.5, 30) == nullptr);
+
+    CHECK(risk_engine.position("600000.SH") == 30);
+    CHECK(risk_engine.working("600000.SH", trade::types::SideType::buy) == 70);
+    /// Price improvement is returned to available fund.
+    CHECK(risk_engine.available_fund() == Approx(9015));
+
+    const auto second = on_rtn_trade("T2", 10, 70);
+
+    REQUIRE(second != nullptr);
+    CHECK(second->cumulative_quantity() == 100);
+
+    CHECK(risk_engine.position("600000.SH") == 100);
+    CHECK(risk_engine.working("600000.SH", trade::types::SideType::buy) == 0);
+    CHECK(risk_engine.working_value() == 0);
+    CHECK(risk_engine.available_fund() == Approx(9015));
+}
@@ -0,0 +1,323 @@
+#include <catch.hpp>
+#include <future>
+#include <thread>
+
+#include "libreporter/ReporterBus.h"
+
+namespace
+{
+
+/// Records ranged ticks, optionally holding on the first one until released.
+class RecordingSink final: public trade::reporter::NopReporter
+{
+public:
+    explicit RecordingSink(const bool is_held = false)
+        : m_is_held(is_held)
+    {
+    }
+
+public:
+    void ranged_tick_generated(const std::shared_ptr<trade::types::RangedTick> ranged_tick) override
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_ticks.emplace_back(ranged_tick->symbol(), ranged_tick->exchange_time());
+        }
+
+        m_is_entered = true;
+
+        while (m_is_held)
+            std::this_thread::yield();
+    }
+
+    void exchange_order_tick_arrived(const std::shared_ptr<trade::types::OrderTick> order_tick) override
+    {
+        std::lock_guard lock(m_mutex);
+        m_ticks.emplace_back(order_tick->symbol(), order_tick->unique_id());
+    }
+
+    void trade_accepted(const std::shared_ptr<trade::types::Trade> trade) override
+    {
+        std::lock_guard lock(m_mutex);
+        m_ticks.emplace_back(trade->symbol(), trade->unique_id());
+    }
+
+public:
+    void wait_entered() const
+    {
+        while (!m_is_entered)
+            std::this_thread::yield();
+    }
+
+    void release() { m_is_held = false; }
+
+    [[nodiscard]] std::vector<std::pair<std::string, int64_t>> ticks()
+    {
+        std::lock_guard lock(m_mutex);
+        return m_ticks;
+    }
+
+private:
+    std::atomic<bool> m_is_held;
+    std::atomic<bool> m_is_entered = false;
+    std::mutex m_mutex;
+    std::vector<std::pair<std::string, int64_t>> m_ticks;
+};
+
+std::shared_ptr<trade::types::RangedTick> make_ranged_tick(const std::string& symbol, const int64_t exchange_time)
+{
+    const auto tick = std::make_shared<trade::types::RangedTick>();
+    tick->set_symbol(symbol);
+    tick->set_exchange_time(exchange_time);
+    return tick;
+}
+
+} // namespace
+
+TEST_CASE("ReporterBus fan-out", "[ReporterBus]")
+{
+    SECTION("Deliver to inline and threaded sinks in order")
+    {
+        const auto inline_sink   = std::make_shared<RecordingSink>();
+        const auto threaded_sink = std::make_shared<RecordingSink>();
+
+        {
+            trade::reporter::ReporterBus bus;
+            bus.add_sink(threaded_sink, {.name = "threaded", .capacity = 16});
+            bus.add_sink(inline_sink, {.name = "inline", .is_inline = true});
+
+            for (int64_t i = 0; i < 10000; i++)
+                bus.ranged_tick_generated(make_ranged_tick("600000.SH", i));
+
+            /// Inline sink has got them all before returning.
+            CHECK(inline_sink->ticks().size() == 10000);
+            CHECK(bus.stats("inline")->delivered == 10000);
+            CHECK(bus.stats("no_such_sink") == nullptr);
+        }
+
+        const auto ticks = threaded_sink->ticks();
+
+        REQUIRE(ticks.size() == 10000);
+
+        for (int64_t i = 0; i < 10000; i++)
+            CHECK(ticks[i].second == i);
+    }
+
+    SECTION("Deliver batch larger than queue capacity")
+    {
+        const auto inline_sink   = std::make_shared<RecordingSink>();
+        const auto threaded_sink = std::make_shared<RecordingSink>();
+
+        std::vector<std::shared_ptr<trade::types::RangedTick>> batch;
+
+        for (int64_t i = 0; i < 1000; i++)
+            batch.push_back(make_ranged_tick("600000.SH", i));
+
+        {
+            trade::reporter::ReporterBus bus;
+            bus.add_sink(threaded_sink, {.name = "threaded", .capacity = 16});
+            bus.add_sink(inline_sink, {.name = "inline", .is_inline = true});
+
+            bus.ranged_ticks_generated(batch);
+            bus.ranged_ticks_generated({});
+
+            /// Inline sink falls back to per-event method.
+            CHECK(inline_sink->ticks().size() == 1000);
+            CHECK(bus.stats("inline")->delivered == 1000);
+        }
+
+        const auto ticks = threaded_sink->ticks();
+
+        REQUIRE(ticks.size() == 1000);
+
+        for (int64_t i = 0; i < 1000; i++)
+            CHECK(ticks[i].second == i);
+    }
+
+    SECTION("Drop oldest events of slow sink")
+    {
+        const auto slow_sink = std::make_shared<RecordingSink>(true);
+        const auto fast_sink = std::make_shared<RecordingSink>();
+
+        trade::reporter::ReporterBus bus;
+        bus.add_sink(slow_sink, {.name = "slow", .capacity = 10, .overflow_policy = trade::reporter::OverflowPolicy::drop_oldest});
+        bus.add_sink(fast_sink, {.name = "fast", .is_inline = true});
+
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 0));
+        slow_sink->wait_entered();
+
+        /// Never blocked by the slow sink.
+        for (int64_t i = 1; i <= 100; i++)
+            bus.ranged_tick_generated(make_ranged_tick("600000.SH", i));
+
+        CHECK(fast_sink->ticks().size() == 101);
+        CHECK(bus.stats("slow")->dropped == 90);
+
+        slow_sink->release();
+
+        while (bus.stats("slow")->delivered < 11)
+            std::this_thread::yield();
+
+        const auto ticks = slow_sink->ticks();
+
+        REQUIRE(ticks.size() == 11);
+        CHECK(ticks[1].second == 91);
+        CHECK(ticks[10].second == 100);
+    }
+
+    SECTION("Stalled queued sinks never delay inline sink")
+    {
+        const auto inline_sink = std::make_shared<RecordingSink>();
+        std::vector<std::shared_ptr<RecordingSink>> stalled_sinks;
+
+        trade::reporter::ReporterBus bus;
+        bus.add_sink(inline_sink, {.name = "inline", .is_inline = true, .priority = 100});
+
+        /// As disk and database sinks are added by trade.
+        for (const auto& name : {"csv", "archive", "mysql"}) {
+            stalled_sinks.push_back(std::make_shared<RecordingSink>(true));
+            bus.add_sink(stalled_sinks.back(), {.name = name, .capacity = 8, .overflow_policy = trade::reporter::OverflowPolicy::drop_oldest});
+        }
+
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 0));
+
+        for (const auto& stalled_sink : stalled_sinks)
+            stalled_sink->wait_entered();
+
+        auto producer = std::async(std::launch::async, [&bus] {
+            std::vector<std::shared_ptr<trade::types::RangedTick>> batch;
+
+            for (int64_t i = 1; i <= 10000; i++) {
+                batch.push_back(make_ranged_tick("600000.SH", i));
+
+                if (batch.size() == 100) {
+                    bus.ranged_ticks_generated(batch);
+                    batch.clear();
+                }
+            }
+        });
+
+        const bool is_produced = producer.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+
+        /// Checked before queued sinks are released.
+        const auto inline_ticks = inline_sink->ticks().size();
+
+        for (const auto& stalled_sink : stalled_sinks)
+            stalled_sink->release();
+
+        producer.wait();
+
+        CHECK(is_produced);
+        CHECK(inline_ticks == 10001);
+
+        for (const auto& name : {"csv", "archive", "mysql"})
+            CHECK(bus.stats(name)->dropped == 10000 - 8);
+    }
+
+    SECTION("Never drop order lifecycle events")
+    {
+        const auto slow_sink = std::make_shared<RecordingSink>(true);
+
+        trade::reporter::ReporterBus bus;
+        bus.add_sink(slow_sink, {.name = "slow", .capacity = 4, .overflow_policy = trade::reporter::OverflowPolicy::drop_oldest});
+
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 0));
+        slow_sink->wait_entered();
+
+        const auto make_trade = [](const int64_t unique_id) {
+            const auto trade = std::make_shared<trade::types::Trade>();
+            trade->set_symbol("trade");
+            trade->set_unique_id(unique_id);
+            return trade;
+        };
+
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 1));
+        bus.trade_accepted(make_trade(1));
+
+        for (int64_t i = 2; i <= 100; i++)
+            bus.ranged_tick_generated(make_ranged_tick("600000.SH", i));
+
+        /// Queued market data makes room for trades, then trades block.
+        for (int64_t i = 2; i <= 4; i++)
+            bus.trade_accepted(make_trade(i));
+
+        std::thread producer([&bus, &make_trade] { bus.trade_accepted(make_trade(5)); });
+
+        slow_sink->release();
+        producer.join();
+
+        while (bus.stats("slow")->delivered < 6)
+            std::this_thread::yield();
+
+        const auto ticks = slow_sink->ticks();
+
+        REQUIRE(ticks.size() == 6);
+
+        for (int64_t i = 1; i <= 5; i++)
+            CHECK(ticks[i] == std::make_pair(std::string("trade"), i));
+    }
+
+    SECTION("Conflate events of the same symbol")
+    {
+        const auto slow_sink = std::make_shared<RecordingSink>(true);
+
+        trade::reporter::ReporterBus bus;
+        bus.add_sink(slow_sink, {.name = "slow", .capacity = 10, .overflow_policy = trade::reporter::OverflowPolicy::conflate});
+
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 0));
+        slow_sink->wait_entered();
+
+        for (int64_t i = 1; i <= 100; i++) {
+            bus.ranged_tick_generated(make_ranged_tick("600000.SH", i));
+            bus.ranged_tick_generated(make_ranged_tick("000001.SZ", i));
+        }
+
+        /// Order ticks are never conflated.
+        const auto order_tick = std::make_shared<trade::types::OrderTick>();
+        order_tick->set_symbol("600000.SH");
+        order_tick->set_unique_id(1);
+        bus.exchange_order_tick_arrived(order_tick);
+        bus.exchange_order_tick_arrived(order_tick);
+
+        CHECK(bus.stats("slow")->conflated == 198);
+
+        slow_sink->release();
+
+        while (bus.stats("slow")->delivered < 5)
+            std::this_thread::yield();
+
+        const auto ticks = slow_sink->ticks();
+
+        REQUIRE(ticks.size() == 5);
+        CHECK(ticks[1] == std::make_pair(std::string("600000.SH"), int64_t(100)));
+        CHECK(ticks[2] == std::make_pair(std::string("000001.SZ"), int64_t(100)));
+        CHECK(ticks[3] == std::make_pair(std::string("600000.SH"), int64_t(1)));
+    }
+
+    SECTION("Conflated event takes the queued place")
+    {
+        const auto slow_sink = std::make_shared<RecordingSink>(true);
+
+        trade::reporter::ReporterBus bus;
+        bus.add_sink(slow_sink, {.name = "slow", .capacity = 10, .overflow_policy = trade::reporter::OverflowPolicy::conflate});
+
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 0));
+        slow_sink->wait_entered();
+
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 1));
+        bus.ranged_tick_generated(make_ranged_tick("000001.SZ", 2));
+        bus.ranged_tick_generated(make_ranged_tick("600000.SH", 3));
+
+        slow_sink->release();
+
+        while (bus.stats("slow")->delivered < 3)
+            std::this_thread::yield();
+
+        /// Delivered ahead of the tick of the other symbol arrived before it.
+        const auto ticks = slow_sink->ticks();
+
+        REQUIRE(ticks.size() == 3);
+        CHECK(ticks[1] == std::make_pair(std::string("600000.SH"), int64_t(3)));
+        CHECK(ticks[2] == std::make_pair(std::string("000001.SZ"), int64_t(2)));
+    }
+}
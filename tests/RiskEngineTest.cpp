@@ -0,0 +1,270 @@
+#include <catch.hpp>
+#include <chrono>
+#include <fmt/format.h>
+#include <vector>
+
+#include "libbroker/RiskEngine.hpp"
+
+namespace
+{
+
+trade::types::NewOrderReq make_order(const int64_t unique_id, const trade::types::SideType side, const double price, const int64_t quantity, const std::string& symbol = "600000")
+{
+    trade::types::NewOrderReq new_order_req;
+
+    new_order_req.set_unique_id(unique_id);
+    new_order_req.set_symbol(symbol);
+    new_order_req.set_exchange(trade::types::ExchangeType::sse);
+    new_order_req.set_side(side);
+    new_order_req.set_price(price);
+    new_order_req.set_quantity(quantity);
+
+    return new_order_req;
+}
+
+std::shared_ptr<trade::types::Trade> make_trade(const int64_t unique_id, const trade::types::SideType side, const double price, const int64_t quantity, const std::string& symbol = "600000")
+{
+    const auto trade = std::make_shared<trade::types::Trade>();
+
+    trade->set_unique_id(unique_id);
+    trade->set_symbol(symbol);
+    trade->set_side(side);
+    trade->set_price(price);
+    trade->set_quantity(quantity);
+
+    return trade;
+}
+
+std::shared_ptr<trade::types::CancelSuccess> make_cancel(const int64_t unique_id)
+{
+    const auto cancel_success = std::make_shared<trade::types::CancelSuccess>();
+    cancel_success->set_original_unique_id(unique_id);
+
+    return cancel_success;
+}
+
+} // namespace
+
+TEST_CASE("Pre-trade risk checks", "[RiskEngine]")
+{
+    using trade::types::RejectionCode;
+    using trade::types::SideType;
+
+    SECTION("Order limits")
+    {
+        trade::broker::RiskEngine risk_engine({.max_order_quantity = 1000, .max_order_value = 10000});
+
+        CHECK(risk_engine.check(make_order(1, SideType::buy, 10, 0)) == RejectionCode::invalid_quantity);
+        CHECK(risk_engine.check(make_order(2, SideType::buy, 10, 1001)) == RejectionCode::invalid_quantity);
+        CHECK(risk_engine.check(make_order(3, SideType::buy, 20, 1000)) == RejectionCode::order_value_exceeded);
+        CHECK(risk_engine.check(make_order(4, SideType::buy, 10, 1000)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(4, SideType::buy, 10, 100)) == RejectionCode::repeated_unique_id);
+    }
+
+    SECTION("Symbol position follows fills and cancels")
+    {
+        trade::broker::RiskEngine risk_engine({.max_symbol_position = 1000});
+
+        CHECK(risk_engine.check(make_order(1, SideType::buy, 10, 600)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(2, SideType::buy, 10, 500)) == RejectionCode::position_limit_exceeded);
+        CHECK(risk_engine.check(make_order(3, SideType::buy, 10, 400, "000001")) == RejectionCode::invalid_rejection_code);
+
+        risk_engine.trade_accepted(make_trade(1, SideType::buy, 10, 200));
+
+        CHECK(risk_engine.position("600000") == 200);
+        CHECK(risk_engine.working("600000", SideType::buy) == 400);
+
+        risk_engine.cancel_success(make_cancel(1));
+
+        CHECK(risk_engine.working("600000", SideType::buy) == 0);
+        CHECK(risk_engine.check(make_order(4, SideType::buy, 10, 800)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(5, SideType::buy, 10, 1)) == RejectionCode::position_limit_exceeded);
+    }
+
+    SECTION("Working value and released orders")
+    {
+        trade::broker::RiskEngine risk_engine({.max_working_value = 10000});
+
+        CHECK(risk_engine.check(make_order(1, SideType::buy, 10, 800)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(2, SideType::sell, 10, 300, "000001")) == RejectionCode::exposure_exceeded);
+
+        risk_engine.release(1);
+
+        CHECK(risk_engine.working_value() == 0);
+        CHECK(risk_engine.check(make_order(2, SideType::sell, 10, 300, "000001")) == RejectionCode::invalid_rejection_code);
+    }
+
+    SECTION("Available fund")
+    {
+        trade::broker::RiskEngine risk_engine({}, 10000);
+
+        CHECK(risk_engine.check(make_order(1, SideType::buy, 10, 800)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.available_fund() == 2000);
+        CHECK(risk_engine.check(make_order(2, SideType::buy, 10, 300, "000001")) == RejectionCode::fund_not_enough);
+        CHECK(risk_engine.available_fund() == 2000);
+
+        /// Filled below limit price, the difference is given back.
+        risk_engine.trade_accepted(make_trade(1, SideType::buy, 9, 800));
+
+        CHECK(risk_engine.available_fund() == 2800);
+
+        /// Fill of an order not checked here.
+        risk_engine.trade_accepted(make_trade(100, SideType::sell, 10, 100));
+
+        CHECK(risk_engine.available_fund() == 3800);
+        CHECK(risk_engine.position("600000") == 700);
+    }
+
+    SECTION("Self-trade guard")
+    {
+        trade::broker::RiskEngine risk_engine({});
+
+        CHECK(risk_engine.check(make_order(1, SideType::sell, 10, 100)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(2, SideType::buy, 10, 100)) == RejectionCode::self_trade);
+        CHECK(risk_engine.check(make_order(3, SideType::buy, 9.99, 100)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(4, SideType::sell, 9.99, 100)) == RejectionCode::self_trade);
+
+        risk_engine.order_rejected([] {
+            const auto order_rejection = std::make_shared<trade::types::OrderRejection>();
+            order_rejection->set_original_unique_id(1);
+            return order_rejection;
+        }());
+
+        CHECK(risk_engine.check(make_order(5, SideType::buy, 10.01, 100)) == RejectionCode::invalid_rejection_code);
+    }
+
+    SECTION("Orders dropped once filled or canceled")
+    {
+        trade::broker::RiskEngine risk_engine({.order_capacity = 2});
+
+        /// Far more orders than the table holds pass when not working at once.
+        for (int64_t i = 1; i <= 100; i += 2) {
+            CHECK(risk_engine.check(make_order(i, SideType::buy, 10, 100)) == RejectionCode::invalid_rejection_code);
+            CHECK(risk_engine.check(make_order(i + 1, SideType::buy, 10, 100, "000001")) == RejectionCode::invalid_rejection_code);
+
+            risk_engine.trade_accepted(make_trade(i, SideType::buy, 10, 40));
+            risk_engine.trade_accepted(make_trade(i, SideType::buy, 10, 60));
+            risk_engine.cancel_success(make_cancel(i + 1));
+        }
+
+        CHECK(risk_engine.position("600000") == 5000);
+        CHECK(risk_engine.working_value() == 0);
+
+        /// Fill after the order is dropped only moves position.
+        risk_engine.trade_accepted(make_trade(1, SideType::buy, 10, 100));
+
+        CHECK(risk_engine.position("600000") == 5100);
+        CHECK(risk_engine.working("600000", SideType::buy) == 0);
+    }
+
+    SECTION("Order rate")
+    {
+        trade::broker::RiskEngine risk_engine({.max_order_rate = 1, .max_order_burst = 2, .is_self_trade_guarded = false});
+
+        CHECK(risk_engine.check(make_order(1, SideType::buy, 10, 100)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(2, SideType::buy, 10, 100)) == RejectionCode::invalid_rejection_code);
+        CHECK(risk_engine.check(make_order(3, SideType::buy, 10, 100)) == RejectionCode::order_rate_exceeded);
+        CHECK(risk_engine.working("600000", SideType::buy) == 200);
+    }
+}
+
+TEST_CASE("Atomic table of risk engine", "[RiskEngine]")
+{
+    trade::broker::AtomicTable<std::pair<std::string, int64_t>> table(4);
+
+    const auto match = [](const std::string& name) {
+        return [name](const std::pair<std::string, int64_t>& value) { return value.first == name; };
+    };
+
+    const auto init = [](const std::string& name, const int64_t number) {
+        return [name, number](std::pair<std::string, int64_t>& value) { value = {name, number}; };
+    };
+
+    SECTION("Colliding keys told apart by value")
+    {
+        CHECK(table.emplace(1, init("a", 1), match("a")).second);
+        CHECK(table.emplace(1, init("b", 2), match("b")).second);
+        CHECK_FALSE(table.emplace(1, init("a", 3), match("a")).second);
+
+        REQUIRE(table.find(1, match("b")) != nullptr);
+        CHECK(table.find(1, match("b"))->second == 2);
+        CHECK(table.find(1, match("a"))->second == 1);
+        CHECK(table.find(1, match("c")) == nullptr);
+    }
+
+    SECTION("Erased slots reused")
+    {
+        for (uint64_t key = 1; key <= 100; key++) {
+            REQUIRE(table.emplace(key, init("", static_cast<int64_t>(key))).second);
+            CHECK(table.erase(key));
+            CHECK(table.find(key) == nullptr);
+        }
+
+        for (uint64_t key = 101; key <= 104; key++)
+            CHECK(table.emplace(key, init("", 0)).second);
+
+        CHECK(table.emplace(105, init("", 0)).first == nullptr);
+        CHECK_FALSE(table.erase(105));
+
+        for (uint64_t key = 101; key <= 104; key++)
+            CHECK(table.erase(key));
+
+        CHECK(table.emplace(105, init("", 0)).second);
+        CHECK(table.find(106) == nullptr);
+    }
+}
+
+TEST_CASE("Pre-trade risk checking benchmark", "[.][RiskEngine][benchmark]")
+{
+    constexpr int64_t orders  = 1000000;
+    constexpr int64_t symbols = 1000;
+
+    trade::broker::RiskEngine risk_engine(
+        {
+            .max_order_quantity  = 1000000,
+            .max_order_value     = 1e9,
+            .max_symbol_position = 1000000,
+            .max_working_value   = 1e12,
+            .max_order_rate      = 1000000000,
+            .max_order_burst     = orders,
+            .order_capacity      = orders,
+        },
+        1e12
+    );
+
+    std::vector<trade::types::NewOrderReq> new_order_reqs;
+    new_order_reqs.reserve(orders);
+
+    for (int64_t i = 0; i < orders; i++)
+        new_order_reqs.push_back(make_order(i + 1, i % 2 == 0 ? trade::types::SideType::buy : trade::types::SideType::sell, i % 2 == 0 ? 10 : 11, 100, fmt::format("{:06d}", i % symbols)));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    int64_t passed = 0;
+    for (const auto& new_order_req : new_order_reqs)
+        passed += risk_engine.check(new_order_req) == trade::types::RejectionCode::invalid_rejection_code;
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    CHECK(passed == orders);
+
+    const auto cancel_success = std::make_shared<trade::types::CancelSuccess>();
+    const auto release_start  = std::chrono::steady_clock::now();
+
+    for (int64_t i = 1; i <= orders; i++) {
+        cancel_success->set_original_unique_id(i);
+        risk_engine.cancel_success(cancel_success);
+    }
+
+    const auto release_elapsed = std::chrono::steady_clock::now() - release_start;
+
+    CHECK(risk_engine.working_value() == Approx(0).margin(1e-3));
+
+    WARN(fmt::format(
+        "{} orders on {} symbols: {:.1f} ns per check, {:.1f} ns per release",
+        orders,
+        symbols,
+        std::chrono::duration<double, std::nano>(elapsed).count() / orders,
+        std::chrono::duration<double, std::nano>(release_elapsed).count() / orders
+    ));
+}
@@ -1,365 +1,249 @@
 #include <catch.hpp>
+#include <chrono>
+#include <filesystem>
 
 #include "libholder/SQLiteHolder.h"
-#include "utilities/TimeHelper.hpp"
-
-constexpr size_t insertion_times = 16;
-constexpr size_t insertion_batch = 1024;
+#include "utilities/HolderSuite.hpp"
 
 /// A global holder for testing.
 auto holder = std::make_shared<trade::holder::SQLiteHolder>();
 
-/// All optional fields of odd rows will be null.
-
 TEST_CASE("SQLite model write and read test", "[SQLiteHolder]")
 {
-    SECTION("Symbols inserting")
-    {
-        int counter = 0;
+    HolderSuite::write_and_read(holder);
+}
 
-        for (int i = 0; i < insertion_times; i++) {
-            const auto symbols = std::make_shared<trade::types::Symbols>();
+namespace
+{
 
-            for (int j = 0; j < insertion_batch; j++) {
-                trade::types::Symbol symbol;
+std::shared_ptr<trade::types::Orders> make_order(const int64_t unique_id)
+{
+    const auto orders = std::make_shared<trade::types::Orders>();
+    const auto order  = orders->add_orders();
+
+    order->set_unique_id(unique_id);
+    order->set_broker_id(fmt::format("broker_id_{}", unique_id));
+    order->set_symbol("600000.SH");
+    order->set_side(trade::types::SideType::buy);
+    order->set_price(10.0);
+    order->set_quantity(100);
+    order->mutable_creation_time()->set_seconds(946684800);
+    order->mutable_update_time()->set_seconds(946684800);
+    order->mutable_update_time()->set_nanos(static_cast<int32_t>(unique_id % 1000000000));
+
+    return orders;
+}
 
-                symbol.set_symbol(fmt::format("symbol_{}", counter));
-                symbol.set_symbol_name(fmt::format("symbol_name_{}", counter));
-                symbol.set_exchange(j % 2 ? trade::types::ExchangeType::sse : trade::types::ExchangeType::szse);
-                if (j % 2 == 0)
-                    symbol.set_underlying(fmt::format("underlying_{}", counter));
+std::string temp_db_path(const std::string& name)
+{
+    const auto path = std::filesystem::temp_directory_path() / "trade_sqlite_holder_test" / name;
 
-                counter++;
+    std::filesystem::remove_all(path.parent_path());
 
-                symbols->add_symbols()->CopyFrom(symbol);
-            }
+    return path.string();
+}
 
-            CHECK(holder->update_symbols(symbols) == insertion_batch);
-        }
-    }
+} // namespace
 
-    SECTION("Symbols querying by symbol")
+TEST_CASE("SQLite batch and pragmas", "[SQLiteHolder]")
+{
+    SECTION("Commit batch")
     {
-        int counter = 0;
+        trade::holder::SQLiteHolder sqlite_holder;
 
-        for (int i = 0; i < insertion_times * insertion_batch; i++) {
-            const auto symbols = holder->query_symbols_by_symbol(fmt::format("symbol_{}", counter));
+        auto batch = sqlite_holder.batch();
 
-            REQUIRE(symbols->symbols_size() == 1);
+        sqlite_holder.update_orders(make_order(1));
+        sqlite_holder.update_orders(make_order(2));
 
-            CHECK(symbols->symbols(0).symbol() == fmt::format("symbol_{}", counter));
-            CHECK(symbols->symbols(0).symbol_name() == fmt::format("symbol_name_{}", counter));
-            CHECK(symbols->symbols(0).exchange() == (counter % 2 ? trade::types::ExchangeType::sse : trade::types::ExchangeType::szse));
-            if (counter % 2 == 0)
-                CHECK(symbols->symbols(0).underlying() == fmt::format("underlying_{}", counter));
-            else
-                CHECK(symbols->symbols(0).has_underlying() == false);
+        /// Visible inside the batch.
+        CHECK(sqlite_holder.query_orders_by_unique_id(1)->orders_size() == 1);
 
-            counter++;
-        }
+        CHECK(batch.commit());
+        CHECK(sqlite_holder.query_orders_by_broker_id("broker_id_2")->orders_size() == 1);
     }
 
-    SECTION("Symbols querying by exchange")
+    SECTION("Roll back batch not committed")
     {
-        const auto symbols_in_sse = holder->query_symbols_by_exchange(trade::types::ExchangeType::sse);
-
-        REQUIRE(symbols_in_sse->symbols_size() == insertion_times * insertion_batch / 2);
+        trade::holder::SQLiteHolder sqlite_holder;
 
-        for (const auto& symbol : symbols_in_sse->symbols()) {
-            CHECK(symbol.exchange() == trade::types::ExchangeType::sse);
+        {
+            const auto batch = sqlite_holder.batch();
+            sqlite_holder.update_orders(make_order(1));
         }
 
-        const auto symbols_in_szse = holder->query_symbols_by_exchange(trade::types::ExchangeType::szse);
+        CHECK(sqlite_holder.query_orders_by_unique_id(1)->orders_size() == 0);
 
-        REQUIRE(symbols_in_szse->symbols_size() == insertion_times * insertion_batch / 2);
+        sqlite_holder.update_orders(make_order(1));
 
-        for (const auto& symbol : symbols_in_szse->symbols()) {
-            CHECK(symbol.exchange() == trade::types::ExchangeType::szse);
-        }
+        CHECK(sqlite_holder.query_orders_by_unique_id(1)->orders_size() == 1);
     }
 
-    SECTION("Funds inserting")
+    SECTION("Roll back batch with failed statement")
     {
-        int counter = 0;
+        trade::holder::SQLiteHolder sqlite_holder;
 
-        for (int i = 0; i < insertion_times; i++) {
-            const auto funds = std::make_shared<trade::types::Funds>();
+        const auto invalid = make_order(2);
+        invalid->mutable_orders(0)->set_side(trade::types::SideType::invalid_side);
 
-            for (int j = 0; j < insertion_batch; j++) {
-                trade::types::Fund fund;
+        auto batch = sqlite_holder.batch();
 
-                fund.set_account_id(fmt::format("account_id_{}", counter));
-                fund.set_available_fund(counter);
-                fund.set_withdrawn_fund(counter);
-                fund.set_frozen_fund(counter);
-                fund.set_frozen_margin(counter);
-                fund.set_frozen_commission(counter);
-#ifdef LIB_DATE_SUPPORT
-                fund.set_allocated_update_time(trade::utilities::ToTime<google::protobuf::Timestamp*>()(fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100)));
-#endif
+        sqlite_holder.update_orders(make_order(1));
+        sqlite_holder.update_orders(invalid);
+        sqlite_holder.update_orders(make_order(3));
 
-                counter++;
+        CHECK_FALSE(batch.commit());
+        CHECK(sqlite_holder.query_orders_by_unique_id(1)->orders_size() == 0);
+        CHECK(sqlite_holder.query_orders_by_unique_id(3)->orders_size() == 0);
 
-                funds->add_funds()->CopyFrom(fund);
-            }
+        /// Next batch is not affected.
+        auto next_batch = sqlite_holder.batch();
+        sqlite_holder.update_orders(make_order(1));
 
-            CHECK(holder->update_funds(funds) == insertion_batch);
-        }
+        CHECK(next_batch.commit());
+        CHECK(sqlite_holder.query_orders_by_unique_id(1)->orders_size() == 1);
     }
 
-    SECTION("Funds querying")
+    SECTION("Roll back update with failed statement")
     {
-        int counter = 0;
-
-        for (int i = 0; i < insertion_times * insertion_batch; i++) {
-            const auto funds = holder->query_funds_by_account_id(fmt::format("account_id_{}", counter));
+        trade::holder::SQLiteHolder sqlite_holder;
 
-            REQUIRE(funds->funds_size() == 1);
+        const auto orders = make_order(1);
+        orders->add_orders()->CopyFrom(make_order(2)->orders(0));
+        orders->mutable_orders(1)->set_side(trade::types::SideType::invalid_side);
 
-            CHECK(funds->funds(0).account_id() == fmt::format("account_id_{}", counter));
-            CHECK(funds->funds(0).available_fund() == counter);
-            CHECK(funds->funds(0).frozen_fund() == counter);
-            CHECK(funds->funds(0).frozen_margin() == counter);
-            CHECK(funds->funds(0).frozen_commission() == counter);
-            CHECK(funds->funds(0).withdrawn_fund() == counter);
-#ifdef LIB_DATE_SUPPORT
-            CHECK(trade::utilities::ToTime<std::string>()(funds->funds(0).update_time()) == fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100));
-#endif
+        sqlite_holder.update_orders(orders);
 
-            counter++;
-        }
+        CHECK(sqlite_holder.query_orders_by_unique_id(1)->orders_size() == 0);
     }
 
-    SECTION("Position inserting")
+    SECTION("Refuse nested batch")
     {
-        int counter = 0;
-
-        for (int i = 0; i < insertion_times; i++) {
-            const auto positions = std::make_shared<trade::types::Positions>();
-
-            for (int j = 0; j < insertion_batch; j++) {
-                trade::types::Position position;
-
-                position.set_symbol(fmt::format("symbol_{}", counter));
-                position.set_yesterday_position(counter);
-                position.set_today_position(counter);
-                if (counter % 2 == 0) {
-                    position.set_open_volume(counter);
-                    position.set_close_volume(counter);
-                    position.set_position_cost(counter);
-                    position.set_pre_margin(counter);
-                    position.set_used_margin(counter);
-                    position.set_frozen_margin(counter);
-                    position.set_open_cost(counter);
-                }
-#ifdef LIB_DATE_SUPPORT
-                position.set_allocated_update_time(trade::utilities::ToTime<google::protobuf::Timestamp*>()(fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100)));
-#endif
-
-                counter++;
-
-                positions->add_positions()->CopyFrom(position);
-            }
+        trade::holder::SQLiteHolder sqlite_holder;
 
-            CHECK(holder->update_positions(positions) == insertion_batch);
-        }
+        const auto batch = sqlite_holder.batch();
+
+        CHECK_THROWS_AS(sqlite_holder.batch(), std::runtime_error);
     }
 
-    SECTION("Position querying")
+    SECTION("Keep timestamps in nanoseconds")
     {
-        int counter = 0;
-
-        for (int i = 0; i < insertion_times * insertion_batch; i++) {
-            const auto positions = holder->query_positions_by_symbol(fmt::format("symbol_{}", counter));
-
-            REQUIRE(positions->positions_size() == 1);
-
-            CHECK(positions->positions(0).symbol() == fmt::format("symbol_{}", counter));
-            CHECK(positions->positions(0).yesterday_position() == counter);
-            CHECK(positions->positions(0).today_position() == counter);
-            if (counter % 2 == 0) {
-                CHECK(positions->positions(0).open_volume() == counter);
-                CHECK(positions->positions(0).close_volume() == counter);
-                CHECK(positions->positions(0).position_cost() == counter);
-                CHECK(positions->positions(0).pre_margin() == counter);
-                CHECK(positions->positions(0).used_margin() == counter);
-                CHECK(positions->positions(0).frozen_margin() == counter);
-                CHECK(positions->positions(0).open_cost() == counter);
-            }
-            else {
-                CHECK(positions->positions(0).has_open_volume() == false);
-                CHECK(positions->positions(0).has_close_volume() == false);
-                CHECK(positions->positions(0).has_position_cost() == false);
-                CHECK(positions->positions(0).has_pre_margin() == false);
-                CHECK(positions->positions(0).has_used_margin() == false);
-                CHECK(positions->positions(0).has_frozen_margin() == false);
-                CHECK(positions->positions(0).has_open_cost() == false);
-            }
-#ifdef LIB_DATE_SUPPORT
-            CHECK(trade::utilities::ToTime<std::string>()(positions->positions(0).update_time()) == fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100));
-#endif
+        trade::holder::SQLiteHolder sqlite_holder;
 
-            counter++;
-        }
+        sqlite_holder.update_orders(make_order(123456789));
+
+        const auto orders = sqlite_holder.query_orders_by_unique_id(123456789);
+
+        REQUIRE(orders->orders_size() == 1);
+        CHECK(orders->orders(0).update_time().seconds() == 946684800);
+        CHECK(orders->orders(0).update_time().nanos() == 123456789);
     }
 
-    SECTION("Order inserting")
+    SECTION("Reopen file-backed database in WAL mode")
     {
-        /// An order with unique_id == INVALID_ID will be ignored, so we start from
-        /// INVALID_ID + 1.
-        int counter = INVALID_ID + 1;
-
-        for (int i = 0; i < insertion_times; i++) {
-            const auto orders = std::make_shared<trade::types::Orders>();
-
-            for (int j = 0; j < insertion_batch; j++) {
-                trade::types::Order order;
-
-                order.set_unique_id(counter);
-                if (counter % 2 == 0) {
-                    order.set_broker_id(fmt::format("broker_id_{}", counter));
-                    order.set_exchange_id(fmt::format("exchange_id_{}", counter));
-                }
-                order.set_symbol(fmt::format("symbol_{}", counter));
-                order.set_side(trade::types::SideType::buy);
-                if (counter % 2 == 0)
-                    order.set_position_side(trade::types::PositionSideType::open);
-                order.set_price(counter);
-                order.set_quantity(counter);
-#ifdef LIB_DATE_SUPPORT
-                order.set_allocated_creation_time(trade::utilities::ToTime<google::protobuf::Timestamp*>()("2000-01-01 08:00:00.000"));
-                order.set_allocated_update_time(trade::utilities::ToTime<google::protobuf::Timestamp*>()(fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100)));
-#endif
-
-                counter++;
-
-                orders->add_orders()->CopyFrom(order);
-            }
+        const auto db_path = temp_db_path("wal.db");
 
-            CHECK(holder->update_orders(orders) == insertion_batch);
+        {
+            trade::holder::SQLiteHolder sqlite_holder(db_path, "wal", "normal");
+            sqlite_holder.update_orders(make_order(1));
         }
+
+        trade::holder::SQLiteHolder sqlite_holder(db_path, "WAL", "NORMAL");
+
+        CHECK(sqlite_holder.query_orders_by_unique_id(1)->orders_size() == 1);
     }
 
-    SECTION("Order querying by unique id")
+    SECTION("Migrate schema version 0")
     {
-        /// An order with unique_id == INVALID_ID will be ignored, so we start from
-        /// INVALID_ID + 1.
-        int counter = INVALID_ID + 1;
+        const auto db_path = temp_db_path("v0.db");
+
+        {
+            std::filesystem::create_directories(std::filesystem::path(db_path).parent_path());
+
+            sqlite3* raw_db;
+            sqlite3_open(db_path.c_str(), &raw_db);
+            const trade::holder::SQLite3Ptr db(raw_db);
+
+            /// Tables and rows as written by version 0.
+            REQUIRE(sqlite3_exec(
+                        db.get(),
+                        "CREATE TABLE funds (account_id TEXT NOT NULL PRIMARY KEY, available_fund REAL, withdrawn_fund REAL, frozen_fund REAL,"
+                        "frozen_margin REAL, frozen_commission REAL, update_time DATETIME);"
+                        "CREATE TABLE orders (unique_id INTEGER NOT NULL PRIMARY KEY, broker_id TEXT, exchange_id TEXT UNIQUE, symbol TEXT NOT NULL,"
+                        "side TEXT CHECK(side in ('buy', 'sell')) NOT NULL, position_side TEXT CHECK(position_side in ('open', 'close')),"
+                        "price REAL NOT NULL, quantity INTEGER NOT NULL, creation_time DATETIME NOT NULL, update_time DATETIME NOT NULL);"
+                        "INSERT INTO funds VALUES ('account', 1.0, 0.0, 0.0, 0.0, 0.0, '2000-01-01 08:00:01.000');"
+                        "INSERT INTO orders VALUES (1, 'broker_id_1', NULL, '600000.SH', 'buy', NULL, 10.0, 100, '2000-01-01 08:00:00.000', '2000-01-01 09:30:00.123');",
+                        nullptr,
+                        nullptr,
+                        nullptr
+                    ) == SQLITE_OK);
+        }
 
-        for (int i = 0; i < insertion_times * insertion_batch; i++) {
-            const auto orders = holder->query_orders_by_unique_id(counter);
+        trade::holder::SQLiteHolder sqlite_holder(db_path);
 
-            REQUIRE(orders->orders_size() == 1);
+        const auto orders = sqlite_holder.query_orders_by_unique_id(1);
 
-            CHECK(orders->orders(0).unique_id() == counter);
-            if (counter % 2 == 0) {
-                CHECK(orders->orders(0).broker_id() == fmt::format("broker_id_{}", counter));
-                CHECK(orders->orders(0).exchange_id() == fmt::format("exchange_id_{}", counter));
-            }
-            else {
-                CHECK(orders->orders(0).has_broker_id() == false);
-                CHECK(orders->orders(0).has_exchange_id() == false);
-            }
-            CHECK(orders->orders(0).symbol() == fmt::format("symbol_{}", counter));
-            CHECK(orders->orders(0).side() == trade::types::SideType::buy);
-            if (counter % 2 == 0)
-                CHECK(orders->orders(0).position_side() == trade::types::PositionSideType::open);
-            else
-                CHECK(orders->orders(0).has_position_side() == false);
-            CHECK(orders->orders(0).price() == counter);
-            CHECK(orders->orders(0).quantity() == counter);
-#ifdef LIB_DATE_SUPPORT
-            CHECK(trade::utilities::ToTime<std::string>()(orders->orders(0).creation_time()) == "2000-01-01 08:00:00.000");
-            CHECK(trade::utilities::ToTime<std::string>()(orders->orders(0).update_time()) == fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100));
-#endif
-
-            counter++;
-        }
+        REQUIRE(orders->orders_size() == 1);
+        CHECK(orders->orders(0).creation_time().seconds() == 946684800);
+        CHECK(orders->orders(0).update_time().seconds() == 946684800 + 5400);
+        CHECK(orders->orders(0).update_time().nanos() == 123000000);
+        CHECK(sqlite_holder.query_funds_by_account_id("account")->funds(0).update_time().seconds() == 946684801);
+
+        /// Migrated once.
+        CHECK(trade::holder::SQLiteHolder(db_path).query_orders_by_unique_id(1)->orders(0).update_time().nanos() == 123000000);
     }
 
-    SECTION("Order querying by broker id")
+    SECTION("Refuse invalid pragma")
     {
-        /// An order with unique_id == INVALID_ID will be ignored, so we start from
-        /// INVALID_ID + 1.
-        int counter = INVALID_ID + 1;
+        CHECK_THROWS_AS(trade::holder::SQLiteHolder(":memory:", "fast"), std::runtime_error);
+        CHECK_THROWS_AS(trade::holder::SQLiteHolder(":memory:", "WAL", "fast"), std::runtime_error);
+    }
 
-        for (int i = 0; i < insertion_times * insertion_batch; i++) {
-            const auto orders = holder->query_orders_by_broker_id(fmt::format("broker_id_{}", counter));
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "trade_sqlite_holder_test");
+}
 
-            if (counter % 2 == 0) {
-                REQUIRE(orders->orders_size() == 1);
-            }
-            else {
-                REQUIRE(orders->orders_size() == 0);
+TEST_CASE("SQLite order updating benchmark", "[.][SQLiteHolder][benchmark]")
+{
+    constexpr int64_t orders = 500;
+    constexpr int64_t batch  = 100;
+
+    const auto measure = [](const std::string& journal_mode, const std::string& synchronous, const int64_t batch_size) {
+        trade::holder::SQLiteHolder sqlite_holder(temp_db_path(fmt::format("{}_{}_{}.db", journal_mode, synchronous, batch_size)), journal_mode, synchronous);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int64_t i = 1; i <= orders; i += batch_size) {
+            /// Each update commits on its own without batch.
+            if (batch_size == 1) {
+                sqlite_holder.update_orders(make_order(i));
                 continue;
             }
 
-            CHECK(orders->orders(0).unique_id() == counter);
-            if (counter % 2 == 0) {
-                CHECK(orders->orders(0).broker_id() == fmt::format("broker_id_{}", counter));
-                CHECK(orders->orders(0).exchange_id() == fmt::format("exchange_id_{}", counter));
-            }
-            else {
-                CHECK(orders->orders(0).has_broker_id() == false);
-                CHECK(orders->orders(0).has_exchange_id() == false);
-            }
-            CHECK(orders->orders(0).symbol() == fmt::format("symbol_{}", counter));
-            CHECK(orders->orders(0).side() == trade::types::SideType::buy);
-            if (counter % 2 == 0)
-                CHECK(orders->orders(0).position_side() == trade::types::PositionSideType::open);
-            else
-                CHECK(orders->orders(0).has_position_side() == false);
-            CHECK(orders->orders(0).price() == counter);
-            CHECK(orders->orders(0).quantity() == counter);
-#ifdef LIB_DATE_SUPPORT
-            CHECK(trade::utilities::ToTime<std::string>()(orders->orders(0).creation_time()) == "2000-01-01 08:00:00.000");
-            CHECK(trade::utilities::ToTime<std::string>()(orders->orders(0).update_time()) == fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100));
-#endif
-
-            counter++;
+            auto sqlite_batch = sqlite_holder.batch();
+
+            for (int64_t j = i; j < i + batch_size; j++)
+                sqlite_holder.update_orders(make_order(j));
+
+            sqlite_batch.commit();
         }
-    }
 
-    SECTION("Order querying by exchange id")
-    {
-        /// An order with unique_id == INVALID_ID will be ignored, so we start from
-        /// INVALID_ID + 1.
-        int counter = INVALID_ID + 1;
+        const auto update_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / orders;
 
-        for (int i = 0; i < insertion_times * insertion_batch; i++) {
-            const auto orders = holder->query_orders_by_exchange_id(fmt::format("exchange_id_{}", counter));
+        const auto query_start = std::chrono::steady_clock::now();
 
-            if (counter % 2 == 0) {
-                REQUIRE(orders->orders_size() == 1);
-            }
-            else {
-                REQUIRE(orders->orders_size() == 0);
-                continue;
-            }
+        for (int64_t i = 1; i <= orders; i++)
+            CHECK(sqlite_holder.query_orders_by_broker_id(fmt::format("broker_id_{}", i))->orders_size() == 1);
 
-            CHECK(orders->orders(0).unique_id() == counter);
-            if (counter % 2 == 0) {
-                CHECK(orders->orders(0).broker_id() == fmt::format("broker_id_{}", counter));
-                CHECK(orders->orders(0).exchange_id() == fmt::format("exchange_id_{}", counter));
-            }
-            else {
-                CHECK(orders->orders(0).has_broker_id() == false);
-                CHECK(orders->orders(0).has_exchange_id() == false);
-            }
-            CHECK(orders->orders(0).symbol() == fmt::format("symbol_{}", counter));
-            CHECK(orders->orders(0).side() == trade::types::SideType::buy);
-            if (counter % 2 == 0)
-                CHECK(orders->orders(0).position_side() == trade::types::PositionSideType::open);
-            else
-                CHECK(orders->orders(0).has_position_side() == false);
-            CHECK(orders->orders(0).price() == counter);
-            CHECK(orders->orders(0).quantity() == counter);
-#ifdef LIB_DATE_SUPPORT
-            CHECK(trade::utilities::ToTime<std::string>()(orders->orders(0).creation_time()) == "2000-01-01 08:00:00.000");
-            CHECK(trade::utilities::ToTime<std::string>()(orders->orders(0).update_time()) == fmt::format("2000-01-01 08:00:00.{:0>3}", counter % 100));
-#endif
-
-            counter++;
-        }
-    }
+        const auto query_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - query_start).count() / orders;
+
+        WARN(fmt::format("{} / {} / batch of {}: {:.2f} us/update, {:.2f} us/query", journal_mode, synchronous, batch_size, update_us, query_us));
+    };
+
+    /// SQLite defaults, which the holder used before journal and synchronous were configurable.
+    measure("DELETE", "FULL", 1);
+    measure("WAL", "NORMAL", 1);
+    measure("WAL", "NORMAL", batch);
+
+    std::filesystem::remove_all(std::filesystem::temp_directory_path() / "trade_sqlite_holder_test");
 }
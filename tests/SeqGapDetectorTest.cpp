@@ -0,0 +1,99 @@
+#include <catch.hpp>
+
+#include "utilities/SeqGapDetector.hpp"
+
+TEST_CASE("SeqGapDetector", "[SeqGapDetector]")
+{
+    using Result = trade::utilities::SeqGapResult;
+
+    uint64_t missing;
+
+    SECTION("Check without missing")
+    {
+        trade::utilities::SeqGapDetector<> detector;
+
+        for (uint64_t i = 1; i < 100000; i++) {
+            CHECK(detector.check(i, missing) == Result::in_order);
+            CHECK(missing == 0);
+        }
+
+        CHECK(detector.gaps() == 0);
+        CHECK(detector.duplicates() == 0);
+        CHECK(detector.reorders() == 0);
+    }
+
+    SECTION("Check with gap, duplicate and reorder")
+    {
+        trade::utilities::SeqGapDetector<> detector;
+
+        CHECK(detector.check(1, missing) == Result::in_order);
+        CHECK(detector.check(2, missing) == Result::in_order);
+        CHECK(detector.check(5, missing) == Result::gap);
+        CHECK(missing == 2);
+        CHECK(detector.check(5, missing) == Result::duplicate);
+        CHECK(detector.check(3, missing) == Result::reorder);
+        CHECK(detector.check(3, missing) == Result::duplicate);
+        CHECK(detector.check(6, missing) == Result::in_order);
+
+        CHECK(detector.gaps() == 2);
+        CHECK(detector.duplicates() == 2);
+        CHECK(detector.reorders() == 1);
+        CHECK(detector.missing() == 1);
+    }
+
+    SECTION("Check out of window")
+    {
+        trade::utilities::SeqGapDetector<64> detector;
+
+        CHECK(detector.check(1, missing) == Result::in_order);
+        CHECK(detector.check(1000, missing) == Result::gap);
+        CHECK(missing == 998);
+        CHECK(detector.check(2, missing) == Result::stale);
+        CHECK(detector.check(999, missing) == Result::reorder);
+        CHECK(detector.check(1000, missing) == Result::duplicate);
+
+        /// Bits reused by window are cleared.
+        CHECK(detector.check(1001, missing) == Result::in_order);
+        CHECK(detector.check(1064, missing) == Result::gap);
+        CHECK(detector.check(1002, missing) == Result::reorder);
+    }
+
+    SECTION("Reorder before first sequence")
+    {
+        trade::utilities::SeqGapDetector<> detector;
+
+        CHECK(detector.check(100, missing) == Result::in_order);
+        CHECK(detector.check(50, missing) == Result::reorder);
+
+        CHECK(detector.reorders() == 1);
+        CHECK(detector.missing() == 0);
+
+        CHECK(detector.check(103, missing) == Result::gap);
+        CHECK(detector.check(101, missing) == Result::reorder);
+        CHECK(detector.missing() == 1);
+    }
+
+    SECTION("Re-baseline on feed reset")
+    {
+        trade::utilities::SeqGapDetector<64> detector(1000);
+
+        for (uint64_t i = 5000; i < 5100; i++)
+            CHECK(detector.check(i, missing) == Result::in_order);
+
+        /// Not far enough to be a reset.
+        CHECK(detector.check(4500, missing) == Result::stale);
+
+        CHECK(detector.check(1, missing) == Result::reset);
+        CHECK(detector.highest() == 1);
+
+        CHECK(detector.check(2, missing) == Result::in_order);
+        CHECK(detector.check(4, missing) == Result::gap);
+        CHECK(missing == 1);
+        CHECK(detector.check(3, missing) == Result::reorder);
+        CHECK(detector.check(2, missing) == Result::duplicate);
+
+        CHECK(detector.resets() == 1);
+        CHECK(detector.stales() == 1);
+        CHECK(detector.missing() == 0);
+    }
+}
@@ -0,0 +1,176 @@
+#include <catch.hpp>
+#include <fmt/format.h>
+#include <set>
+#include <thread>
+
+#include "libreporter/ShmLastValueCache.h"
+#include "utilities/MakeAssignable.hpp"
+
+namespace
+{
+
+trade::reporter::GeneratedL2Tick make_record(const std::string& symbol, const int64_t price_1000x)
+{
+    trade::reporter::GeneratedL2Tick record;
+    M_A {record.symbol}  = symbol;
+    record.price_1000x   = price_1000x;
+    record.quantity      = price_1000x;
+    record.exchange_time = price_1000x;
+    return record;
+}
+
+} // namespace
+
+TEST_CASE("Last value cache in shared memory", "[ShmLastValueCache]")
+{
+    const std::string shm_name = "trade_lvc_for_unit_test";
+
+    SECTION("Latest value per symbol")
+    {
+        trade::reporter::ShmLastValueCache cache(shm_name, 4);
+        const trade::reporter::ShmLastValueCacheReader reader(shm_name);
+
+        CHECK(reader.slot("600000.SH") == -1);
+
+        CHECK(cache.update(make_record("600000.SH", 1000)));
+        CHECK(cache.update(make_record("000001.SZ", 2000)));
+        CHECK(cache.update(make_record("600000.SH", 3000)));
+
+        CHECK(reader.slot_count() == 2);
+        REQUIRE(reader.slot("600000.SH") == 0);
+        REQUIRE(reader.slot("000001.SZ") == 1);
+
+        trade::reporter::GeneratedL2Tick generated_l2_tick;
+        REQUIRE(reader.read(0, generated_l2_tick));
+        CHECK(std::string(generated_l2_tick.symbol) == "600000.SH");
+        CHECK(generated_l2_tick.price_1000x == 3000);
+
+        /// Other values of the symbol are not written yet.
+        trade::reporter::ExchangeL2Snap exchange_l2_snap;
+        CHECK_FALSE(reader.read(0, exchange_l2_snap));
+
+        trade::reporter::RangedTick ranged_tick;
+        M_A {ranged_tick.symbol}        = "000001.SZ";
+        ranged_tick.highest_price_1000x = 4000;
+        CHECK(cache.update(ranged_tick));
+
+        trade::reporter::RangedTick read_ranged_tick;
+        REQUIRE(reader.read(1, read_ranged_tick));
+        CHECK(read_ranged_tick.highest_price_1000x == 4000);
+    }
+
+    SECTION("Reject new symbols when full")
+    {
+        trade::reporter::ShmLastValueCache cache(shm_name, 2);
+        const trade::reporter::ShmLastValueCacheReader reader(shm_name);
+
+        CHECK(cache.update(make_record("600000.SH", 1)));
+        CHECK(cache.update(make_record("600001.SH", 1)));
+        CHECK_FALSE(cache.update(make_record("600002.SH", 1)));
+        CHECK(cache.update(make_record("600001.SH", 2)));
+
+        CHECK(reader.slot_count() == 2);
+        CHECK(reader.slot("600002.SH") == -1);
+    }
+
+    SECTION("Never read torn values")
+    {
+        trade::reporter::ShmLastValueCache cache(shm_name, 1);
+        const trade::reporter::ShmLastValueCacheReader reader(shm_name);
+
+        cache.update(make_record("600000.SH", 0));
+
+        std::atomic<bool> is_running = true;
+        std::thread writer([&cache, &is_running] {
+            for (int64_t i = 1; i <= 1000000; i++)
+                cache.update(make_record("600000.SH", i));
+
+            is_running = false;
+        });
+
+        size_t torn = 0;
+        trade::reporter::GeneratedL2Tick generated_l2_tick;
+
+        while (is_running) {
+            reader.read(0, generated_l2_tick);
+
+            if (generated_l2_tick.price_1000x != generated_l2_tick.quantity || generated_l2_tick.price_1000x != generated_l2_tick.exchange_time)
+                torn++;
+        }
+
+        writer.join();
+
+        CHECK(torn == 0);
+        REQUIRE(reader.read(0, generated_l2_tick));
+        CHECK(generated_l2_tick.price_1000x == 1000000);
+    }
+
+    SECTION("Kept by ShmReporter")
+    {
+        const auto reporter = std::make_shared<trade::reporter::ShmReporter>(
+            "trade_data_for_lvc_test",
+            "trade_data_mutex_for_lvc_test",
+            1,
+            std::make_shared<trade::reporter::NopReporter>(),
+            std::array<size_t, 4> {1, 1, 1, 1},
+            trade::reporter::ShmPrefault::none,
+            trade::reporter::ShmHugePage::none,
+            "",
+            16
+        );
+
+        const auto ranged_tick = std::make_shared<trade::types::RangedTick>();
+        ranged_tick->set_symbol("600875.SH");
+        ranged_tick->set_active_buy_quantity(100);
+        reporter->ranged_tick_generated(ranged_tick);
+
+        const trade::reporter::ShmLastValueCacheReader reader("trade_data_for_lvc_test_lvc");
+
+        trade::reporter::RangedTick record;
+        REQUIRE(reader.slot("600875.SH") == 0);
+        REQUIRE(reader.read(0, record));
+        CHECK(record.shm_union_type == trade::reporter::ShmUnionType::ranged_tick);
+        CHECK(record.active_buy_quantity == 100);
+
+        /// New symbols from booker threads calling the inline reporter.
+        std::vector<std::thread> bookers;
+
+        for (int i = 0; i < 3; i++) {
+            bookers.emplace_back([&reporter, i] {
+                for (int j = 0; j < 1000; j++) {
+                    const auto ranged_tick = std::make_shared<trade::types::RangedTick>();
+                    ranged_tick->set_symbol(fmt::format("60000{}.SH", (i * 5 + j) % 15));
+                    reporter->ranged_tick_generated(ranged_tick);
+                }
+            });
+        }
+
+        for (auto& booker : bookers)
+            booker.join();
+
+        CHECK(reader.slot_count() == 16);
+
+        std::set<int32_t> slots;
+
+        for (int i = 0; i < 15; i++)
+            slots.insert(reader.slot(fmt::format("60000{}.SH", i)));
+
+        CHECK(slots.size() == 15);
+        CHECK_FALSE(slots.contains(-1));
+
+        boost::interprocess::shared_memory_object::remove("trade_data_for_lvc_test");
+        boost::interprocess::shared_memory_object::remove("trade_data_for_lvc_test_lvc");
+    }
+
+    SECTION("Refuse segment of other kind")
+    {
+        boost::interprocess::shared_memory_object shm(boost::interprocess::open_or_create, "trade_not_lvc_for_unit_test", boost::interprocess::read_write);
+        shm.truncate(4096);
+
+        CHECK_THROWS_AS(trade::reporter::ShmLastValueCacheReader("trade_not_lvc_for_unit_test"), std::runtime_error);
+
+        boost::interprocess::shared_memory_object::remove("trade_not_lvc_for_unit_test");
+    }
+
+    boost::interprocess::shared_memory_object::remove(shm_name.c_str());
+}
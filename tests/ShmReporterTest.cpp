@@ -311,3 +311,217 @@ TEST_CASE("Shm writing and reading", "[ShmReporter]")
     boost::interprocess::shared_memory_object::remove(shm_name.c_str());
     boost::interprocess::named_upgradable_mutex::remove(shm_mutex_name.c_str());
 }
+
+TEST_CASE("Shm region layout", "[ShmReporter]")
+{
+    const std::string shm_name       = "trade_data_for_layout_test";
+    const std::string shm_mutex_name = "trade_data_mutex_for_layout_test";
+
+    const auto prefault = GENERATE(trade::reporter::ShmPrefault::none, trade::reporter::ShmPrefault::background, trade::reporter::ShmPrefault::eager);
+
+    SECTION("Walk regions of different sizes")
+    {
+        const auto reporter = std::make_shared<trade::reporter::ShmReporter>(
+            shm_name,
+            shm_mutex_name,
+            1,
+            std::make_shared<trade::reporter::NopReporter>(),
+            std::array<size_t, 4> {4, 8, 2, 2},
+            prefault
+        );
+
+        const auto trade_tick = std::make_shared<trade::types::TradeTick>();
+        trade_tick->set_symbol("600875.SH");
+        trade_tick->set_exec_price_1000x(1111);
+        reporter->exchange_trade_tick_arrived(trade_tick);
+
+        boost::interprocess::shared_memory_object shm_reader(boost::interprocess::open_only, shm_name.c_str(), boost::interprocess::read_only);
+        const boost::interprocess::mapped_region segment(shm_reader, boost::interprocess::read_only);
+
+        CHECK(segment.get_size() == 16 * 1024 * 1024);
+
+        /// Locate trade tick region by size of order tick region.
+        const auto order_tick_mate_info = static_cast<const trade::reporter::SMTickMateInfo*>(segment.get_address());
+        CHECK(order_tick_mate_info->region_size == 4 * 1024 * 1024);
+        CHECK(order_tick_mate_info->tick_count == 0);
+
+        const auto trade_tick_mate_info = reinterpret_cast<const trade::reporter::SMTickMateInfo*>(static_cast<const u_char*>(segment.get_address()) + order_tick_mate_info->region_size);
+        CHECK(trade_tick_mate_info->region_size == 8 * 1024 * 1024);
+        REQUIRE(trade_tick_mate_info->tick_count == 1);
+
+        const auto md_current = reinterpret_cast<const trade::reporter::TradeTick*>(trade_tick_mate_info + 1);
+        CHECK(std::string(md_current[0].symbol) == "600875.SH");
+        CHECK(md_current[0].exec_price_1000x == 1111);
+    }
+
+    boost::interprocess::shared_memory_object::remove(shm_name.c_str());
+}
+
+TEST_CASE("Shm compact layout", "[ShmReporter]")
+{
+    const std::string shm_name       = "trade_data_for_compact_test";
+    const std::string shm_mutex_name = "trade_data_mutex_for_compact_test";
+
+    SECTION("Read records through segment header")
+    {
+        const auto reporter = std::make_shared<trade::reporter::ShmReporter>(
+            shm_name,
+            shm_mutex_name,
+            1,
+            std::make_shared<trade::reporter::NopReporter>(),
+            std::array<size_t, 4> {1, 1, 1, 1},
+            trade::reporter::ShmPrefault::none,
+            trade::reporter::ShmHugePage::none,
+            "",
+            0,
+            trade::reporter::ShmLayout::compact
+        );
+
+        const auto order_tick = std::make_shared<trade::types::OrderTick>();
+        order_tick->set_unique_id(10000);
+        order_tick->set_order_type(trade::types::OrderType::limit);
+        order_tick->set_symbol("600875.SH");
+        order_tick->set_side(trade::types::SideType::sell);
+        order_tick->set_price_1000x(1111);
+        order_tick->set_quantity(100);
+        order_tick->set_exchange_time(20240102093000120);
+        reporter->exchange_order_tick_arrived(order_tick);
+
+        const auto l2_tick = std::make_shared<trade::types::GeneratedL2Tick>();
+        l2_tick->set_symbol("600875.SH");
+        for (int i = 1; i < 6; i++) {
+            const auto ask_levels = l2_tick->add_ask_levels();
+            ask_levels->set_price_1000x(i * 1111);
+            ask_levels->set_quantity(i * 1000);
+
+            const auto bid_levels = l2_tick->add_bid_levels();
+            bid_levels->set_price_1000x(i * 111);
+            bid_levels->set_quantity(i * 100);
+        }
+        reporter->l2_tick_generated(l2_tick);
+
+        boost::interprocess::shared_memory_object shm_reader(boost::interprocess::open_only, shm_name.c_str(), boost::interprocess::read_only);
+        const boost::interprocess::mapped_region segment(shm_reader, boost::interprocess::read_only);
+
+        REQUIRE(trade::reporter::ShmReporter::check_layout(segment.get_address(), segment.get_size()) == trade::reporter::ShmLayout::compact);
+
+        const auto address = static_cast<const u_char*>(segment.get_address());
+        const auto header  = static_cast<const trade::reporter::SMSegmentHeader*>(segment.get_address());
+        CHECK(header->regions[0].record_size == sizeof(trade::reporter::CompactOrderTick));
+
+        const auto order_tick_mate_info = reinterpret_cast<const trade::reporter::SMTickMateInfo*>(address + header->regions[0].offset);
+        REQUIRE(order_tick_mate_info->tick_count == 1);
+
+        const auto order_ticks = reinterpret_cast<const trade::reporter::CompactOrderTick*>(order_tick_mate_info + 1);
+        CHECK(order_ticks[0].shm_union_type == trade::reporter::ShmUnionType::order_tick_from_exchange);
+        CHECK(order_ticks[0].order_type == trade::reporter::OrderType::sell);
+        CHECK(order_ticks[0].unique_id == 10000);
+        CHECK(std::string(order_ticks[0].symbol) == "600875.SH");
+        CHECK(order_ticks[0].price_1000x == 1111);
+        CHECK(order_ticks[0].quantity == 100);
+        CHECK(order_ticks[0].exchange_time == 93000120);
+
+        const auto l2_tick_mate_info = reinterpret_cast<const trade::reporter::SMGeneratedL2TickMateInfo*>(address + header->regions[3].offset);
+        REQUIRE(l2_tick_mate_info->generated_l2_tick_count == 1);
+
+        const auto l2_ticks = reinterpret_cast<const trade::reporter::CompactGeneratedL2Tick*>(l2_tick_mate_info + 1);
+        CHECK(l2_ticks[0].asks[0].price_1000x == 1111);
+        CHECK(l2_ticks[0].asks[4].quantity == 5000);
+        CHECK(l2_ticks[0].bids[0].price_1000x == 111);
+        CHECK(l2_ticks[0].bids[4].quantity == 500);
+    }
+
+    SECTION("Detect legacy layout")
+    {
+        const auto reporter = std::make_shared<trade::reporter::ShmReporter>(
+            shm_name,
+            shm_mutex_name,
+            1,
+            std::make_shared<trade::reporter::NopReporter>(),
+            std::array<size_t, 4> {1, 1, 1, 1},
+            trade::reporter::ShmPrefault::none
+        );
+
+        boost::interprocess::shared_memory_object shm_reader(boost::interprocess::open_only, shm_name.c_str(), boost::interprocess::read_only);
+        const boost::interprocess::mapped_region segment(shm_reader, boost::interprocess::read_only);
+
+        CHECK(trade::reporter::ShmReporter::check_layout(segment.get_address(), segment.get_size()) == trade::reporter::ShmLayout::legacy);
+
+        /// Segment smaller than regions written.
+        CHECK_THROWS_AS(trade::reporter::ShmReporter::check_layout(segment.get_address(), segment.get_size() / 2), std::runtime_error);
+    }
+
+    SECTION("Refuse header of other version")
+    {
+        trade::reporter::SMSegmentHeader header;
+        header.version = 3;
+
+        CHECK_THROWS_AS(trade::reporter::ShmReporter::check_layout(&header, sizeof(header)), std::runtime_error);
+    }
+
+    boost::interprocess::shared_memory_object::remove(shm_name.c_str());
+}
+
+TEST_CASE("Shm segment size", "[ShmReporter]")
+{
+    constexpr size_t MB        = 1024 * 1024;
+    constexpr size_t huge_page = 2 * MB;
+
+    const std::array<size_t, 4> odd_sizes  = {3 * MB, 2 * MB, 2 * MB, 2 * MB};
+    const std::array<size_t, 4> even_sizes = {4 * MB, 2 * MB, 2 * MB, 2 * MB};
+
+    SECTION("Without huge pages")
+    {
+        const auto legacy = trade::reporter::ShmReporter::size_segment(odd_sizes, trade::reporter::ShmLayout::legacy, 0);
+
+        CHECK(legacy.header_size == 0);
+        CHECK(legacy.segment_size == 9 * MB);
+
+        const auto compact = trade::reporter::ShmReporter::size_segment(odd_sizes, trade::reporter::ShmLayout::compact, 0);
+
+        CHECK(compact.header_size == 4096);
+        CHECK(compact.segment_size == 9 * MB + 4096);
+    }
+
+    SECTION("Rounded up to huge page size")
+    {
+        const auto legacy = trade::reporter::ShmReporter::size_segment(odd_sizes, trade::reporter::ShmLayout::legacy, huge_page);
+
+        CHECK(legacy.header_size == 0);
+        CHECK(legacy.segment_size == 10 * MB);
+
+        const auto even = trade::reporter::ShmReporter::size_segment(even_sizes, trade::reporter::ShmLayout::legacy, huge_page);
+
+        CHECK(even.segment_size == 10 * MB);
+    }
+
+    SECTION("Header takes a huge page")
+    {
+        const auto compact = trade::reporter::ShmReporter::size_segment(even_sizes, trade::reporter::ShmLayout::compact, huge_page);
+
+        /// Regions start at a huge page boundary.
+        CHECK(compact.header_size == huge_page);
+        CHECK(compact.segment_size == 12 * MB);
+        CHECK(compact.segment_size % huge_page == 0);
+
+        const auto odd = trade::reporter::ShmReporter::size_segment(odd_sizes, trade::reporter::ShmLayout::compact, huge_page);
+
+        CHECK(odd.segment_size == 12 * MB);
+    }
+}
+
+TEST_CASE("Shm startup benchmark", "[.][ShmReporter][benchmark]")
+{
+    const std::string shm_name       = "trade_data_for_startup_benchmark";
+    const std::string shm_mutex_name = "trade_data_mutex_for_startup_benchmark";
+
+    const auto prefault = GENERATE(trade::reporter::ShmPrefault::none, trade::reporter::ShmPrefault::background, trade::reporter::ShmPrefault::eager);
+
+    const auto start    = std::chrono::steady_clock::now();
+    const auto reporter = std::make_shared<trade::reporter::ShmReporter>(shm_name, shm_mutex_name, 1, std::make_shared<trade::reporter::NopReporter>(), std::array<size_t, 4> {}, prefault);
+    const auto elapsed  = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    WARN(fmt::format("Prefault mode {}: constructed in {}us", static_cast<int>(prefault), elapsed));
+
+    boost::interprocess::shared_memory_object::remove(shm_name.c_str());
+}
@@ -0,0 +1,142 @@
+#include <catch.hpp>
+#include <chrono>
+#include <fmt/format.h>
+
+#include "libbroker/SimImpl/SimMatcher.hpp"
+
+namespace
+{
+
+/// Levels are given as {price_1000x, quantity}, best first.
+trade::types::GeneratedL2Tick make_depth(
+    const std::vector<std::pair<int64_t, int64_t>>& asks,
+    const std::vector<std::pair<int64_t, int64_t>>& bids,
+    const std::string& symbol = "600000"
+)
+{
+    trade::types::GeneratedL2Tick generated_l2_tick;
+
+    generated_l2_tick.set_symbol(symbol);
+
+    for (const auto& [price_1000x, quantity] : asks) {
+        const auto level = generated_l2_tick.add_ask_levels();
+        level->set_price_1000x(price_1000x);
+        level->set_quantity(quantity);
+    }
+
+    for (const auto& [price_1000x, quantity] : bids) {
+        const auto level = generated_l2_tick.add_bid_levels();
+        level->set_price_1000x(price_1000x);
+        level->set_quantity(quantity);
+    }
+
+    return generated_l2_tick;
+}
+
+} // namespace
+
+TEST_CASE("Simulated matching against generated depth", "[SimMatcher]")
+{
+    trade::broker::SimMatcher matcher;
+    std::vector<trade::broker::SimMatcher::Fill> fills;
+
+    SECTION("Take crossed levels at their prices")
+    {
+        matcher.update(make_depth({{10000, 100}, {10010, 200}, {10020, 300}}, {{9990, 100}}), fills);
+
+        CHECK(matcher.add(1, "600000", true, 10010, 250, fills));
+
+        REQUIRE(fills.size() == 2);
+        CHECK(fills[0].price_1000x == 10000);
+        CHECK(fills[0].quantity == 100);
+        CHECK(fills[1].price_1000x == 10010);
+        CHECK(fills[1].quantity == 150);
+        CHECK(fills[1].cumulative_quantity == 250);
+        CHECK(matcher.size() == 0);
+
+        /// Only 50 left at 10010 until depth is replaced.
+        fills.clear();
+
+        CHECK(matcher.add(2, "600000", true, 10010, 100, fills));
+        REQUIRE(fills.size() == 1);
+        CHECK(fills[0].quantity == 50);
+        CHECK(matcher.size() == 1);
+    }
+
+    SECTION("Working orders filled by later depth")
+    {
+        CHECK(matcher.add(1, "600000", false, 10000, 300, fills));
+        CHECK(matcher.add(2, "600000", false, 10010, 100, fills));
+        CHECK(fills.empty());
+        CHECK_FALSE(matcher.add(1, "600000", false, 10000, 300, fills));
+
+        matcher.update(make_depth({{10020, 100}}, {{10010, 200}, {10000, 200}}), fills);
+
+        /// Better priced order is filled first.
+        REQUIRE(fills.size() == 2);
+        CHECK(fills[0].unique_id == 1);
+        CHECK(fills[0].quantity == 200);
+        CHECK(fills[1].unique_id == 1);
+        CHECK(fills[1].quantity == 100);
+        CHECK(fills[1].cumulative_quantity == 300);
+
+        /// Depth at 10010 has been taken by order 1.
+        CHECK(matcher.size() == 1);
+        CHECK(matcher.cancel(2) == 100);
+        CHECK_FALSE(matcher.cancel(1).has_value());
+    }
+
+    SECTION("Cancel partially filled order")
+    {
+        matcher.update(make_depth({{10000, 100}}, {}), fills);
+
+        CHECK(matcher.add(1, "600000", true, 10000, 300, fills));
+        CHECK(matcher.cancel(1) == 200);
+        CHECK(matcher.size() == 0);
+    }
+
+    SECTION("Symbols do not interfere")
+    {
+        CHECK(matcher.add(1, "600000", true, 10000, 100, fills));
+
+        matcher.update(make_depth({{9000, 100}}, {}, "000001"), fills);
+
+        CHECK(fills.empty());
+        CHECK(matcher.size() == 1);
+    }
+}
+
+TEST_CASE("Simulated matching benchmark", "[.][SimMatcher][benchmark]")
+{
+    constexpr int64_t orders  = 1000000;
+    constexpr int64_t symbols = 1000;
+
+    trade::broker::SimMatcher matcher;
+    std::vector<trade::broker::SimMatcher::Fill> fills;
+    std::vector<std::string> symbol_names;
+
+    for (int64_t i = 0; i < symbols; i++)
+        symbol_names.push_back(fmt::format("{:06d}", i));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    /// Half of orders rest, half of them are filled by next depth.
+    for (int64_t i = 0; i < orders; i++) {
+        matcher.add(i + 1, symbol_names[i % symbols], true, i % 2 == 0 ? 10000 : 9000, 100, fills);
+
+        i % symbols == symbols - 1 ? matcher.update(make_depth({{10000, 1000000}}, {{9990, 100}}, symbol_names[i / symbols % symbols]), fills) : void();
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    CHECK(fills.size() > 0);
+
+    WARN(fmt::format(
+        "{} orders on {} symbols: {:.1f} ns per order, {} fills, {} working",
+        orders,
+        symbols,
+        std::chrono::duration<double, std::nano>(elapsed).count() / orders,
+        fills.size(),
+        matcher.size()
+    ));
+}
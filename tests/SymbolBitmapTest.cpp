@@ -0,0 +1,66 @@
+#include <catch.hpp>
+#include <memory>
+#include <thread>
+
+#include "utilities/SymbolBitmap.hpp"
+
+TEST_CASE("SymbolBitmap", "[SymbolBitmap]")
+{
+    /// Too large to be put on stack.
+    const auto bitmap = std::make_unique<trade::utilities::SymbolBitmap>();
+
+    SECTION("Set and reset")
+    {
+        CHECK(bitmap->count() == 0);
+
+        CHECK(bitmap->set(0));
+        CHECK(bitmap->set(600000));
+        CHECK(bitmap->set(999999));
+        CHECK_FALSE(bitmap->set(1000000));
+        CHECK_FALSE(bitmap->set(-1));
+
+        CHECK(bitmap->test(0));
+        CHECK(bitmap->test(600000));
+        CHECK(bitmap->test(999999));
+        CHECK_FALSE(bitmap->test(600001));
+        CHECK_FALSE(bitmap->test(1000000));
+        CHECK(bitmap->count() == 3);
+
+        CHECK(bitmap->reset(600000));
+        CHECK_FALSE(bitmap->test(600000));
+        CHECK(bitmap->count() == 2);
+    }
+
+    SECTION("Set and reset all")
+    {
+        bitmap->set_all();
+        CHECK(bitmap->count() == trade::utilities::SymbolBitmap::capacity);
+        CHECK(bitmap->test(999999));
+        CHECK_FALSE(bitmap->test(1000000));
+
+        bitmap->reset_all();
+        CHECK(bitmap->count() == 0);
+    }
+
+    SECTION("Update while testing")
+    {
+        std::atomic<bool> is_running = true;
+        std::atomic<int64_t> false_positives = 0;
+
+        std::thread tester([&bitmap, &is_running, &false_positives] {
+            while (is_running) {
+                /// Never set.
+                false_positives += bitmap->test(1);
+            }
+        });
+
+        for (int64_t symbol = 2; symbol < trade::utilities::SymbolBitmap::capacity; symbol += 2)
+            bitmap->set(symbol);
+
+        is_running = false;
+        tester.join();
+
+        CHECK(false_positives == 0);
+        CHECK(bitmap->count() == trade::utilities::SymbolBitmap::capacity / 2 - 1);
+    }
+}
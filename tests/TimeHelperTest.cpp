@@ -1,4 +1,5 @@
 #include <catch.hpp>
+#include <thread>
 
 #include "utilities/TimeHelper.hpp"
 
@@ -68,5 +69,22 @@ TEST_CASE("Time conversion correctness verification", "[TimeHelper]")
         CHECK(timestamp->seconds() == 946753445); /// 2000-01-02 03:04:05.
         CHECK(timestamp->nanos() == 678000000);   /// 678 milliseconds.
     }
+
+    SECTION("Cached current time")
+    {
+        trade::utilities::CachedNow cached_now;
+
+        for (int i = 0; i < 100; i++) {
+            const auto before = trade::utilities::Now<std::string>()();
+            const auto cached = std::string(cached_now());
+            const auto after  = trade::utilities::Now<std::string>()();
+
+            CHECK(cached.size() == before.size());
+            CHECK(before <= cached);
+            CHECK(cached <= after);
+
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
 }
 #endif
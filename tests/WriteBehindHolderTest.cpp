@@ -0,0 +1,224 @@
+#include <catch.hpp>
+
+#include "libholder/SQLiteHolder.h"
+#include "libholder/WriteBehindHolder.h"
+#include "utilities/TimeHelper.hpp"
+
+namespace
+{
+
+std::shared_ptr<trade::types::Orders> make_orders(const int64_t unique_id, const std::string& broker_id = "", const std::string& exchange_id = "")
+{
+    const auto orders = std::make_shared<trade::types::Orders>();
+    const auto order  = orders->add_orders();
+
+    order->set_unique_id(unique_id);
+    broker_id.empty() ? void() : order->set_broker_id(broker_id);
+    exchange_id.empty() ? void() : order->set_exchange_id(exchange_id);
+    order->set_symbol("600000.SH");
+    order->set_side(trade::types::SideType::buy);
+    order->set_price(10.0);
+    order->set_quantity(100);
+    order->set_allocated_creation_time(trade::utilities::Now<google::protobuf::Timestamp*>()());
+    order->set_allocated_update_time(trade::utilities::Now<google::protobuf::Timestamp*>()());
+
+    return orders;
+}
+
+/// Fails the first failures order updates, passes others to SQLite.
+class FailingHolder final: public trade::holder::IHolder
+{
+public:
+    explicit FailingHolder(const int failures) : failures(failures) {}
+
+public:
+    int64_t update_symbols(const std::shared_ptr<trade::types::Symbols> symbols) override { return holder->update_symbols(symbols); }
+    std::shared_ptr<trade::types::Symbols> query_symbols_by_symbol(const std::string& symbol) override { return holder->query_symbols_by_symbol(symbol); }
+    std::shared_ptr<trade::types::Symbols> query_symbols_by_exchange(const trade::types::ExchangeType exchange) override { return holder->query_symbols_by_exchange(exchange); }
+
+    int64_t update_funds(const std::shared_ptr<trade::types::Funds> funds) override { return holder->update_funds(funds); }
+    std::shared_ptr<trade::types::Funds> query_funds_by_account_id(const std::string& account_id) override { return holder->query_funds_by_account_id(account_id); }
+
+    int64_t update_positions(const std::shared_ptr<trade::types::Positions> positions) override { return holder->update_positions(positions); }
+    std::shared_ptr<trade::types::Positions> query_positions_by_symbol(const std::string& symbol) override { return holder->query_positions_by_symbol(symbol); }
+
+    int64_t update_orders(const std::shared_ptr<trade::types::Orders> orders) override
+    {
+        if (++attempts <= failures)
+            throw std::runtime_error("Database is locked");
+
+        return holder->update_orders(orders);
+    }
+
+    std::shared_ptr<trade::types::Orders> query_orders_by_unique_id(const int64_t unique_id) override { return holder->query_orders_by_unique_id(unique_id); }
+    std::shared_ptr<trade::types::Orders> query_orders_by_broker_id(const std::string& broker_id) override { return holder->query_orders_by_broker_id(broker_id); }
+    std::shared_ptr<trade::types::Orders> query_orders_by_exchange_id(const std::string& exchange_id) override { return holder->query_orders_by_exchange_id(exchange_id); }
+
+public:
+    const std::shared_ptr<trade::holder::SQLiteHolder> holder = std::make_shared<trade::holder::SQLiteHolder>();
+    const int failures;
+    int attempts = 0;
+};
+
+} // namespace
+
+TEST_CASE("Write-behind order store", "[WriteBehindHolder]")
+{
+    const auto sqlite_holder = std::make_shared<trade::holder::SQLiteHolder>();
+
+    SECTION("Query from memory before written")
+    {
+        trade::holder::WriteBehindHolder holder(sqlite_holder, std::chrono::hours(1));
+
+        CHECK(holder.update_orders(make_orders(1)) == 1);
+        CHECK(holder.update_orders(make_orders(1, "100")) == 1);
+        CHECK(holder.update_orders(make_orders(1, "100", "SH100")) == 1);
+
+        REQUIRE(holder.query_orders_by_unique_id(1)->orders_size() == 1);
+        REQUIRE(holder.query_orders_by_broker_id("100")->orders_size() == 1);
+        REQUIRE(holder.query_orders_by_exchange_id("SH100")->orders_size() == 1);
+        CHECK(holder.query_orders_by_exchange_id("SH100")->orders(0).unique_id() == 1);
+
+        CHECK(holder.pending() == 3);
+        CHECK(sqlite_holder->query_orders_by_unique_id(1)->orders_size() == 0);
+
+        holder.flush();
+
+        CHECK(holder.pending() == 0);
+
+        const auto written = sqlite_holder->query_orders_by_exchange_id("SH100");
+
+        REQUIRE(written->orders_size() == 1);
+        CHECK(written->orders(0).broker_id() == "100");
+    }
+
+    SECTION("Move indexes with order")
+    {
+        trade::holder::WriteBehindHolder holder(sqlite_holder, std::chrono::hours(1));
+
+        holder.update_orders(make_orders(2, "200"));
+        holder.update_orders(make_orders(2, "201"));
+
+        CHECK(holder.query_orders_by_broker_id("200")->orders_size() == 0);
+        CHECK(holder.query_orders_by_broker_id("201")->orders_size() == 1);
+    }
+
+    SECTION("Write in batches within lag")
+    {
+        trade::holder::WriteBehindHolder holder(sqlite_holder, std::chrono::milliseconds(10), 4);
+
+        for (int64_t unique_id = 10; unique_id < 20; unique_id++)
+            holder.update_orders(make_orders(unique_id));
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (holder.pending() > 0 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        CHECK(holder.pending() == 0);
+        CHECK(sqlite_holder->query_orders_by_unique_id(19)->orders_size() == 1);
+    }
+
+    SECTION("Write pending orders when destroyed")
+    {
+        {
+            trade::holder::WriteBehindHolder holder(sqlite_holder, std::chrono::hours(1));
+            holder.update_orders(make_orders(3, "300"));
+        }
+
+        CHECK(sqlite_holder->query_orders_by_broker_id("300")->orders_size() == 1);
+    }
+
+    SECTION("Fall back to persistent holder")
+    {
+        sqlite_holder->update_orders(make_orders(4, "400", "SH400"));
+
+        trade::holder::WriteBehindHolder holder(sqlite_holder, std::chrono::hours(1));
+
+        REQUIRE(holder.query_orders_by_exchange_id("SH400")->orders_size() == 1);
+
+        /// Read through, neither kept in memory nor written back.
+        CHECK(holder.query_orders_by_broker_id("400")->orders_size() == 1);
+        CHECK(holder.pending() == 0);
+        CHECK(holder.kept() == 0);
+    }
+
+    SECTION("Count only orders accepted")
+    {
+        trade::holder::WriteBehindHolder holder(sqlite_holder, std::chrono::hours(1));
+
+        const auto orders = make_orders(5);
+        orders->add_orders()->CopyFrom(make_orders(INVALID_ID)->orders(0));
+
+        CHECK(holder.update_orders(orders) == 1);
+        CHECK(holder.pending() == 1);
+    }
+
+    SECTION("Evict orders once written")
+    {
+        trade::holder::WriteBehindHolder holder(sqlite_holder, std::chrono::hours(1));
+
+        holder.update_orders(make_orders(6, "600"));
+        holder.update_orders(make_orders(7, "700"));
+        holder.flush();
+
+        CHECK(holder.kept() == 0);
+
+        /// Read from persistent holder after evicted.
+        REQUIRE(holder.query_orders_by_broker_id("600")->orders_size() == 1);
+        CHECK(holder.query_orders_by_unique_id(7)->orders(0).broker_id() == "700");
+
+        /// Kept again while changes are not written.
+        holder.update_orders(make_orders(6, "600", "SH600"));
+
+        CHECK(holder.kept() == 1);
+        CHECK(holder.query_orders_by_exchange_id("SH600")->orders_size() == 1);
+
+        holder.flush();
+
+        CHECK(holder.kept() == 0);
+        CHECK(holder.query_orders_by_exchange_id("SH600")->orders_size() == 1);
+    }
+}
+
+TEST_CASE("Write-behind retries", "[WriteBehindHolder]")
+{
+    SECTION("Write orders again after failed writes")
+    {
+        const auto failing_holder = std::make_shared<FailingHolder>(2);
+
+        trade::holder::WriteBehindHolder holder(failing_holder, std::chrono::milliseconds(1));
+
+        holder.update_orders(make_orders(1, "100"));
+        holder.flush();
+
+        CHECK(failing_holder->attempts == 3);
+        CHECK(holder.pending() == 0);
+        CHECK(failing_holder->holder->query_orders_by_broker_id("100")->orders_size() == 1);
+    }
+
+    SECTION("Drop orders still failing when destroyed")
+    {
+        const auto failing_holder = std::make_shared<FailingHolder>(100);
+
+        {
+            trade::holder::WriteBehindHolder holder(failing_holder, std::chrono::milliseconds(1));
+
+            holder.update_orders(make_orders(1));
+            holder.update_orders(make_orders(2));
+        }
+
+        CHECK(failing_holder->attempts == 3);
+        CHECK(failing_holder->holder->query_orders_by_unique_id(1)->orders_size() == 0);
+    }
+
+    SECTION("Written count of rolled back update")
+    {
+        const auto sqlite_holder = std::make_shared<trade::holder::SQLiteHolder>();
+        const auto orders        = make_orders(1);
+
+        orders->mutable_orders(0)->set_side(trade::types::SideType::invalid_side);
+
+        CHECK(sqlite_holder->update_orders(orders) == 0);
+    }
+}